@@ -0,0 +1,127 @@
+#ifndef ASSIGNMENT_2_CAPACITYSWEEP_H
+#define ASSIGNMENT_2_CAPACITYSWEEP_H
+
+#include "childProcess.h"
+#include <dc_application/command_line.h>
+#include <dc_application/config.h>
+#include <dc_application/defaults.h>
+#include <dc_application/environment.h>
+#include <dc_application/options.h>
+#include <dc_posix/dc_fcntl.h>
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <dc_posix/dc_unistd.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define DEFAULT_SERVER_PROGRAM "./server"
+#define DEFAULT_CLIENT_PROGRAM "./client"
+#define DEFAULT_SWEEP_PORT 5981
+#define DEFAULT_SWEEP_SIZES "64,512,1024"
+#define DEFAULT_MIN_RATE "1000"
+#define DEFAULT_MAX_RATE "1000000"
+#define DEFAULT_TRIAL_SECONDS 2
+#define DEFAULT_PRECISION "0.05"
+#define DEFAULT_WORK_DIR "sweep"
+#define DEFAULT_CSV "sweep.csv"
+#define DEFAULT_JSON "sweep.json"
+#define MIN_PACKET_SIZE 13
+#define MAX_TRIAL_PACKETS 65535
+#define MIN_TRIAL_PACKETS 100
+#define MAX_SWEEP_SIZES 32
+#define SERVER_STARTUP_MS 300
+#define TRIAL_DRAIN_MS 250
+
+/**
+ * Sweep configuration and the long running server it measures.
+ */
+struct sweep {
+    const char *serverProgram;
+    const char *clientProgram;
+    u_int16_t port;
+    u_int16_t sizes[MAX_SWEEP_SIZES];
+    size_t sizeCount;
+    u_int32_t minRate;
+    u_int32_t maxRate;
+    u_int16_t trialSeconds;
+    double precision;
+    char tcpLog[512];
+    char udpLog[512];
+    pid_t serverPID;
+    int nullFD;
+    off_t udpOffset;
+    unsigned int clientsStarted;
+};
+
+/**
+ * Outcome of sending one client's packets at a fixed rate.
+ */
+struct trial_result {
+    u_int16_t size;
+    u_int32_t rate;
+    u_int32_t sent;
+    u_int32_t received;
+    double seconds;
+    double serverCpu;
+    double clientCpu;
+};
+
+/**
+ * Highest loss-free rate found for one packet size.
+ */
+struct sweep_result {
+    u_int16_t size;
+    bool saturated;
+    struct trial_result best;
+    unsigned int trials;
+};
+
+/**
+ * Runs one client at the given rate and counts how many of its packets the
+ * server logged.
+ * @param env
+ * @param err
+ * @param sweep
+ * @param size packet size in bytes
+ * @param rate packets per second
+ * @param result filled with the trial outcome
+ * @return 0 on success, -1 if the client could not be run
+ */
+int runTrial(const struct dc_posix_env *env, struct dc_error *err, struct sweep *sweep, u_int16_t size,
+        u_int32_t rate, struct trial_result *result);
+
+/**
+ * Finds the highest loss-free rate for a packet size: the rate doubles
+ * until packets are lost, then a binary search narrows the gap to the
+ * configured precision.
+ * @param env
+ * @param err
+ * @param sweep
+ * @param size packet size in bytes
+ * @param result filled with the best trial
+ */
+void sweepPacketSize(const struct dc_posix_env *env, struct dc_error *err, struct sweep *sweep, u_int16_t size,
+        struct sweep_result *result);
+
+/**
+ * Writes the sweep table as CSV.
+ * @param path
+ * @param results
+ * @param count
+ * @return 0 on success, -1 if the file could not be written
+ */
+int writeSweepCsv(const char *path, const struct sweep_result *results, size_t count);
+
+/**
+ * Writes the sweep table as JSON.
+ * @param path
+ * @param results
+ * @param count
+ * @return 0 on success, -1 if the file could not be written
+ */
+int writeSweepJson(const char *path, const struct sweep_result *results, size_t count);
+
+#endif //ASSIGNMENT_2_CAPACITYSWEEP_H
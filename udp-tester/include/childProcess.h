@@ -0,0 +1,65 @@
+#ifndef ASSIGNMENT_2_CHILDPROCESS_H
+#define ASSIGNMENT_2_CHILDPROCESS_H
+
+#include <dc_posix/dc_fcntl.h>
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <dc_posix/dc_unistd.h>
+#include <dc_posix/sys/dc_wait.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <time.h>
+
+/**
+ * Starts a program in a child process.
+ * @param env
+ * @param err
+ * @param argv NULL terminated argument list, argv[0] is the program path
+ * @param outputFD descriptor for the child's stdout and stderr, -1 to inherit
+ * @return pid of the child, -1 on failure
+ */
+pid_t spawnProcess(const struct dc_posix_env *env, struct dc_error *err, const char *const argv[], int outputFD);
+
+/**
+ * Waits for a child and collects its resource usage.
+ * @param env
+ * @param err
+ * @param pid
+ * @param usage filled with the child's CPU usage, may be NULL
+ * @return exit status of the child, -1 if it did not exit normally
+ */
+int waitProcess(const struct dc_posix_env *env, struct dc_error *err, pid_t pid, struct rusage *usage);
+
+/**
+ * Stops a long running child such as the server and reaps it.
+ * @param env
+ * @param err
+ * @param pid
+ */
+void stopProcess(const struct dc_posix_env *env, struct dc_error *err, pid_t pid);
+
+/**
+ * Reads the user plus system CPU time a running process has used so far.
+ * @param pid
+ * @return CPU time in seconds, 0 if /proc is not available
+ */
+double processCpuSeconds(pid_t pid);
+
+/**
+ * Converts the user plus system time in a rusage to seconds.
+ * @param usage
+ * @return CPU time in seconds
+ */
+double rusageCpuSeconds(const struct rusage *usage);
+
+/**
+ * Returns a monotonic timestamp in seconds for measuring wall time.
+ * @return double seconds
+ */
+double monotonicSeconds(void);
+
+#endif //ASSIGNMENT_2_CHILDPROCESS_H
@@ -13,8 +13,18 @@
 #include <dc_posix/dc_netdb.h>
 #include <dc_posix/dc_unistd.h>
 #include <dc_posix/sys/dc_socket.h>
+#include "fastFormat.h"
+#include "hotPath.h"
+#include "pcapReplay.h"
+#include "rateSeries.h"
+#include "tcpStream.h"
+#include <arpa/inet.h>
+#include <dc_posix/dc_fcntl.h>
 #include <getopt.h>
+#include <inttypes.h>
 #include <netinet/in.h>
+#include <poll.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
@@ -26,6 +36,20 @@
 #define DEFAULT_PACKETS 100
 #define DEFAULT_PACKET_SIZE 100
 #define DEFAULT_DELAY 50
+#define DEFAULT_RATE "0"
+#define DEFAULT_STREAM_BYTES "0"
+#define DEFAULT_CLIENT_TCP_LOG "../../logs/clientTcpLog.txt"
+#define DEFAULT_CLIENT_UDP_LOG "../../logs/clientUdpLog.txt"
+#define DEFAULT_REPLAY ""
+#define DEFAULT_REPLAY_SPEED "1"
+#define DEFAULT_REPLAY_PORT 0
+#define DEFAULT_STATS ""
+#define RECEIVE_BATCH 64
+#define RECEIVE_SLOT 64
+#define RECEIVE_HEADER 11
+#define RECEIVE_LOG_LINE 128
+#define RECEIVE_SOCKET_BUFFER (4 * 1024 * 1024)
+#define RECEIVE_DRAIN_MS 250
 #define MAXLINE  1024
 
 /**
@@ -35,6 +59,9 @@ enum application_states {
     SEND_TCP = DC_FSM_USER_START,
     CREATE_UDP_CONNECTION,
     SEND_TO_SERVER,
+    STREAM_TO_SERVER,
+    RECEIVE_FROM_SERVER,
+    SHOW_STATS,
     CLOSE,
 };
 
@@ -44,10 +71,24 @@ enum application_states {
 struct client {
     const char* server;
     u_int16_t port;
+    u_int16_t udpPort;
     const char* start;
     u_int16_t packets;
     u_int16_t packetSize;
     u_int16_t delay;
+    u_int32_t rate;
+    bool stream;
+    u_int16_t duration;
+    uint64_t streamBytes;
+    u_int16_t interval;
+    bool reverse;
+    const char* tcpLog;
+    const char* udpLog;
+    const char* replay;
+    double speed;
+    u_int16_t replayPort;
+    struct replay_trace trace;
+    const char* stats;
     int tcpSocketFD;
     int udpSocketFD;
     const char* clientID;
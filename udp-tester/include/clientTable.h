@@ -0,0 +1,127 @@
+#ifndef ASSIGNMENT_2_CLIENTTABLE_H
+#define ASSIGNMENT_2_CLIENTTABLE_H
+
+#include "hotPath.h"
+#include "logScanner.h"
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#define CLIENT_TABLE_INITIAL_SLOTS 64
+#define CLIENT_PACKETS_INITIAL 256
+
+/**
+ * One client from the TCP log and the packet numbers the UDP log holds for it,
+ * in log order, with the second each one arrived.
+ */
+struct client_record {
+    u_int32_t clientID;
+    char name[12];
+    u_int32_t expectedNumberOfPackets;
+    u_int16_t packetSize;
+    u_int32_t *packetIDs;
+    u_int32_t *arrivals;
+    size_t receivedNumberOfPackets;
+    size_t packetCapacity;
+};
+
+/**
+ * Clients in TCP log order, indexed by an open-addressing hash on the numeric
+ * client id so each UDP log line is matched in constant time.
+ */
+struct client_table {
+    struct client_record *records;
+    size_t count;
+    size_t capacity;
+    u_int32_t *slots;
+    size_t slotCount;
+};
+
+/**
+ * Sets up an empty table.
+ * @param env
+ * @param err
+ * @param table
+ * @return 0 on success, -1 if allocation failed
+ */
+int initClientTable(const struct dc_posix_env *env, struct dc_error *err, struct client_table *table);
+
+/**
+ * Frees the table and every client's packet arrays.
+ * @param env
+ * @param table
+ */
+void destroyClientTable(const struct dc_posix_env *env, struct client_table *table);
+
+/**
+ * Looks up a client by its numeric id.
+ * @param table
+ * @param clientID
+ * @return the client, NULL if it is not in the table
+ */
+struct client_record *findClient(const struct client_table *table, u_int32_t clientID);
+
+/**
+ * Finds a client or appends a new one. The returned pointer is valid until
+ * the next call to addClient.
+ * @param env
+ * @param err
+ * @param table
+ * @param clientID
+ * @return the client, NULL if allocation failed
+ */
+struct client_record *addClient(const struct dc_posix_env *env, struct dc_error *err, struct client_table *table,
+        u_int32_t clientID);
+
+/**
+ * Appends a packet number to a client, growing its arrays geometrically.
+ * @param env
+ * @param err
+ * @param record
+ * @param packetID
+ * @param arrival second the packet was logged
+ * @return 0 on success, -1 if allocation failed
+ */
+int appendPacket(const struct dc_posix_env *env, struct dc_error *err, struct client_record *record, u_int32_t packetID,
+        u_int32_t arrival);
+
+/**
+ * Makes room for count more packets with one allocation at most, so later
+ * appends up to that many do not reallocate.
+ * @param env
+ * @param err
+ * @param record
+ * @param count
+ * @return 0 on success, -1 if allocation failed
+ */
+int reserveClientPackets(const struct dc_posix_env *env, struct dc_error *err, struct client_record *record,
+        size_t count);
+
+/**
+ * Appends a run of packet numbers to a client with one allocation at most.
+ * @param env
+ * @param err
+ * @param record
+ * @param packetIDs
+ * @param arrivals one per packet number
+ * @param count
+ * @return 0 on success, -1 if allocation failed
+ */
+int appendPackets(const struct dc_posix_env *env, struct dc_error *err, struct client_record *record,
+        const u_int32_t *packetIDs, const u_int32_t *arrivals, size_t count);
+
+/**
+ * Adds every client registered in a TCP log to the table, in log order.
+ * @param env
+ * @param err
+ * @param tcpLog path of the log
+ * @param table initialised by initClientTable
+ * @return 0 on success, -1 if the log could not be read or allocation failed
+ */
+int loadClientTable(const struct dc_posix_env *env, struct dc_error *err, const char *tcpLog,
+        struct client_table *table);
+
+#endif //ASSIGNMENT_2_CLIENTTABLE_H
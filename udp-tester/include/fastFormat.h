@@ -0,0 +1,63 @@
+#ifndef ASSIGNMENT_2_FASTFORMAT_H
+#define ASSIGNMENT_2_FASTFORMAT_H
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#define FORMAT_DECIMAL_LENGTH 20
+#define FORMAT_IPV4_LENGTH 15
+#define FORMAT_HEADER_LENGTH (4 + 1 + FORMAT_DECIMAL_LENGTH + 1)
+#define FORMAT_LOG_LINE_LENGTH 128
+
+/*
+ * Formatting for the per-packet and per-line paths. Numbers are written two
+ * digits at a time from a table and nothing is NUL terminated; every call
+ * returns the number of bytes written so the caller can keep appending.
+ */
+
+/**
+ * Writes value in decimal, zero padded to at least width digits, like
+ * printf's %0*llu.
+ * @param out room for max(width, FORMAT_DECIMAL_LENGTH) bytes
+ * @param value
+ * @param width 0 for no padding
+ * @return bytes written
+ */
+size_t formatDecimal(char *out, u_int64_t value, size_t width);
+
+/**
+ * Writes an IPv4 address in dotted decimal, like inet_ntop().
+ * @param out room for FORMAT_IPV4_LENGTH bytes
+ * @param address in network byte order
+ * @return bytes written
+ */
+size_t formatIPv4(char *out, in_addr_t address);
+
+/**
+ * Writes a packet header the way "%.4s:%06u:" does.
+ * @param out room for FORMAT_HEADER_LENGTH bytes
+ * @param clientID at most its first four characters are used
+ * @param packetID
+ * @return bytes written
+ */
+size_t formatPacketHeader(char *out, const char *clientID, u_int32_t packetID);
+
+/**
+ * Writes a UDP log line, "client:packet:time:address:port\n", the way
+ * "%.4s:%.6s:%s:%s:%hu\n" does with the address from inet_ntop().
+ * @param out room for FORMAT_LOG_LINE_LENGTH bytes
+ * @param packet datagram, its id fields end at a NUL or at length
+ * @param length datagram length
+ * @param timeString receive time
+ * @param timeLength length of timeString, at most 32
+ * @param sender
+ * @return bytes written
+ */
+size_t formatLogLine(char *out, const char *packet, size_t length, const char *timeString, size_t timeLength,
+        const struct sockaddr_in *sender);
+
+#endif //ASSIGNMENT_2_FASTFORMAT_H
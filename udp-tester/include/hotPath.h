@@ -0,0 +1,87 @@
+#ifndef ASSIGNMENT_2_HOTPATH_H
+#define ASSIGNMENT_2_HOTPATH_H
+
+#include <dc_posix/dc_unistd.h>
+#include <dc_posix/sys/dc_socket.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/*
+ * Per-packet and per-line calls that skip the dc_posix wrappers. The
+ * wrappers check the tracer and the error object on every call; these go
+ * straight to libc and only touch err when the call fails. Setup and
+ * configuration code keeps using the wrappers.
+ */
+
+/**
+ * sendto() that records errno in err on failure.
+ * @param err
+ * @param fd
+ * @param buffer
+ * @param length
+ * @param address
+ * @param addressLength
+ * @return bytes sent, -1 on failure
+ */
+static inline ssize_t hotSendTo(struct dc_error *err, int fd, const void *buffer, size_t length,
+        const struct sockaddr *address, socklen_t addressLength) {
+    ssize_t sent = sendto(fd, buffer, length, 0, address, addressLength);
+
+    if (sent == -1) {
+        DC_ERROR_RAISE_ERRNO(err, errno);
+    }
+
+    return sent;
+}
+
+/**
+ * write() that records errno in err on failure.
+ * @param err
+ * @param fd
+ * @param buffer
+ * @param length
+ * @return bytes written, -1 on failure
+ */
+static inline ssize_t hotWrite(struct dc_error *err, int fd, const void *buffer, size_t length) {
+    ssize_t written = write(fd, buffer, length);
+
+    if (written == -1) {
+        DC_ERROR_RAISE_ERRNO(err, errno);
+    }
+
+    return written;
+}
+
+/**
+ * memcpy() without the tracer, so small fixed sizes compile to moves.
+ * @param destination
+ * @param source
+ * @param length
+ */
+static inline void hotCopy(void *destination, const void *source, size_t length) {
+    memcpy(destination, source, length);
+}
+
+/**
+ * memset() without the tracer.
+ * @param destination
+ * @param value
+ * @param length
+ */
+static inline void hotFill(void *destination, int value, size_t length) {
+    memset(destination, value, length);
+}
+
+/**
+ * strlen() without the tracer.
+ * @param text
+ * @return length of text
+ */
+static inline size_t hotLength(const char *text) {
+    return strlen(text);
+}
+
+#endif //ASSIGNMENT_2_HOTPATH_H
@@ -0,0 +1,145 @@
+#ifndef ASSIGNMENT_2_IMPAIRPROXY_H
+#define ASSIGNMENT_2_IMPAIRPROXY_H
+
+#include "prng.h"
+#include <arpa/inet.h>
+#include <dc_application/command_line.h>
+#include <dc_application/config.h>
+#include <dc_application/defaults.h>
+#include <dc_application/environment.h>
+#include <dc_application/options.h>
+#include <dc_posix/dc_netdb.h>
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <dc_posix/dc_unistd.h>
+#include <dc_posix/sys/dc_socket.h>
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <time.h>
+
+#define DEFAULT_PROXY_PORT 4982
+#define DEFAULT_SERVER_ADDRESS "127.0.0.1"
+#define DEFAULT_SERVER_PORT 4981
+#define DEFAULT_SEED "1"
+#define DEFAULT_REORDER_DEPTH 3
+#define PROXY_BATCH 64
+#define PROXY_SLOTS 8192
+#define PROXY_SLOT_SIZE 2048
+#define PROXY_MAX_HELD 256
+#define PROXY_IDLE_FLUSH_MS 100
+#define PROXY_SOCKET_BUFFER (4 * 1024 * 1024)
+
+/**
+ * Impairments applied to every datagram. Probabilities are stored as
+ * prngThreshold() values so each decision is one compare.
+ */
+struct impairment {
+    uint64_t drop;
+    bool gilbertElliott;
+    uint64_t goodToBad;
+    uint64_t badToGood;
+    uint64_t goodLoss;
+    uint64_t badLoss;
+    uint64_t reorder;
+    u_int16_t reorderDepth;
+    uint64_t duplicate;
+    uint64_t corrupt;
+    uint64_t delayNs;
+};
+
+/**
+ * Counters printed when the proxy shuts down.
+ */
+struct proxy_stats {
+    uint64_t received;
+    uint64_t forwarded;
+    uint64_t dropped;
+    uint64_t burstDropped;
+    uint64_t duplicated;
+    uint64_t reordered;
+    uint64_t corrupted;
+    uint64_t overflow;
+};
+
+/**
+ * A packet held back until reorderDepth later packets have passed it.
+ */
+struct held_packet {
+    u_int32_t slot;
+    u_int16_t remaining;
+};
+
+/**
+ * Proxy state. Packets live in a fixed pool of slots; the delay queue is a
+ * FIFO of slot numbers because every packet gets the same delay.
+ */
+struct proxy {
+    int listenFD;
+    int upstreamFD;
+    struct impairment impairment;
+    struct prng prng;
+    bool badState;
+    char *pool;
+    u_int16_t *lengths;
+    u_int32_t *freeSlots;
+    size_t freeCount;
+    u_int32_t *queue;
+    uint64_t *release;
+    size_t queueHead;
+    size_t queueCount;
+    struct held_packet held[PROXY_MAX_HELD];
+    size_t heldCount;
+    struct proxy_stats stats;
+};
+
+/**
+ * Allocates the packet pool and queues for a proxy.
+ * @param env
+ * @param err
+ * @param proxy
+ * @return 0 on success, -1 if memory could not be allocated
+ */
+int createProxy(const struct dc_posix_env *env, struct dc_error *err, struct proxy *proxy);
+
+/**
+ * Frees the packet pool and queues and closes the sockets.
+ * @param env
+ * @param err
+ * @param proxy
+ */
+void destroyProxy(const struct dc_posix_env *env, struct dc_error *err, struct proxy *proxy);
+
+/**
+ * Decides whether the next packet is lost, applying the Gilbert-Elliott
+ * model first and then the independent drop rate.
+ * @param proxy
+ * @return true if the packet should be dropped
+ */
+bool shouldDrop(struct proxy *proxy);
+
+/**
+ * Runs the impairment pipeline on one received packet: loss, corruption,
+ * duplication, reordering and finally the delay queue.
+ * @param proxy
+ * @param slot pool slot holding the packet
+ * @param now monotonic time in nanoseconds
+ */
+void impairPacket(struct proxy *proxy, u_int32_t slot, uint64_t now);
+
+/**
+ * Forwards datagrams from the listen socket to the upstream server until
+ * SIGINT or SIGTERM is received.
+ * @param env
+ * @param err
+ * @param proxy
+ */
+void runProxy(const struct dc_posix_env *env, struct dc_error *err, struct proxy *proxy);
+
+#endif //ASSIGNMENT_2_IMPAIRPROXY_H
@@ -0,0 +1,75 @@
+#ifndef ASSIGNMENT_2_LOGFOLLOWER_H
+#define ASSIGNMENT_2_LOGFOLLOWER_H
+
+#include "clientTable.h"
+#include "logScanner.h"
+#include "packetBitset.h"
+#include "packetMetrics.h"
+#include <dc_posix/dc_stdio.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <sys/inotify.h>
+#include <time.h>
+
+#define FOLLOW_READ_SIZE (1024 * 1024)
+#define FOLLOW_PATH_LENGTH 4096
+#define FOLLOW_CHECKPOINT_MAGIC 0x55504c46U
+#define FOLLOW_CHECKPOINT_VERSION 3U
+
+/**
+ * Live statistics for one client, indexed like the client table. Only a
+ * bitset of received packet numbers is kept, not the packets themselves.
+ */
+struct follow_stats {
+    struct packet_bitset seen;
+    struct packet_metrics metrics;
+    u_int32_t highest;
+};
+
+/**
+ * A log being followed: how far it has been parsed and the file it was.
+ */
+struct followed_log {
+    const char *path;
+    int fd;
+    off_t offset;
+    ino_t inode;
+
+    // Set while the rest of a line longer than FOLLOW_READ_SIZE is being passed over.
+    bool skipping;
+    u_int64_t longLines;
+};
+
+/**
+ * State of a follow session.
+ */
+struct log_follower {
+    struct followed_log tcp;
+    struct followed_log udp;
+    struct client_table table;
+    struct follow_stats *stats;
+    size_t statsCapacity;
+    char *buffer;
+    struct log_time_cache times;
+    const char *checkpoint;
+};
+
+/**
+ * Follows the TCP and UDP logs until SIGINT/SIGTERM. Appended bytes are
+ * parsed as inotify reports them, a summary is printed every refreshMs
+ * and the state is saved to the checkpoint so a restart resumes where it
+ * left off.
+ * @param env
+ * @param err
+ * @param tcpLog
+ * @param udpLog
+ * @param checkpoint path of the checkpoint file
+ * @param refreshMs summary interval
+ * @return 0 on a clean stop, -1 if the logs could not be watched
+ */
+int followLogs(const struct dc_posix_env *env, struct dc_error *err, const char *tcpLog, const char *udpLog,
+        const char *checkpoint, u_int16_t refreshMs);
+
+#endif //ASSIGNMENT_2_LOGFOLLOWER_H
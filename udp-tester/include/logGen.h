@@ -0,0 +1,117 @@
+#ifndef ASSIGNMENT_2_LOGGEN_H
+#define ASSIGNMENT_2_LOGGEN_H
+
+#include "childProcess.h"
+#include "prng.h"
+#include <dc_application/command_line.h>
+#include <dc_application/config.h>
+#include <dc_application/defaults.h>
+#include <dc_application/environment.h>
+#include <dc_application/options.h>
+#include <dc_posix/dc_fcntl.h>
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <dc_posix/dc_unistd.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_GEN_TCP_LOG "genTcpLog.txt"
+#define DEFAULT_GEN_UDP_LOG "genUdpLog.txt"
+#define DEFAULT_GEN_CLIENTS 50
+#define DEFAULT_GEN_PACKETS "100000"
+#define DEFAULT_GEN_SIZE 100
+#define DEFAULT_GEN_LOSS "0.01"
+#define DEFAULT_GEN_REORDER "0.001"
+#define DEFAULT_GEN_DUPLICATE "0.0001"
+#define DEFAULT_GEN_RATE "1000000"
+#define DEFAULT_GEN_START "1649546377"
+#define DEFAULT_GEN_SEED "1"
+#define DEFAULT_GEN_THREADS 0
+#define GEN_MAX_CLIENTS 9999
+#define GEN_MAX_PACKETS 999999
+#define GEN_MAX_THREADS 256
+#define GEN_BLOCK_SLOTS (256 * 1024)
+#define GEN_TIME_LENGTH 24
+#define GEN_ADDRESS "127.0.0.1"
+#define GEN_TCP_PORT_BASE 30000
+#define GEN_UDP_PORT_BASE 20000
+// "0001:000001:Sat Apr  9 16:19:37 2022:127.0.0.1:20001\n"
+#define GEN_LINE_LENGTH (4 + 1 + 6 + 1 + GEN_TIME_LENGTH + 1 + 9 + 1 + 5 + 1)
+
+/**
+ * What to generate. Packets are sent round robin, one slot per packet: slot
+ * k belongs to client k % clients and carries packet k / clients + 1, and
+ * arrives at start + k / rate.
+ */
+struct log_gen {
+    u_int32_t clients;
+    u_int32_t packets;
+    u_int16_t size;
+    uint64_t lossThreshold;
+    uint64_t reorderThreshold;
+    uint64_t duplicateThreshold;
+    u_int32_t rate;
+    time_t start;
+    uint64_t seed;
+    uint64_t slots;
+    uint64_t blockCount;
+    uint64_t *lineOffsets;
+    int udpFD;
+};
+
+/**
+ * One writer thread. Thread i handles blocks i, i + threads, ... so the
+ * output does not depend on the thread count.
+ */
+struct gen_worker {
+    const struct dc_posix_env *env;
+    struct dc_error err;
+    struct log_gen *gen;
+    size_t index;
+    size_t threads;
+    bool write;
+    char *buffer;
+    u_int32_t *held;
+    int status;
+};
+
+/**
+ * Generates one block of GEN_BLOCK_SLOTS slots. Every block has its own
+ * generator seeded from the seed and the block number, so a block gives the
+ * same lines whether it is counted or written. A reordered packet is held
+ * back until after the next packet of its client; a duplicate follows its
+ * original.
+ * @param gen
+ * @param block
+ * @param held one entry per client, scratch space
+ * @param buffer receives the lines, NULL to only count them
+ * @return number of lines in the block
+ */
+size_t generateBlock(const struct log_gen *gen, uint64_t block, u_int32_t *held, char *buffer);
+
+/**
+ * Writes the UDP log with one thread per CPU (or threads): a first pass
+ * counts the lines of every block, so each block's offset is known and the
+ * second pass writes blocks in parallel with pwrite().
+ * @param env
+ * @param err
+ * @param gen
+ * @param threads
+ * @return number of lines written, -1 on failure
+ */
+int64_t generateUdpLog(const struct dc_posix_env *env, struct dc_error *err, struct log_gen *gen, size_t threads);
+
+/**
+ * Writes one TCP log line per client, as the server logs a test request.
+ * @param path
+ * @param gen
+ * @return 0 on success, -1 if the file could not be written
+ */
+int generateTcpLog(const char *path, const struct log_gen *gen);
+
+#endif //ASSIGNMENT_2_LOGGEN_H
@@ -0,0 +1,161 @@
+#ifndef ASSIGNMENT_2_LOGINDEX_H
+#define ASSIGNMENT_2_LOGINDEX_H
+
+#include "clientTable.h"
+#include "logScanner.h"
+#include "packetBitset.h"
+#include "packetMetrics.h"
+#include <dc_posix/dc_stdio.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#define INDEX_MAGIC 0x58444950U
+#define INDEX_VERSION 2U
+#define INDEX_BLOCK_SIZE (4 * 1024 * 1024)
+#define INDEX_SUFFIX ".idx"
+#define INDEX_PATH_LENGTH 4096
+
+/**
+ * Identifies the exact log an index was built from.
+ */
+struct index_stamp {
+    u_int64_t size;
+    int64_t modifiedSeconds;
+    int64_t modifiedNanoseconds;
+    u_int64_t inode;
+};
+
+/**
+ * Start of an index file; the tables follow in the order of the counts.
+ */
+struct index_header {
+    u_int32_t magic;
+    u_int32_t version;
+    struct index_stamp tcp;
+    struct index_stamp udp;
+    u_int64_t blockSize;
+    u_int64_t maxBlockLength;
+    u_int64_t clientCount;
+    u_int64_t runCount;
+    u_int64_t blockCount;
+    u_int64_t timeCount;
+};
+
+/**
+ * A client from the TCP log with the statistics of a full run over its
+ * packets and where its lines are in the UDP log.
+ */
+struct index_client {
+    u_int32_t clientID;
+    char name[12];
+    u_int32_t expected;
+    u_int16_t packetSize;
+    u_int64_t received;
+    struct packet_metrics summary;
+    u_int64_t firstRun;
+    u_int64_t runCount;
+};
+
+/**
+ * Consecutive UDP log blocks that hold lines of one client.
+ */
+struct index_run {
+    u_int32_t firstBlock;
+    u_int32_t lastBlock;
+};
+
+/**
+ * The block holding the first line logged in a second.
+ */
+struct index_time {
+    u_int32_t second;
+    u_int32_t block;
+};
+
+/**
+ * A byte range of the UDP log, starting at a line.
+ */
+struct log_range {
+    off_t start;
+    off_t end;
+};
+
+/**
+ * An index loaded into memory. blocks holds blockCount + 1 offsets, so
+ * block i is [blocks[i], blocks[i + 1]).
+ */
+struct log_index {
+    struct index_header header;
+    struct index_client *clients;
+    struct index_run *runs;
+    u_int64_t *blocks;
+    struct index_time *times;
+};
+
+/**
+ * Default index path: the UDP log path with INDEX_SUFFIX added.
+ * @param udpLog
+ * @param path
+ * @param size
+ */
+void defaultIndexPath(const char *udpLog, char *path, size_t size);
+
+/**
+ * Reads both logs once and writes the index: per-client block runs, the
+ * block each second starts in, and per-client summaries.
+ * @param env
+ * @param err
+ * @param tcpLog
+ * @param udpLog
+ * @param indexPath
+ * @return 0 on success, -1 if a log could not be read or the index written
+ */
+int buildLogIndex(const struct dc_posix_env *env, struct dc_error *err, const char *tcpLog, const char *udpLog,
+        const char *indexPath);
+
+/**
+ * Loads an index if it was built from the logs as they are now.
+ * @param env
+ * @param err
+ * @param indexPath
+ * @param tcpLog
+ * @param udpLog
+ * @param index
+ * @return 0 on success, -1 if it is missing, stale or damaged
+ */
+int loadLogIndex(const struct dc_posix_env *env, struct dc_error *err, const char *indexPath, const char *tcpLog,
+        const char *udpLog, struct log_index *index);
+
+/**
+ * Frees a loaded index.
+ * @param env
+ * @param index
+ */
+void freeLogIndex(const struct dc_posix_env *env, struct log_index *index);
+
+/**
+ * Finds a client in a loaded index.
+ * @param index
+ * @param clientID
+ * @return the client, NULL if it is not indexed
+ */
+const struct index_client *findIndexedClient(const struct log_index *index, u_int32_t clientID);
+
+/**
+ * Works out which byte ranges of the UDP log can hold lines for a client
+ * in a time span, merging adjacent blocks.
+ * @param env
+ * @param err
+ * @param index
+ * @param client NULL for every client
+ * @param from first second wanted, 0 for the start of the log
+ * @param to last second wanted, UINT32_MAX for the end of the log
+ * @param ranges allocated here with room for one more range than the
+ *        client has runs (two for every client), freed by the caller
+ * @param count
+ * @return 0 on success, -1 if allocation failed
+ */
+int indexRanges(const struct dc_posix_env *env, struct dc_error *err, const struct log_index *index,
+        const struct index_client *client, u_int32_t from, u_int32_t to, struct log_range **ranges, size_t *count);
+
+#endif //ASSIGNMENT_2_LOGINDEX_H
@@ -0,0 +1,102 @@
+#ifndef ASSIGNMENT_2_LOGMERGE_H
+#define ASSIGNMENT_2_LOGMERGE_H
+
+#include "clientTable.h"
+#include "logScanner.h"
+#include "packedLog.h"
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MERGE_MAX_LOGS 64
+#define MERGE_READ_SIZE (1024 * 1024)
+#define LOG_LIST_SEPARATOR ','
+
+/**
+ * A comma separated list of log paths, split in a private copy.
+ */
+struct log_list {
+    char *copy;
+    size_t length;
+    const char *paths[MERGE_MAX_LOGS];
+    size_t count;
+};
+
+/**
+ * One shard of a merge: a log read sequentially into a fixed buffer, and
+ * its next line waiting to be taken.
+ */
+struct merge_shard {
+    int fd;
+    char *buffer;
+    size_t filled;
+    size_t position;
+    bool done;
+    bool failed;
+    struct log_span line;
+    u_int32_t arrival;
+    struct log_time_cache times;
+};
+
+/**
+ * Splits a --tcp or --udp value such as "a.txt,b.txt" into paths.
+ * @param env
+ * @param err
+ * @param list
+ * @param logs
+ * @return 0 on success, -1 if the list is empty, too long or allocation failed
+ */
+int splitLogList(const struct dc_posix_env *env, struct dc_error *err, const char *list, struct log_list *logs);
+
+/**
+ * Frees the copy behind a split list.
+ * @param env
+ * @param logs
+ */
+void freeLogList(const struct dc_posix_env *env, struct log_list *logs);
+
+/**
+ * Adds the clients from every TCP log in a list to a table.
+ * @param env
+ * @param err
+ * @param tcpLogs
+ * @param table
+ * @return 0 on success, -1 if a log could not be read
+ */
+int loadClientLogs(const struct dc_posix_env *env, struct dc_error *err, const struct log_list *tcpLogs,
+        struct client_table *table);
+
+/**
+ * Hands over the lines of several UDP logs in arrival order, as if one
+ * server had written them all. Each log is already in arrival order, so a
+ * min-heap over the next line of each one is enough, and memory stays at
+ * one MERGE_READ_SIZE buffer per log however long they are. Lines stamped
+ * in the same second keep the order of the logs in the list. Stamps only
+ * resolve whole seconds, so for a client whose packets are split across
+ * logs the order inside a second is lost, and its out of order and
+ * reordered counts can come out higher than one log would give; loss,
+ * duplicates and clients kept to one log are exact.
+ * @param env
+ * @param err
+ * @param udpLogs
+ * @param handler
+ * @param context passed to the handler
+ * @return 0 on success, -1 if a log could not be opened or read
+ */
+int mergeLogs(const struct dc_posix_env *env, struct dc_error *err, const struct log_list *udpLogs,
+        log_line_handler handler, void *context);
+
+/**
+ * Reads sharded UDP logs into a client table, in arrival order across all
+ * of them.
+ * @param env
+ * @param err
+ * @param udpLogs
+ * @param table with every client already added
+ * @return 0 on success, -1 on failure
+ */
+int mergeUdpLogs(const struct dc_posix_env *env, struct dc_error *err, const struct log_list *udpLogs,
+        struct client_table *table);
+
+#endif //ASSIGNMENT_2_LOGMERGE_H
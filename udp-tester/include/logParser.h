@@ -14,31 +14,82 @@
 #include <getopt.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "clientTable.h"
+#include "logScanner.h"
+#include "packetBitset.h"
+#include "packetMetrics.h"
+#include "logFollower.h"
+#include "parallelParse.h"
+#include "parserReport.h"
+#include "reportWriter.h"
+#include "logIndex.h"
+#include "logQuery.h"
+#include "logWindows.h"
+#include "logMerge.h"
+#include "packedLog.h"
 
 #define MAXLINE  1024
+#define DEFAULT_TCP_LOG "../../logs/tcpLog.txt"
+#define DEFAULT_UDP_LOG "../../logs/udpLog.txt"
+#define DEFAULT_THREADS 0
+#define DEFAULT_REFRESH 1000
+#define DEFAULT_CHECKPOINT "../../logs/logParser.checkpoint"
+#define DEFAULT_FORMAT "text"
+#define DEFAULT_INDEX ""
+#define DEFAULT_CLIENT ""
+#define DEFAULT_FROM ""
+#define DEFAULT_TO ""
+#define DEFAULT_WINDOW ""
 
-struct Node {
-    const char *clientID;
-    u_int16_t expectedNumberOfPackets;
-    u_int16_t receivedNumberOfPackets;
-    u_int16_t packetSize;
-    u_int16_t *packetIDs;
-    struct Node* next;
+/**
+ * Log parser configuration gathered from the program arguments.
+ */
+struct parser_options {
+    const char *tcpLog;
+    const char *udpLog;
+    size_t threads;
+    bool follow;
+    u_int16_t refresh;
+    const char *checkpoint;
+    enum report_format format;
+    bool buildIndex;
+    const char *index;
+    const char *client;
+    bool summary;
+    const char *from;
+    const char *to;
+    const char *window;
 };
 
-typedef struct Node* Link;
+/**
+ * State shared with the record handler while a packed UDP log is decoded.
+ */
+struct packed_fill {
+    const struct dc_posix_env *env;
+    struct dc_error *err;
+    struct client_table *table;
+    int status;
+};
+
+/**
+ * Reads the TCP and UDP logs and writes per-client and overall loss and
+ * ordering statistics to stdout in the chosen format. Either log may be a
+ * comma separated list of shards, and a single UDP log may be packed.
+ * @param env
+ * @param err
+ * @param options from program arguments
+ */
+void parseLogStatistics(const struct dc_posix_env *env, struct dc_error *err, const struct parser_options *options);
 
-Link createNode(void);
-Link createNodeWithNextNode(Link next);
-Link getTail(Link head);
-Link addLast(Link *head);
-void deleteList(Link head_ref);
-size_t printMissingPackets(const struct dc_posix_env *env, struct dc_error *err, const u_int16_t *packetIDs, size_t expectedPackets, size_t receivedPackets);
-size_t calculateMissingPacketsInSequence(const struct dc_posix_env *env, struct dc_error *err, const u_int16_t *packetIDs,
-        size_t expectedPackets, size_t receivedPackets, const char *function);
-void printOutOfOrderPackets(const struct dc_posix_env *env, struct dc_error *err, const u_int16_t *packetIDs, size_t receivedPackets);
-size_t calculateOutOfOrderInSequence(const struct dc_posix_env *env, struct dc_error *err, const u_int16_t *packetIDs,
-        size_t receivedPackets, const char *function);
-void parseLogStatistics(const struct dc_posix_env *env, struct dc_error *err);
+/**
+ * Builds the sidecar index and answers client, time, window and summary
+ * queries from it, falling back to a full scan when there is no current
+ * index.
+ * @param env
+ * @param err
+ * @param options from program arguments
+ * @return 0 on success, -1 on failure
+ */
+int queryLogs(const struct dc_posix_env *env, struct dc_error *err, const struct parser_options *options);
 
 #endif //ASSIGNMENT_2_LOGPARSER_H
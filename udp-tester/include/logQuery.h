@@ -0,0 +1,65 @@
+#ifndef ASSIGNMENT_2_LOGQUERY_H
+#define ASSIGNMENT_2_LOGQUERY_H
+
+#include "clientTable.h"
+#include "logIndex.h"
+#include "logMerge.h"
+#include "logScanner.h"
+#include "logWindows.h"
+#include "packedLog.h"
+#include "parserReport.h"
+#include "reportWriter.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define QUERY_READ_SIZE (4 * 1024 * 1024)
+#define QUERY_LINE_SLACK 4096
+
+/**
+ * A time bound from --from or --to: seconds into the log, or an absolute
+ * "YYYY-MM-DD HH:MM:SS" read the same way as the log stamps.
+ */
+struct time_bound {
+    bool set;
+    bool relative;
+    u_int32_t seconds;
+};
+
+/**
+ * What to report from the logs: everything, one client, a time span or the
+ * stored summaries, optionally split into windows of window seconds.
+ */
+struct log_query {
+    const char *tcpLog;
+    const char *udpLog;
+    const char *indexPath;
+    enum report_format format;
+    bool summary;
+    bool hasClient;
+    u_int32_t clientID;
+    struct time_bound from;
+    struct time_bound to;
+    u_int32_t window;
+};
+
+/**
+ * Parses a --from or --to value.
+ * @param text empty for no bound
+ * @param bound
+ * @return false if the text is not a time
+ */
+bool parseTimeBound(const char *text, struct time_bound *bound);
+
+/**
+ * Answers a query. With a current index only the index and the blocks that
+ * can hold matching lines are read; without one the whole UDP log is
+ * scanned, sharded logs are merged by arrival time and a packed log skips
+ * blocks by their headers. A summary query needs an index.
+ * @param env
+ * @param err
+ * @param query
+ * @return 0 on success, -1 on failure
+ */
+int queryLogStatistics(const struct dc_posix_env *env, struct dc_error *err, const struct log_query *query);
+
+#endif //ASSIGNMENT_2_LOGQUERY_H
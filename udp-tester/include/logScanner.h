@@ -0,0 +1,190 @@
+#ifndef ASSIGNMENT_2_LOGSCANNER_H
+#define ASSIGNMENT_2_LOGSCANNER_H
+
+#include <dc_posix/dc_fcntl.h>
+#include <dc_posix/dc_unistd.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+/**
+ * A field inside a mapped log: a pointer into the mapping and a length. The
+ * bytes are not NUL terminated.
+ */
+struct log_span {
+    const char *data;
+    size_t length;
+};
+
+/**
+ * A log file mapped read-only into memory.
+ */
+struct log_map {
+    int fd;
+    const char *data;
+    size_t length;
+};
+
+#define LOG_TIME_LENGTH 24
+#define UDP_CLIENT_DIGITS 4
+#define UDP_PACKET_DIGITS 6
+
+/**
+ * The last ctime() stamp converted and its value. Consecutive log lines
+ * almost always share a stamp, so most lines cost one compare.
+ */
+struct log_time_cache {
+    char text[LOG_TIME_LENGTH];
+    u_int32_t seconds;
+    bool valid;
+};
+
+/**
+ * Walks a range of a mapped log one line at a time.
+ */
+struct log_cursor {
+    const char *position;
+    const char *end;
+};
+
+/**
+ * Called once per line by readLogRange.
+ */
+typedef void (*log_line_handler)(struct log_span line, void *context);
+
+/**
+ * Maps a log read-only and advises the kernel that it is read sequentially.
+ * An empty file maps to a NULL span of length 0.
+ * @param env
+ * @param err
+ * @param path
+ * @param map
+ * @return 0 on success, -1 if the file could not be opened or mapped
+ */
+int mapLog(const struct dc_posix_env *env, struct dc_error *err, const char *path, struct log_map *map);
+
+/**
+ * Unmaps a log and closes it.
+ * @param env
+ * @param err
+ * @param map
+ */
+void unmapLog(const struct dc_posix_env *env, struct dc_error *err, struct log_map *map);
+
+/**
+ * Finds the first occurrence of a byte in [from, end). Uses AVX2 or SSE2
+ * where the CPU has them.
+ * @param from
+ * @param end
+ * @param byte
+ * @return pointer to the byte, end if it does not occur
+ */
+const char *findByte(const char *from, const char *end, char byte);
+
+/**
+ * Sets a cursor to the start of a range.
+ * @param cursor
+ * @param data
+ * @param length
+ */
+void startCursor(struct log_cursor *cursor, const char *data, size_t length);
+
+/**
+ * Returns the next line without its newline. A last line without a newline
+ * is returned as well.
+ * @param cursor
+ * @param line
+ * @return false once the range is exhausted
+ */
+bool nextLine(struct log_cursor *cursor, struct log_span *line);
+
+/**
+ * Splits a span on a delimiter into at most maxFields spans; the last field
+ * keeps any remaining delimiters.
+ * @param span
+ * @param delimiter
+ * @param fields
+ * @param maxFields
+ * @return number of fields written
+ */
+size_t splitSpan(struct log_span span, char delimiter, struct log_span *fields, size_t maxFields);
+
+/**
+ * Reads the leading decimal digits of a span.
+ * @param span
+ * @return the value, 0 if the span does not start with a digit
+ */
+u_int32_t spanToUnsigned(struct log_span span);
+
+/**
+ * Parses a TCP log line "TCP Client <id>:<ip>:<port>:Packets:<n> Size:<size>".
+ * @param line
+ * @param clientName the id field as written
+ * @param expectedPackets
+ * @param packetSize
+ * @return false if the line is not a client registration
+ */
+bool parseTcpLine(struct log_span line, struct log_span *clientName, u_int32_t *expectedPackets, u_int16_t *packetSize);
+
+/**
+ * Seconds since the epoch for a civil date and time, read as UTC.
+ * @param year
+ * @param month 1 to 12
+ * @param day 1 to 31
+ * @param hour
+ * @param minute
+ * @param second
+ * @return the seconds
+ */
+u_int32_t civilSeconds(u_int32_t year, u_int32_t month, u_int32_t day, u_int32_t hour, u_int32_t minute,
+        u_int32_t second);
+
+/**
+ * Converts a ctime() stamp "Www Mmm dd hh:mm:ss yyyy" to seconds since the
+ * epoch, read as UTC. Only differences between stamps are meaningful.
+ * @param cache last stamp converted
+ * @param text at least LOG_TIME_LENGTH bytes
+ * @return the seconds, 0 if the stamp is malformed
+ */
+u_int32_t parseLogTime(struct log_time_cache *cache, const char *text);
+
+/**
+ * Parses the client and packet numbers at the start of a UDP log line
+ * "<id>:<packet>:<time>:<ip>:<port>", and the arrival time when asked.
+ * Lines in the server's fixed "CCCC:PPPPPP:" layout are decoded eight
+ * digits at a time; anything else takes the field splitting path, which
+ * rejects numbers wider than UDP_CLIENT_DIGITS and UDP_PACKET_DIGITS.
+ * @param line
+ * @param clientID
+ * @param packetID
+ * @param cache NULL to skip the time
+ * @param arrival seconds from parseLogTime, 0 if the line has no time
+ * @return false if the line does not start with the two numbers
+ */
+bool parseUdpLine(struct log_span line, u_int32_t *clientID, u_int32_t *packetID, struct log_time_cache *cache,
+        u_int32_t *arrival);
+
+/**
+ * Reads [start, end) of an open log with pread and hands over each line.
+ * start must be at the beginning of a line; a line cut by end is still
+ * passed whole up to end.
+ * @param env
+ * @param err
+ * @param fd
+ * @param start
+ * @param end
+ * @param buffer scratch space, longer than any line
+ * @param size
+ * @param handler
+ * @param context passed to the handler
+ * @return 0 on success, -1 if a read failed
+ */
+int readLogRange(const struct dc_posix_env *env, struct dc_error *err, int fd, off_t start, off_t end, char *buffer,
+        size_t size, log_line_handler handler, void *context);
+
+#endif //ASSIGNMENT_2_LOGSCANNER_H
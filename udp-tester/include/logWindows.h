@@ -0,0 +1,49 @@
+#ifndef ASSIGNMENT_2_LOGWINDOWS_H
+#define ASSIGNMENT_2_LOGWINDOWS_H
+
+#include "clientTable.h"
+#include "packetBitset.h"
+#include "parserReport.h"
+#include "reportWriter.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * What happened to one client, or all of them, during one window.
+ * Packets are counted as lost in the window where the gap in front of them
+ * was first seen, so the windows add up to the client's total loss.
+ */
+struct window_stats {
+    u_int64_t received;
+    u_int64_t lost;
+    u_int64_t bytes;
+    u_int64_t reordered;
+};
+
+/**
+ * Parses a --window value: a number of seconds with an optional s, m or h
+ * suffix, e.g. 1s, 30 or 5m.
+ * @param text
+ * @param seconds
+ * @return false if the text is not a window length
+ */
+bool parseWindowLength(const char *text, u_int32_t *seconds);
+
+/**
+ * Splits every client's packets into fixed windows by arrival time and
+ * writes each window, then the windows summed over all clients.
+ * @param env
+ * @param err
+ * @param writer
+ * @param format
+ * @param table
+ * @param window window length in seconds
+ * @param origin start of the first window, 0 for the first packet in the table
+ * @param slice true when the packets are only part of the test, as for reportClientTable
+ * @return 0 on success, -1 if allocation failed
+ */
+int reportWindows(const struct dc_posix_env *env, struct dc_error *err, struct report_writer *writer,
+        enum report_format format, const struct client_table *table, u_int32_t window, u_int32_t origin, bool slice);
+
+#endif //ASSIGNMENT_2_LOGWINDOWS_H
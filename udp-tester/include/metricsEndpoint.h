@@ -0,0 +1,70 @@
+#ifndef ASSIGNMENT_2_METRICSENDPOINT_H
+#define ASSIGNMENT_2_METRICSENDPOINT_H
+
+#include <arpa/inet.h>
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <dc_posix/dc_unistd.h>
+#include <dc_posix/sys/dc_socket.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include "rateSeries.h"
+#include "udpReceiver.h"
+
+#define DEFAULT_METRICS_PORT 0
+#define METRICS_BODY_SIZE (16 * 1024)
+#define METRICS_REQUEST_SIZE 1024
+#define METRICS_DEFER_SECONDS 1
+#define METRICS_WAKEUP_BUCKETS 10
+
+/**
+ * What the metrics page reads. The counters belong to the receive loop; the
+ * page is written from the same loop, so nothing is copied or locked.
+ */
+struct server_metrics {
+    const struct udp_receiver *receiver;
+    const struct rate_series *series;
+    u_int64_t sessionsTotal;
+    u_int32_t sessionsActive;
+};
+
+/**
+ * Opens the non-blocking HTTP listener on every interface, like the test
+ * port, so a remote scraper can reach it. Accepts are deferred until the
+ * client has sent data, for up to METRICS_DEFER_SECONDS.
+ * @param env
+ * @param err
+ * @param port
+ * @return listening socket, -1 if it could not be bound
+ */
+int openMetricsListener(const struct dc_posix_env *env, struct dc_error *err, u_int16_t port);
+
+/**
+ * Accepts one scrape and answers GET /metrics with the counters in the
+ * Prometheus text format; other paths get 404. The listener only reports
+ * connections whose request has arrived, and the connection is
+ * non-blocking, so a connection with no request yet is dropped and a
+ * scraper that stops reading gets a cut-off page; neither holds up the
+ * receive loop.
+ * @param env
+ * @param err
+ * @param listenFD
+ * @param metrics
+ */
+void serveMetrics(const struct dc_posix_env *env, struct dc_error *err, int listenFD,
+        const struct server_metrics *metrics);
+
+/**
+ * Writes the metrics page body.
+ * @param metrics
+ * @param body
+ * @param size
+ * @return length of the body, at most size - 1
+ */
+size_t formatMetrics(const struct server_metrics *metrics, char *body, size_t size);
+
+#endif //ASSIGNMENT_2_METRICSENDPOINT_H
@@ -0,0 +1,179 @@
+#ifndef ASSIGNMENT_2_PACKEDLOG_H
+#define ASSIGNMENT_2_PACKEDLOG_H
+
+#include <dc_posix/dc_fcntl.h>
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <dc_posix/dc_unistd.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#define PACKED_MAGIC 0x4B505455U
+#define PACKED_BLOCK_MAGIC 0x4B4C4250U
+#define PACKED_VERSION 1U
+#define PACKED_BLOCK_RECORDS 65536U
+#define PACKED_FLUSH_SECONDS 5U
+#define PACKED_MAX_GROUPS 256
+#define PACKED_GROUP_SLOTS 512
+#define PACKED_VARINT_LENGTH 10
+
+/**
+ * Start of a packed UDP log, written once when the file is created.
+ */
+struct packed_file_header {
+    u_int32_t magic;
+    u_int32_t version;
+};
+
+/**
+ * Start of every block. length counts the bytes after the header, so a
+ * reader can hop from header to header and skip blocks outside a time span
+ * without decoding them; the headers are the log's block index.
+ */
+struct packed_block_header {
+    u_int32_t magic;
+    u_int32_t length;
+    u_int32_t records;
+    u_int32_t groups;
+    u_int32_t firstArrival;
+    u_int32_t lastArrival;
+};
+
+/**
+ * The records of one client from one address within a block. Each record is
+ * two zigzag varints: the change in packet number and in arrival second from
+ * the previous record of the group, so an in-order stream costs two bytes a
+ * packet.
+ */
+struct packed_group {
+    u_int32_t clientID;
+    u_int32_t address;
+    u_int16_t port;
+    u_int32_t records;
+    u_int32_t lastPacket;
+    u_int32_t lastArrival;
+    u_int8_t *bytes;
+    size_t length;
+    size_t capacity;
+};
+
+/**
+ * Builds blocks in memory and appends each one to the log with one write.
+ */
+struct packed_writer {
+    int fd;
+    struct packed_group groups[PACKED_MAX_GROUPS];
+    u_int16_t slots[PACKED_GROUP_SLOTS];
+    size_t groupCount;
+    u_int32_t records;
+    u_int32_t firstArrival;
+    u_int32_t lastArrival;
+    u_int8_t *block;
+    size_t blockCapacity;
+    u_int64_t totalRecords;
+    u_int64_t totalBytes;
+    u_int64_t lostRecords;
+};
+
+/**
+ * Called for each record a packed log holds, in arrival order per client.
+ */
+typedef void (*packed_record_handler)(u_int32_t clientID, u_int32_t packetID, u_int32_t arrival, void *context);
+
+/**
+ * Prepares a writer for a UDP log opened for appending. A new log gets the
+ * file header; an existing one must already be packed.
+ * @param env
+ * @param err
+ * @param writer
+ * @param path
+ * @param fd opened with O_APPEND
+ * @return 0 on success, -1 if the log holds text or a write failed
+ */
+int openPackedWriter(const struct dc_posix_env *env, struct dc_error *err, struct packed_writer *writer,
+        const char *path, int fd);
+
+/**
+ * Adds one received packet. A block is written when it is full, when a new
+ * group does not fit, or when it spans PACKED_FLUSH_SECONDS.
+ * @param env
+ * @param err
+ * @param writer
+ * @param clientID
+ * @param packetID
+ * @param arrival seconds of the local wall clock, as ctime() prints it in a text log
+ * @param address sender IPv4 address in network order
+ * @param port sender port in network order
+ * @return 0 on success, -1 if allocation or a write failed
+ */
+int packRecord(const struct dc_posix_env *env, struct dc_error *err, struct packed_writer *writer,
+        u_int32_t clientID, u_int32_t packetID, u_int32_t arrival, u_int32_t address, u_int16_t port);
+
+/**
+ * Writes the block being built, if it has any records.
+ * @param env
+ * @param err
+ * @param writer
+ * @return 0 on success, -1 if the write failed
+ */
+int flushPackedWriter(const struct dc_posix_env *env, struct dc_error *err, struct packed_writer *writer);
+
+/**
+ * Writes the last block and frees the buffers. The descriptor stays open.
+ * @param env
+ * @param err
+ * @param writer
+ * @return 0 on success, -1 if the write failed
+ */
+int closePackedWriter(const struct dc_posix_env *env, struct dc_error *err, struct packed_writer *writer);
+
+/**
+ * Tells a packed log from a text one by its first bytes.
+ * @param data
+ * @param length
+ * @return true if the data starts with the packed file header
+ */
+bool isPackedLog(const char *data, size_t length);
+
+/**
+ * Tells a packed log file from a text one without mapping it.
+ * @param env
+ * @param err
+ * @param path
+ * @return true if the file starts with the packed file header
+ */
+bool isPackedFile(const struct dc_posix_env *env, struct dc_error *err, const char *path);
+
+/**
+ * The arrival second of the first block, the start of the log for relative
+ * --from and --to bounds.
+ * @param data
+ * @param length
+ * @param arrival
+ * @return false if the log has no complete block
+ */
+bool firstPackedArrival(const char *data, size_t length, u_int32_t *arrival);
+
+/**
+ * Decodes a mapped packed log one block at a time. Blocks outside [from, to]
+ * are skipped by their headers and, with a client, the other groups by their
+ * lengths. A block cut short by a crash ends the log.
+ * @param data
+ * @param length
+ * @param from first arrival second wanted, 0 for all
+ * @param to last arrival second wanted, UINT32_MAX for all
+ * @param hasClient
+ * @param clientID only used with hasClient
+ * @param handler
+ * @param context passed to the handler
+ * @return 0 on success, -1 if a block is corrupt
+ */
+int unpackLog(const char *data, size_t length, u_int32_t from, u_int32_t to, bool hasClient, u_int32_t clientID,
+        packed_record_handler handler, void *context);
+
+#endif //ASSIGNMENT_2_PACKEDLOG_H
@@ -0,0 +1,102 @@
+#ifndef ASSIGNMENT_2_PACKETBITSET_H
+#define ASSIGNMENT_2_PACKETBITSET_H
+
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/**
+ * One bit per packet number, packed into 64-bit words on the heap.
+ */
+struct packet_bitset {
+    uint64_t *words;
+    size_t wordCount;
+    size_t bits;
+};
+
+/**
+ * Allocates a cleared bitset.
+ * @param env
+ * @param err
+ * @param bitset
+ * @param bits number of packet numbers it can hold, 0 to bits - 1
+ * @return 0 on success, -1 if allocation failed
+ */
+int createPacketBitset(const struct dc_posix_env *env, struct dc_error *err, struct packet_bitset *bitset, size_t bits);
+
+/**
+ * Frees a bitset.
+ * @param env
+ * @param bitset
+ */
+void destroyPacketBitset(const struct dc_posix_env *env, struct packet_bitset *bitset);
+
+/**
+ * Grows a bitset so it holds at least bits packet numbers; new bits are clear.
+ * @param env
+ * @param err
+ * @param bitset
+ * @param bits
+ * @return 0 on success, -1 if allocation failed
+ */
+int growPacketBitset(const struct dc_posix_env *env, struct dc_error *err, struct packet_bitset *bitset, size_t bits);
+
+/**
+ * Marks one packet number.
+ * @param bitset
+ * @param packetID must be below bitset->bits
+ * @return true if it was already marked
+ */
+bool markPacket(struct packet_bitset *bitset, size_t packetID);
+
+/**
+ * Marks every packet number in the list; numbers outside the bitset are ignored.
+ * @param bitset
+ * @param packetIDs
+ * @param count
+ */
+void markPackets(struct packet_bitset *bitset, const u_int32_t *packetIDs, size_t count);
+
+/**
+ * Counts marked packet numbers in [from, to) with popcount.
+ * @param bitset
+ * @param from
+ * @param to
+ * @return marked count
+ */
+size_t countMarked(const struct packet_bitset *bitset, size_t from, size_t to);
+
+/**
+ * Finds the first unmarked packet number in [from, to), skipping whole words
+ * that are fully marked.
+ * @param bitset
+ * @param from
+ * @param to
+ * @return the packet number, to if every number is marked
+ */
+size_t nextUnmarked(const struct packet_bitset *bitset, size_t from, size_t to);
+
+/**
+ * Finds the first marked packet number in [from, to).
+ * @param bitset
+ * @param from
+ * @param to
+ * @return the packet number, to if none is marked
+ */
+size_t nextMarked(const struct packet_bitset *bitset, size_t from, size_t to);
+
+/**
+ * Measures the runs of consecutive unmarked packet numbers in [from, to).
+ * @param bitset
+ * @param from
+ * @param to
+ * @param shortest length of the shortest run, 0 if there are none
+ * @param longest length of the longest run, 0 if there are none
+ * @return number of runs
+ */
+size_t unmarkedRuns(const struct packet_bitset *bitset, size_t from, size_t to, size_t *shortest, size_t *longest);
+
+#endif //ASSIGNMENT_2_PACKETBITSET_H
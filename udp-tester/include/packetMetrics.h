@@ -0,0 +1,131 @@
+#ifndef ASSIGNMENT_2_PACKETMETRICS_H
+#define ASSIGNMENT_2_PACKETMETRICS_H
+
+#include "clientTable.h"
+#include "packetBitset.h"
+#include <dc_posix/dc_stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define METRIC_HISTOGRAM_BUCKETS 16
+#define METRIC_JITTER_GAIN 16.0
+#define METRIC_PACKET_MARGIN 65536
+
+/**
+ * Loss, reordering, duplication and jitter for one client, gathered in a
+ * single pass over its packets in arrival order. Histogram bucket k counts
+ * lengths from 2^k to 2^(k+1) - 1; the last bucket holds everything longer.
+ */
+struct packet_metrics {
+    u_int64_t received;
+    u_int64_t unique;
+    u_int64_t duplicates;
+
+    // Packet numbers too far past the test to be real, left out of everything else.
+    u_int64_t malformed;
+
+    // Packets numbered below the one before them, and runs of them one number apart.
+    u_int64_t outOfOrder;
+    u_int64_t outOfOrderRun;
+    u_int64_t shortestClosedRun;
+    u_int64_t longestOutOfOrderRun;
+    u_int32_t previous;
+    u_int32_t previousOutOfOrder;
+
+    // RFC 4737: a packet is reordered when it is numbered below NextExp.
+    u_int32_t nextExpected;
+    u_int64_t reordered;
+    u_int64_t longestReorderDistance;
+    u_int64_t reorderHistogram[METRIC_HISTOGRAM_BUCKETS];
+
+    // Smoothed variation between consecutive inter-arrival gaps, in seconds.
+    u_int32_t previousArrival;
+    int64_t previousGap;
+    double jitter;
+
+    // Filled by finishPacketMetrics from the bitset.
+    u_int64_t firstPacket;
+    u_int64_t expected;
+    u_int64_t lost;
+    u_int64_t lossRuns;
+    u_int64_t shortestLossRun;
+    u_int64_t longestLossRun;
+    u_int64_t lossHistogram[METRIC_HISTOGRAM_BUCKETS];
+    u_int64_t shortestOutOfOrderRun;
+};
+
+/**
+ * Clears the metrics before the first packet.
+ * @param metrics
+ */
+void startPacketMetrics(struct packet_metrics *metrics);
+
+/**
+ * Adds one packet in arrival order.
+ * @param metrics
+ * @param seen packet numbers received so far, must hold packetID
+ * @param packetID
+ * @param arrival second the packet was logged, 0 if unknown
+ */
+void addPacketMetric(struct packet_metrics *metrics, struct packet_bitset *seen, u_int32_t packetID, u_int32_t arrival);
+
+/**
+ * Checks a packet number before a bit is grown for it. A number more than
+ * METRIC_PACKET_MARGIN past both the expected count and the highest number
+ * accepted so far comes from a garbled line; it is counted as malformed.
+ * @param metrics
+ * @param expected packets the client registered, 0 if unknown
+ * @param packetID
+ * @return true if the packet should be added
+ */
+bool acceptPacketID(struct packet_metrics *metrics, u_int32_t expected, u_int32_t packetID);
+
+/**
+ * Counts the lost packets in firstPacket to lastPacket and their burst
+ * lengths. It can be called again after more packets are added.
+ * @param metrics
+ * @param seen
+ * @param firstPacket lowest packet number that should have arrived, at least 1
+ * @param lastPacket highest packet number that should have arrived
+ */
+void finishPacketMetrics(struct packet_metrics *metrics, const struct packet_bitset *seen, size_t firstPacket,
+        size_t lastPacket);
+
+/**
+ * Runs the metrics over a client's packets, counting loss from 1 to the
+ * expected count. The bitset is left for the caller to list lost packets
+ * from and to destroy.
+ * @param env
+ * @param err
+ * @param metrics
+ * @param seen created here
+ * @param record
+ * @return 0 on success, -1 if allocation failed
+ */
+int measurePackets(const struct dc_posix_env *env, struct dc_error *err, struct packet_metrics *metrics,
+        struct packet_bitset *seen, const struct client_record *record);
+
+/**
+ * Runs the metrics over a client's packets, counting loss only between the
+ * lowest and highest packet numbers received. Used when the packets are a
+ * slice of the test, such as one time window.
+ * @param env
+ * @param err
+ * @param metrics
+ * @param seen created here
+ * @param record
+ * @return 0 on success, -1 if allocation failed
+ */
+int measurePacketSlice(const struct dc_posix_env *env, struct dc_error *err, struct packet_metrics *metrics,
+        struct packet_bitset *seen, const struct client_record *record);
+
+/**
+ * Histogram bucket for a burst length or distance of at least 1.
+ * @param length
+ * @return 0 to METRIC_HISTOGRAM_BUCKETS - 1
+ */
+size_t metricBucket(u_int64_t length);
+
+#endif //ASSIGNMENT_2_PACKETMETRICS_H
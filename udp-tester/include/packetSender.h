@@ -0,0 +1,43 @@
+#ifndef ASSIGNMENT_2_PACKETSENDER_H
+#define ASSIGNMENT_2_PACKETSENDER_H
+
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <dc_posix/sys/dc_socket.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include "fastFormat.h"
+#include "hotPath.h"
+
+#define SENDER_BATCH 64
+#define SENDER_HEADER 12
+#define SENDER_MIN_PACKET (SENDER_HEADER + 1)
+
+/**
+ * One paced UDP transmission in the client packet format
+ * "CCCC:PPPPPP:****...\n".
+ */
+struct packet_sender {
+    int socketFD;
+    struct sockaddr_in destination;
+    const char *clientID;
+    u_int16_t packets;
+    u_int16_t packetSize;
+    u_int32_t rate;
+};
+
+/**
+ * Sends every packet with sendmmsg() batches. With a rate the batches are
+ * sized so the total never runs ahead of rate packets per second; without one
+ * the batches go out back to back.
+ * @param env
+ * @param err
+ * @param sender
+ * @return number of packets sent, -1 on a socket error
+ */
+int sendPackets(const struct dc_posix_env *env, struct dc_error *err, const struct packet_sender *sender);
+
+#endif //ASSIGNMENT_2_PACKETSENDER_H
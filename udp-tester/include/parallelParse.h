@@ -0,0 +1,52 @@
+#ifndef ASSIGNMENT_2_PARALLELPARSE_H
+#define ASSIGNMENT_2_PARALLELPARSE_H
+
+#include "clientTable.h"
+#include "logScanner.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#define MAX_PARSE_THREADS 256
+
+/**
+ * One newline-aligned byte range of the UDP log and the packet numbers it
+ * holds for every client, indexed like the client table.
+ */
+struct parse_chunk {
+    const struct dc_posix_env *env;
+    struct dc_error err;
+    const struct client_table *table;
+    struct log_span range;
+    struct client_record *partials;
+    int status;
+};
+
+/**
+ * Resolves the thread count: 0 means one per online CPU.
+ * @param requested
+ * @return threads to use, at least 1 and at most MAX_PARSE_THREADS
+ */
+size_t parseThreadCount(size_t requested);
+
+/**
+ * Appends the packets of every UDP log line to its client in the table.
+ * The log is cut into one newline-aligned range per thread. Each thread
+ * fills its own per-client arrays and the arrays are concatenated in range
+ * order, so the result matches a sequential pass exactly. Only the line
+ * splitting runs in parallel: the metrics are computed afterwards, one
+ * client at a time, from the concatenated arrays. While a client is being
+ * concatenated its packet numbers and arrivals are held twice, 8 bytes per
+ * packet on top of the table.
+ * @param env
+ * @param err
+ * @param table clients from the TCP log, read-only while the threads run
+ * @param data mapped UDP log
+ * @param length
+ * @param threads from parseThreadCount
+ * @return 0 on success, -1 if a thread could not be started or ran out of memory
+ */
+int parseUdpLogParallel(const struct dc_posix_env *env, struct dc_error *err, struct client_table *table,
+        const char *data, size_t length, size_t threads);
+
+#endif //ASSIGNMENT_2_PARALLELPARSE_H
@@ -0,0 +1,85 @@
+#ifndef ASSIGNMENT_2_PARSERBENCH_H
+#define ASSIGNMENT_2_PARSERBENCH_H
+
+#include "childProcess.h"
+#include <dc_application/command_line.h>
+#include <dc_application/config.h>
+#include <dc_application/defaults.h>
+#include <dc_application/environment.h>
+#include <dc_application/options.h>
+#include <dc_posix/dc_fcntl.h>
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <dc_posix/dc_unistd.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#define DEFAULT_PARSER_PROGRAM "./logParser"
+#define DEFAULT_BENCH_TCP_LOG "genTcpLog.txt"
+#define DEFAULT_BENCH_UDP_LOG "genUdpLog.txt"
+#define DEFAULT_BENCH_RUNS 5
+#define DEFAULT_BENCH_ARGS ""
+#define DEFAULT_BENCH_LABEL ""
+#define DEFAULT_BENCH_CSV ""
+#define MAX_BENCH_RUNS 100
+#define MAX_BENCH_ARGS 32
+
+/**
+ * The parser command line and the log it is timed on.
+ */
+struct parser_bench {
+    const char *parserProgram;
+    const char *tcpLog;
+    const char *udpLog;
+    char *args;
+    const char *argv[MAX_BENCH_ARGS + 6];
+    u_int64_t bytes;
+    u_int64_t records;
+    int nullFD;
+};
+
+/**
+ * Wall and CPU time of one parser run.
+ */
+struct bench_run {
+    double seconds;
+    double cpuSeconds;
+};
+
+/**
+ * Counts the lines of the UDP log, the records the parser has to read.
+ * @param env
+ * @param err
+ * @param bench
+ * @return 0 on success, -1 if the log could not be read
+ */
+int measureLog(const struct dc_posix_env *env, struct dc_error *err, struct parser_bench *bench);
+
+/**
+ * Runs the parser once with its report sent to /dev/null.
+ * @param env
+ * @param err
+ * @param bench
+ * @param run filled with the times
+ * @return 0 on success, -1 if the parser failed
+ */
+int runParser(const struct dc_posix_env *env, struct dc_error *err, const struct parser_bench *bench,
+        struct bench_run *run);
+
+/**
+ * Appends one row to the benchmark history, with a header if the file is new.
+ * @param path
+ * @param label names the parser change being measured
+ * @param bench
+ * @param best fastest run
+ * @param median
+ * @param runs
+ * @return 0 on success, -1 if the file could not be written
+ */
+int appendBenchCsv(const char *path, const char *label, const struct parser_bench *bench, const struct bench_run *best,
+        const struct bench_run *median, size_t runs);
+
+#endif //ASSIGNMENT_2_PARSERBENCH_H
@@ -0,0 +1,93 @@
+#ifndef ASSIGNMENT_2_PARSERREPORT_H
+#define ASSIGNMENT_2_PARSERREPORT_H
+
+#include "clientTable.h"
+#include "packetBitset.h"
+#include "packetMetrics.h"
+#include "reportWriter.h"
+#include <stdbool.h>
+
+#define REPORT_SEPARATOR "----------------------------------------\n"
+
+/**
+ * Layouts the log parser can write its results in.
+ */
+enum report_format {
+    REPORT_TEXT,
+    REPORT_JSON,
+    REPORT_CSV,
+};
+
+/**
+ * Totals across every client, written after the last one.
+ */
+struct report_summary {
+    size_t clients;
+    u_int64_t lostTotal;
+    u_int64_t minLost;
+    u_int64_t maxLost;
+    u_int64_t minOrder;
+    u_int64_t maxOrder;
+    u_int64_t malformedTotal;
+};
+
+/**
+ * Looks up a format by its option value: text, json or csv.
+ * @param name
+ * @param format
+ * @return false if the name is not a format
+ */
+bool reportFormatFromString(const char *name, enum report_format *format);
+
+/**
+ * Writes whatever comes before the first client: the JSON opening or the
+ * CSV header row.
+ * @param writer
+ * @param format
+ */
+void startReport(struct report_writer *writer, enum report_format format);
+
+/**
+ * Writes one client's statistics. Lost packets are listed as ranges such
+ * as "12-340,512".
+ * @param writer
+ * @param format
+ * @param record
+ * @param metrics from measurePackets or measurePacketSlice
+ * @param seen from the same call, NULL when only a stored summary is known
+ * @param index position of the client in the report, from 0
+ */
+void reportClient(struct report_writer *writer, enum report_format format, const struct client_record *record,
+        const struct packet_metrics *metrics, const struct packet_bitset *seen, size_t index);
+
+/**
+ * Writes the totals and closes the report.
+ * @param writer
+ * @param format
+ * @param summary
+ */
+void finishReport(struct report_writer *writer, enum report_format format, const struct report_summary *summary);
+
+/**
+ * Folds one client's metrics into the totals.
+ * @param summary
+ * @param metrics
+ */
+void addToSummary(struct report_summary *summary, const struct packet_metrics *metrics);
+
+/**
+ * Measures and writes every client in a table, then the totals.
+ * @param env
+ * @param err
+ * @param writer
+ * @param format
+ * @param table
+ * @param slice true when the packets are only part of the test: loss is
+ *        then counted between the lowest and highest packet received and
+ *        clients without packets are left out
+ * @return 0 on success, -1 if measuring ran out of memory
+ */
+int reportClientTable(const struct dc_posix_env *env, struct dc_error *err, struct report_writer *writer,
+        enum report_format format, const struct client_table *table, bool slice);
+
+#endif //ASSIGNMENT_2_PARSERREPORT_H
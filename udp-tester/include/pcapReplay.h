@@ -0,0 +1,116 @@
+#ifndef ASSIGNMENT_2_PCAPREPLAY_H
+#define ASSIGNMENT_2_PCAPREPLAY_H
+
+#include <dc_posix/dc_fcntl.h>
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <dc_posix/dc_unistd.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "fastFormat.h"
+#include "hotPath.h"
+
+#define PCAP_MAGIC_MICRO 0xA1B2C3D4U
+#define PCAP_MAGIC_NANO 0xA1B23C4DU
+#define PCAPNG_SECTION_BLOCK 0x0A0D0D0AU
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4DU
+#define PCAPNG_INTERFACE_BLOCK 1U
+#define PCAPNG_ENHANCED_BLOCK 6U
+#define PCAPNG_OPTION_TSRESOL 9U
+#define PCAP_LINK_NULL 0U
+#define PCAP_LINK_ETHERNET 1U
+#define PCAP_LINK_RAW 101U
+#define PCAP_LINK_LOOP 108U
+#define PCAP_LINK_SLL 113U
+#define PCAP_LINK_IPV4 228U
+#define PCAP_LINK_IPV6 229U
+#define PCAP_LINK_SLL2 276U
+#define REPLAY_MAX_INTERFACES 64
+#define REPLAY_MAX_PACKETS 65535
+#define REPLAY_HEADER 12
+#define REPLAY_MIN_PACKET (REPLAY_HEADER + 1)
+#define REPLAY_MAX_PACKET 65507
+#define REPLAY_BATCH 64
+#define REPLAY_SPIN_NS 200000
+
+/**
+ * UDP payload sizes and send times read from a capture. Offsets are
+ * nanoseconds from the first UDP packet and never go backwards.
+ */
+struct replay_trace {
+    size_t count;
+    size_t capacity;
+    u_int16_t *sizes;
+    uint64_t *offsets;
+    uint64_t bytes;
+    size_t clamped;
+    size_t skipped;
+};
+
+/**
+ * How closely a replay kept to the capture's timing. Lateness is how long
+ * after its scheduled time a packet went out.
+ */
+struct replay_stats {
+    size_t sent;
+    double seconds;
+    double meanLateness;
+    double maxLateness;
+};
+
+/**
+ * Reads the UDP packets of a pcap (microsecond or nanosecond, either byte
+ * order) or pcapng capture. Ethernet with VLAN tags, Linux cooked (v1 and
+ * v2), BSD loopback and raw IP links are understood, over IPv4 or IPv6;
+ * other packets and later fragments are skipped.
+ * @param env
+ * @param err
+ * @param path
+ * @param port only packets from or to this port, 0 for all
+ * @param trace filled with the packets, at most REPLAY_MAX_PACKETS
+ * @return 0 on success, -1 if the file is not a capture or cannot be read
+ */
+int loadReplayTrace(const struct dc_posix_env *env, struct dc_error *err, const char *path, u_int16_t port,
+        struct replay_trace *trace);
+
+/**
+ * Frees the packets of a trace.
+ * @param env
+ * @param trace
+ */
+void freeReplayTrace(const struct dc_posix_env *env, struct replay_trace *trace);
+
+/**
+ * The mean payload size, declared to the server as the test's packet size.
+ * @param trace
+ * @return u_int16_t bytes
+ */
+u_int16_t meanReplaySize(const struct replay_trace *trace);
+
+/**
+ * Sends the trace against absolute deadlines with the client header written
+ * over the start of each payload. Packets whose time has come go out
+ * together with sendmmsg(); before the next one the sender sleeps and spins
+ * for the last REPLAY_SPIN_NS so short gaps are kept.
+ * @param env
+ * @param err
+ * @param trace
+ * @param socketFD
+ * @param destination
+ * @param clientID
+ * @param speed 2 replays twice as fast as captured
+ * @param stats filled with the timing of the replay
+ * @return 0 on success, -1 on a socket error
+ */
+int replayTrace(const struct dc_posix_env *env, struct dc_error *err, const struct replay_trace *trace, int socketFD,
+        const struct sockaddr_in *destination, const char *clientID, double speed, struct replay_stats *stats);
+
+#endif //ASSIGNMENT_2_PCAPREPLAY_H
@@ -0,0 +1,61 @@
+#ifndef ASSIGNMENT_2_PRNG_H
+#define ASSIGNMENT_2_PRNG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Seeded xoshiro256** generator. Every tool that needs reproducible
+ * randomness owns one of these so a run can be replayed from its seed.
+ */
+struct prng {
+    uint64_t state[4];
+};
+
+/**
+ * Seeds the generator by expanding the seed with splitmix64.
+ * @param prng
+ * @param seed
+ */
+void prngSeed(struct prng *prng, uint64_t seed);
+
+/**
+ * Returns the next 64 random bits.
+ * @param prng
+ * @return uint64_t
+ */
+uint64_t prngNext(struct prng *prng);
+
+/**
+ * Returns a uniformly distributed double in [0, 1).
+ * @param prng
+ * @return double
+ */
+double prngUniform(struct prng *prng);
+
+/**
+ * Returns a uniformly distributed integer in [0, bound).
+ * @param prng
+ * @param bound must be greater than zero
+ * @return uint64_t
+ */
+uint64_t prngBelow(struct prng *prng, uint64_t bound);
+
+/**
+ * Converts a probability into a threshold for prngChance() so the
+ * per-packet decision is a single integer compare.
+ * @param probability in [0, 1]
+ * @return uint64_t threshold
+ */
+uint64_t prngThreshold(double probability);
+
+/**
+ * Draws one Bernoulli trial against a threshold from prngThreshold().
+ * @param prng
+ * @param threshold
+ * @return true with the configured probability
+ */
+bool prngChance(struct prng *prng, uint64_t threshold);
+
+#endif //ASSIGNMENT_2_PRNG_H
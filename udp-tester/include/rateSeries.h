@@ -0,0 +1,137 @@
+#ifndef ASSIGNMENT_2_RATESERIES_H
+#define ASSIGNMENT_2_RATESERIES_H
+
+#include <dc_posix/dc_fcntl.h>
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <dc_posix/dc_unistd.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <time.h>
+
+#define STATS_COMMAND "Stats:"
+#define DEFAULT_STATS_INTERVAL 1000
+#define DEFAULT_STATS_LOG ""
+#define SERIES_SLOTS 300
+#define SERIES_SESSION_SLOTS 60
+#define SERIES_SESSIONS 256
+#define SERIES_LINE 96
+
+/**
+ * Counters of one interval.
+ */
+struct series_slot {
+    u_int64_t bytes;
+    u_int32_t packets;
+    u_int32_t drops;
+    u_int32_t reorders;
+};
+
+/**
+ * One client's ring. A packet number past the next expected one counts the
+ * gap as drops; a number below the highest seen counts as a reorder and a
+ * repeat of the highest as a duplicate.
+ * A late packet below the highest takes back one of the drops still
+ * missing: from the totals always, and from the interval counters when the
+ * client's last gap opened in the current interval.
+ */
+struct series_session {
+    u_int32_t clientID;
+    u_int32_t highest;
+    u_int64_t missing;
+    u_int64_t gapInterval;
+    u_int64_t first;
+    u_int64_t current;
+    struct series_slot slots[SERIES_SESSION_SLOTS];
+};
+
+/**
+ * Rings of per-interval counters for the whole server and for the last
+ * SERIES_SESSIONS clients. Intervals are numbered by wall clock time
+ * divided by the interval, and a slot is cleared when its interval comes
+ * round again, so an idle stretch reads back as zeros.
+ */
+struct rate_series {
+    u_int32_t intervalMs;
+    u_int64_t first;
+    u_int64_t current;
+    struct series_slot slots[SERIES_SLOTS];
+    struct series_session *sessions;
+    u_int64_t totalDrops;
+    u_int64_t totalReorders;
+    u_int64_t totalDuplicates;
+    int logFD;
+};
+
+/**
+ * Starts the rings at the current interval.
+ * @param env
+ * @param err
+ * @param series
+ * @param intervalMs interval length, at least 1
+ * @param logFD time-series file that closed intervals are appended to, -1 for none
+ * @return 0 on success, -1 if the sessions could not be allocated
+ */
+int createRateSeries(const struct dc_posix_env *env, struct dc_error *err, struct rate_series *series,
+        u_int32_t intervalMs, int logFD);
+
+/**
+ * Writes the last interval to the time-series file and frees the sessions.
+ * @param env
+ * @param err
+ * @param series
+ */
+void destroyRateSeries(const struct dc_posix_env *env, struct dc_error *err, struct rate_series *series);
+
+/**
+ * Moves the rings to the interval holding nowMs. The interval that ends is
+ * appended to the time-series file: one line for the server and one for
+ * every client that sent in it.
+ * @param env
+ * @param err
+ * @param series
+ * @param nowMs wall clock milliseconds
+ */
+void advanceRateSeries(const struct dc_posix_env *env, struct dc_error *err, struct rate_series *series,
+        u_int64_t nowMs);
+
+/**
+ * Counts one datagram in the current interval.
+ * @param series
+ * @param clientID
+ * @param packetID
+ * @param bytes datagram length
+ */
+void countRatePacket(struct rate_series *series, u_int32_t clientID, u_int32_t packetID, u_int32_t bytes);
+
+/**
+ * Writes the server's or one client's ring, oldest interval first, as
+ * "start_ms,packets,bytes,drops,reorders" lines after a header line.
+ * @param env
+ * @param err
+ * @param series
+ * @param fd
+ * @param clientID the client, 0 for the whole server
+ * @param nowMs wall clock milliseconds, intervals after the last packet read as zeros
+ * @return 0 on success, -1 if the client is not in the table
+ */
+int writeRateSeries(const struct dc_posix_env *env, struct dc_error *err, const struct rate_series *series, int fd,
+        u_int32_t clientID, u_int64_t nowMs);
+
+/**
+ * Counts the clients that sent in the current or the previous interval.
+ * @param series
+ * @return u_int32_t clients
+ */
+u_int32_t activeRateClients(const struct rate_series *series);
+
+/**
+ * Returns the wall clock time in milliseconds.
+ * @return u_int64_t milliseconds
+ */
+u_int64_t wallMilliseconds(void);
+
+#endif //ASSIGNMENT_2_RATESERIES_H
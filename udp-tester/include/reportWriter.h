@@ -0,0 +1,107 @@
+#ifndef ASSIGNMENT_2_REPORTWRITER_H
+#define ASSIGNMENT_2_REPORTWRITER_H
+
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <dc_posix/dc_unistd.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include "fastFormat.h"
+#include "hotPath.h"
+
+#define REPORT_BUFFER_SIZE (256 * 1024)
+#define REPORT_NUMBER_LENGTH 32
+
+/**
+ * Output collected in one large buffer and written when it fills, so a
+ * report with millions of entries takes a handful of write() calls.
+ */
+struct report_writer {
+    const struct dc_posix_env *env;
+    struct dc_error *err;
+    int fd;
+    char *buffer;
+    size_t length;
+    int status;
+};
+
+/**
+ * Allocates the buffer for a writer on an open descriptor.
+ * @param env
+ * @param err
+ * @param writer
+ * @param fd written to, not closed by the writer
+ * @return 0 on success, -1 if allocation failed
+ */
+int openReportWriter(const struct dc_posix_env *env, struct dc_error *err, struct report_writer *writer, int fd);
+
+/**
+ * Flushes what is left and frees the buffer.
+ * @param writer
+ * @return 0 if every byte was written, -1 otherwise
+ */
+int closeReportWriter(struct report_writer *writer);
+
+/**
+ * Writes out the buffer, retrying short writes.
+ * @param writer
+ * @return 0 on success, -1 once any write has failed
+ */
+int flushReport(struct report_writer *writer);
+
+/**
+ * Appends bytes.
+ * @param writer
+ * @param data
+ * @param length
+ */
+void reportBytes(struct report_writer *writer, const char *data, size_t length);
+
+/**
+ * Appends a NUL terminated string.
+ * @param writer
+ * @param text
+ */
+void reportString(struct report_writer *writer, const char *text);
+
+/**
+ * Appends a string as a quoted JSON string, escaping quotes, backslashes
+ * and control characters.
+ * @param writer
+ * @param text
+ */
+void reportJsonString(struct report_writer *writer, const char *text);
+
+/**
+ * Appends a string as one quoted CSV field, doubling embedded quotes (RFC 4180).
+ * @param writer
+ * @param text
+ */
+void reportCsvString(struct report_writer *writer, const char *text);
+
+/**
+ * Appends an unsigned number in decimal, zero padded to width digits.
+ * @param writer
+ * @param value
+ * @param width 0 for no padding
+ */
+void reportUnsigned(struct report_writer *writer, u_int64_t value, size_t width);
+
+/**
+ * Appends a signed number in decimal.
+ * @param writer
+ * @param value
+ */
+void reportSigned(struct report_writer *writer, int64_t value);
+
+/**
+ * Appends a number the way printf's %f does.
+ * @param writer
+ * @param value
+ */
+void reportDouble(struct report_writer *writer, double value);
+
+#endif //ASSIGNMENT_2_REPORTWRITER_H
@@ -0,0 +1,181 @@
+#ifndef ASSIGNMENT_2_SCENARIO_H
+#define ASSIGNMENT_2_SCENARIO_H
+
+#include "childProcess.h"
+#include <dc_application/command_line.h>
+#include <dc_application/config.h>
+#include <dc_application/defaults.h>
+#include <dc_application/environment.h>
+#include <dc_application/options.h>
+#include <dc_posix/dc_fcntl.h>
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <dc_posix/dc_unistd.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define DEFAULT_PLAN "scenario.txt"
+#define DEFAULT_SERVER_PROGRAM "./server"
+#define DEFAULT_CLIENT_PROGRAM "./client"
+#define DEFAULT_PARSER_PROGRAM "./logParser"
+#define DEFAULT_SCENARIO_DIR "scenario"
+#define DEFAULT_SCENARIO_REPORT "scenario.json"
+#define DEFAULT_SCENARIO_PORT 6981
+#define DEFAULT_WARMUP_SECONDS 2
+#define SCENARIO_MAX_PHASES 32
+#define SCENARIO_MAX_FLOWS 16
+#define SCENARIO_MAX_CLIENTS 256
+#define SCENARIO_NAME_LENGTH 32
+#define SCENARIO_MAX_PACKETS 65535
+#define SCENARIO_MIN_PACKET_SIZE 13
+#define SCENARIO_MIN_CHUNK_MS 250
+#define SCENARIO_TICK_MS 5
+#define SCENARIO_STARTUP_MS 300
+#define SCENARIO_DRAIN_MS 500
+#define SCENARIO_STEADY_VARIATION 0.1
+
+/**
+ * Clients that send the same packets for the whole phase. The rate is per
+ * client, so a flow offers clients * rate packets per second.
+ */
+struct scenario_flow {
+    u_int16_t clients;
+    u_int32_t rate;
+    u_int16_t size;
+};
+
+/**
+ * One step of the test. A flow's clients start evenly spread over the ramp,
+ * so its load climbs linearly to the full rate; the steady state is measured
+ * from max(ramp, warmup) seconds after the start of the phase to its end.
+ */
+struct scenario_phase {
+    char name[SCENARIO_NAME_LENGTH];
+    u_int16_t duration;
+    u_int16_t ramp;
+    u_int16_t warmup;
+    struct scenario_flow flows[SCENARIO_MAX_FLOWS];
+    size_t flowCount;
+    size_t clients;
+};
+
+/**
+ * A test plan: the server port and the phases, run one after the other.
+ */
+struct scenario_plan {
+    u_int16_t port;
+    u_int16_t warmup;
+    struct scenario_phase phases[SCENARIO_MAX_PHASES];
+    size_t phaseCount;
+};
+
+/**
+ * The programs a scenario runs and the server they share.
+ */
+struct scenario {
+    const char *serverProgram;
+    const char *clientProgram;
+    const char *parserProgram;
+    char tcpLog[512];
+    char udpLog[512];
+    char clientOutput[512];
+    char windows[512];
+    pid_t serverPID;
+    int serverFD;
+    int clientFD;
+};
+
+/**
+ * One client position of a flow. A test sends at most SCENARIO_MAX_PACKETS
+ * packets, so a client that finishes before the end of the phase is started
+ * again for the time that is left.
+ */
+struct scenario_slot {
+    const struct scenario_flow *flow;
+    double startAt;
+    u_int32_t packets;
+    pid_t pid;
+    bool done;
+};
+
+/**
+ * What a phase sent and what the server logged during its steady state.
+ */
+struct phase_result {
+    const struct scenario_phase *phase;
+    double wallStart;
+    double seconds;
+    unsigned int clientsRun;
+    unsigned int clientsFailed;
+    u_int64_t packetsSent;
+    double serverCpu;
+    double clientCpu;
+    time_t steadyFrom;
+    u_int32_t steadySeconds;
+    u_int64_t received;
+    u_int64_t lost;
+    u_int64_t bytes;
+    u_int64_t reordered;
+    double variation;
+    bool steady;
+};
+
+/**
+ * Reads a test plan. Lines hold a keyword and key value pairs; # starts a
+ * comment:
+ *   port 6981
+ *   warmup 2
+ *   phase ramp-up duration 20 ramp 10
+ *   flow clients 4 rate 2000 size 512
+ * A flow belongs to the phase above it.
+ * @param path
+ * @param plan filled with the phases
+ * @return 0 on success, -1 with the offending line printed if the plan is invalid
+ */
+int loadPlan(const char *path, struct scenario_plan *plan);
+
+/**
+ * Runs one phase: starts the flows' clients on their ramp, restarts clients
+ * that run out of packets and waits until every client has finished.
+ * @param env
+ * @param err
+ * @param scenario
+ * @param port
+ * @param phase
+ * @param result filled with what the phase sent
+ * @return 0 on success, -1 if the server exited
+ */
+int runPhase(const struct dc_posix_env *env, struct dc_error *err, struct scenario *scenario, u_int16_t port,
+        const struct scenario_phase *phase, struct phase_result *result);
+
+/**
+ * Runs the parser over the server logs with one second windows and sums the
+ * windows inside each phase's steady state.
+ * @param env
+ * @param err
+ * @param scenario
+ * @param results
+ * @param count
+ * @return 0 on success, -1 if the parser failed
+ */
+int measurePhases(const struct dc_posix_env *env, struct dc_error *err, const struct scenario *scenario,
+        struct phase_result *results, size_t count);
+
+/**
+ * Writes the scenario report as JSON.
+ * @param path
+ * @param planPath
+ * @param plan
+ * @param results
+ * @param count
+ * @return 0 on success, -1 if the file could not be written
+ */
+int writeScenarioReport(const char *path, const char *planPath, const struct scenario_plan *plan,
+        const struct phase_result *results, size_t count);
+
+#endif //ASSIGNMENT_2_SCENARIO_H
@@ -21,14 +21,53 @@
 #include <dc_posix/sys/dc_wait.h>
 #include <getopt.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/select.h>
 #include <time.h>
+#include "packetSender.h"
+#include "tcpStream.h"
+#include "udpReceiver.h"
+#include "packedLog.h"
+#include "rateSeries.h"
+#include "metricsEndpoint.h"
+#include "serverEvents.h"
 
 #define DEFAULT_PORT 4981
+#define DEFAULT_TCP_LOG "../../logs/tcpLog.txt"
+#define DEFAULT_UDP_LOG "../../logs/udpLog.txt"
+#define DEFAULT_STREAM_LOG "../../logs/streamLog.txt"
+#define REVERSE_COMMAND "Reverse:"
+#define DEFAULT_CPU "-1"
+#define DEFAULT_BUSY_POLL_USEC 50
+#define DEFAULT_LOG_FORMAT "text"
+#define SERVER_ACCEPT_SPINS 1024
+#define SERVER_DEFER_SECONDS 1
 #define MAXLINE  1024
 
+/**
+ * Server configuration gathered from the program arguments.
+ */
+struct server_options {
+    u_int16_t port;
+    const char *tcpLog;
+    const char *udpLog;
+    const char *streamLog;
+    bool busyPoll;
+    int cpu;
+    u_int16_t busyPollUsec;
+    bool packedLog;
+    u_int16_t statsInterval;
+    const char *statsLog;
+    u_int16_t metricsPort;
+    enum event_backend backend;
+};
+
 /**
  * Finds maximum value between two input parameters.
  * @param x as an int
@@ -42,9 +81,10 @@ int max(int x, int y);
  * received data to log files.
  * @param env
  * @param err
- * @param tcpPort from program arguments
+ * @param options from program arguments
+ * @return 0 when the server was stopped, -1 if it could not start or failed while running
  */
-void createServer(const struct dc_posix_env *env, struct dc_error *err, u_int16_t tcpPort);
+int createServer(const struct dc_posix_env *env, struct dc_error *err, const struct server_options *options);
 
 const char connectionTerminated[27] = "TCP Connection Terminated\n\n";
 
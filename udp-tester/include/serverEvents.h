@@ -0,0 +1,91 @@
+#ifndef ASSIGNMENT_2_SERVEREVENTS_H
+#define ASSIGNMENT_2_SERVEREVENTS_H
+
+#include <dc_posix/dc_string.h>
+#include <dc_posix/dc_unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/select.h>
+#include "udpReceiver.h"
+#include "uringReceiver.h"
+
+#define DEFAULT_BACKEND "select"
+#define EVENT_LISTEN 1
+#define EVENT_UDP 2
+#define EVENT_METRICS 4
+
+/**
+ * How the server waits for its sockets.
+ */
+enum event_backend {
+    BACKEND_SELECT,
+    BACKEND_EPOLL,
+    BACKEND_URING
+};
+
+/**
+ * The sockets of the server's select loop behind one wait. With io_uring the
+ * datagrams are read and logged inside the wait, so EVENT_UDP is never
+ * reported; select and epoll report it and leave the read to the caller.
+ */
+struct server_events {
+    enum event_backend backend;
+    int listenFD;
+    int udpFD;
+    int metricsFD;
+    int epollFD;
+    struct uring_receiver uring;
+};
+
+/**
+ * Looks up a backend by name.
+ * @param name select, epoll or uring
+ * @param backend filled with the backend
+ * @return 0 on success, -1 for an unknown name
+ */
+int parseEventBackend(const char *name, enum event_backend *backend);
+
+/**
+ * Returns the name of a backend.
+ * @param backend
+ * @return name as given to parseEventBackend()
+ */
+const char *eventBackendName(enum event_backend backend);
+
+/**
+ * Prepares the wait. A kernel that cannot run the io_uring backend is
+ * reported and epoll is used instead.
+ * @param env
+ * @param err
+ * @param events
+ * @param backend
+ * @param listenFD TCP listening socket
+ * @param receiver UDP receiver
+ * @param metricsFD metrics listener, -1 for none
+ * @return 0 on success, -1 if epoll could not be set up
+ */
+int openServerEvents(const struct dc_posix_env *env, struct dc_error *err, struct server_events *events,
+        enum event_backend backend, int listenFD, struct udp_receiver *receiver, int metricsFD);
+
+/**
+ * Waits until a socket is readable, a signal arrives or the timeout ends.
+ * @param env
+ * @param err
+ * @param events
+ * @param timeoutMs longest wait, -1 for none
+ * @return EVENT_* bits of the readable sockets, 0 on a timeout or signal, -1 on an error
+ */
+int waitServerEvents(const struct dc_posix_env *env, struct dc_error *err, struct server_events *events,
+        int timeoutMs);
+
+/**
+ * Releases the wait; io_uring finishes its log writes first.
+ * @param env
+ * @param err
+ * @param events
+ */
+void closeServerEvents(const struct dc_posix_env *env, struct dc_error *err, struct server_events *events);
+
+#endif //ASSIGNMENT_2_SERVEREVENTS_H
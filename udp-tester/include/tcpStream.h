@@ -0,0 +1,88 @@
+#ifndef ASSIGNMENT_2_TCPSTREAM_H
+#define ASSIGNMENT_2_TCPSTREAM_H
+
+#include <dc_posix/dc_fcntl.h>
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <dc_posix/dc_unistd.h>
+#include <dc_posix/sys/dc_socket.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#define STREAM_COMMAND "Stream:"
+#define STREAM_CHUNK (1024 * 1024)
+#define STREAM_RECEIVE_BUFFER (4 * 1024 * 1024)
+#define STREAM_SOCKET_BUFFER (4 * 1024 * 1024)
+#define DEFAULT_STREAM_SECONDS 10
+#define DEFAULT_STREAM_INTERVAL 1000
+
+/**
+ * Where a stream reports its per-interval throughput. Lines always go to
+ * stdout and also to logFD when it is not -1.
+ */
+struct stream_report {
+    const char *label;
+    u_int16_t intervalMs;
+    int logFD;
+    double start;
+    double intervalStart;
+    uint64_t intervalBytes;
+    uint64_t totalBytes;
+};
+
+/**
+ * Prepares a report and starts its clock.
+ * @param report
+ * @param label printed at the start of every line
+ * @param intervalMs length of one reporting interval
+ * @param logFD extra destination for the lines, -1 for none
+ */
+void startStreamReport(struct stream_report *report, const char *label, u_int16_t intervalMs, int logFD);
+
+/**
+ * Adds transferred bytes and prints every interval that has completed.
+ * @param report
+ * @param bytes
+ */
+void addStreamBytes(struct stream_report *report, uint64_t bytes);
+
+/**
+ * Prints the final partial interval and the total for the whole stream.
+ * @param report
+ */
+void finishStreamReport(struct stream_report *report);
+
+/**
+ * Sends a TCP bulk stream for a duration and/or byte count. The payload is
+ * a preallocated in-memory file sent with sendfile() so the data is not
+ * copied through user space; plain send() is used if sendfile() is not
+ * available for the socket.
+ * @param env
+ * @param err
+ * @param socketFD connected TCP socket
+ * @param seconds stop after this many seconds, 0 for no limit
+ * @param bytes stop after this many bytes, 0 for no limit
+ * @param report
+ * @return 0 on success, -1 if the connection failed; a peer that hung up
+ *         is raised as EPIPE rather than ending the process with SIGPIPE
+ */
+int sendStream(const struct dc_posix_env *env, struct dc_error *err, int socketFD, u_int16_t seconds, uint64_t bytes,
+        struct stream_report *report);
+
+/**
+ * Receives and discards a TCP bulk stream until the sender closes it. Data
+ * is spliced through a pipe into /dev/null; large recv() calls are used if
+ * splice() is not available.
+ * @param env
+ * @param err
+ * @param socketFD connected TCP socket
+ * @param report
+ * @return 0 on success, -1 if the connection failed
+ */
+int receiveStream(const struct dc_posix_env *env, struct dc_error *err, int socketFD, struct stream_report *report);
+
+#endif //ASSIGNMENT_2_TCPSTREAM_H
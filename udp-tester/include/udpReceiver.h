@@ -0,0 +1,171 @@
+#ifndef ASSIGNMENT_2_UDPRECEIVER_H
+#define ASSIGNMENT_2_UDPRECEIVER_H
+
+#include <arpa/inet.h>
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <dc_posix/dc_unistd.h>
+#include <dc_posix/sys/dc_socket.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/resource.h>
+#include <time.h>
+#include "fastFormat.h"
+#include "hotPath.h"
+#include "packedLog.h"
+#include "rateSeries.h"
+
+#define RECEIVER_BATCH 64
+#define RECEIVER_SLOT 1024
+#define RECEIVER_LOG_LINE 128
+#define RECEIVER_CONTROL 64
+#define LATENCY_BUCKETS 1000
+#define STAGE_BUCKETS 18
+
+/**
+ * Wakeup latency: the time from the kernel stamping a datagram
+ * (SO_TIMESTAMPNS) to the server reading it, in microsecond buckets.
+ */
+struct latency_stats {
+    uint64_t buckets[LATENCY_BUCKETS + 1];
+    uint64_t count;
+    uint64_t totalNs;
+    uint64_t minNs;
+    uint64_t maxNs;
+};
+
+/**
+ * Time spent in one step of handling a batch, in power-of-two microsecond
+ * buckets: bucket i holds times up to 2^i us, the last one everything longer.
+ */
+struct stage_latency {
+    uint64_t buckets[STAGE_BUCKETS + 1];
+    uint64_t count;
+    uint64_t totalNs;
+};
+
+/**
+ * Batched UDP receive path of the server. Datagrams are read with recvmmsg()
+ * and their log lines are written with one write() per batch, or handed to
+ * a packed log writer.
+ */
+struct udp_receiver {
+    int socketFD;
+    int logFD;
+    bool timestamps;
+    struct mmsghdr messages[RECEIVER_BATCH];
+    struct iovec iovecs[RECEIVER_BATCH];
+    struct sockaddr_in senders[RECEIVER_BATCH];
+    char controls[RECEIVER_BATCH][RECEIVER_CONTROL];
+    char *slots;
+    char *logBuffer;
+    char timeString[32];
+    size_t timeLength;
+    time_t cachedSecond;
+    struct packed_writer *packed;
+    struct rate_series *series;
+    u_int32_t wallSecond;
+    uint64_t packets;
+    uint64_t bytes;
+    uint64_t batches;
+    uint64_t batchSizes[RECEIVER_BATCH + 1];
+    struct latency_stats latency;
+    struct stage_latency parse;
+    struct stage_latency write;
+    struct timespec started;
+    struct rusage startUsage;
+};
+
+/**
+ * Prepares a receiver for a bound UDP socket and turns on kernel receive
+ * timestamps.
+ * @param env
+ * @param err
+ * @param receiver
+ * @param socketFD bound UDP socket
+ * @param logFD UDP log
+ * @param packed writer for a packed log, NULL to write text lines
+ * @param series per-interval counters every datagram is added to, may be NULL
+ * @return 0 on success, -1 if the buffers could not be allocated
+ */
+int createUdpReceiver(const struct dc_posix_env *env, struct dc_error *err, struct udp_receiver *receiver,
+        int socketFD, int logFD, struct packed_writer *packed, struct rate_series *series);
+
+/**
+ * Releases the receiver buffers.
+ * @param env
+ * @param receiver
+ */
+void destroyUdpReceiver(const struct dc_posix_env *env, struct udp_receiver *receiver);
+
+/**
+ * Starts a batch of datagrams: reads the clocks, refreshes the cached log
+ * time and moves the rate series to the current interval.
+ * @param env
+ * @param err
+ * @param receiver
+ * @param now filled with the wall clock time the batch is logged at
+ * @param batchStart filled with the monotonic time the batch started
+ */
+void beginReceiveBatch(const struct dc_posix_env *env, struct dc_error *err, struct udp_receiver *receiver,
+        struct timespec *now, struct timespec *batchStart);
+
+/**
+ * Counts one datagram and logs it, to the packed writer or as a text line.
+ * A record the packed writer fails to take is raised in err.
+ * @param env
+ * @param err
+ * @param receiver
+ * @param packet datagram as received, NUL terminated here if shorter than RECEIVER_SLOT
+ * @param length full datagram length
+ * @param sender
+ * @param header ancillary data carrying the kernel receive timestamp
+ * @param now wall clock time of the batch
+ * @param line where the text line is written, RECEIVER_LOG_LINE bytes
+ * @return length of the text line, 0 if the packed writer took the record
+ */
+size_t logDatagram(const struct dc_posix_env *env, struct dc_error *err, struct udp_receiver *receiver,
+        char *packet, size_t length, const struct sockaddr_in *sender, struct msghdr *header,
+        const struct timespec *now, char *line);
+
+/**
+ * Ends a batch: records the parse and write stage times and the batch size.
+ * @param receiver
+ * @param received datagrams in the batch
+ * @param batchStart from beginReceiveBatch()
+ * @param parsed monotonic time the last datagram was logged
+ */
+void endReceiveBatch(struct udp_receiver *receiver, size_t received, const struct timespec *batchStart,
+        const struct timespec *parsed);
+
+/**
+ * Reads one batch of datagrams and logs them.
+ * @param env
+ * @param err
+ * @param receiver
+ * @param flags recvmmsg() flags, MSG_DONTWAIT for polling
+ * @return datagrams read, 0 if none were waiting, -1 on a socket error
+ */
+int receiveDatagrams(const struct dc_posix_env *env, struct dc_error *err, struct udp_receiver *receiver, int flags);
+
+/**
+ * Turns on SO_BUSY_POLL and SO_PREFER_BUSY_POLL where the kernel has them.
+ * Failures are reported and ignored, busy polling still spins in user space.
+ * @param socketFD
+ * @param usec busy poll budget per receive
+ */
+void enableBusyPoll(int socketFD, int usec);
+
+/**
+ * Prints packets, wakeup latency percentiles and CPU use since the receiver
+ * was created.
+ * @param receiver
+ * @param mode label for the receive mode
+ */
+void printReceiverReport(const struct udp_receiver *receiver, const char *mode);
+
+#endif //ASSIGNMENT_2_UDPRECEIVER_H
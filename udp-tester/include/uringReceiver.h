@@ -0,0 +1,117 @@
+#ifndef ASSIGNMENT_2_URINGRECEIVER_H
+#define ASSIGNMENT_2_URINGRECEIVER_H
+
+#include <dc_posix/dc_stdlib.h>
+#include <dc_posix/dc_string.h>
+#include <dc_posix/dc_unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include "udpReceiver.h"
+
+#define URING_ENTRIES 64
+#define URING_COMPLETIONS 4096
+#define URING_BUFFERS 256
+#define URING_BUFFER_SIZE 2048
+#define URING_BUFFER_GROUP 0
+#define URING_LOG_BUFFERS 8
+#define URING_MAX_WATCHES 4
+#define URING_RECV_TAG UINT64_C(0x100000000)
+#define URING_WRITE_TAG UINT64_C(0x200000000)
+
+/**
+ * io_uring receive path of the server. One multishot recvmsg on the UDP
+ * socket reads datagrams into a ring of kernel-provided buffers, multishot
+ * polls report the other sockets, and each batch's log lines go out as one
+ * asynchronous write at an offset reserved for it, so writes may complete
+ * in any order and the file still reads in receive order.
+ */
+struct uring_receiver {
+    int ringFD;
+    struct udp_receiver *receiver;
+    void *sqRing;
+    size_t sqRingSize;
+    void *cqRing;
+    size_t cqRingSize;
+    struct io_uring_sqe *sqes;
+    size_t sqesSize;
+    unsigned *sqHead;
+    unsigned *sqTail;
+    unsigned *sqArray;
+    unsigned sqMask;
+    unsigned sqEntries;
+    unsigned sqLocalTail;
+    unsigned toSubmit;
+    unsigned *cqHead;
+    unsigned *cqTail;
+    struct io_uring_cqe *cqes;
+    unsigned cqMask;
+    struct io_uring_buf_ring *bufferRing;
+    size_t bufferRingSize;
+    char *buffers;
+    unsigned short bufferTail;
+    struct msghdr recvHeader;
+    bool recvArmed;
+    int watchFDs[URING_MAX_WATCHES];
+    int watchEvents[URING_MAX_WATCHES];
+    bool watchArmed[URING_MAX_WATCHES];
+    size_t watchCount;
+    char *logBuffers;
+    size_t logLengths[URING_LOG_BUFFERS];
+    off_t logOffsets[URING_LOG_BUFFERS];
+    bool logBusy[URING_LOG_BUFFERS];
+    off_t logOffset;
+    unsigned writesInFlight;
+    bool draining;
+};
+
+/**
+ * Sets up the ring, registers the receive buffers and arms a multishot
+ * recvmsg on the receiver's socket. A text log is switched from O_APPEND to
+ * writes at tracked offsets.
+ * @param env
+ * @param err
+ * @param ring
+ * @param receiver created receiver whose socket and logs are used
+ * @return 0 on success, -1 with errno set if the kernel lacks a feature the ring needs
+ */
+int createUringReceiver(const struct dc_posix_env *env, struct dc_error *err, struct uring_receiver *ring,
+        struct udp_receiver *receiver);
+
+/**
+ * Reports a socket through waitUringReceiver() when it becomes readable.
+ * @param ring
+ * @param fd
+ * @param event bit returned while fd is readable
+ * @return 0 on success, -1 if URING_MAX_WATCHES sockets are already watched
+ */
+int watchUringSocket(struct uring_receiver *ring, int fd, int event);
+
+/**
+ * Submits queued work, waits for completions and handles them: datagrams
+ * are logged in batches of up to RECEIVER_BATCH, finished log writes free
+ * their buffers and readable watched sockets are reported.
+ * @param env
+ * @param err
+ * @param ring
+ * @param timeoutMs longest wait, -1 to wait until something completes
+ * @return event bits of the readable watched sockets, 0 on a timeout or signal, -1 on a ring error
+ */
+int waitUringReceiver(const struct dc_posix_env *env, struct dc_error *err, struct uring_receiver *ring,
+        int timeoutMs);
+
+/**
+ * Waits for the log writes still in flight and releases the ring.
+ * @param env
+ * @param err
+ * @param ring
+ */
+void destroyUringReceiver(const struct dc_posix_env *env, struct dc_error *err, struct uring_receiver *ring);
+
+#endif //ASSIGNMENT_2_URINGRECEIVER_H
@@ -0,0 +1,570 @@
+#include "capacitySweep.h"
+
+struct application_settings {
+    struct dc_opt_settings opts;
+    struct dc_setting_string *message;
+    struct dc_setting_string *server;
+    struct dc_setting_string *client;
+    struct dc_setting_uint16 *port;
+    struct dc_setting_string *sizes;
+    struct dc_setting_string *minRate;
+    struct dc_setting_string *maxRate;
+    struct dc_setting_uint16 *duration;
+    struct dc_setting_string *precision;
+    struct dc_setting_string *workDir;
+    struct dc_setting_string *csv;
+    struct dc_setting_string *json;
+};
+
+static struct dc_application_settings *create_settings(const struct dc_posix_env *env, struct dc_error *err);
+static int destroy_settings(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings **psettings);
+static int run(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings *settings);
+static void error_reporter(const struct dc_error *err);
+static void trace_reporter(const struct dc_posix_env *env, const char *file_name, const char *function_name, size_t line_number);
+static size_t parseSizes(const char *list, u_int16_t *sizes, size_t maxSizes);
+static void sleepMillis(long millis);
+static u_int32_t countNewLines(const struct dc_posix_env *env, struct dc_error *err, struct sweep *sweep);
+static pid_t startServer(const struct dc_posix_env *env, struct dc_error *err, struct sweep *sweep);
+static double megabitsPerSecond(u_int32_t rate, u_int16_t size);
+
+int main(int argc, char *argv[]) {
+    dc_posix_tracer tracer;
+    dc_error_reporter reporter;
+    struct dc_posix_env env;
+    struct dc_error err;
+    struct dc_application_info *info;
+    int ret_val;
+
+    reporter = error_reporter;
+//    tracer = trace_reporter;
+    tracer = NULL;
+    dc_error_init(&err, reporter);
+    dc_posix_env_init(&env, tracer);
+    info = dc_application_info_create(&env, &err, "Settings Application");
+    ret_val = dc_application_run(&env, &err, info, create_settings, destroy_settings,
+                                 run, dc_default_create_lifecycle, dc_default_destroy_lifecycle,
+                                 NULL, argc, argv);
+    dc_application_info_destroy(&env, &info);
+    dc_error_reset(&err);
+
+    return ret_val;
+}
+
+static struct dc_application_settings *create_settings(const struct dc_posix_env *env, struct dc_error *err) {
+    struct application_settings *settings;
+
+    static const uint16_t default_port = DEFAULT_SWEEP_PORT;
+    static const uint16_t default_duration = DEFAULT_TRIAL_SECONDS;
+
+    DC_TRACE(env);
+    settings = dc_malloc(env, err, sizeof(struct application_settings));
+
+    if(settings == NULL) {
+        return NULL;
+    }
+
+    settings->opts.parent.config_path = dc_setting_path_create(env, err);
+    settings->message = dc_setting_string_create(env, err);
+    settings->server = dc_setting_string_create(env, err);
+    settings->client = dc_setting_string_create(env, err);
+    settings->port = dc_setting_uint16_create(env, err);
+    settings->sizes = dc_setting_string_create(env, err);
+    settings->minRate = dc_setting_string_create(env, err);
+    settings->maxRate = dc_setting_string_create(env, err);
+    settings->duration = dc_setting_uint16_create(env, err);
+    settings->precision = dc_setting_string_create(env, err);
+    settings->workDir = dc_setting_string_create(env, err);
+    settings->csv = dc_setting_string_create(env, err);
+    settings->json = dc_setting_string_create(env, err);
+
+    struct options opts[] = {
+            {(struct dc_setting *)settings->opts.parent.config_path,
+                    dc_options_set_path,
+                    "config",
+                    required_argument,
+                    'c',
+                    "CONFIG",
+                    dc_string_from_string,
+                    NULL,
+                    dc_string_from_config,
+                    NULL},
+            {(struct dc_setting *)settings->message,
+                    dc_options_set_string,
+                    "message",
+                    required_argument,
+                    'm',
+                    "MESSAGE",
+                    dc_string_from_string,
+                    "message",
+                    dc_string_from_config,
+                    "Hello, Default World!"},
+            {(struct dc_setting *)settings->server,
+                    dc_options_set_string,
+                    "server",
+                    required_argument,
+                    's',
+                    "SERVER",
+                    dc_string_from_string,
+                    "server",
+                    dc_string_from_config,
+                    DEFAULT_SERVER_PROGRAM},
+            {(struct dc_setting *)settings->client,
+                    dc_options_set_string,
+                    "client",
+                    required_argument,
+                    'C',
+                    "CLIENT",
+                    dc_string_from_string,
+                    "client",
+                    dc_string_from_config,
+                    DEFAULT_CLIENT_PROGRAM},
+            {(struct dc_setting *)settings->port,
+                    dc_options_set_uint16,
+                    "port",
+                    required_argument,
+                    'p',
+                    "PORT",
+                    dc_uint16_from_string,
+                    "port",
+                    dc_uint16_from_config,
+                    &default_port},
+            {(struct dc_setting *)settings->sizes,
+                    dc_options_set_string,
+                    "sizes",
+                    required_argument,
+                    'z',
+                    "SIZES",
+                    dc_string_from_string,
+                    "sizes",
+                    dc_string_from_config,
+                    DEFAULT_SWEEP_SIZES},
+            {(struct dc_setting *)settings->minRate,
+                    dc_options_set_string,
+                    "min-rate",
+                    required_argument,
+                    'r',
+                    "MIN_RATE",
+                    dc_string_from_string,
+                    "min-rate",
+                    dc_string_from_config,
+                    DEFAULT_MIN_RATE},
+            {(struct dc_setting *)settings->maxRate,
+                    dc_options_set_string,
+                    "max-rate",
+                    required_argument,
+                    'R',
+                    "MAX_RATE",
+                    dc_string_from_string,
+                    "max-rate",
+                    dc_string_from_config,
+                    DEFAULT_MAX_RATE},
+            {(struct dc_setting *)settings->duration,
+                    dc_options_set_uint16,
+                    "duration",
+                    required_argument,
+                    'd',
+                    "DURATION",
+                    dc_uint16_from_string,
+                    "duration",
+                    dc_uint16_from_config,
+                    &default_duration},
+            {(struct dc_setting *)settings->precision,
+                    dc_options_set_string,
+                    "precision",
+                    required_argument,
+                    'e',
+                    "PRECISION",
+                    dc_string_from_string,
+                    "precision",
+                    dc_string_from_config,
+                    DEFAULT_PRECISION},
+            {(struct dc_setting *)settings->workDir,
+                    dc_options_set_string,
+                    "work-dir",
+                    required_argument,
+                    'w',
+                    "WORK_DIR",
+                    dc_string_from_string,
+                    "work-dir",
+                    dc_string_from_config,
+                    DEFAULT_WORK_DIR},
+            {(struct dc_setting *)settings->csv,
+                    dc_options_set_string,
+                    "csv",
+                    required_argument,
+                    'v',
+                    "CSV",
+                    dc_string_from_string,
+                    "csv",
+                    dc_string_from_config,
+                    DEFAULT_CSV},
+            {(struct dc_setting *)settings->json,
+                    dc_options_set_string,
+                    "json",
+                    required_argument,
+                    'j',
+                    "JSON",
+                    dc_string_from_string,
+                    "json",
+                    dc_string_from_config,
+                    DEFAULT_JSON},
+    };
+
+    settings->opts.opts_count = (sizeof(opts) / sizeof(struct options)) + 1;
+    settings->opts.opts_size = sizeof(struct options);
+    settings->opts.opts = dc_calloc(env, err, settings->opts.opts_count, settings->opts.opts_size);
+    dc_memcpy(env, settings->opts.opts, opts, sizeof(opts));
+    settings->opts.flags = "m:";
+    settings->opts.env_prefix = "DC_EXAMPLE_";
+
+    return (struct dc_application_settings *)settings;
+}
+
+static int destroy_settings(const struct dc_posix_env *env, __attribute__((unused)) struct dc_error *err,
+                            struct dc_application_settings **psettings) {
+    struct application_settings *app_settings;
+
+    DC_TRACE(env);
+    app_settings = (struct application_settings *)*psettings;
+    dc_setting_string_destroy(env, &app_settings->message);
+    dc_free(env, app_settings->opts.opts, app_settings->opts.opts_count);
+    dc_free(env, *psettings, sizeof(struct application_settings));
+
+    if(env->null_free) {
+        *psettings = NULL;
+    }
+
+    return 0;
+}
+
+static size_t parseSizes(const char *list, u_int16_t *sizes, size_t maxSizes) {
+    const char *current = list;
+    size_t count = 0;
+
+    while (*current != '\0' && count < maxSizes) {
+        char *endPointer;
+        unsigned long size = strtoul(current, &endPointer, 10);
+
+        if (endPointer == current) {
+            break;
+        }
+
+        if (size >= MIN_PACKET_SIZE && size <= UINT16_MAX) {
+            sizes[count++] = (u_int16_t) size;
+        } else {
+            printf("Skipping packet size %lu: sizes must be between %d and %d\n", size, MIN_PACKET_SIZE, UINT16_MAX);
+        }
+
+        current = *endPointer == ',' ? endPointer + 1 : endPointer;
+    }
+
+    return count;
+}
+
+static void sleepMillis(long millis) {
+    struct timespec ts;
+
+    ts.tv_sec = millis / 1000;
+    ts.tv_nsec = (millis % 1000) * 1000000;
+    nanosleep(&ts, &ts);
+}
+
+static double megabitsPerSecond(u_int32_t rate, u_int16_t size) {
+    return (double) rate * (double) size * 8.0 / 1000000.0;
+}
+
+static u_int32_t countNewLines(const struct dc_posix_env *env, struct dc_error *err, struct sweep *sweep) {
+    char buffer[65536];
+    u_int32_t lines = 0;
+    ssize_t bytes;
+    int fd;
+
+    fd = dc_open(env, err, sweep->udpLog, O_RDONLY, 0);
+
+    if (dc_error_has_error(err)) {
+        return 0;
+    }
+
+    // Only the bytes appended since the previous trial belong to this client.
+    while ((bytes = pread(fd, buffer, sizeof(buffer), sweep->udpOffset)) > 0) {
+        for (ssize_t i = 0; i < bytes; i++) {
+            if (buffer[i] == '\n') {
+                lines++;
+            }
+        }
+
+        sweep->udpOffset += bytes;
+    }
+
+    dc_close(env, err, fd);
+    return lines;
+}
+
+static pid_t startServer(const struct dc_posix_env *env, struct dc_error *err, struct sweep *sweep) {
+    char port[8];
+    const char *argv[] = {
+            sweep->serverProgram,
+            "--port", port,
+            "--tcp-log", sweep->tcpLog,
+            "--udp-log", sweep->udpLog,
+            NULL
+    };
+
+    sprintf(port, "%hu", sweep->port);
+    sweep->serverPID = spawnProcess(env, err, argv, sweep->nullFD);
+    sleepMillis(SERVER_STARTUP_MS);
+
+    return sweep->serverPID;
+}
+
+int runTrial(const struct dc_posix_env *env, struct dc_error *err, struct sweep *sweep, u_int16_t size,
+        u_int32_t rate, struct trial_result *result) {
+    char port[8];
+    char packets[8];
+    char packetSize[8];
+    char packetRate[16];
+    const char *argv[] = {
+            sweep->clientProgram,
+            "--port", port,
+            "--packets", packets,
+            "--pSize", packetSize,
+            "--rate", packetRate,
+            "--delay", "0",
+            NULL
+    };
+    struct rusage usage;
+    unsigned long count;
+    double start;
+    double serverCpuStart;
+    pid_t clientPID;
+
+    count = (unsigned long) rate * sweep->trialSeconds;
+
+    if (count > MAX_TRIAL_PACKETS) {
+        count = MAX_TRIAL_PACKETS;
+    } else if (count < MIN_TRIAL_PACKETS) {
+        count = MIN_TRIAL_PACKETS;
+    }
+
+    sprintf(port, "%hu", sweep->port);
+    sprintf(packets, "%lu", count);
+    sprintf(packetSize, "%hu", size);
+    sprintf(packetRate, "%u", rate);
+
+    serverCpuStart = processCpuSeconds(sweep->serverPID);
+    start = monotonicSeconds();
+    clientPID = spawnProcess(env, err, argv, sweep->nullFD);
+
+    if (clientPID == -1 || waitProcess(env, err, clientPID, &usage) != 0) {
+        printf("Client Failed -> Stopping Sweep\n");
+        return -1;
+    }
+
+    sweep->clientsStarted++;
+
+    // Give the server time to drain its socket buffer before counting.
+    sleepMillis(TRIAL_DRAIN_MS);
+
+    result->size = size;
+    result->rate = rate;
+    result->sent = (u_int32_t) count;
+    result->received = countNewLines(env, err, sweep);
+    result->seconds = monotonicSeconds() - start;
+    result->serverCpu = 100.0 * (processCpuSeconds(sweep->serverPID) - serverCpuStart) / result->seconds;
+    result->clientCpu = 100.0 * rusageCpuSeconds(&usage) / result->seconds;
+
+    printf("size %5hu  rate %8u pps  sent %6u  received %6u  server cpu %5.1f%%  client cpu %5.1f%%\n",
+           size, rate, result->sent, result->received, result->serverCpu, result->clientCpu);
+
+    return 0;
+}
+
+void sweepPacketSize(const struct dc_posix_env *env, struct dc_error *err, struct sweep *sweep, u_int16_t size,
+        struct sweep_result *result) {
+    struct trial_result trial;
+    u_int32_t good = 0;
+    u_int32_t bad = 0;
+    u_int32_t rate = sweep->minRate;
+
+    dc_memset(env, result, 0, sizeof(*result));
+    result->size = size;
+
+    // Double the rate until the server drops something or the ceiling is reached.
+    while (bad == 0) {
+        if (runTrial(env, err, sweep, size, rate, &trial) != 0) {
+            return;
+        }
+
+        result->trials++;
+
+        if (trial.received >= trial.sent) {
+            good = rate;
+            result->best = trial;
+
+            if (rate == sweep->maxRate) {
+                result->saturated = true;
+                return;
+            }
+
+            rate = rate > sweep->maxRate / 2 ? sweep->maxRate : rate * 2;
+        } else {
+            bad = rate;
+        }
+    }
+
+    // Binary search between the last clean rate and the first lossy one.
+    while (good > 0 && (double) (bad - good) > (double) good * sweep->precision) {
+        rate = good + (bad - good) / 2;
+
+        if (runTrial(env, err, sweep, size, rate, &trial) != 0) {
+            return;
+        }
+
+        result->trials++;
+
+        if (trial.received >= trial.sent) {
+            good = rate;
+            result->best = trial;
+        } else {
+            bad = rate;
+        }
+    }
+}
+
+int writeSweepCsv(const char *path, const struct sweep_result *results, size_t count) {
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL) {
+        return -1;
+    }
+
+    fprintf(file, "packet_size,max_lossfree_pps,throughput_mbps,server_cpu_percent,client_cpu_percent,"
+                  "reached_max_rate,trials\n");
+
+    for (size_t i = 0; i < count; i++) {
+        const struct sweep_result *result = &results[i];
+
+        fprintf(file, "%hu,%u,%.3f,%.1f,%.1f,%s,%u\n", result->size, result->best.rate,
+                megabitsPerSecond(result->best.rate, result->size), result->best.serverCpu, result->best.clientCpu,
+                result->saturated ? "true" : "false", result->trials);
+    }
+
+    fclose(file);
+    return 0;
+}
+
+int writeSweepJson(const char *path, const struct sweep_result *results, size_t count) {
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL) {
+        return -1;
+    }
+
+    fprintf(file, "[\n");
+
+    for (size_t i = 0; i < count; i++) {
+        const struct sweep_result *result = &results[i];
+
+        fprintf(file, "  {\"packet_size\": %hu, \"max_lossfree_pps\": %u, \"throughput_mbps\": %.3f, "
+                      "\"server_cpu_percent\": %.1f, \"client_cpu_percent\": %.1f, \"reached_max_rate\": %s, "
+                      "\"trials\": %u}%s\n",
+                result->size, result->best.rate, megabitsPerSecond(result->best.rate, result->size),
+                result->best.serverCpu, result->best.clientCpu, result->saturated ? "true" : "false",
+                result->trials, i + 1 < count ? "," : "");
+    }
+
+    fprintf(file, "]\n");
+    fclose(file);
+    return 0;
+}
+
+static int run(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings *settings) {
+    struct application_settings *app_settings;
+    struct sweep_result results[MAX_SWEEP_SIZES];
+    struct sweep sweep;
+    const char *workDir;
+    const char *csv;
+    const char *json;
+    size_t completed = 0;
+    int fd;
+
+    DC_TRACE(env);
+
+    app_settings = (struct application_settings *)settings;
+    dc_memset(env, &sweep, 0, sizeof(sweep));
+    sweep.serverProgram = dc_setting_string_get(env, app_settings->server);
+    sweep.clientProgram = dc_setting_string_get(env, app_settings->client);
+    sweep.port = dc_setting_uint16_get(env, app_settings->port);
+    sweep.sizeCount = parseSizes(dc_setting_string_get(env, app_settings->sizes), sweep.sizes, MAX_SWEEP_SIZES);
+    sweep.minRate = (u_int32_t) strtoul(dc_setting_string_get(env, app_settings->minRate), NULL, 10);
+    sweep.maxRate = (u_int32_t) strtoul(dc_setting_string_get(env, app_settings->maxRate), NULL, 10);
+    sweep.trialSeconds = dc_setting_uint16_get(env, app_settings->duration);
+    sweep.precision = strtod(dc_setting_string_get(env, app_settings->precision), NULL);
+    workDir = dc_setting_string_get(env, app_settings->workDir);
+    csv = dc_setting_string_get(env, app_settings->csv);
+    json = dc_setting_string_get(env, app_settings->json);
+
+    if (sweep.sizeCount == 0 || sweep.minRate == 0 || sweep.maxRate < sweep.minRate || sweep.trialSeconds == 0
+        || sweep.precision <= 0.0) {
+        printf("Invalid sweep configuration -> Closing Sweep\n");
+        return EXIT_FAILURE;
+    }
+
+    if (mkdir(workDir, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) != 0 && errno != EEXIST) {
+        printf("Could not create %s -> Closing Sweep\n", workDir);
+        return EXIT_FAILURE;
+    }
+
+    snprintf(sweep.tcpLog, sizeof(sweep.tcpLog), "%s/tcpLog.txt", workDir);
+    snprintf(sweep.udpLog, sizeof(sweep.udpLog), "%s/udpLog.txt", workDir);
+
+    // Every sweep starts from empty logs so the trial counts line up.
+    fd = dc_open(env, err, sweep.tcpLog, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    dc_close(env, err, fd);
+    fd = dc_open(env, err, sweep.udpLog, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    dc_close(env, err, fd);
+    sweep.nullFD = dc_open(env, err, "/dev/null", O_WRONLY, 0);
+
+    if (dc_error_has_error(err) || startServer(env, err, &sweep) == -1) {
+        printf("Could not start %s -> Closing Sweep\n", sweep.serverProgram);
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < sweep.sizeCount; i++) {
+        sweepPacketSize(env, err, &sweep, sweep.sizes[i], &results[i]);
+
+        if (results[i].trials == 0) {
+            break;
+        }
+
+        completed++;
+    }
+
+    stopProcess(env, err, sweep.serverPID);
+    dc_close(env, err, sweep.nullFD);
+
+    printf("----------------------------------------\n");
+
+    for (size_t i = 0; i < completed; i++) {
+        printf("Size %5hu: %u pps loss-free (%.1f Mbit/s), server cpu %.1f%%%s\n", results[i].size,
+               results[i].best.rate, megabitsPerSecond(results[i].best.rate, results[i].size),
+               results[i].best.serverCpu, results[i].saturated ? ", reached --max-rate" : "");
+    }
+
+    if (writeSweepCsv(csv, results, completed) != 0 || writeSweepJson(json, results, completed) != 0) {
+        printf("Could not write sweep results\n");
+        return EXIT_FAILURE;
+    }
+
+    return completed == sweep.sizeCount ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static void error_reporter(const struct dc_error *err) {
+    fprintf(stderr, "ERROR: %s : %s : @ %zu : %d\n", err->file_name, err->function_name, err->line_number, 0);
+    fprintf(stderr, "ERROR: %s\n", err->message);
+}
+
+static void trace_reporter(__attribute__((unused)) const struct dc_posix_env *env, const char *file_name,
+                           const char *function_name, size_t line_number) {
+    fprintf(stdout, "TRACE: %s : %s : @ %zu\n", file_name, function_name, line_number);
+}
@@ -0,0 +1,105 @@
+#include "childProcess.h"
+
+pid_t spawnProcess(const struct dc_posix_env *env, struct dc_error *err, const char *const argv[], int outputFD) {
+    // execv() takes a non-const vector for historical reasons but never writes to it.
+    union {
+        const char *const *constant;
+        char *const *mutable;
+    } arguments;
+    pid_t pid;
+
+    arguments.constant = argv;
+
+    pid = dc_fork(env, err);
+
+    if (pid == 0) {
+        if (outputFD != -1) {
+            dc_dup2(env, err, outputFD, STDOUT_FILENO);
+            dc_dup2(env, err, outputFD, STDERR_FILENO);
+        }
+
+        execv(argv[0], arguments.mutable);
+        fprintf(stderr, "Could not start %s\n", argv[0]);
+        _exit(127);
+    }
+
+    return pid;
+}
+
+int waitProcess(const struct dc_posix_env *env, struct dc_error *err, pid_t pid, struct rusage *usage) {
+    struct rusage childUsage;
+    int status;
+
+    DC_TRACE(env);
+
+    if (wait4(pid, &status, 0, &childUsage) == -1) {
+        DC_ERROR_RAISE_ERRNO(err, errno);
+        return -1;
+    }
+
+    if (usage != NULL) {
+        *usage = childUsage;
+    }
+
+    if (!WIFEXITED(status)) {
+        return -1;
+    }
+
+    return WEXITSTATUS(status);
+}
+
+void stopProcess(const struct dc_posix_env *env, struct dc_error *err, pid_t pid) {
+    int status;
+
+    if (pid <= 0) {
+        return;
+    }
+
+    kill(pid, SIGTERM);
+    dc_waitpid(env, err, pid, &status, 0);
+}
+
+double processCpuSeconds(pid_t pid) {
+    char path[64];
+    char stat[1024];
+    unsigned long userTicks;
+    unsigned long systemTicks;
+    long ticksPerSecond;
+    const char *fields;
+    FILE *file;
+    size_t length;
+
+    sprintf(path, "/proc/%d/stat", (int) pid);
+    file = fopen(path, "r");
+
+    if (file == NULL) {
+        return 0.0;
+    }
+
+    length = fread(stat, 1, sizeof(stat) - 1, file);
+    fclose(file);
+    stat[length] = '\0';
+
+    // The command name may contain spaces, so start after its closing parenthesis.
+    fields = strrchr(stat, ')');
+
+    if (fields == NULL || sscanf(fields + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+                                 &userTicks, &systemTicks) != 2) {
+        return 0.0;
+    }
+
+    ticksPerSecond = sysconf(_SC_CLK_TCK);
+    return (double) (userTicks + systemTicks) / (double) ticksPerSecond;
+}
+
+double rusageCpuSeconds(const struct rusage *usage) {
+    return (double) (usage->ru_utime.tv_sec + usage->ru_stime.tv_sec)
+           + (double) (usage->ru_utime.tv_usec + usage->ru_stime.tv_usec) / 1000000.0;
+}
+
+double monotonicSeconds(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1000000000.0;
+}
@@ -5,10 +5,23 @@ struct application_settings {
     struct dc_setting_string *message;
     struct dc_setting_string *server;
     struct dc_setting_uint16 *port;
+    struct dc_setting_uint16 *udpPort;
     struct dc_setting_string *start;
     struct dc_setting_uint16 *packets;
     struct dc_setting_uint16 *packetSize;
     struct dc_setting_uint16 *delay;
+    struct dc_setting_string *rate;
+    struct dc_setting_bool *stream;
+    struct dc_setting_uint16 *duration;
+    struct dc_setting_string *streamBytes;
+    struct dc_setting_uint16 *interval;
+    struct dc_setting_bool *reverse;
+    struct dc_setting_string *tcpLog;
+    struct dc_setting_string *udpLog;
+    struct dc_setting_string *replay;
+    struct dc_setting_string *speed;
+    struct dc_setting_uint16 *replayPort;
+    struct dc_setting_string *stats;
 };
 
 static struct dc_application_settings *create_settings(const struct dc_posix_env *env, struct dc_error *err);
@@ -19,6 +32,10 @@ static void trace_reporter(const struct dc_posix_env *env, const char *file_name
 static int createSocket(const struct dc_posix_env *env, struct dc_error *err, void *arg);
 static int sendTCPInformation(const struct dc_posix_env *env, struct dc_error *err, void *arg);
 static int sendToServer(const struct dc_posix_env *env, struct dc_error *err, void *arg);
+static int streamToServer(const struct dc_posix_env *env, struct dc_error *err, void *arg);
+static u_int16_t bindReceiveSocket(const struct dc_posix_env *env, struct dc_error *err, struct client *client);
+static int receiveFromServer(const struct dc_posix_env *env, struct dc_error *err, void *arg);
+static int showStats(const struct dc_posix_env *env, struct dc_error *err, void *arg);
 static int closeConnection(const struct dc_posix_env *env, struct dc_error *err, void *arg);
 
 int main(int argc, char *argv[]) {
@@ -49,9 +66,15 @@ static struct dc_application_settings *create_settings(const struct dc_posix_env
 
     static const char *default_server = DEFAULT_SERVER_ADDRESS;
     static const uint16_t default_port = DEFAULT_PORT;
+    static const uint16_t default_udpPort = 0;
     static const uint16_t default_packetSize = DEFAULT_PACKET_SIZE;
     static const uint16_t default_packets = DEFAULT_PACKETS;
     static const uint16_t default_delay = DEFAULT_DELAY;
+    static const bool default_stream = false;
+    static const uint16_t default_duration = DEFAULT_STREAM_SECONDS;
+    static const uint16_t default_interval = DEFAULT_STREAM_INTERVAL;
+    static const bool default_reverse = false;
+    static const uint16_t default_replayPort = DEFAULT_REPLAY_PORT;
 
     DC_TRACE(env);
     settings = dc_malloc(env, err, sizeof(struct application_settings));
@@ -64,10 +87,23 @@ static struct dc_application_settings *create_settings(const struct dc_posix_env
     settings->message = dc_setting_string_create(env, err);
     settings->server = dc_setting_string_create(env, err);
     settings->port = dc_setting_uint16_create(env, err);
+    settings->udpPort = dc_setting_uint16_create(env, err);
     settings->start = dc_setting_string_create(env, err);
     settings->packets = dc_setting_uint16_create(env, err);
     settings->packetSize = dc_setting_uint16_create(env, err);
     settings->delay = dc_setting_uint16_create(env, err);
+    settings->rate = dc_setting_string_create(env, err);
+    settings->stream = dc_setting_bool_create(env, err);
+    settings->duration = dc_setting_uint16_create(env, err);
+    settings->streamBytes = dc_setting_string_create(env, err);
+    settings->interval = dc_setting_uint16_create(env, err);
+    settings->reverse = dc_setting_bool_create(env, err);
+    settings->tcpLog = dc_setting_string_create(env, err);
+    settings->udpLog = dc_setting_string_create(env, err);
+    settings->replay = dc_setting_string_create(env, err);
+    settings->speed = dc_setting_string_create(env, err);
+    settings->replayPort = dc_setting_uint16_create(env, err);
+    settings->stats = dc_setting_string_create(env, err);
 
     struct options opts[] = {
             {(struct dc_setting *)settings->opts.parent.config_path,
@@ -110,6 +146,16 @@ static struct dc_application_settings *create_settings(const struct dc_posix_env
                     "port",
                     dc_uint16_from_config,
                     &default_port},
+            {(struct dc_setting *)settings->udpPort,
+                    dc_options_set_uint16,
+                    "udp-port",
+                    required_argument,
+                    'u',
+                    "UDP_PORT",
+                    dc_uint16_from_string,
+                    "udp-port",
+                    dc_uint16_from_config,
+                    &default_udpPort},
             {(struct dc_setting *)settings->start,
                     dc_options_set_string,
                     "start",
@@ -150,6 +196,126 @@ static struct dc_application_settings *create_settings(const struct dc_posix_env
                     "delay",
                     dc_uint16_from_config,
                     &default_delay},
+            {(struct dc_setting *)settings->rate,
+                    dc_options_set_string,
+                    "rate",
+                    required_argument,
+                    'r',
+                    "RATE",
+                    dc_string_from_string,
+                    "rate",
+                    dc_string_from_config,
+                    DEFAULT_RATE},
+            {(struct dc_setting *)settings->stream,
+                    dc_options_set_bool,
+                    "tcp-stream",
+                    no_argument,
+                    'T',
+                    "TCP_STREAM",
+                    dc_flag_from_string,
+                    "tcp-stream",
+                    dc_flag_from_config,
+                    &default_stream},
+            {(struct dc_setting *)settings->duration,
+                    dc_options_set_uint16,
+                    "duration",
+                    required_argument,
+                    'D',
+                    "DURATION",
+                    dc_uint16_from_string,
+                    "duration",
+                    dc_uint16_from_config,
+                    &default_duration},
+            {(struct dc_setting *)settings->streamBytes,
+                    dc_options_set_string,
+                    "bytes",
+                    required_argument,
+                    'b',
+                    "BYTES",
+                    dc_string_from_string,
+                    "bytes",
+                    dc_string_from_config,
+                    DEFAULT_STREAM_BYTES},
+            {(struct dc_setting *)settings->interval,
+                    dc_options_set_uint16,
+                    "interval",
+                    required_argument,
+                    'i',
+                    "INTERVAL",
+                    dc_uint16_from_string,
+                    "interval",
+                    dc_uint16_from_config,
+                    &default_interval},
+            {(struct dc_setting *)settings->reverse,
+                    dc_options_set_bool,
+                    "reverse",
+                    no_argument,
+                    'R',
+                    "REVERSE",
+                    dc_flag_from_string,
+                    "reverse",
+                    dc_flag_from_config,
+                    &default_reverse},
+            {(struct dc_setting *)settings->tcpLog,
+                    dc_options_set_string,
+                    "tcp-log",
+                    required_argument,
+                    'l',
+                    "TCP_LOG",
+                    dc_string_from_string,
+                    "tcp-log",
+                    dc_string_from_config,
+                    DEFAULT_CLIENT_TCP_LOG},
+            {(struct dc_setting *)settings->udpLog,
+                    dc_options_set_string,
+                    "udp-log",
+                    required_argument,
+                    'L',
+                    "UDP_LOG",
+                    dc_string_from_string,
+                    "udp-log",
+                    dc_string_from_config,
+                    DEFAULT_CLIENT_UDP_LOG},
+            {(struct dc_setting *)settings->replay,
+                    dc_options_set_string,
+                    "replay",
+                    required_argument,
+                    'f',
+                    "REPLAY",
+                    dc_string_from_string,
+                    "replay",
+                    dc_string_from_config,
+                    DEFAULT_REPLAY},
+            {(struct dc_setting *)settings->speed,
+                    dc_options_set_string,
+                    "speed",
+                    required_argument,
+                    'x',
+                    "SPEED",
+                    dc_string_from_string,
+                    "speed",
+                    dc_string_from_config,
+                    DEFAULT_REPLAY_SPEED},
+            {(struct dc_setting *)settings->replayPort,
+                    dc_options_set_uint16,
+                    "replay-port",
+                    required_argument,
+                    'o',
+                    "REPLAY_PORT",
+                    dc_uint16_from_string,
+                    "replay-port",
+                    dc_uint16_from_config,
+                    &default_replayPort},
+            {(struct dc_setting *)settings->stats,
+                    dc_options_set_string,
+                    "stats",
+                    required_argument,
+                    'S',
+                    "STATS",
+                    dc_string_from_string,
+                    "stats",
+                    dc_string_from_config,
+                    DEFAULT_STATS},
     };
 
     settings->opts.opts_count = (sizeof(opts) / sizeof(struct options)) + 1;
@@ -189,10 +355,16 @@ static int run(const struct dc_posix_env *env, struct dc_error *err, struct dc_a
     static struct dc_fsm_transition transitions[] = {
             {DC_FSM_INIT,           SEND_TCP,              sendTCPInformation},
             {SEND_TCP,              CREATE_UDP_CONNECTION, createSocket},
+            {SEND_TCP,              STREAM_TO_SERVER,      streamToServer},
+            {SEND_TCP,              RECEIVE_FROM_SERVER,   receiveFromServer},
+            {SEND_TCP,              SHOW_STATS,            showStats},
             {SEND_TCP,              CLOSE,                 closeConnection},
             {CREATE_UDP_CONNECTION, SEND_TO_SERVER,        sendToServer},
             {CREATE_UDP_CONNECTION, CLOSE,                 closeConnection},
             {SEND_TO_SERVER,        CLOSE,                 closeConnection},
+            {STREAM_TO_SERVER,      CLOSE,                 closeConnection},
+            {RECEIVE_FROM_SERVER,   CLOSE,                 closeConnection},
+            {SHOW_STATS,            CLOSE,                 closeConnection},
             {CLOSE,                 DC_FSM_EXIT, NULL}
     };
 
@@ -208,13 +380,42 @@ static int run(const struct dc_posix_env *env, struct dc_error *err, struct dc_a
 
         client.server = dc_setting_string_get(env, app_settings->server);
         client.port = dc_setting_uint16_get(env, app_settings->port);
+        client.udpPort = dc_setting_uint16_get(env, app_settings->udpPort);
         client.start = dc_setting_string_get(env, app_settings->start);
         client.packets = dc_setting_uint16_get(env, app_settings->packets);
         client.packetSize = dc_setting_uint16_get(env, app_settings->packetSize);
         client.delay = dc_setting_uint16_get(env, app_settings->delay);
+        client.rate = (u_int32_t) strtoul(dc_setting_string_get(env, app_settings->rate), NULL, 10);
+        client.stream = dc_setting_bool_get(env, app_settings->stream);
+        client.duration = dc_setting_uint16_get(env, app_settings->duration);
+        client.streamBytes = strtoumax(dc_setting_string_get(env, app_settings->streamBytes), NULL, 10);
+        client.interval = dc_setting_uint16_get(env, app_settings->interval);
+        client.reverse = dc_setting_bool_get(env, app_settings->reverse);
+        client.tcpLog = dc_setting_string_get(env, app_settings->tcpLog);
+        client.udpLog = dc_setting_string_get(env, app_settings->udpLog);
+        client.replay = dc_setting_string_get(env, app_settings->replay);
+        client.speed = strtod(dc_setting_string_get(env, app_settings->speed), NULL);
+        client.replayPort = dc_setting_uint16_get(env, app_settings->replayPort);
+        client.stats = dc_setting_string_get(env, app_settings->stats);
+        client.tcpSocketFD = -1;
+        client.udpSocketFD = -1;
+        dc_memset(env, &client.trace, 0, sizeof(client.trace));
+
+        if (client.replay[0] != '\0' && (client.reverse || client.stream)) {
+            printf("Replay Sends UDP Packets -> Drop --reverse And --tcp-stream\n");
+            dc_fsm_info_destroy(env, &fsm_info);
+            return EXIT_FAILURE;
+        }
+
+        if (client.speed <= 0.0) {
+            printf("Unknown Speed -> Use A Factor Above 0 Such As 0.5 Or 2\n");
+            dc_fsm_info_destroy(env, &fsm_info);
+            return EXIT_FAILURE;
+        }
 
         ret_val = dc_fsm_run(env, err, fsm_info, &from_state, &to_state, &client, transitions);
         dc_fsm_info_destroy(env, &fsm_info);
+        freeReplayTrace(env, &client.trace);
     }
 
     return ret_val;
@@ -263,7 +464,55 @@ static int sendTCPInformation(const struct dc_posix_env *env, struct dc_error *e
     char buffer[MAXLINE] = {0};
 
     char tcpCommand[MAXLINE]= {0};
-    sprintf(tcpCommand, "Packets:%hu Size:%hu\n", client->packets, client->packetSize);
+    if (client->stats[0] != '\0') {
+        // "all" reads as client 0, the whole server.
+        sprintf(tcpCommand, STATS_COMMAND "%s\n", client->stats);
+    } else if (client->reverse) {
+        u_int16_t receivePort = bindReceiveSocket(env, err, client);
+
+        if (receivePort == 0) {
+            printf("UDP Socket Creation Failed -> Closing Client\n");
+            next_state = CLOSE;
+            return next_state;
+        }
+
+        sprintf(tcpCommand, "Reverse:%hu Packets:%hu Size:%hu Rate:%u\n", receivePort, client->packets,
+                client->packetSize, client->rate);
+    } else if (client->stream) {
+        sprintf(tcpCommand, STREAM_COMMAND "%hu Bytes:%" PRIu64 " Interval:%hu\n", client->duration,
+                client->streamBytes, client->interval);
+    } else {
+        // A replay declares the capture's packet count and mean size to the server.
+        if (client->replay[0] != '\0') {
+            if (loadReplayTrace(env, err, client->replay, client->replayPort, &client->trace) == -1) {
+                printf("Reading Capture Failed -> Closing Client\n");
+                next_state = CLOSE;
+                return next_state;
+            }
+
+            if (client->trace.count == 0) {
+                printf("No UDP Packets In Capture -> Closing Client\n");
+                next_state = CLOSE;
+                return next_state;
+            }
+
+            client->packets = (u_int16_t) client->trace.count;
+            client->packetSize = meanReplaySize(&client->trace);
+            printf("Capture: %zu UDP packets over %.3f sec, mean size %hu bytes\n", client->trace.count,
+                   (double) client->trace.offsets[client->trace.count - 1] / 1e9, client->packetSize);
+
+            if (client->trace.skipped > 0) {
+                printf("Replaying the first %d packets, %zu more were left out\n", REPLAY_MAX_PACKETS,
+                       client->trace.skipped);
+            }
+
+            if (client->trace.clamped > 0) {
+                printf("%zu packets resized to fit the client header or one datagram\n", client->trace.clamped);
+            }
+        }
+
+        sprintf(tcpCommand, "Packets:%hu Size:%hu\n", client->packets, client->packetSize);
+    }
 
     if(dc_strcmp(env, ipVersion, "IPv4") == 0) {
         family = PF_INET;
@@ -329,13 +578,25 @@ static int sendTCPInformation(const struct dc_posix_env *env, struct dc_error *e
 
     message_length = dc_strlen(env, tcpCommand);
     dc_write(env, err, client->tcpSocketFD, tcpCommand, message_length);
+
+    // The server answers a stats request with the series instead of a client id.
+    if (client->stats[0] != '\0') {
+        dc_freeaddrinfo(env, result);
+        next_state = SHOW_STATS;
+        return next_state;
+    }
+
     dc_read(env, err, client->tcpSocketFD, buffer, sizeof(buffer));
     dc_write(env, err, STDOUT_FILENO, "TCP Message Sent.\n", sizeof ("TCP Message Sent.\n"));
     client->clientID = dc_strdup(env, err, buffer);
 
     dc_freeaddrinfo(env, result);
 
-    next_state = CREATE_UDP_CONNECTION;
+    if (client->reverse) {
+        next_state = RECEIVE_FROM_SERVER;
+    } else {
+        next_state = client->stream ? STREAM_TO_SERVER : CREATE_UDP_CONNECTION;
+    }
     return next_state;
 }
 
@@ -354,7 +615,8 @@ static int createSocket(const struct dc_posix_env *env, struct dc_error *err, vo
     memset(&client->serverAddress, 0, sizeof(client->serverAddress));
 
     client->serverAddress.sin_family = AF_INET;
-    client->serverAddress.sin_port = htons(client->port);
+    // A separate UDP port lets the packets go through impairProxy while the TCP session goes to the server.
+    client->serverAddress.sin_port = htons(client->udpPort != 0 ? client->udpPort : client->port);
     client->serverAddress.sin_addr.s_addr = INADDR_ANY;
 
     next_state = SEND_TO_SERVER;
@@ -368,9 +630,12 @@ static int sendToServer(const struct dc_posix_env *env, struct dc_error *err, vo
 
     char *packet;
     u_int16_t packetID = 1;
-    char *packetBody;
+    size_t prefixLength;
+    size_t packetLength;
 
     struct timespec ts;
+    struct timespec deadline;
+    long interval;
 
     char *currentTime;
     currentTime = getCurrentTime(env, err);
@@ -382,27 +647,68 @@ static int sendToServer(const struct dc_posix_env *env, struct dc_error *err, vo
         dc_sleep(env, 30);
     }
 
-    packet = dc_calloc(env, err, client->packetSize, sizeof(char));
-    packetBody = dc_calloc(env, err, (client->packetSize - 12), sizeof(char));
+    if (client->replay[0] != '\0') {
+        struct replay_stats stats;
+
+        if (replayTrace(env, err, &client->trace, client->udpSocketFD, &client->serverAddress, client->clientID,
+                        client->speed, &stats) == -1) {
+            printf("UDP Send to Server Failed -> Closing Client\n");
+            next_state = CLOSE;
+            return next_state;
+        }
+
+        printf("Replayed %zu packets in %.3f sec at %.2fx: %.1f us late on average, %.1f us at most\n", stats.sent,
+               stats.seconds, client->speed, stats.meanLateness * 1e6, stats.maxLateness * 1e6);
+        next_state = CLOSE;
+        return next_state;
+    }
+
+    // Only the packet number changes between packets, so the id and the body are written once.
+    prefixLength = hotLength(client->clientID) + 1;
+    packetLength = client->packetSize + prefixLength + FORMAT_DECIMAL_LENGTH;
+    packet = dc_calloc(env, err, packetLength, sizeof(char));
 
-    for (size_t i = 0; i < client->packetSize - 12; i++) {
-        packetBody[i] = '*';
+    if (packet == NULL) {
+        printf("Packet Allocation Failed -> Closing Client\n");
+        next_state = CLOSE;
+        return next_state;
     }
 
+    hotCopy(packet, client->clientID, prefixLength - 1);
+    packet[prefixLength - 1] = ':';
+    packet[prefixLength + 6] = ':';
+    hotFill(packet + prefixLength + 7, '*', client->packetSize > 12 ? client->packetSize - 12u : 0);
+
+    // --rate paces against absolute deadlines so sleep overshoot does not accumulate.
+    interval = client->rate > 0 ? 1000000000L / (long) client->rate : 0;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
     for (int i = 0; i < client->packets; i++) {
-        sprintf(packet, "%s:%06hu:%s\n", client->clientID, packetID, packetBody);
-        dc_sendto(env, err, client->udpSocketFD, packet, client->packetSize, 0,
+        formatDecimal(packet + prefixLength, packetID, 6);
+        hotSendTo(err, client->udpSocketFD, packet, client->packetSize,
                   (const struct sockaddr *) &client->serverAddress, sizeof(client->serverAddress));
 
         if (dc_error_has_error(err)) {
             printf("UDP Send to Server Failed -> Closing Client\n");
+            dc_free(env, packet, packetLength);
             next_state = CLOSE;
             return next_state;
         }
 
-        dc_memset(env, packet, 0, sizeof(packet));
         packetID++;
 
+        if (client->rate > 0) {
+            deadline.tv_nsec += interval;
+
+            while (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_nsec -= 1000000000L;
+                deadline.tv_sec++;
+            }
+
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+            continue;
+        }
+
         if (client->delay >= 1000) {
             ts.tv_sec = client->delay / 1000;
             ts.tv_nsec = (client->delay % 1000) * 1000000;
@@ -413,10 +719,254 @@ static int sendToServer(const struct dc_posix_env *env, struct dc_error *err, vo
         nanosleep(&ts, &ts);
     }
 
+    dc_free(env, packet, packetLength);
     next_state = CLOSE;
     return next_state;
 }
 
+static int streamToServer(const struct dc_posix_env *env, struct dc_error *err, void *arg) {
+    struct client *client;
+    struct stream_report report;
+    client = (struct client *)arg;
+
+    report.label = client->clientID;
+    report.intervalMs = client->interval;
+    report.logFD = -1;
+
+    if (sendStream(env, err, client->tcpSocketFD, client->duration, client->streamBytes, &report) == -1) {
+        printf("TCP Stream to Server Failed -> Closing Client\n");
+    }
+
+    // The stream owns the whole connection, so close it without the terminated message.
+    shutdown(client->tcpSocketFD, SHUT_WR);
+    dc_close(env, err, client->tcpSocketFD);
+    client->tcpSocketFD = -1;
+
+    return CLOSE;
+}
+
+static int showStats(const struct dc_posix_env *env, struct dc_error *err, void *arg) {
+    struct client *client;
+    char buffer[MAXLINE];
+    ssize_t length;
+    client = (struct client *)arg;
+
+    // The server closes the connection after the last interval.
+    while ((length = read(client->tcpSocketFD, buffer, sizeof(buffer))) > 0) {
+        dc_write(env, err, STDOUT_FILENO, buffer, (size_t) length);
+    }
+
+    dc_close(env, err, client->tcpSocketFD);
+    client->tcpSocketFD = -1;
+
+    return CLOSE;
+}
+
+static u_int16_t bindReceiveSocket(const struct dc_posix_env *env, struct dc_error *err, struct client *client) {
+    struct sockaddr_in address;
+    socklen_t length = sizeof(address);
+    int bufferSize = RECEIVE_SOCKET_BUFFER;
+
+    client->udpSocketFD = dc_socket(env, err, AF_INET, SOCK_DGRAM, 0);
+
+    if (dc_error_has_error(err)) {
+        return 0;
+    }
+
+    setsockopt(client->udpSocketFD, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+
+    // --udp-port picks the local receive port in reverse mode, 0 lets the kernel choose one.
+    dc_memset(env, &address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(client->udpPort);
+    dc_bind(env, err, client->udpSocketFD, (struct sockaddr *) &address, sizeof(address));
+
+    if (dc_error_has_error(err) || getsockname(client->udpSocketFD, (struct sockaddr *) &address, &length) == -1) {
+        return 0;
+    }
+
+    return ntohs(address.sin_port);
+}
+
+static int receiveFromServer(const struct dc_posix_env *env, struct dc_error *err, void *arg) {
+    struct client *client;
+    client = (struct client *)arg;
+
+    struct mmsghdr messages[RECEIVE_BATCH];
+    struct iovec iovecs[RECEIVE_BATCH];
+    struct sockaddr_in senders[RECEIVE_BATCH];
+    struct pollfd fds[2];
+    struct sockaddr_in serverAddress;
+    socklen_t length = sizeof(serverAddress);
+    char serverIP[INET_ADDRSTRLEN] = {0};
+    char timeString[32] = {0};
+    size_t timeLength = 0;
+    char line[RECEIVE_LOG_LINE];
+    time_t cachedSecond = 0;
+    char *slots;
+    char *logBuffer;
+    u_int8_t seen[65536 / 8] = {0};
+    u_int32_t unique = 0;
+    u_int32_t duplicates = 0;
+    u_int32_t outOfOrder = 0;
+    u_int32_t highest = 0;
+    bool controlClosed = false;
+    struct timespec startTime;
+    struct timespec endTime;
+    struct timespec drainUntil = {0, 0};
+    int tcpLogFD;
+    int udpLogFD;
+    double elapsed;
+
+    // Only the "CCCC:PPPPPP:" header is logged, so each slot is small and the rest of a datagram is truncated.
+    slots = dc_malloc(env, err, RECEIVE_BATCH * RECEIVE_SLOT);
+    logBuffer = dc_malloc(env, err, RECEIVE_BATCH * RECEIVE_LOG_LINE);
+
+    if (slots == NULL || logBuffer == NULL) {
+        return CLOSE;
+    }
+
+    tcpLogFD = dc_open(env, err, client->tcpLog, O_WRONLY|O_CREAT|O_APPEND, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+    udpLogFD = dc_open(env, err, client->udpLog, O_WRONLY|O_CREAT|O_APPEND, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+
+    // The registration line mirrors the server's TCP log so logParser reads either side.
+    getpeername(client->tcpSocketFD, (struct sockaddr *) &serverAddress, &length);
+    inet_ntop(AF_INET, &serverAddress.sin_addr, serverIP, sizeof(serverIP));
+    snprintf(line, sizeof(line), "TCP Client %s:%s:%hu:Packets:%hu Size:%hu\n", client->clientID, serverIP,
+             ntohs(serverAddress.sin_port), client->packets, client->packetSize);
+    dc_write(env, err, tcpLogFD, line, dc_strlen(env, line));
+
+    for (size_t i = 0; i < RECEIVE_BATCH; i++) {
+        iovecs[i].iov_base = slots + i * RECEIVE_SLOT;
+        iovecs[i].iov_len = RECEIVE_SLOT;
+    }
+
+    fds[0].fd = client->udpSocketFD;
+    fds[0].events = POLLIN;
+    fds[1].fd = client->tcpSocketFD;
+    fds[1].events = POLLIN;
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    while (unique < client->packets) {
+        int timeout = -1;
+        int received;
+        size_t logLength = 0;
+
+        // Once the server closes the control connection, keep draining for a moment to catch late packets.
+        if (controlClosed) {
+            struct timespec now;
+
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            timeout = (int) ((drainUntil.tv_sec - now.tv_sec) * 1000 + (drainUntil.tv_nsec - now.tv_nsec) / 1000000);
+
+            if (timeout <= 0) {
+                break;
+            }
+        }
+
+        if (poll(fds, controlClosed ? 1 : 2, timeout) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            DC_ERROR_RAISE_ERRNO(err, errno);
+            break;
+        }
+
+        if (!controlClosed && (fds[1].revents & (POLLIN | POLLHUP | POLLERR))) {
+            char control[64];
+
+            if (read(client->tcpSocketFD, control, sizeof(control)) <= 0) {
+                controlClosed = true;
+                clock_gettime(CLOCK_MONOTONIC, &drainUntil);
+                drainUntil.tv_nsec += RECEIVE_DRAIN_MS * 1000000L;
+
+                while (drainUntil.tv_nsec >= 1000000000L) {
+                    drainUntil.tv_nsec -= 1000000000L;
+                    drainUntil.tv_sec++;
+                }
+            }
+        }
+
+        if (!(fds[0].revents & POLLIN)) {
+            continue;
+        }
+
+        for (size_t i = 0; i < RECEIVE_BATCH; i++) {
+            hotFill(&messages[i].msg_hdr, 0, sizeof(messages[i].msg_hdr));
+            messages[i].msg_hdr.msg_iov = &iovecs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_name = &senders[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(senders[i]);
+        }
+
+        received = recvmmsg(client->udpSocketFD, messages, RECEIVE_BATCH, MSG_DONTWAIT, NULL);
+
+        if (received <= 0) {
+            continue;
+        }
+
+        // ctime() only changes once a second, so format it once per second rather than per packet.
+        if (time(NULL) != cachedSecond) {
+            cachedSecond = time(NULL);
+            ctime_r(&cachedSecond, timeString);
+            timeLength = dc_strlen(env, timeString) - 1;
+            timeString[timeLength] = '\0';
+        }
+
+        for (int i = 0; i < received; i++) {
+            const char *packet = slots + (size_t) i * RECEIVE_SLOT;
+            u_int32_t packetID = 0;
+
+            if (messages[i].msg_len < RECEIVE_HEADER) {
+                continue;
+            }
+
+            for (size_t j = 5; j < 11; j++) {
+                packetID = packetID * 10 + (u_int32_t) (packet[j] - '0');
+            }
+
+            packetID &= 0xFFFF;
+
+            if (seen[packetID / 8] & (1U << (packetID % 8))) {
+                duplicates++;
+            } else {
+                seen[packetID / 8] |= (u_int8_t) (1U << (packetID % 8));
+                unique++;
+            }
+
+            if (packetID < highest) {
+                outOfOrder++;
+            } else {
+                highest = packetID;
+            }
+
+            logLength += formatLogLine(logBuffer + logLength, packet, messages[i].msg_len, timeString, timeLength,
+                                       &senders[i]);
+        }
+
+        // One write per batch instead of one per packet.
+        hotWrite(err, udpLogFD, logBuffer, logLength);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+    elapsed = (double) (endTime.tv_sec - startTime.tv_sec) + (double) (endTime.tv_nsec - startTime.tv_nsec) / 1000000000.0;
+    printf("Received %u of %hu packets: %u lost, %u duplicate, %u out of order in %.3f sec (%.0f packets/sec)\n",
+           unique, client->packets, client->packets - unique, duplicates, outOfOrder, elapsed,
+           elapsed > 0.0 ? (double) (unique + duplicates) / elapsed : 0.0);
+
+    // The server already closed the control connection, so skip the terminated message.
+    dc_close(env, err, client->tcpSocketFD);
+    client->tcpSocketFD = -1;
+    dc_close(env, err, tcpLogFD);
+    dc_close(env, err, udpLogFD);
+    dc_free(env, slots, RECEIVE_BATCH * RECEIVE_SLOT);
+    dc_free(env, logBuffer, RECEIVE_BATCH * RECEIVE_LOG_LINE);
+
+    return CLOSE;
+}
+
 static int closeConnection(const struct dc_posix_env *env, struct dc_error *err, void *arg) {
     int next_state;
     struct client *client;
@@ -0,0 +1,232 @@
+#include "clientTable.h"
+
+static size_t hashClient(u_int32_t clientID, size_t slotCount);
+static int growSlots(const struct dc_posix_env *env, struct dc_error *err, struct client_table *table);
+static int reservePackets(const struct dc_posix_env *env, struct dc_error *err, struct client_record *record,
+        size_t capacity);
+
+static size_t hashClient(u_int32_t clientID, size_t slotCount) {
+    // Client ids are sequential, so mix the bits before masking.
+    u_int32_t hash = clientID * 2654435761U;
+
+    return (size_t) (hash ^ (hash >> 16)) & (slotCount - 1);
+}
+
+int initClientTable(const struct dc_posix_env *env, struct dc_error *err, struct client_table *table) {
+    table->count = 0;
+    table->capacity = 0;
+    table->records = NULL;
+    table->slotCount = CLIENT_TABLE_INITIAL_SLOTS;
+    table->slots = dc_calloc(env, err, table->slotCount, sizeof(u_int32_t));
+
+    return table->slots == NULL ? -1 : 0;
+}
+
+void destroyClientTable(const struct dc_posix_env *env, struct client_table *table) {
+    for (size_t i = 0; i < table->count; i++) {
+        if (table->records[i].packetIDs != NULL) {
+            dc_free(env, table->records[i].packetIDs, table->records[i].packetCapacity * sizeof(u_int32_t));
+        }
+
+        if (table->records[i].arrivals != NULL) {
+            dc_free(env, table->records[i].arrivals, table->records[i].packetCapacity * sizeof(u_int32_t));
+        }
+    }
+
+    if (table->records != NULL) {
+        dc_free(env, table->records, table->capacity * sizeof(struct client_record));
+    }
+
+    dc_free(env, table->slots, table->slotCount * sizeof(u_int32_t));
+    table->records = NULL;
+    table->slots = NULL;
+    table->count = 0;
+}
+
+struct client_record *findClient(const struct client_table *table, u_int32_t clientID) {
+    size_t slot = hashClient(clientID, table->slotCount);
+
+    // Slots hold record index + 1 so that 0 marks an empty slot.
+    while (table->slots[slot] != 0) {
+        struct client_record *record = &table->records[table->slots[slot] - 1];
+
+        if (record->clientID == clientID) {
+            return record;
+        }
+
+        slot = (slot + 1) & (table->slotCount - 1);
+    }
+
+    return NULL;
+}
+
+static int growSlots(const struct dc_posix_env *env, struct dc_error *err, struct client_table *table) {
+    size_t slotCount = table->slotCount * 2;
+    u_int32_t *slots = dc_calloc(env, err, slotCount, sizeof(u_int32_t));
+
+    if (slots == NULL) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < table->count; i++) {
+        size_t slot = hashClient(table->records[i].clientID, slotCount);
+
+        while (slots[slot] != 0) {
+            slot = (slot + 1) & (slotCount - 1);
+        }
+
+        slots[slot] = (u_int32_t) (i + 1);
+    }
+
+    dc_free(env, table->slots, table->slotCount * sizeof(u_int32_t));
+    table->slots = slots;
+    table->slotCount = slotCount;
+
+    return 0;
+}
+
+struct client_record *addClient(const struct dc_posix_env *env, struct dc_error *err, struct client_table *table,
+        u_int32_t clientID) {
+    struct client_record *record = findClient(table, clientID);
+    size_t slot;
+
+    if (record != NULL) {
+        return record;
+    }
+
+    // Keep the load factor at or below one half.
+    if ((table->count + 1) * 2 > table->slotCount && growSlots(env, err, table) == -1) {
+        return NULL;
+    }
+
+    if (table->count == table->capacity) {
+        size_t capacity = table->capacity == 0 ? CLIENT_TABLE_INITIAL_SLOTS : table->capacity * 2;
+        struct client_record *records = dc_realloc(env, err, table->records, capacity * sizeof(struct client_record));
+
+        if (records == NULL) {
+            return NULL;
+        }
+
+        table->records = records;
+        table->capacity = capacity;
+    }
+
+    record = &table->records[table->count];
+    dc_memset(env, record, 0, sizeof(*record));
+    record->clientID = clientID;
+
+    slot = hashClient(clientID, table->slotCount);
+
+    while (table->slots[slot] != 0) {
+        slot = (slot + 1) & (table->slotCount - 1);
+    }
+
+    table->count++;
+    table->slots[slot] = (u_int32_t) table->count;
+
+    return record;
+}
+
+static int reservePackets(const struct dc_posix_env *env, struct dc_error *err, struct client_record *record,
+        size_t capacity) {
+    u_int32_t *packetIDs = dc_realloc(env, err, record->packetIDs, capacity * sizeof(u_int32_t));
+    u_int32_t *arrivals;
+
+    if (packetIDs == NULL) {
+        return -1;
+    }
+
+    record->packetIDs = packetIDs;
+    arrivals = dc_realloc(env, err, record->arrivals, capacity * sizeof(u_int32_t));
+
+    if (arrivals == NULL) {
+        return -1;
+    }
+
+    // Both arrays always share one capacity.
+    record->arrivals = arrivals;
+    record->packetCapacity = capacity;
+    return 0;
+}
+
+int appendPacket(const struct dc_posix_env *env, struct dc_error *err, struct client_record *record, u_int32_t packetID,
+        u_int32_t arrival) {
+    if (record->receivedNumberOfPackets == record->packetCapacity &&
+        reservePackets(env, err, record,
+                       record->packetCapacity == 0 ? CLIENT_PACKETS_INITIAL : record->packetCapacity * 2) == -1) {
+        return -1;
+    }
+
+    record->packetIDs[record->receivedNumberOfPackets] = packetID;
+    record->arrivals[record->receivedNumberOfPackets++] = arrival;
+    return 0;
+}
+
+int reserveClientPackets(const struct dc_posix_env *env, struct dc_error *err, struct client_record *record,
+        size_t count) {
+    size_t needed = record->receivedNumberOfPackets + count;
+
+    if (needed <= record->packetCapacity) {
+        return 0;
+    }
+
+    return reservePackets(env, err, record, needed);
+}
+
+int appendPackets(const struct dc_posix_env *env, struct dc_error *err, struct client_record *record,
+        const u_int32_t *packetIDs, const u_int32_t *arrivals, size_t count) {
+    size_t needed = record->receivedNumberOfPackets + count;
+
+    if (count == 0) {
+        return 0;
+    }
+
+    if (reserveClientPackets(env, err, record, count) == -1) {
+        return -1;
+    }
+
+    hotCopy(record->packetIDs + record->receivedNumberOfPackets, packetIDs, count * sizeof(u_int32_t));
+    hotCopy(record->arrivals + record->receivedNumberOfPackets, arrivals, count * sizeof(u_int32_t));
+    record->receivedNumberOfPackets = needed;
+    return 0;
+}
+
+int loadClientTable(const struct dc_posix_env *env, struct dc_error *err, const char *tcpLog,
+        struct client_table *table) {
+    struct log_map tcpLogMap;
+    struct log_cursor cursor;
+    struct log_span line;
+    int ret_val = 0;
+
+    if (mapLog(env, err, tcpLog, &tcpLogMap) == -1) {
+        return -1;
+    }
+
+    // Parsed in place without copying.
+    startCursor(&cursor, tcpLogMap.data, tcpLogMap.length);
+
+    while (nextLine(&cursor, &line)) {
+        struct client_record *record;
+        struct log_span clientName;
+        u_int32_t expectedPackets;
+        u_int16_t packetSize;
+
+        if (!parseTcpLine(line, &clientName, &expectedPackets, &packetSize)) {
+            continue;
+        }
+
+        record = addClient(env, err, table, spanToUnsigned(clientName));
+
+        if (record == NULL) {
+            ret_val = -1;
+            break;
+        }
+
+        snprintf(record->name, sizeof(record->name), "%.*s", (int) clientName.length, clientName.data);
+        record->expectedNumberOfPackets = expectedPackets;
+        record->packetSize = packetSize;
+    }
+
+    unmapLog(env, err, &tcpLogMap);
+    return ret_val;
+}
@@ -0,0 +1,107 @@
+#include "fastFormat.h"
+
+static size_t copyField(char *out, const char *text, size_t limit);
+
+static const char digitPairs[201] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+size_t formatDecimal(char *out, u_int64_t value, size_t width) {
+    size_t digits = 1;
+    size_t position;
+
+    for (u_int64_t rest = value; rest >= 10; rest /= 10) {
+        digits++;
+    }
+
+    digits = digits > width ? digits : width;
+    position = digits;
+
+    // Two digits per division, filled backwards; padding is whatever is left once value reaches 0.
+    while (value >= 100) {
+        const char *pair = &digitPairs[(value % 100) * 2];
+
+        value /= 100;
+        out[--position] = pair[1];
+        out[--position] = pair[0];
+    }
+
+    if (value >= 10) {
+        out[--position] = digitPairs[value * 2 + 1];
+        out[--position] = digitPairs[value * 2];
+    } else {
+        out[--position] = (char) ('0' + value);
+    }
+
+    while (position > 0) {
+        out[--position] = '0';
+    }
+
+    return digits;
+}
+
+size_t formatIPv4(char *out, in_addr_t address) {
+    const unsigned char *octets = (const unsigned char *) &address;
+    size_t length = 0;
+
+    for (size_t i = 0; i < 4; i++) {
+        if (i > 0) {
+            out[length++] = '.';
+        }
+
+        length += formatDecimal(out + length, octets[i], 0);
+    }
+
+    return length;
+}
+
+static size_t copyField(char *out, const char *text, size_t limit) {
+    size_t length = 0;
+
+    while (length < limit && text[length] != '\0') {
+        out[length] = text[length];
+        length++;
+    }
+
+    return length;
+}
+
+size_t formatPacketHeader(char *out, const char *clientID, u_int32_t packetID) {
+    size_t length = copyField(out, clientID, 4);
+
+    out[length++] = ':';
+    length += formatDecimal(out + length, packetID, 6);
+    out[length++] = ':';
+
+    return length;
+}
+
+size_t formatLogLine(char *out, const char *packet, size_t length, const char *timeString, size_t timeLength,
+        const struct sockaddr_in *sender) {
+    size_t used = copyField(out, packet, length < 4 ? length : 4);
+
+    out[used++] = ':';
+
+    if (length > 5) {
+        used += copyField(out + used, packet + 5, length - 5 < 6 ? length - 5 : 6);
+    }
+
+    out[used++] = ':';
+    memcpy(out + used, timeString, timeLength);
+    used += timeLength;
+    out[used++] = ':';
+    used += formatIPv4(out + used, sender->sin_addr.s_addr);
+    out[used++] = ':';
+    used += formatDecimal(out + used, ntohs(sender->sin_port), 0);
+    out[used++] = '\n';
+
+    return used;
+}
@@ -0,0 +1,734 @@
+#include "impairProxy.h"
+
+struct application_settings {
+    struct dc_opt_settings opts;
+    struct dc_setting_string *message;
+    struct dc_setting_uint16 *port;
+    struct dc_setting_string *server;
+    struct dc_setting_uint16 *serverPort;
+    struct dc_setting_string *seed;
+    struct dc_setting_string *drop;
+    struct dc_setting_string *goodToBad;
+    struct dc_setting_string *badToGood;
+    struct dc_setting_string *goodLoss;
+    struct dc_setting_string *badLoss;
+    struct dc_setting_string *reorder;
+    struct dc_setting_uint16 *reorderDepth;
+    struct dc_setting_string *duplicate;
+    struct dc_setting_string *corrupt;
+    struct dc_setting_uint16 *delay;
+};
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static struct dc_application_settings *create_settings(const struct dc_posix_env *env, struct dc_error *err);
+static int destroy_settings(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings **psettings);
+static int run(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings *settings);
+static void error_reporter(const struct dc_error *err);
+static void trace_reporter(const struct dc_posix_env *env, const char *file_name, const char *function_name, size_t line_number);
+static void handleStop(int signal);
+static int parseProbability(const char *name, const char *value, uint64_t *threshold);
+static int connectUpstream(const struct dc_posix_env *env, struct dc_error *err, struct proxy *proxy,
+        const char *server, u_int16_t serverPort);
+static uint64_t monotonicNanos(void);
+static void enqueuePacket(struct proxy *proxy, u_int32_t slot, uint64_t now);
+static void forwardPacket(struct proxy *proxy, u_int32_t slot, uint64_t now);
+static void flushHeld(struct proxy *proxy, uint64_t now);
+static void releaseDue(struct proxy *proxy, uint64_t now);
+static void receiveBatch(struct proxy *proxy);
+static void printProxyStats(const struct proxy *proxy);
+
+int main(int argc, char *argv[]) {
+    dc_posix_tracer tracer;
+    dc_error_reporter reporter;
+    struct dc_posix_env env;
+    struct dc_error err;
+    struct dc_application_info *info;
+    int ret_val;
+
+    reporter = error_reporter;
+//    tracer = trace_reporter;
+    tracer = NULL;
+    dc_error_init(&err, reporter);
+    dc_posix_env_init(&env, tracer);
+    info = dc_application_info_create(&env, &err, "Settings Application");
+    ret_val = dc_application_run(&env, &err, info, create_settings, destroy_settings,
+                                 run, dc_default_create_lifecycle, dc_default_destroy_lifecycle,
+                                 NULL, argc, argv);
+    dc_application_info_destroy(&env, &info);
+    dc_error_reset(&err);
+
+    return ret_val;
+}
+
+static struct dc_application_settings *create_settings(const struct dc_posix_env *env, struct dc_error *err) {
+    struct application_settings *settings;
+
+    static const uint16_t default_port = DEFAULT_PROXY_PORT;
+    static const uint16_t default_serverPort = DEFAULT_SERVER_PORT;
+    static const uint16_t default_reorderDepth = DEFAULT_REORDER_DEPTH;
+    static const uint16_t default_delay = 0;
+
+    DC_TRACE(env);
+    settings = dc_malloc(env, err, sizeof(struct application_settings));
+
+    if(settings == NULL) {
+        return NULL;
+    }
+
+    settings->opts.parent.config_path = dc_setting_path_create(env, err);
+    settings->message = dc_setting_string_create(env, err);
+    settings->port = dc_setting_uint16_create(env, err);
+    settings->server = dc_setting_string_create(env, err);
+    settings->serverPort = dc_setting_uint16_create(env, err);
+    settings->seed = dc_setting_string_create(env, err);
+    settings->drop = dc_setting_string_create(env, err);
+    settings->goodToBad = dc_setting_string_create(env, err);
+    settings->badToGood = dc_setting_string_create(env, err);
+    settings->goodLoss = dc_setting_string_create(env, err);
+    settings->badLoss = dc_setting_string_create(env, err);
+    settings->reorder = dc_setting_string_create(env, err);
+    settings->reorderDepth = dc_setting_uint16_create(env, err);
+    settings->duplicate = dc_setting_string_create(env, err);
+    settings->corrupt = dc_setting_string_create(env, err);
+    settings->delay = dc_setting_uint16_create(env, err);
+
+    struct options opts[] = {
+            {(struct dc_setting *)settings->opts.parent.config_path,
+                    dc_options_set_path,
+                    "config",
+                    required_argument,
+                    'c',
+                    "CONFIG",
+                    dc_string_from_string,
+                    NULL,
+                    dc_string_from_config,
+                    NULL},
+            {(struct dc_setting *)settings->message,
+                    dc_options_set_string,
+                    "message",
+                    required_argument,
+                    'm',
+                    "MESSAGE",
+                    dc_string_from_string,
+                    "message",
+                    dc_string_from_config,
+                    "Hello, Default World!"},
+            {(struct dc_setting *)settings->port,
+                    dc_options_set_uint16,
+                    "port",
+                    required_argument,
+                    'p',
+                    "PORT",
+                    dc_uint16_from_string,
+                    "port",
+                    dc_uint16_from_config,
+                    &default_port},
+            {(struct dc_setting *)settings->server,
+                    dc_options_set_string,
+                    "server",
+                    required_argument,
+                    's',
+                    "SERVER",
+                    dc_string_from_string,
+                    "server",
+                    dc_string_from_config,
+                    DEFAULT_SERVER_ADDRESS},
+            {(struct dc_setting *)settings->serverPort,
+                    dc_options_set_uint16,
+                    "server-port",
+                    required_argument,
+                    'P',
+                    "SERVER_PORT",
+                    dc_uint16_from_string,
+                    "server-port",
+                    dc_uint16_from_config,
+                    &default_serverPort},
+            {(struct dc_setting *)settings->seed,
+                    dc_options_set_string,
+                    "seed",
+                    required_argument,
+                    'S',
+                    "SEED",
+                    dc_string_from_string,
+                    "seed",
+                    dc_string_from_config,
+                    DEFAULT_SEED},
+            {(struct dc_setting *)settings->drop,
+                    dc_options_set_string,
+                    "drop",
+                    required_argument,
+                    'l',
+                    "DROP",
+                    dc_string_from_string,
+                    "drop",
+                    dc_string_from_config,
+                    "0"},
+            {(struct dc_setting *)settings->goodToBad,
+                    dc_options_set_string,
+                    "ge-p",
+                    required_argument,
+                    'g',
+                    "GE_P",
+                    dc_string_from_string,
+                    "ge-p",
+                    dc_string_from_config,
+                    "0"},
+            {(struct dc_setting *)settings->badToGood,
+                    dc_options_set_string,
+                    "ge-r",
+                    required_argument,
+                    'r',
+                    "GE_R",
+                    dc_string_from_string,
+                    "ge-r",
+                    dc_string_from_config,
+                    "1"},
+            {(struct dc_setting *)settings->goodLoss,
+                    dc_options_set_string,
+                    "ge-good-loss",
+                    required_argument,
+                    'k',
+                    "GE_GOOD_LOSS",
+                    dc_string_from_string,
+                    "ge-good-loss",
+                    dc_string_from_config,
+                    "0"},
+            {(struct dc_setting *)settings->badLoss,
+                    dc_options_set_string,
+                    "ge-bad-loss",
+                    required_argument,
+                    'h',
+                    "GE_BAD_LOSS",
+                    dc_string_from_string,
+                    "ge-bad-loss",
+                    dc_string_from_config,
+                    "1"},
+            {(struct dc_setting *)settings->reorder,
+                    dc_options_set_string,
+                    "reorder",
+                    required_argument,
+                    'o',
+                    "REORDER",
+                    dc_string_from_string,
+                    "reorder",
+                    dc_string_from_config,
+                    "0"},
+            {(struct dc_setting *)settings->reorderDepth,
+                    dc_options_set_uint16,
+                    "reorder-depth",
+                    required_argument,
+                    'e',
+                    "REORDER_DEPTH",
+                    dc_uint16_from_string,
+                    "reorder-depth",
+                    dc_uint16_from_config,
+                    &default_reorderDepth},
+            {(struct dc_setting *)settings->duplicate,
+                    dc_options_set_string,
+                    "duplicate",
+                    required_argument,
+                    'u',
+                    "DUPLICATE",
+                    dc_string_from_string,
+                    "duplicate",
+                    dc_string_from_config,
+                    "0"},
+            {(struct dc_setting *)settings->corrupt,
+                    dc_options_set_string,
+                    "corrupt",
+                    required_argument,
+                    'x',
+                    "CORRUPT",
+                    dc_string_from_string,
+                    "corrupt",
+                    dc_string_from_config,
+                    "0"},
+            {(struct dc_setting *)settings->delay,
+                    dc_options_set_uint16,
+                    "delay",
+                    required_argument,
+                    'd',
+                    "DELAY",
+                    dc_uint16_from_string,
+                    "delay",
+                    dc_uint16_from_config,
+                    &default_delay},
+    };
+
+    settings->opts.opts_count = (sizeof(opts) / sizeof(struct options)) + 1;
+    settings->opts.opts_size = sizeof(struct options);
+    settings->opts.opts = dc_calloc(env, err, settings->opts.opts_count, settings->opts.opts_size);
+    dc_memcpy(env, settings->opts.opts, opts, sizeof(opts));
+    settings->opts.flags = "m:";
+    settings->opts.env_prefix = "DC_EXAMPLE_";
+
+    return (struct dc_application_settings *)settings;
+}
+
+static int destroy_settings(const struct dc_posix_env *env, __attribute__((unused)) struct dc_error *err,
+                            struct dc_application_settings **psettings) {
+    struct application_settings *app_settings;
+
+    DC_TRACE(env);
+    app_settings = (struct application_settings *)*psettings;
+    dc_setting_string_destroy(env, &app_settings->message);
+    dc_free(env, app_settings->opts.opts, app_settings->opts.opts_count);
+    dc_free(env, *psettings, sizeof(struct application_settings));
+
+    if(env->null_free) {
+        *psettings = NULL;
+    }
+
+    return 0;
+}
+
+static void handleStop(__attribute__((unused)) int signal) {
+    stopRequested = 1;
+}
+
+static int parseProbability(const char *name, const char *value, uint64_t *threshold) {
+    char *endPointer;
+    double probability;
+
+    probability = strtod(value, &endPointer);
+
+    if (endPointer == value || *endPointer != '\0' || probability < 0.0 || probability > 1.0) {
+        printf("Invalid --%s value %s: expected a probability between 0 and 1\n", name, value);
+        return -1;
+    }
+
+    *threshold = prngThreshold(probability);
+    return 0;
+}
+
+static uint64_t monotonicNanos(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * UINT64_C(1000000000) + (uint64_t) ts.tv_nsec;
+}
+
+int createProxy(const struct dc_posix_env *env, struct dc_error *err, struct proxy *proxy) {
+    proxy->pool = dc_malloc(env, err, (size_t) PROXY_SLOTS * PROXY_SLOT_SIZE);
+    proxy->lengths = dc_calloc(env, err, PROXY_SLOTS, sizeof(u_int16_t));
+    proxy->freeSlots = dc_calloc(env, err, PROXY_SLOTS, sizeof(u_int32_t));
+    proxy->queue = dc_calloc(env, err, PROXY_SLOTS, sizeof(u_int32_t));
+    proxy->release = dc_calloc(env, err, PROXY_SLOTS, sizeof(uint64_t));
+
+    if (dc_error_has_error(err)) {
+        return -1;
+    }
+
+    // Hand out low slot numbers first so a lightly loaded proxy stays in cache.
+    for (u_int32_t i = 0; i < PROXY_SLOTS; i++) {
+        proxy->freeSlots[i] = PROXY_SLOTS - 1 - i;
+    }
+
+    proxy->freeCount = PROXY_SLOTS;
+    proxy->queueHead = 0;
+    proxy->queueCount = 0;
+    proxy->heldCount = 0;
+    proxy->badState = false;
+    dc_memset(env, &proxy->stats, 0, sizeof(proxy->stats));
+
+    return 0;
+}
+
+void destroyProxy(const struct dc_posix_env *env, struct dc_error *err, struct proxy *proxy) {
+    dc_free(env, proxy->pool, (size_t) PROXY_SLOTS * PROXY_SLOT_SIZE);
+    dc_free(env, proxy->lengths, PROXY_SLOTS * sizeof(u_int16_t));
+    dc_free(env, proxy->freeSlots, PROXY_SLOTS * sizeof(u_int32_t));
+    dc_free(env, proxy->queue, PROXY_SLOTS * sizeof(u_int32_t));
+    dc_free(env, proxy->release, PROXY_SLOTS * sizeof(uint64_t));
+
+    if (proxy->listenFD != -1) {
+        dc_close(env, err, proxy->listenFD);
+    }
+
+    if (proxy->upstreamFD != -1) {
+        dc_close(env, err, proxy->upstreamFD);
+    }
+}
+
+bool shouldDrop(struct proxy *proxy) {
+    struct impairment *impairment = &proxy->impairment;
+
+    // Loss is drawn in the current state, then the chain moves to its next state.
+    if (impairment->gilbertElliott) {
+        bool lost;
+
+        lost = prngChance(&proxy->prng, proxy->badState ? impairment->badLoss : impairment->goodLoss);
+
+        if (proxy->badState) {
+            proxy->badState = !prngChance(&proxy->prng, impairment->badToGood);
+        } else {
+            proxy->badState = prngChance(&proxy->prng, impairment->goodToBad);
+        }
+
+        if (lost) {
+            proxy->stats.burstDropped++;
+            return true;
+        }
+    }
+
+    if (prngChance(&proxy->prng, impairment->drop)) {
+        proxy->stats.dropped++;
+        return true;
+    }
+
+    return false;
+}
+
+static void enqueuePacket(struct proxy *proxy, u_int32_t slot, uint64_t now) {
+    size_t tail = (proxy->queueHead + proxy->queueCount) % PROXY_SLOTS;
+
+    proxy->queue[tail] = slot;
+    proxy->release[tail] = now + proxy->impairment.delayNs;
+    proxy->queueCount++;
+}
+
+static void forwardPacket(struct proxy *proxy, u_int32_t slot, uint64_t now) {
+    size_t kept = 0;
+
+    enqueuePacket(proxy, slot, now);
+
+    // Every packet that goes out moves the held packets one step closer to release.
+    for (size_t i = 0; i < proxy->heldCount; i++) {
+        struct held_packet held = proxy->held[i];
+
+        held.remaining--;
+
+        if (held.remaining == 0) {
+            enqueuePacket(proxy, held.slot, now);
+        } else {
+            proxy->held[kept++] = held;
+        }
+    }
+
+    proxy->heldCount = kept;
+}
+
+static void flushHeld(struct proxy *proxy, uint64_t now) {
+    for (size_t i = 0; i < proxy->heldCount; i++) {
+        enqueuePacket(proxy, proxy->held[i].slot, now);
+    }
+
+    proxy->heldCount = 0;
+}
+
+void impairPacket(struct proxy *proxy, u_int32_t slot, uint64_t now) {
+    struct impairment *impairment = &proxy->impairment;
+    char *data = proxy->pool + (size_t) slot * PROXY_SLOT_SIZE;
+    u_int16_t length = proxy->lengths[slot];
+
+    proxy->stats.received++;
+
+    if (shouldDrop(proxy)) {
+        proxy->freeSlots[proxy->freeCount++] = slot;
+        return;
+    }
+
+    if (length > 0 && prngChance(&proxy->prng, impairment->corrupt)) {
+        size_t offset = (size_t) prngBelow(&proxy->prng, length);
+
+        data[offset] = (char) (data[offset] ^ (char) (1U << prngBelow(&proxy->prng, 8)));
+        proxy->stats.corrupted++;
+    }
+
+    if (impairment->reorderDepth > 0 && proxy->heldCount < PROXY_MAX_HELD
+        && prngChance(&proxy->prng, impairment->reorder)) {
+        proxy->held[proxy->heldCount].slot = slot;
+        proxy->held[proxy->heldCount].remaining = impairment->reorderDepth;
+        proxy->heldCount++;
+        proxy->stats.reordered++;
+    } else {
+        forwardPacket(proxy, slot, now);
+    }
+
+    if (proxy->freeCount > 0 && prngChance(&proxy->prng, impairment->duplicate)) {
+        u_int32_t copy = proxy->freeSlots[--proxy->freeCount];
+
+        memcpy(proxy->pool + (size_t) copy * PROXY_SLOT_SIZE, data, length);
+        proxy->lengths[copy] = length;
+        forwardPacket(proxy, copy, now);
+        proxy->stats.duplicated++;
+    }
+}
+
+static void releaseDue(struct proxy *proxy, uint64_t now) {
+    struct mmsghdr messages[PROXY_BATCH];
+    struct iovec iovecs[PROXY_BATCH];
+
+    while (proxy->queueCount > 0 && proxy->release[proxy->queueHead] <= now) {
+        unsigned int batch = 0;
+        int sent;
+
+        while (batch < PROXY_BATCH && batch < proxy->queueCount) {
+            size_t index = (proxy->queueHead + batch) % PROXY_SLOTS;
+            u_int32_t slot = proxy->queue[index];
+
+            if (proxy->release[index] > now) {
+                break;
+            }
+
+            iovecs[batch].iov_base = proxy->pool + (size_t) slot * PROXY_SLOT_SIZE;
+            iovecs[batch].iov_len = proxy->lengths[slot];
+            memset(&messages[batch], 0, sizeof(messages[batch]));
+            messages[batch].msg_hdr.msg_iov = &iovecs[batch];
+            messages[batch].msg_hdr.msg_iovlen = 1;
+            batch++;
+        }
+
+        sent = sendmmsg(proxy->upstreamFD, messages, batch, 0);
+
+        // A refused or failed send still consumes the packets so the queue cannot wedge.
+        if (sent <= 0) {
+            sent = (int) batch;
+        } else {
+            proxy->stats.forwarded += (uint64_t) sent;
+        }
+
+        for (int i = 0; i < sent; i++) {
+            proxy->freeSlots[proxy->freeCount++] = proxy->queue[proxy->queueHead];
+            proxy->queueHead = (proxy->queueHead + 1) % PROXY_SLOTS;
+            proxy->queueCount--;
+        }
+    }
+}
+
+static void receiveBatch(struct proxy *proxy) {
+    struct mmsghdr messages[PROXY_BATCH];
+    struct iovec iovecs[PROXY_BATCH];
+    u_int32_t slots[PROXY_BATCH];
+    char scratch[PROXY_SLOT_SIZE];
+    unsigned int batch;
+    int received = 0;
+    uint64_t now;
+
+    do {
+        batch = 0;
+
+        while (batch < PROXY_BATCH && proxy->freeCount > 0) {
+            slots[batch] = proxy->freeSlots[--proxy->freeCount];
+            iovecs[batch].iov_base = proxy->pool + (size_t) slots[batch] * PROXY_SLOT_SIZE;
+            iovecs[batch].iov_len = PROXY_SLOT_SIZE;
+            batch++;
+        }
+
+        // The pool is exhausted: keep draining the socket so the kernel queue does not hide the overflow.
+        if (batch == 0) {
+            while (!stopRequested && recv(proxy->listenFD, scratch, sizeof(scratch), MSG_DONTWAIT) >= 0) {
+                proxy->stats.received++;
+                proxy->stats.overflow++;
+            }
+
+            break;
+        }
+
+        for (unsigned int i = 0; i < batch; i++) {
+            memset(&messages[i], 0, sizeof(messages[i]));
+            messages[i].msg_hdr.msg_iov = &iovecs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        received = recvmmsg(proxy->listenFD, messages, batch, MSG_DONTWAIT, NULL);
+        now = monotonicNanos();
+
+        for (int i = 0; i < received; i++) {
+            proxy->lengths[slots[i]] = (u_int16_t) messages[i].msg_len;
+            impairPacket(proxy, slots[i], now);
+        }
+
+        if (received < 0) {
+            received = 0;
+        }
+
+        // Return the slots that recvmmsg did not fill.
+        for (unsigned int i = batch; i > (unsigned int) received; i--) {
+            proxy->freeSlots[proxy->freeCount++] = slots[i - 1];
+        }
+    } while (received == (int) batch && !stopRequested);
+}
+
+static int connectUpstream(const struct dc_posix_env *env, struct dc_error *err, struct proxy *proxy,
+        const char *server, u_int16_t serverPort) {
+    struct addrinfo hints;
+    struct addrinfo *result;
+    int bufferSize = PROXY_SOCKET_BUFFER;
+
+    dc_memset(env, &hints, 0, sizeof(hints));
+    hints.ai_family = PF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    dc_getaddrinfo(env, err, server, NULL, &hints, &result);
+
+    if (dc_error_has_error(err)) {
+        return -1;
+    }
+
+    ((struct sockaddr_in *) result->ai_addr)->sin_port = htons(serverPort);
+    proxy->upstreamFD = dc_socket(env, err, AF_INET, SOCK_DGRAM, 0);
+
+    if (dc_error_has_no_error(err)) {
+        dc_connect(env, err, proxy->upstreamFD, result->ai_addr, result->ai_addrlen);
+    }
+
+    dc_freeaddrinfo(env, result);
+
+    if (dc_error_has_error(err)) {
+        return -1;
+    }
+
+    setsockopt(proxy->upstreamFD, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+    return 0;
+}
+
+static void printProxyStats(const struct proxy *proxy) {
+    printf("Proxy Statistics:\n");
+    printf("Packets Received = %" PRIu64 "\n", proxy->stats.received);
+    printf("Packets Forwarded = %" PRIu64 "\n", proxy->stats.forwarded);
+    printf("Packets Dropped = %" PRIu64 "\n", proxy->stats.dropped);
+    printf("Packets Dropped In Bursts = %" PRIu64 "\n", proxy->stats.burstDropped);
+    printf("Packets Duplicated = %" PRIu64 "\n", proxy->stats.duplicated);
+    printf("Packets Reordered = %" PRIu64 "\n", proxy->stats.reordered);
+    printf("Packets Corrupted = %" PRIu64 "\n", proxy->stats.corrupted);
+    printf("Packets Lost To Pool Overflow = %" PRIu64 "\n", proxy->stats.overflow);
+}
+
+void runProxy(const struct dc_posix_env *env, struct dc_error *err, struct proxy *proxy) {
+    struct pollfd pollFD;
+    int timeout;
+    int ready;
+    uint64_t now;
+
+    dc_write(env, err, STDOUT_FILENO, "Proxy Forwarding Packets...\n", sizeof ("Proxy Forwarding Packets...\n") - 1);
+
+    pollFD.fd = proxy->listenFD;
+    pollFD.events = POLLIN;
+
+    while (!stopRequested) {
+        now = monotonicNanos();
+
+        if (proxy->queueCount > 0) {
+            uint64_t due = proxy->release[proxy->queueHead];
+
+            timeout = due > now ? (int) ((due - now + 999999) / 1000000) : 0;
+        } else if (proxy->heldCount > 0) {
+            timeout = PROXY_IDLE_FLUSH_MS;
+        } else {
+            timeout = -1;
+        }
+
+        ready = poll(&pollFD, 1, timeout);
+        now = monotonicNanos();
+
+        // Held packets would never be released once traffic stops, so let them go when idle.
+        if (ready == 0 && proxy->queueCount == 0) {
+            flushHeld(proxy, now);
+        }
+
+        if (ready > 0 && (pollFD.revents & POLLIN)) {
+            receiveBatch(proxy);
+        }
+
+        releaseDue(proxy, monotonicNanos());
+    }
+
+    printProxyStats(proxy);
+}
+
+static int run(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings *settings) {
+    struct application_settings *app_settings;
+    struct impairment *impairment;
+    struct proxy proxy;
+    struct sockaddr_in listenAddress;
+    struct sigaction action;
+    const char *server;
+    u_int16_t port;
+    u_int16_t serverPort;
+    const char *seedText;
+    char *endPointer;
+    uint64_t seed;
+    int bufferSize = PROXY_SOCKET_BUFFER;
+    int ret_val = EXIT_SUCCESS;
+
+    DC_TRACE(env);
+
+    app_settings = (struct application_settings *)settings;
+    port = dc_setting_uint16_get(env, app_settings->port);
+    server = dc_setting_string_get(env, app_settings->server);
+    serverPort = dc_setting_uint16_get(env, app_settings->serverPort);
+    seedText = dc_setting_string_get(env, app_settings->seed);
+    errno = 0;
+    seed = strtoumax(seedText, &endPointer, 10);
+
+    // strtoumax() would take a sign, and stop quietly at the first character that is not a digit.
+    if (seedText[0] < '0' || seedText[0] > '9' || *endPointer != '\0' || errno == ERANGE) {
+        printf("Invalid --seed value %s: expected a whole number\n", seedText);
+        return EXIT_FAILURE;
+    }
+
+    impairment = &proxy.impairment;
+    impairment->reorderDepth = dc_setting_uint16_get(env, app_settings->reorderDepth);
+    impairment->delayNs = (uint64_t) dc_setting_uint16_get(env, app_settings->delay) * UINT64_C(1000000);
+
+    if (parseProbability("drop", dc_setting_string_get(env, app_settings->drop), &impairment->drop) != 0
+        || parseProbability("ge-p", dc_setting_string_get(env, app_settings->goodToBad), &impairment->goodToBad) != 0
+        || parseProbability("ge-r", dc_setting_string_get(env, app_settings->badToGood), &impairment->badToGood) != 0
+        || parseProbability("ge-good-loss", dc_setting_string_get(env, app_settings->goodLoss),
+                            &impairment->goodLoss) != 0
+        || parseProbability("ge-bad-loss", dc_setting_string_get(env, app_settings->badLoss),
+                            &impairment->badLoss) != 0
+        || parseProbability("reorder", dc_setting_string_get(env, app_settings->reorder), &impairment->reorder) != 0
+        || parseProbability("duplicate", dc_setting_string_get(env, app_settings->duplicate),
+                            &impairment->duplicate) != 0
+        || parseProbability("corrupt", dc_setting_string_get(env, app_settings->corrupt), &impairment->corrupt) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    // The burst model only runs when the chain can actually leave the good state.
+    impairment->gilbertElliott = impairment->goodToBad != 0;
+    prngSeed(&proxy.prng, seed);
+    proxy.listenFD = -1;
+    proxy.upstreamFD = -1;
+
+    if (createProxy(env, err, &proxy) != 0) {
+        printf("Proxy Allocation Failed -> Closing Proxy\n");
+        return EXIT_FAILURE;
+    }
+
+    proxy.listenFD = dc_socket(env, err, AF_INET, SOCK_DGRAM, 0);
+    dc_memset(env, &listenAddress, 0, sizeof(listenAddress));
+    listenAddress.sin_family = AF_INET;
+    listenAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+    listenAddress.sin_port = htons(port);
+    dc_bind(env, err, proxy.listenFD, (struct sockaddr *) &listenAddress, sizeof(listenAddress));
+    setsockopt(proxy.listenFD, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+
+    if (dc_error_has_error(err) || connectUpstream(env, err, &proxy, server, serverPort) != 0) {
+        printf("Proxy Socket Setup Failed -> Closing Proxy\n");
+        ret_val = EXIT_FAILURE;
+    } else {
+        dc_memset(env, &action, 0, sizeof(action));
+        action.sa_handler = handleStop;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, NULL);
+        sigaction(SIGTERM, &action, NULL);
+
+        runProxy(env, err, &proxy);
+    }
+
+    destroyProxy(env, err, &proxy);
+
+    return ret_val;
+}
+
+static void error_reporter(const struct dc_error *err) {
+    fprintf(stderr, "ERROR: %s : %s : @ %zu : %d\n", err->file_name, err->function_name, err->line_number, 0);
+    fprintf(stderr, "ERROR: %s\n", err->message);
+}
+
+static void trace_reporter(__attribute__((unused)) const struct dc_posix_env *env, const char *file_name,
+                           const char *function_name, size_t line_number) {
+    fprintf(stdout, "TRACE: %s : %s : @ %zu\n", file_name, function_name, line_number);
+}
@@ -0,0 +1,447 @@
+#include "logFollower.h"
+
+static volatile sig_atomic_t following = 1;
+
+static void stopFollowing(int signalNumber);
+static struct follow_stats *statsFor(const struct dc_posix_env *env, struct dc_error *err,
+        struct log_follower *follower, const struct client_record *record);
+static void freeFollowStats(const struct dc_posix_env *env, struct log_follower *follower);
+static void resetFollower(const struct dc_posix_env *env, struct dc_error *err, struct log_follower *follower);
+static void followTcpLine(const struct dc_posix_env *env, struct dc_error *err, struct log_follower *follower,
+        struct log_span line);
+static void followUdpLine(const struct dc_posix_env *env, struct dc_error *err, struct log_follower *follower,
+        struct log_span line);
+static int readAppended(const struct dc_posix_env *env, struct dc_error *err, struct log_follower *follower,
+        struct followed_log *log, bool udp);
+static void printFollowSummary(struct log_follower *follower);
+static void saveCheckpoint(const struct dc_posix_env *env, struct dc_error *err, const struct log_follower *follower);
+static void loadCheckpoint(const struct dc_posix_env *env, struct dc_error *err, struct log_follower *follower);
+static void watchLogs(const struct dc_posix_env *env, struct dc_error *err, struct log_follower *follower, int inotifyFD,
+        u_int16_t refreshMs);
+
+static void stopFollowing(__attribute__((unused)) int signalNumber) {
+    following = 0;
+}
+
+static struct follow_stats *statsFor(const struct dc_posix_env *env, struct dc_error *err,
+        struct log_follower *follower, const struct client_record *record) {
+    size_t index = (size_t) (record - follower->table.records);
+
+    // The stats array grows alongside the table, one entry per client.
+    if (index >= follower->statsCapacity) {
+        size_t capacity = follower->table.capacity;
+        struct follow_stats *stats = dc_realloc(env, err, follower->stats, capacity * sizeof(struct follow_stats));
+
+        if (stats == NULL) {
+            return NULL;
+        }
+
+        dc_memset(env, stats + follower->statsCapacity, 0,
+                  (capacity - follower->statsCapacity) * sizeof(struct follow_stats));
+        follower->stats = stats;
+        follower->statsCapacity = capacity;
+    }
+
+    if (follower->stats[index].seen.words == NULL &&
+        createPacketBitset(env, err, &follower->stats[index].seen, record->expectedNumberOfPackets + 1) == -1) {
+        return NULL;
+    }
+
+    return &follower->stats[index];
+}
+
+static void freeFollowStats(const struct dc_posix_env *env, struct log_follower *follower) {
+    for (size_t i = 0; i < follower->statsCapacity; i++) {
+        destroyPacketBitset(env, &follower->stats[i].seen);
+    }
+
+    if (follower->stats != NULL) {
+        dc_free(env, follower->stats, follower->statsCapacity * sizeof(struct follow_stats));
+    }
+
+    follower->stats = NULL;
+    follower->statsCapacity = 0;
+}
+
+static void resetFollower(const struct dc_posix_env *env, struct dc_error *err, struct log_follower *follower) {
+    freeFollowStats(env, follower);
+    destroyClientTable(env, &follower->table);
+    initClientTable(env, err, &follower->table);
+    follower->tcp.offset = 0;
+    follower->udp.offset = 0;
+    follower->tcp.skipping = false;
+    follower->udp.skipping = false;
+}
+
+static void followTcpLine(const struct dc_posix_env *env, struct dc_error *err, struct log_follower *follower,
+        struct log_span line) {
+    struct client_record *record;
+    struct log_span clientName;
+    u_int32_t expectedPackets;
+    u_int16_t packetSize;
+
+    if (!parseTcpLine(line, &clientName, &expectedPackets, &packetSize)) {
+        return;
+    }
+
+    record = addClient(env, err, &follower->table, spanToUnsigned(clientName));
+
+    if (record == NULL) {
+        return;
+    }
+
+    snprintf(record->name, sizeof(record->name), "%.*s", (int) clientName.length, clientName.data);
+    record->expectedNumberOfPackets = expectedPackets;
+    record->packetSize = packetSize;
+    statsFor(env, err, follower, record);
+}
+
+static void followUdpLine(const struct dc_posix_env *env, struct dc_error *err, struct log_follower *follower,
+        struct log_span line) {
+    struct client_record *record;
+    struct follow_stats *stats;
+    u_int32_t clientID;
+    u_int32_t packetID;
+    u_int32_t arrival;
+
+    if (!parseUdpLine(line, &clientID, &packetID, &follower->times, &arrival)) {
+        return;
+    }
+
+    // Packets can reach the UDP log before the registration reaches the TCP log.
+    record = findClient(&follower->table, clientID);
+
+    if (record == NULL) {
+        record = addClient(env, err, &follower->table, clientID);
+
+        if (record == NULL) {
+            return;
+        }
+
+        snprintf(record->name, sizeof(record->name), "%04u", clientID);
+    }
+
+    stats = statsFor(env, err, follower, record);
+
+    if (stats == NULL || !acceptPacketID(&stats->metrics, record->expectedNumberOfPackets, packetID) ||
+        growPacketBitset(env, err, &stats->seen, (size_t) packetID + 1) == -1) {
+        return;
+    }
+
+    addPacketMetric(&stats->metrics, &stats->seen, packetID, arrival);
+
+    if (packetID > stats->highest) {
+        stats->highest = packetID;
+    }
+}
+
+static int readAppended(const struct dc_posix_env *env, struct dc_error *err, struct log_follower *follower,
+        struct followed_log *log, bool udp) {
+    struct stat status;
+
+    if (fstat(log->fd, &status) == -1) {
+        DC_ERROR_RAISE_ERRNO(err, errno);
+        return -1;
+    }
+
+    // A shorter file means the log was truncated for a new test; start over.
+    if (status.st_size < log->offset) {
+        printf("%s Truncated -> Restarting Statistics\n", log->path);
+        resetFollower(env, err, follower);
+    }
+
+    while (log->offset < status.st_size) {
+        struct log_cursor cursor;
+        struct log_span line;
+        ssize_t length = pread(log->fd, follower->buffer, FOLLOW_READ_SIZE, log->offset);
+        const char *lastNewline;
+        const char *first = follower->buffer;
+
+        if (length <= 0) {
+            break;
+        }
+
+        // Only whole lines are consumed; a line still being written is picked up next time.
+        lastNewline = follower->buffer + length;
+
+        while (lastNewline > follower->buffer && lastNewline[-1] != '\n') {
+            lastNewline--;
+        }
+
+        if (lastNewline == follower->buffer) {
+            // A full buffer without a newline can never be parsed whole, so the line is passed over as malformed.
+            if (length == FOLLOW_READ_SIZE) {
+                log->offset += length;
+                log->skipping = true;
+                continue;
+            }
+
+            break;
+        }
+
+        if (log->skipping) {
+            first = findByte(follower->buffer, lastNewline, '\n') + 1;
+            log->skipping = false;
+            log->longLines++;
+        }
+
+        startCursor(&cursor, first, (size_t) (lastNewline - first));
+
+        while (nextLine(&cursor, &line)) {
+            if (udp) {
+                followUdpLine(env, err, follower, line);
+            } else {
+                followTcpLine(env, err, follower, line);
+            }
+        }
+
+        log->offset += lastNewline - follower->buffer;
+    }
+
+    return 0;
+}
+
+static void printFollowSummary(struct log_follower *follower) {
+    time_t now = time(NULL);
+    char timeString[32];
+
+    ctime_r(&now, timeString);
+    printf("----------------------------------------\n");
+    printf("Following %zu Clients at %s", follower->table.count, timeString);
+
+    if (follower->tcp.longLines + follower->udp.longLines > 0) {
+        printf("Skipped %" PRIu64 " Lines Longer Than %d Bytes\n", follower->tcp.longLines + follower->udp.longLines,
+               FOLLOW_READ_SIZE);
+    }
+
+    for (size_t i = 0; i < follower->table.count && i < follower->statsCapacity; i++) {
+        const struct client_record *record = &follower->table.records[i];
+        struct follow_stats *stats = &follower->stats[i];
+
+        // While the test runs only gaps below the highest packet seen count as lost.
+        finishPacketMetrics(&stats->metrics, &stats->seen, 1, stats->highest);
+        printf("Client %s: Expected %u Received %" PRIu64 " Lost %" PRIu64 " Duplicates %" PRIu64
+               " Out Of Order %" PRIu64 " Reordered %" PRIu64 " Loss Bursts %" PRIu64 " Jitter %f s Malformed %"
+               PRIu64 "\n", record->name, record->expectedNumberOfPackets, stats->metrics.received,
+               stats->metrics.lost, stats->metrics.duplicates, stats->metrics.outOfOrder, stats->metrics.reordered,
+               stats->metrics.lossRuns, stats->metrics.jitter, stats->metrics.malformed);
+    }
+
+    fflush(stdout);
+}
+
+static void saveCheckpoint(const struct dc_posix_env *env, struct dc_error *err, const struct log_follower *follower) {
+    char temporary[FOLLOW_PATH_LENGTH];
+    u_int32_t header[2] = {FOLLOW_CHECKPOINT_MAGIC, FOLLOW_CHECKPOINT_VERSION};
+    u_int64_t count = follower->table.count < follower->statsCapacity ? follower->table.count : follower->statsCapacity;
+    bool written;
+    FILE *file;
+
+    // Written to a temporary file and renamed so a crash never leaves half a checkpoint.
+    snprintf(temporary, sizeof(temporary), "%s.tmp", follower->checkpoint);
+    file = fopen(temporary, "wb");
+
+    if (file == NULL) {
+        return;
+    }
+
+    written = fwrite(header, sizeof(header), 1, file) == 1 &&
+              fwrite(&follower->tcp.inode, sizeof(ino_t), 1, file) == 1 &&
+              fwrite(&follower->tcp.offset, sizeof(off_t), 1, file) == 1 &&
+              fwrite(&follower->udp.inode, sizeof(ino_t), 1, file) == 1 &&
+              fwrite(&follower->udp.offset, sizeof(off_t), 1, file) == 1 && fwrite(&count, sizeof(count), 1, file) == 1;
+
+    for (size_t i = 0; written && i < count; i++) {
+        const struct follow_stats *stats = &follower->stats[i];
+        u_int64_t wordCount = (u_int64_t) stats->highest / 64 + 1;
+
+        // Nothing above the highest packet is marked, so the words past it are left out.
+        if (wordCount > stats->seen.wordCount) {
+            wordCount = stats->seen.wordCount;
+        }
+
+        written = fwrite(&follower->table.records[i], sizeof(struct client_record), 1, file) == 1 &&
+                  fwrite(stats, sizeof(struct follow_stats), 1, file) == 1 &&
+                  fwrite(&wordCount, sizeof(wordCount), 1, file) == 1 &&
+                  fwrite(stats->seen.words, sizeof(uint64_t), wordCount, file) == wordCount;
+    }
+
+    // A short write or a failed close, such as on a full disk, keeps the previous checkpoint.
+    if (dc_fclose(env, err, file) != 0 || !written || rename(temporary, follower->checkpoint) == -1) {
+        unlink(temporary);
+    }
+}
+
+static void loadCheckpoint(const struct dc_posix_env *env, struct dc_error *err, struct log_follower *follower) {
+    u_int32_t header[2];
+    ino_t tcpInode;
+    ino_t udpInode;
+    off_t tcpOffset;
+    off_t udpOffset;
+    u_int64_t count = 0;
+    bool valid;
+    FILE *file = fopen(follower->checkpoint, "rb");
+
+    if (file == NULL) {
+        return;
+    }
+
+    valid = fread(header, sizeof(header), 1, file) == 1 && header[0] == FOLLOW_CHECKPOINT_MAGIC &&
+            header[1] == FOLLOW_CHECKPOINT_VERSION && fread(&tcpInode, sizeof(ino_t), 1, file) == 1 &&
+            fread(&tcpOffset, sizeof(off_t), 1, file) == 1 && fread(&udpInode, sizeof(ino_t), 1, file) == 1 &&
+            fread(&udpOffset, sizeof(off_t), 1, file) == 1 && fread(&count, sizeof(count), 1, file) == 1;
+
+    // A checkpoint for different log files is ignored.
+    valid = valid && tcpInode == follower->tcp.inode && udpInode == follower->udp.inode;
+
+    for (u_int64_t i = 0; valid && i < count; i++) {
+        struct client_record saved;
+        struct follow_stats savedStats;
+        struct client_record *record;
+        struct follow_stats *stats;
+        u_int64_t wordCount;
+
+        // A bitset longer than the highest packet needs can only come from a damaged file.
+        valid = fread(&saved, sizeof(saved), 1, file) == 1 && fread(&savedStats, sizeof(savedStats), 1, file) == 1 &&
+                fread(&wordCount, sizeof(wordCount), 1, file) == 1 && wordCount <= (u_int64_t) savedStats.highest / 64 + 1;
+
+        if (!valid || (record = addClient(env, err, &follower->table, saved.clientID)) == NULL) {
+            valid = false;
+            break;
+        }
+
+        dc_memcpy(env, record->name, saved.name, sizeof(record->name));
+        record->expectedNumberOfPackets = saved.expectedNumberOfPackets;
+        record->packetSize = saved.packetSize;
+        stats = statsFor(env, err, follower, record);
+        valid = stats != NULL && growPacketBitset(env, err, &stats->seen, wordCount * 64) == 0 &&
+                fread(stats->seen.words, sizeof(uint64_t), wordCount, file) == wordCount;
+
+        if (valid) {
+            struct packet_bitset seen = stats->seen;
+
+            *stats = savedStats;
+            stats->seen = seen;
+        }
+    }
+
+    dc_fclose(env, err, file);
+
+    if (valid) {
+        follower->tcp.offset = tcpOffset;
+        follower->udp.offset = udpOffset;
+        printf("Resuming From Checkpoint: %zu Clients\n", follower->table.count);
+    } else {
+        resetFollower(env, err, follower);
+    }
+}
+
+static void watchLogs(const struct dc_posix_env *env, struct dc_error *err, struct log_follower *follower, int inotifyFD,
+        u_int16_t refreshMs) {
+    struct pollfd events;
+    struct timespec nextRefresh;
+
+    events.fd = inotifyFD;
+    events.events = POLLIN;
+    clock_gettime(CLOCK_MONOTONIC, &nextRefresh);
+
+    while (following) {
+        struct timespec now;
+        char drain[4096];
+        long waitMs;
+
+        // Registrations first so the packets that follow find their client.
+        readAppended(env, err, follower, &follower->tcp, false);
+        readAppended(env, err, follower, &follower->udp, true);
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        waitMs = (nextRefresh.tv_sec - now.tv_sec) * 1000 + (nextRefresh.tv_nsec - now.tv_nsec) / 1000000;
+
+        if (waitMs <= 0) {
+            printFollowSummary(follower);
+            saveCheckpoint(env, err, follower);
+            nextRefresh = now;
+            nextRefresh.tv_sec += refreshMs / 1000;
+            nextRefresh.tv_nsec += (long) (refreshMs % 1000) * 1000000L;
+
+            if (nextRefresh.tv_nsec >= 1000000000L) {
+                nextRefresh.tv_nsec -= 1000000000L;
+                nextRefresh.tv_sec++;
+            }
+
+            waitMs = refreshMs;
+        }
+
+        if (poll(&events, 1, (int) waitMs) > 0) {
+            while (read(inotifyFD, drain, sizeof(drain)) > 0) {
+            }
+        }
+    }
+
+    readAppended(env, err, follower, &follower->tcp, false);
+    readAppended(env, err, follower, &follower->udp, true);
+    printFollowSummary(follower);
+    saveCheckpoint(env, err, follower);
+}
+
+int followLogs(const struct dc_posix_env *env, struct dc_error *err, const char *tcpLog, const char *udpLog,
+        const char *checkpoint, u_int16_t refreshMs) {
+    struct log_follower follower;
+    struct sigaction stop;
+    struct stat tcpStatus;
+    struct stat udpStatus;
+    int inotifyFD;
+    int ret_val = 0;
+
+    dc_memset(env, &stop, 0, sizeof(stop));
+    stop.sa_handler = stopFollowing;
+    sigemptyset(&stop.sa_mask);
+    sigaction(SIGINT, &stop, NULL);
+    sigaction(SIGTERM, &stop, NULL);
+
+    dc_memset(env, &follower, 0, sizeof(follower));
+    follower.tcp.path = tcpLog;
+    follower.udp.path = udpLog;
+    follower.checkpoint = checkpoint;
+    follower.tcp.fd = dc_open(env, err, tcpLog, O_RDONLY, 0);
+    follower.udp.fd = dc_open(env, err, udpLog, O_RDONLY, 0);
+    follower.buffer = dc_malloc(env, err, FOLLOW_READ_SIZE);
+    inotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    // Every exit below goes through the one cleanup, whatever was opened before the failure.
+    if (follower.tcp.fd == -1 || follower.udp.fd == -1 || follower.buffer == NULL || inotifyFD == -1 ||
+        inotify_add_watch(inotifyFD, tcpLog, IN_MODIFY) == -1 || inotify_add_watch(inotifyFD, udpLog, IN_MODIFY) == -1 ||
+        fstat(follower.tcp.fd, &tcpStatus) == -1 || fstat(follower.udp.fd, &udpStatus) == -1 ||
+        initClientTable(env, err, &follower.table) == -1) {
+        printf("Watching Logs Failed -> Closing Log Parser\n");
+        ret_val = -1;
+    } else {
+        follower.tcp.inode = tcpStatus.st_ino;
+        follower.udp.inode = udpStatus.st_ino;
+        loadCheckpoint(env, err, &follower);
+        watchLogs(env, err, &follower, inotifyFD, refreshMs);
+    }
+
+    if (inotifyFD != -1) {
+        dc_close(env, err, inotifyFD);
+    }
+
+    if (follower.tcp.fd != -1) {
+        dc_close(env, err, follower.tcp.fd);
+    }
+
+    if (follower.udp.fd != -1) {
+        dc_close(env, err, follower.udp.fd);
+    }
+
+    if (follower.buffer != NULL) {
+        dc_free(env, follower.buffer, FOLLOW_READ_SIZE);
+    }
+
+    if (follower.table.slots != NULL) {
+        freeFollowStats(env, &follower);
+        destroyClientTable(env, &follower.table);
+    }
+
+    return ret_val;
+}
@@ -0,0 +1,586 @@
+#include "logGen.h"
+
+struct application_settings {
+    struct dc_opt_settings opts;
+    struct dc_setting_string *message;
+    struct dc_setting_string *tcpLog;
+    struct dc_setting_string *udpLog;
+    struct dc_setting_uint16 *clients;
+    struct dc_setting_string *packets;
+    struct dc_setting_uint16 *size;
+    struct dc_setting_string *loss;
+    struct dc_setting_string *reorder;
+    struct dc_setting_string *duplicate;
+    struct dc_setting_string *rate;
+    struct dc_setting_string *start;
+    struct dc_setting_string *seed;
+    struct dc_setting_uint16 *threads;
+};
+
+static struct dc_application_settings *create_settings(const struct dc_posix_env *env, struct dc_error *err);
+static int destroy_settings(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings **psettings);
+static int run(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings *settings);
+static void error_reporter(const struct dc_error *err);
+static void trace_reporter(const struct dc_posix_env *env, const char *file_name, const char *function_name, size_t line_number);
+static char *writeDigits(char *line, u_int32_t value, int digits);
+static char *writeLine(char *line, u_int32_t clientID, u_int32_t packetID, const char *timeText);
+static void *runWorker(void *arg);
+static int runWorkers(const struct dc_posix_env *env, struct dc_error *err, struct log_gen *gen, size_t threads,
+        bool write);
+static bool parseProbability(const char *text, uint64_t *threshold);
+
+int main(int argc, char *argv[]) {
+    dc_posix_tracer tracer;
+    dc_error_reporter reporter;
+    struct dc_posix_env env;
+    struct dc_error err;
+    struct dc_application_info *info;
+    int ret_val;
+
+    reporter = error_reporter;
+//    tracer = trace_reporter;
+    tracer = NULL;
+    dc_error_init(&err, reporter);
+    dc_posix_env_init(&env, tracer);
+    info = dc_application_info_create(&env, &err, "Settings Application");
+    ret_val = dc_application_run(&env, &err, info, create_settings, destroy_settings,
+                                 run, dc_default_create_lifecycle, dc_default_destroy_lifecycle,
+                                 NULL, argc, argv);
+    dc_application_info_destroy(&env, &info);
+    dc_error_reset(&err);
+
+    return ret_val;
+}
+
+static struct dc_application_settings *create_settings(const struct dc_posix_env *env, struct dc_error *err) {
+    struct application_settings *settings;
+
+    static const uint16_t default_clients = DEFAULT_GEN_CLIENTS;
+    static const uint16_t default_size = DEFAULT_GEN_SIZE;
+    static const uint16_t default_threads = DEFAULT_GEN_THREADS;
+
+    DC_TRACE(env);
+    settings = dc_malloc(env, err, sizeof(struct application_settings));
+
+    if(settings == NULL) {
+        return NULL;
+    }
+
+    settings->opts.parent.config_path = dc_setting_path_create(env, err);
+    settings->message = dc_setting_string_create(env, err);
+    settings->tcpLog = dc_setting_string_create(env, err);
+    settings->udpLog = dc_setting_string_create(env, err);
+    settings->clients = dc_setting_uint16_create(env, err);
+    settings->packets = dc_setting_string_create(env, err);
+    settings->size = dc_setting_uint16_create(env, err);
+    settings->loss = dc_setting_string_create(env, err);
+    settings->reorder = dc_setting_string_create(env, err);
+    settings->duplicate = dc_setting_string_create(env, err);
+    settings->rate = dc_setting_string_create(env, err);
+    settings->start = dc_setting_string_create(env, err);
+    settings->seed = dc_setting_string_create(env, err);
+    settings->threads = dc_setting_uint16_create(env, err);
+
+    struct options opts[] = {
+            {(struct dc_setting *)settings->opts.parent.config_path,
+                    dc_options_set_path,
+                    "config",
+                    required_argument,
+                    'c',
+                    "CONFIG",
+                    dc_string_from_string,
+                    NULL,
+                    dc_string_from_config,
+                    NULL},
+            {(struct dc_setting *)settings->message,
+                    dc_options_set_string,
+                    "message",
+                    required_argument,
+                    'm',
+                    "MESSAGE",
+                    dc_string_from_string,
+                    "message",
+                    dc_string_from_config,
+                    "Hello, Default World!"},
+            {(struct dc_setting *)settings->tcpLog,
+                    dc_options_set_string,
+                    "tcp-log",
+                    required_argument,
+                    't',
+                    "TCP_LOG",
+                    dc_string_from_string,
+                    "tcp-log",
+                    dc_string_from_config,
+                    DEFAULT_GEN_TCP_LOG},
+            {(struct dc_setting *)settings->udpLog,
+                    dc_options_set_string,
+                    "udp-log",
+                    required_argument,
+                    'u',
+                    "UDP_LOG",
+                    dc_string_from_string,
+                    "udp-log",
+                    dc_string_from_config,
+                    DEFAULT_GEN_UDP_LOG},
+            {(struct dc_setting *)settings->clients,
+                    dc_options_set_uint16,
+                    "clients",
+                    required_argument,
+                    'n',
+                    "CLIENTS",
+                    dc_uint16_from_string,
+                    "clients",
+                    dc_uint16_from_config,
+                    &default_clients},
+            {(struct dc_setting *)settings->packets,
+                    dc_options_set_string,
+                    "packets",
+                    required_argument,
+                    'p',
+                    "PACKETS",
+                    dc_string_from_string,
+                    "packets",
+                    dc_string_from_config,
+                    DEFAULT_GEN_PACKETS},
+            {(struct dc_setting *)settings->size,
+                    dc_options_set_uint16,
+                    "pSize",
+                    required_argument,
+                    'z',
+                    "SIZE",
+                    dc_uint16_from_string,
+                    "pSize",
+                    dc_uint16_from_config,
+                    &default_size},
+            {(struct dc_setting *)settings->loss,
+                    dc_options_set_string,
+                    "loss",
+                    required_argument,
+                    'l',
+                    "LOSS",
+                    dc_string_from_string,
+                    "loss",
+                    dc_string_from_config,
+                    DEFAULT_GEN_LOSS},
+            {(struct dc_setting *)settings->reorder,
+                    dc_options_set_string,
+                    "reorder",
+                    required_argument,
+                    'o',
+                    "REORDER",
+                    dc_string_from_string,
+                    "reorder",
+                    dc_string_from_config,
+                    DEFAULT_GEN_REORDER},
+            {(struct dc_setting *)settings->duplicate,
+                    dc_options_set_string,
+                    "duplicate",
+                    required_argument,
+                    'd',
+                    "DUPLICATE",
+                    dc_string_from_string,
+                    "duplicate",
+                    dc_string_from_config,
+                    DEFAULT_GEN_DUPLICATE},
+            {(struct dc_setting *)settings->rate,
+                    dc_options_set_string,
+                    "rate",
+                    required_argument,
+                    'r',
+                    "RATE",
+                    dc_string_from_string,
+                    "rate",
+                    dc_string_from_config,
+                    DEFAULT_GEN_RATE},
+            {(struct dc_setting *)settings->start,
+                    dc_options_set_string,
+                    "start",
+                    required_argument,
+                    'S',
+                    "START",
+                    dc_string_from_string,
+                    "start",
+                    dc_string_from_config,
+                    DEFAULT_GEN_START},
+            {(struct dc_setting *)settings->seed,
+                    dc_options_set_string,
+                    "seed",
+                    required_argument,
+                    's',
+                    "SEED",
+                    dc_string_from_string,
+                    "seed",
+                    dc_string_from_config,
+                    DEFAULT_GEN_SEED},
+            {(struct dc_setting *)settings->threads,
+                    dc_options_set_uint16,
+                    "threads",
+                    required_argument,
+                    'T',
+                    "THREADS",
+                    dc_uint16_from_string,
+                    "threads",
+                    dc_uint16_from_config,
+                    &default_threads},
+    };
+
+    settings->opts.opts_count = (sizeof(opts) / sizeof(struct options)) + 1;
+    settings->opts.opts_size = sizeof(struct options);
+    settings->opts.opts = dc_calloc(env, err, settings->opts.opts_count, settings->opts.opts_size);
+    dc_memcpy(env, settings->opts.opts, opts, sizeof(opts));
+    settings->opts.flags = "m:";
+    settings->opts.env_prefix = "DC_EXAMPLE_";
+
+    return (struct dc_application_settings *)settings;
+}
+
+static int destroy_settings(const struct dc_posix_env *env, __attribute__((unused)) struct dc_error *err,
+                            struct dc_application_settings **psettings) {
+    struct application_settings *app_settings;
+
+    DC_TRACE(env);
+    app_settings = (struct application_settings *)*psettings;
+    dc_setting_string_destroy(env, &app_settings->message);
+    dc_free(env, app_settings->opts.opts, app_settings->opts.opts_count);
+    dc_free(env, *psettings, sizeof(struct application_settings));
+
+    if(env->null_free) {
+        *psettings = NULL;
+    }
+
+    return 0;
+}
+
+static char *writeDigits(char *line, u_int32_t value, int digits) {
+    // Zero padded, right to left.
+    for (int i = digits - 1; i >= 0; i--) {
+        line[i] = (char) ('0' + value % 10);
+        value /= 10;
+    }
+
+    return line + digits;
+}
+
+static char *writeLine(char *line, u_int32_t clientID, u_int32_t packetID, const char *timeText) {
+    line = writeDigits(line, clientID, 4);
+    *line++ = ':';
+    line = writeDigits(line, packetID, 6);
+    *line++ = ':';
+    memcpy(line, timeText, GEN_TIME_LENGTH);
+    line += GEN_TIME_LENGTH;
+    memcpy(line, ":" GEN_ADDRESS ":", sizeof(GEN_ADDRESS) + 1);
+    line += sizeof(GEN_ADDRESS) + 1;
+    line = writeDigits(line, GEN_UDP_PORT_BASE + clientID, 5);
+    *line++ = '\n';
+
+    return line;
+}
+
+size_t generateBlock(const struct log_gen *gen, uint64_t block, u_int32_t *held, char *buffer) {
+    struct prng prng;
+    char timeText[32] = "";
+    time_t cachedSecond = -1;
+    uint64_t first = block * GEN_BLOCK_SLOTS;
+    uint64_t last = first + GEN_BLOCK_SLOTS < gen->slots ? first + GEN_BLOCK_SLOTS : gen->slots;
+    char *line = buffer;
+    size_t lines = 0;
+
+    prngSeed(&prng, gen->seed + block * UINT64_C(0x9E3779B97F4A7C15));
+    memset(held, 0, gen->clients * sizeof(u_int32_t));
+
+    for (uint64_t slot = first; slot < last; slot++) {
+        u_int32_t client = (u_int32_t) (slot % gen->clients);
+        u_int32_t packetID = (u_int32_t) (slot / gen->clients) + 1;
+        size_t copies;
+
+        // Every draw is made whether or not the line is written, so counting and writing agree.
+        if (prngChance(&prng, gen->lossThreshold)) {
+            continue;
+        }
+
+        if (held[client] == 0 && prngChance(&prng, gen->reorderThreshold)) {
+            held[client] = packetID;
+            continue;
+        }
+
+        copies = prngChance(&prng, gen->duplicateThreshold) ? 2 : 1;
+        lines += copies + (held[client] != 0 ? 1 : 0);
+
+        if (buffer == NULL) {
+            held[client] = 0;
+            continue;
+        }
+
+        // ctime() only changes once a second, as in the server.
+        if ((time_t) (gen->start + (time_t) (slot / gen->rate)) != cachedSecond) {
+            cachedSecond = gen->start + (time_t) (slot / gen->rate);
+            ctime_r(&cachedSecond, timeText);
+        }
+
+        while (copies-- > 0) {
+            line = writeLine(line, client + 1, packetID, timeText);
+        }
+
+        if (held[client] != 0) {
+            line = writeLine(line, client + 1, held[client], timeText);
+            held[client] = 0;
+        }
+    }
+
+    // Packets still held at the end of the block arrive last.
+    for (u_int32_t client = 0; client < gen->clients; client++) {
+        if (held[client] == 0) {
+            continue;
+        }
+
+        lines++;
+
+        if (buffer != NULL) {
+            if (cachedSecond == -1) {
+                cachedSecond = gen->start + (time_t) ((last - 1) / gen->rate);
+                ctime_r(&cachedSecond, timeText);
+            }
+
+            line = writeLine(line, client + 1, held[client], timeText);
+        }
+    }
+
+    return lines;
+}
+
+static void *runWorker(void *arg) {
+    struct gen_worker *worker = (struct gen_worker *) arg;
+    struct log_gen *gen = worker->gen;
+
+    for (uint64_t block = worker->index; block < gen->blockCount; block += worker->threads) {
+        size_t lines = generateBlock(gen, block, worker->held, worker->write ? worker->buffer : NULL);
+
+        if (!worker->write) {
+            gen->lineOffsets[block + 1] = lines;
+            continue;
+        }
+
+        if (pwrite(gen->udpFD, worker->buffer, lines * GEN_LINE_LENGTH,
+                   (off_t) (gen->lineOffsets[block] * GEN_LINE_LENGTH)) != (ssize_t) (lines * GEN_LINE_LENGTH)) {
+            worker->status = -1;
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+static int runWorkers(const struct dc_posix_env *env, struct dc_error *err, struct log_gen *gen, size_t threads,
+        bool write) {
+    struct gen_worker *workers = dc_calloc(env, err, threads, sizeof(struct gen_worker));
+    pthread_t *ids = dc_calloc(env, err, threads, sizeof(pthread_t));
+    size_t started = 1;
+    int ret_val = 0;
+
+    if (workers == NULL || ids == NULL) {
+        ret_val = -1;
+    }
+
+    for (size_t i = 0; ret_val == 0 && i < threads; i++) {
+        workers[i].env = env;
+        dc_error_init(&workers[i].err, NULL);
+        workers[i].gen = gen;
+        workers[i].index = i;
+        workers[i].threads = threads;
+        workers[i].write = write;
+        workers[i].held = dc_calloc(env, err, gen->clients, sizeof(u_int32_t));
+        // A slot gives at most itself and a duplicate, whether now or after being held back.
+        workers[i].buffer = write ? dc_malloc(env, err, (size_t) GEN_BLOCK_SLOTS * 2 * GEN_LINE_LENGTH) : NULL;
+
+        if (workers[i].held == NULL || (write && workers[i].buffer == NULL)) {
+            ret_val = -1;
+        }
+    }
+
+    // The first worker runs on this thread, the others on their own.
+    for (; ret_val == 0 && started < threads; started++) {
+        if (pthread_create(&ids[started], NULL, runWorker, &workers[started]) != 0) {
+            ret_val = -1;
+            break;
+        }
+    }
+
+    if (ret_val == 0) {
+        runWorker(&workers[0]);
+    }
+
+    for (size_t i = 1; i < started; i++) {
+        pthread_join(ids[i], NULL);
+    }
+
+    for (size_t i = 0; workers != NULL && i < threads; i++) {
+        if (workers[i].status == -1) {
+            ret_val = -1;
+        }
+
+        if (workers[i].held != NULL) {
+            dc_free(env, workers[i].held, gen->clients * sizeof(u_int32_t));
+        }
+
+        if (workers[i].buffer != NULL) {
+            dc_free(env, workers[i].buffer, (size_t) GEN_BLOCK_SLOTS * 2 * GEN_LINE_LENGTH);
+        }
+    }
+
+    if (ids != NULL) {
+        dc_free(env, ids, threads * sizeof(pthread_t));
+    }
+
+    if (workers != NULL) {
+        dc_free(env, workers, threads * sizeof(struct gen_worker));
+    }
+
+    return ret_val;
+}
+
+int64_t generateUdpLog(const struct dc_posix_env *env, struct dc_error *err, struct log_gen *gen, size_t threads) {
+    int64_t lines = -1;
+
+    gen->blockCount = (gen->slots + GEN_BLOCK_SLOTS - 1) / GEN_BLOCK_SLOTS;
+    gen->lineOffsets = dc_calloc(env, err, gen->blockCount + 1, sizeof(uint64_t));
+
+    if (gen->lineOffsets == NULL) {
+        return -1;
+    }
+
+    if (threads > gen->blockCount) {
+        threads = gen->blockCount > 0 ? gen->blockCount : 1;
+    }
+
+    // Counting is only random draws, so the first pass costs a fraction of the second.
+    if (runWorkers(env, err, gen, threads, false) == 0) {
+        for (uint64_t block = 0; block < gen->blockCount; block++) {
+            gen->lineOffsets[block + 1] += gen->lineOffsets[block];
+        }
+
+        if (ftruncate(gen->udpFD, (off_t) (gen->lineOffsets[gen->blockCount] * GEN_LINE_LENGTH)) == 0 &&
+            runWorkers(env, err, gen, threads, true) == 0) {
+            lines = (int64_t) gen->lineOffsets[gen->blockCount];
+        }
+    }
+
+    dc_free(env, gen->lineOffsets, (gen->blockCount + 1) * sizeof(uint64_t));
+    gen->lineOffsets = NULL;
+    return lines;
+}
+
+int generateTcpLog(const char *path, const struct log_gen *gen) {
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL) {
+        return -1;
+    }
+
+    for (u_int32_t client = 1; client <= gen->clients; client++) {
+        fprintf(file, "TCP Client %04u:%s:%u:Packets:%u Size:%hu\n", client, GEN_ADDRESS, GEN_TCP_PORT_BASE + client,
+                gen->packets, gen->size);
+    }
+
+    return fclose(file) == 0 ? 0 : -1;
+}
+
+static bool parseProbability(const char *text, uint64_t *threshold) {
+    char *end;
+    double probability = strtod(text, &end);
+
+    if (end == text || *end != '\0' || probability < 0.0 || probability > 1.0) {
+        return false;
+    }
+
+    *threshold = prngThreshold(probability);
+    return true;
+}
+
+static int run(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings *settings) {
+    struct application_settings *app_settings;
+    struct log_gen gen;
+    const char *tcpLog;
+    const char *udpLog;
+    size_t threads;
+    int64_t lines;
+    double start;
+    double seconds;
+
+    DC_TRACE(env);
+
+    app_settings = (struct application_settings *)settings;
+    dc_memset(env, &gen, 0, sizeof(gen));
+    tcpLog = dc_setting_string_get(env, app_settings->tcpLog);
+    udpLog = dc_setting_string_get(env, app_settings->udpLog);
+    gen.clients = dc_setting_uint16_get(env, app_settings->clients);
+    gen.packets = (u_int32_t) strtoul(dc_setting_string_get(env, app_settings->packets), NULL, 10);
+    gen.size = dc_setting_uint16_get(env, app_settings->size);
+    gen.rate = (u_int32_t) strtoul(dc_setting_string_get(env, app_settings->rate), NULL, 10);
+    gen.start = (time_t) strtoimax(dc_setting_string_get(env, app_settings->start), NULL, 10);
+    gen.seed = strtoumax(dc_setting_string_get(env, app_settings->seed), NULL, 10);
+    threads = dc_setting_uint16_get(env, app_settings->threads);
+
+    if (gen.clients == 0 || gen.clients > GEN_MAX_CLIENTS || gen.packets == 0 || gen.packets > GEN_MAX_PACKETS ||
+        gen.rate == 0) {
+        printf("Invalid Log Size -> Use 1-%d Clients, 1-%d Packets And A Rate Above 0\n", GEN_MAX_CLIENTS,
+               GEN_MAX_PACKETS);
+        return EXIT_FAILURE;
+    }
+
+    if (!parseProbability(dc_setting_string_get(env, app_settings->loss), &gen.lossThreshold) ||
+        !parseProbability(dc_setting_string_get(env, app_settings->reorder), &gen.reorderThreshold) ||
+        !parseProbability(dc_setting_string_get(env, app_settings->duplicate), &gen.duplicateThreshold)) {
+        printf("Invalid Rate -> Loss, Reorder And Duplicate Are Between 0 And 1\n");
+        return EXIT_FAILURE;
+    }
+
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+
+        threads = online > 0 ? (size_t) online : 1;
+    }
+
+    if (threads > GEN_MAX_THREADS) {
+        threads = GEN_MAX_THREADS;
+    }
+
+    gen.slots = (uint64_t) gen.clients * gen.packets;
+
+    if (generateTcpLog(tcpLog, &gen) == -1) {
+        printf("Writing TCP Log Failed -> Closing Log Generator\n");
+        return EXIT_FAILURE;
+    }
+
+    gen.udpFD = dc_open(env, err, udpLog, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+    if (dc_error_has_error(err)) {
+        printf("Opening UDP Log Failed -> Closing Log Generator\n");
+        return EXIT_FAILURE;
+    }
+
+    start = monotonicSeconds();
+    lines = generateUdpLog(env, err, &gen, threads);
+    seconds = monotonicSeconds() - start;
+    dc_close(env, err, gen.udpFD);
+
+    if (lines == -1) {
+        printf("Writing UDP Log Failed -> Closing Log Generator\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("Wrote %" PRId64 " lines (%.1f MB) for %u clients in %.2f s (%.1f MB/s) to %s\n", lines,
+           (double) lines * GEN_LINE_LENGTH / 1e6, gen.clients, seconds,
+           seconds > 0.0 ? (double) lines * GEN_LINE_LENGTH / 1e6 / seconds : 0.0, udpLog);
+
+    return EXIT_SUCCESS;
+}
+
+static void error_reporter(const struct dc_error *err) {
+    fprintf(stderr, "ERROR: %s : %s : @ %zu : %d\n", err->file_name, err->function_name, err->line_number, 0);
+    fprintf(stderr, "ERROR: %s\n", err->message);
+}
+
+static void trace_reporter(__attribute__((unused)) const struct dc_posix_env *env, const char *file_name,
+                           const char *function_name, size_t line_number) {
+    fprintf(stdout, "TRACE: %s : %s : @ %zu\n", file_name, function_name, line_number);
+}
@@ -0,0 +1,454 @@
+#include "logIndex.h"
+
+/**
+ * Per-client state while an index is being built.
+ */
+struct index_builder_client {
+    struct packet_bitset seen;
+    struct packet_metrics metrics;
+    struct index_run *runs;
+    size_t runCount;
+    size_t runCapacity;
+};
+
+static void stampFile(const struct stat *status, struct index_stamp *stamp);
+static bool sameStamp(const char *path, const struct index_stamp *stamp);
+static int pushBytes(const struct dc_posix_env *env, struct dc_error *err, void **array, size_t *capacity,
+        size_t count, size_t width);
+static int indexLine(const struct dc_posix_env *env, struct dc_error *err, struct client_table *table,
+        struct index_builder_client *builders, struct log_span line, u_int32_t block, struct log_time_cache *times,
+        u_int32_t *arrival);
+static int writeLogIndex(const char *indexPath, const struct index_header *header, const struct client_table *table,
+        const struct index_builder_client *builders, const u_int64_t *blocks, const struct index_time *times);
+static u_int32_t blockAtOrBefore(const struct log_index *index, u_int32_t second);
+static u_int32_t blockAfter(const struct log_index *index, u_int32_t second);
+
+void defaultIndexPath(const char *udpLog, char *path, size_t size) {
+    snprintf(path, size, "%s%s", udpLog, INDEX_SUFFIX);
+}
+
+static void stampFile(const struct stat *status, struct index_stamp *stamp) {
+    stamp->size = (u_int64_t) status->st_size;
+    stamp->modifiedSeconds = (int64_t) status->st_mtim.tv_sec;
+    stamp->modifiedNanoseconds = (int64_t) status->st_mtim.tv_nsec;
+    stamp->inode = (u_int64_t) status->st_ino;
+}
+
+static bool sameStamp(const char *path, const struct index_stamp *stamp) {
+    struct stat status;
+    struct index_stamp current;
+
+    if (stat(path, &status) == -1) {
+        return false;
+    }
+
+    stampFile(&status, &current);
+
+    return current.size == stamp->size && current.modifiedSeconds == stamp->modifiedSeconds &&
+           current.modifiedNanoseconds == stamp->modifiedNanoseconds && current.inode == stamp->inode;
+}
+
+static int pushBytes(const struct dc_posix_env *env, struct dc_error *err, void **array, size_t *capacity,
+        size_t count, size_t width) {
+    if (count == *capacity) {
+        size_t grown = *capacity == 0 ? 1024 : *capacity * 2;
+        void *resized = dc_realloc(env, err, *array, grown * width);
+
+        if (resized == NULL) {
+            return -1;
+        }
+
+        *array = resized;
+        *capacity = grown;
+    }
+
+    return 0;
+}
+
+static int indexLine(const struct dc_posix_env *env, struct dc_error *err, struct client_table *table,
+        struct index_builder_client *builders, struct log_span line, u_int32_t block, struct log_time_cache *times,
+        u_int32_t *arrival) {
+    struct client_record *record;
+    struct index_builder_client *builder;
+    u_int32_t clientID;
+    u_int32_t packetID;
+
+    *arrival = 0;
+
+    if (!parseUdpLine(line, &clientID, &packetID, times, arrival) || (record = findClient(table, clientID)) == NULL) {
+        return 0;
+    }
+
+    builder = &builders[record - table->records];
+
+    // A client's lines usually sit in a few long stretches of blocks, so runs stay short.
+    if (builder->runCount > 0 && builder->runs[builder->runCount - 1].lastBlock + 1 >= block) {
+        builder->runs[builder->runCount - 1].lastBlock = block;
+    } else {
+        if (pushBytes(env, err, (void **) &builder->runs, &builder->runCapacity, builder->runCount,
+                      sizeof(struct index_run)) == -1) {
+            return -1;
+        }
+
+        builder->runs[builder->runCount].firstBlock = block;
+        builder->runs[builder->runCount++].lastBlock = block;
+    }
+
+    if (!acceptPacketID(&builder->metrics, record->expectedNumberOfPackets, packetID)) {
+        return 0;
+    }
+
+    if (growPacketBitset(env, err, &builder->seen, (size_t) packetID + 1) == -1) {
+        return -1;
+    }
+
+    addPacketMetric(&builder->metrics, &builder->seen, packetID, *arrival);
+    return 0;
+}
+
+static int writeLogIndex(const char *indexPath, const struct index_header *header, const struct client_table *table,
+        const struct index_builder_client *builders, const u_int64_t *blocks, const struct index_time *times) {
+    char temporary[INDEX_PATH_LENGTH];
+    u_int64_t firstRun = 0;
+    bool written;
+    FILE *file;
+
+    // Written to a temporary file and renamed so a reader never sees half an index.
+    snprintf(temporary, sizeof(temporary), "%s.tmp", indexPath);
+    file = fopen(temporary, "wb");
+
+    if (file == NULL) {
+        return -1;
+    }
+
+    written = fwrite(header, sizeof(*header), 1, file) == 1;
+
+    for (size_t i = 0; written && i < table->count; i++) {
+        struct index_client client;
+
+        memset(&client, 0, sizeof(client));
+        client.clientID = table->records[i].clientID;
+        memcpy(client.name, table->records[i].name, sizeof(client.name));
+        client.expected = table->records[i].expectedNumberOfPackets;
+        client.packetSize = table->records[i].packetSize;
+        client.received = builders[i].metrics.received;
+        client.summary = builders[i].metrics;
+        client.firstRun = firstRun;
+        client.runCount = builders[i].runCount;
+        firstRun += builders[i].runCount;
+        written = fwrite(&client, sizeof(client), 1, file) == 1;
+    }
+
+    for (size_t i = 0; written && i < table->count; i++) {
+        written = fwrite(builders[i].runs, sizeof(struct index_run), builders[i].runCount, file) == builders[i].runCount;
+    }
+
+    written = written && fwrite(blocks, sizeof(u_int64_t), header->blockCount + 1, file) == header->blockCount + 1 &&
+              fwrite(times, sizeof(struct index_time), header->timeCount, file) == header->timeCount;
+
+    if (fclose(file) != 0 || !written || rename(temporary, indexPath) == -1) {
+        unlink(temporary);
+        return -1;
+    }
+
+    return 0;
+}
+
+int buildLogIndex(const struct dc_posix_env *env, struct dc_error *err, const char *tcpLog, const char *udpLog,
+        const char *indexPath) {
+    struct client_table table;
+    struct index_builder_client *builders = NULL;
+    struct index_header header;
+    struct log_map udpLogMap;
+    struct log_cursor cursor;
+    struct log_span line;
+    struct log_time_cache timeCache = {{0}, 0, false};
+    struct stat status;
+    u_int64_t *blocks = NULL;
+    size_t blockCapacity = 0;
+    struct index_time *times = NULL;
+    size_t timeCapacity = 0;
+    u_int32_t lastSecond = 0;
+    int ret_val = 0;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = INDEX_MAGIC;
+    header.version = INDEX_VERSION;
+    header.blockSize = INDEX_BLOCK_SIZE;
+
+    if (initClientTable(env, err, &table) == -1) {
+        return -1;
+    }
+
+    // The logs are stamped before they are read, so an index over a log that grows meanwhile is already stale.
+    if (stat(tcpLog, &status) == -1) {
+        destroyClientTable(env, &table);
+        return -1;
+    }
+
+    stampFile(&status, &header.tcp);
+
+    if (loadClientTable(env, err, tcpLog, &table) == -1) {
+        destroyClientTable(env, &table);
+        return -1;
+    }
+
+    if (stat(udpLog, &status) == -1 || mapLog(env, err, udpLog, &udpLogMap) == -1) {
+        destroyClientTable(env, &table);
+        return -1;
+    }
+
+    stampFile(&status, &header.udp);
+    header.clientCount = table.count;
+    builders = dc_calloc(env, err, table.count > 0 ? table.count : 1, sizeof(struct index_builder_client));
+
+    for (size_t i = 0; builders != NULL && i < table.count; i++) {
+        if (createPacketBitset(env, err, &builders[i].seen, (size_t) table.records[i].expectedNumberOfPackets + 1) == -1) {
+            ret_val = -1;
+        }
+    }
+
+    if (builders == NULL || pushBytes(env, err, (void **) &blocks, &blockCapacity, 0, sizeof(u_int64_t)) == -1) {
+        ret_val = -1;
+    } else {
+        blocks[0] = 0;
+    }
+
+    startCursor(&cursor, udpLogMap.data, udpLogMap.length);
+
+    while (ret_val == 0 && nextLine(&cursor, &line)) {
+        u_int64_t offset = (u_int64_t) (line.data - udpLogMap.data);
+        u_int32_t arrival;
+
+        // A new block starts at the first line past the block size, so every block begins on a line.
+        if (offset >= blocks[header.blockCount] + INDEX_BLOCK_SIZE) {
+            if (pushBytes(env, err, (void **) &blocks, &blockCapacity, header.blockCount + 1, sizeof(u_int64_t)) == -1) {
+                ret_val = -1;
+                break;
+            }
+
+            header.blockCount++;
+            blocks[header.blockCount] = offset;
+        }
+
+        if (indexLine(env, err, &table, builders, line, (u_int32_t) header.blockCount, &timeCache, &arrival) == -1) {
+            ret_val = -1;
+            break;
+        }
+
+        // The server logs in time order, so each new second is recorded once where it starts.
+        if (arrival > lastSecond) {
+            if (pushBytes(env, err, (void **) &times, &timeCapacity, header.timeCount, sizeof(struct index_time)) == -1) {
+                ret_val = -1;
+                break;
+            }
+
+            times[header.timeCount].second = arrival;
+            times[header.timeCount++].block = (u_int32_t) header.blockCount;
+            lastSecond = arrival;
+        }
+    }
+
+    if (ret_val == 0) {
+        // Close the last block at the end of the log; an empty log has no blocks at all.
+        if (pushBytes(env, err, (void **) &blocks, &blockCapacity, header.blockCount + 1, sizeof(u_int64_t)) == -1) {
+            ret_val = -1;
+        } else if (udpLogMap.length > 0) {
+            header.blockCount++;
+            blocks[header.blockCount] = udpLogMap.length;
+        }
+    }
+
+    for (u_int64_t i = 0; ret_val == 0 && i < header.blockCount; i++) {
+        if (blocks[i + 1] - blocks[i] > header.maxBlockLength) {
+            header.maxBlockLength = blocks[i + 1] - blocks[i];
+        }
+    }
+
+    for (size_t i = 0; ret_val == 0 && i < table.count; i++) {
+        finishPacketMetrics(&builders[i].metrics, &builders[i].seen, 1, table.records[i].expectedNumberOfPackets);
+        header.runCount += builders[i].runCount;
+    }
+
+    if (ret_val == 0) {
+        ret_val = writeLogIndex(indexPath, &header, &table, builders, blocks, times);
+    }
+
+    unmapLog(env, err, &udpLogMap);
+
+    for (size_t i = 0; builders != NULL && i < table.count; i++) {
+        destroyPacketBitset(env, &builders[i].seen);
+
+        if (builders[i].runs != NULL) {
+            dc_free(env, builders[i].runs, builders[i].runCapacity * sizeof(struct index_run));
+        }
+    }
+
+    if (builders != NULL) {
+        dc_free(env, builders, (table.count > 0 ? table.count : 1) * sizeof(struct index_builder_client));
+    }
+
+    if (blocks != NULL) {
+        dc_free(env, blocks, blockCapacity * sizeof(u_int64_t));
+    }
+
+    if (times != NULL) {
+        dc_free(env, times, timeCapacity * sizeof(struct index_time));
+    }
+
+    destroyClientTable(env, &table);
+    return ret_val;
+}
+
+int loadLogIndex(const struct dc_posix_env *env, struct dc_error *err, const char *indexPath, const char *tcpLog,
+        const char *udpLog, struct log_index *index) {
+    FILE *file = fopen(indexPath, "rb");
+    bool loaded;
+
+    memset(index, 0, sizeof(*index));
+
+    if (file == NULL) {
+        return -1;
+    }
+
+    loaded = fread(&index->header, sizeof(index->header), 1, file) == 1 && index->header.magic == INDEX_MAGIC &&
+             index->header.version == INDEX_VERSION && sameStamp(tcpLog, &index->header.tcp) &&
+             sameStamp(udpLog, &index->header.udp);
+
+    if (loaded) {
+        index->clients = dc_calloc(env, err, index->header.clientCount + 1, sizeof(struct index_client));
+        index->runs = dc_calloc(env, err, index->header.runCount + 1, sizeof(struct index_run));
+        index->blocks = dc_calloc(env, err, index->header.blockCount + 1, sizeof(u_int64_t));
+        index->times = dc_calloc(env, err, index->header.timeCount + 1, sizeof(struct index_time));
+        loaded = index->clients != NULL && index->runs != NULL && index->blocks != NULL && index->times != NULL &&
+                 fread(index->clients, sizeof(struct index_client), index->header.clientCount, file) ==
+                 index->header.clientCount &&
+                 fread(index->runs, sizeof(struct index_run), index->header.runCount, file) == index->header.runCount &&
+                 fread(index->blocks, sizeof(u_int64_t), index->header.blockCount + 1, file) ==
+                 index->header.blockCount + 1 &&
+                 fread(index->times, sizeof(struct index_time), index->header.timeCount, file) ==
+                 index->header.timeCount;
+    }
+
+    fclose(file);
+
+    if (!loaded) {
+        freeLogIndex(env, index);
+        return -1;
+    }
+
+    return 0;
+}
+
+void freeLogIndex(const struct dc_posix_env *env, struct log_index *index) {
+    if (index->clients != NULL) {
+        dc_free(env, index->clients, (index->header.clientCount + 1) * sizeof(struct index_client));
+    }
+
+    if (index->runs != NULL) {
+        dc_free(env, index->runs, (index->header.runCount + 1) * sizeof(struct index_run));
+    }
+
+    if (index->blocks != NULL) {
+        dc_free(env, index->blocks, (index->header.blockCount + 1) * sizeof(u_int64_t));
+    }
+
+    if (index->times != NULL) {
+        dc_free(env, index->times, (index->header.timeCount + 1) * sizeof(struct index_time));
+    }
+
+    memset(index, 0, sizeof(*index));
+}
+
+const struct index_client *findIndexedClient(const struct log_index *index, u_int32_t clientID) {
+    for (u_int64_t i = 0; i < index->header.clientCount; i++) {
+        if (index->clients[i].clientID == clientID) {
+            return &index->clients[i];
+        }
+    }
+
+    return NULL;
+}
+
+static u_int32_t blockAtOrBefore(const struct log_index *index, u_int32_t second) {
+    u_int64_t low = 0;
+    u_int64_t high = index->header.timeCount;
+
+    // The last second at or before the one wanted; lines from earlier seconds can share its block.
+    while (low < high) {
+        u_int64_t middle = low + (high - low) / 2;
+
+        if (index->times[middle].second <= second) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low == 0 ? 0 : index->times[low - 1].block;
+}
+
+static u_int32_t blockAfter(const struct log_index *index, u_int32_t second) {
+    u_int64_t low = 0;
+    u_int64_t high = index->header.timeCount;
+
+    while (low < high) {
+        u_int64_t middle = low + (high - low) / 2;
+
+        if (index->times[middle].second <= second) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    // The block where the next second starts still holds the end of this one.
+    return low == index->header.timeCount ? (u_int32_t) (index->header.blockCount - 1) : index->times[low].block;
+}
+
+int indexRanges(const struct dc_posix_env *env, struct dc_error *err, const struct log_index *index,
+        const struct index_client *client, u_int32_t from, u_int32_t to, struct log_range **ranges, size_t *count) {
+    u_int32_t firstBlock;
+    u_int32_t lastBlock;
+    u_int64_t runCount = client == NULL ? 1 : client->runCount;
+
+    *count = 0;
+    *ranges = dc_calloc(env, err, runCount + 1, sizeof(struct log_range));
+
+    if (*ranges == NULL) {
+        return -1;
+    }
+
+    if (index->header.blockCount == 0) {
+        return 0;
+    }
+
+    firstBlock = from == 0 ? 0 : blockAtOrBefore(index, from);
+    lastBlock = to == UINT32_MAX ? (u_int32_t) (index->header.blockCount - 1) : blockAfter(index, to);
+
+    for (u_int64_t i = 0; i < runCount; i++) {
+        u_int32_t start = firstBlock;
+        u_int32_t end = lastBlock;
+
+        if (client != NULL) {
+            const struct index_run *run = &index->runs[client->firstRun + i];
+
+            start = run->firstBlock > firstBlock ? run->firstBlock : firstBlock;
+            end = run->lastBlock < lastBlock ? run->lastBlock : lastBlock;
+        }
+
+        if (start > end) {
+            continue;
+        }
+
+        // Runs are in block order, so touching ranges can only meet the previous one.
+        if (*count > 0 && (*ranges)[*count - 1].end == (off_t) index->blocks[start]) {
+            (*ranges)[*count - 1].end = (off_t) index->blocks[end + 1];
+        } else {
+            (*ranges)[*count].start = (off_t) index->blocks[start];
+            (*ranges)[(*count)++].end = (off_t) index->blocks[end + 1];
+        }
+    }
+
+    return 0;
+}
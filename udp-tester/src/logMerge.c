@@ -0,0 +1,271 @@
+#include "logMerge.h"
+
+/**
+ * The table being filled by mergeUdpLogs.
+ */
+struct merge_fill {
+    const struct dc_posix_env *env;
+    struct dc_error *err;
+    struct client_table *table;
+    struct log_time_cache times;
+    int status;
+};
+
+static bool nextShardLine(struct dc_error *err, struct merge_shard *shard);
+static bool shardBefore(const struct merge_shard *shards, size_t left, size_t right);
+static void siftDown(const struct merge_shard *shards, size_t *heap, size_t count, size_t slot);
+static void fillLine(struct log_span line, void *context);
+
+int splitLogList(const struct dc_posix_env *env, struct dc_error *err, const char *list, struct log_list *logs) {
+    char *start;
+
+    logs->count = 0;
+    logs->length = strlen(list) + 1;
+    logs->copy = dc_malloc(env, err, logs->length);
+
+    if (logs->copy == NULL) {
+        return -1;
+    }
+
+    memcpy(logs->copy, list, logs->length);
+    start = logs->copy;
+
+    for (char *cursor = logs->copy;; cursor++) {
+        bool last = *cursor == '\0';
+
+        if (*cursor != LOG_LIST_SEPARATOR && !last) {
+            continue;
+        }
+
+        *cursor = '\0';
+
+        // Empty entries from stray commas are skipped.
+        if (*start != '\0') {
+            if (logs->count == MERGE_MAX_LOGS) {
+                freeLogList(env, logs);
+                return -1;
+            }
+
+            logs->paths[logs->count++] = start;
+        }
+
+        if (last) {
+            break;
+        }
+
+        start = cursor + 1;
+    }
+
+    if (logs->count == 0) {
+        freeLogList(env, logs);
+        return -1;
+    }
+
+    return 0;
+}
+
+void freeLogList(const struct dc_posix_env *env, struct log_list *logs) {
+    if (logs->copy != NULL) {
+        dc_free(env, logs->copy, logs->length);
+    }
+
+    logs->copy = NULL;
+    logs->count = 0;
+}
+
+int loadClientLogs(const struct dc_posix_env *env, struct dc_error *err, const struct log_list *tcpLogs,
+        struct client_table *table) {
+    // addClient keeps the first record for a client named in more than one log.
+    for (size_t i = 0; i < tcpLogs->count; i++) {
+        if (loadClientTable(env, err, tcpLogs->paths[i], table) == -1) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static bool nextShardLine(struct dc_error *err, struct merge_shard *shard) {
+    while (!shard->done || shard->position < shard->filled) {
+        const char *start = shard->buffer + shard->position;
+        const char *end = shard->buffer + shard->filled;
+        const char *newline = findByte(start, end, '\n');
+        ssize_t count;
+
+        if (newline != end || (shard->done && shard->position < shard->filled) ||
+            (shard->position == 0 && shard->filled == MERGE_READ_SIZE)) {
+            // A last line without a newline, or one longer than the buffer, is taken as it is.
+            u_int32_t clientID;
+            u_int32_t packetID;
+
+            shard->line.data = start;
+            shard->line.length = (size_t) (newline - start);
+            shard->position = (size_t) (newline - shard->buffer) + (newline != end ? 1 : 0);
+
+            // Lines without a time sort first and are then ignored by the handler like any bad line.
+            if (!parseUdpLine(shard->line, &clientID, &packetID, &shard->times, &shard->arrival)) {
+                shard->arrival = 0;
+            }
+
+            return true;
+        }
+
+        // Move the partial line to the front and read more behind it.
+        memmove(shard->buffer, start, shard->filled - shard->position);
+        shard->filled -= shard->position;
+        shard->position = 0;
+        count = read(shard->fd, shard->buffer + shard->filled, MERGE_READ_SIZE - shard->filled);
+
+        if (count == -1) {
+            DC_ERROR_RAISE_ERRNO(err, errno);
+            shard->failed = true;
+            shard->done = true;
+            return false;
+        }
+
+        shard->filled += (size_t) count;
+        shard->done = count == 0;
+    }
+
+    return false;
+}
+
+static bool shardBefore(const struct merge_shard *shards, size_t left, size_t right) {
+    return shards[left].arrival < shards[right].arrival ||
+           (shards[left].arrival == shards[right].arrival && left < right);
+}
+
+static void siftDown(const struct merge_shard *shards, size_t *heap, size_t count, size_t slot) {
+    for (;;) {
+        size_t smallest = slot;
+        size_t left = slot * 2 + 1;
+        size_t right = left + 1;
+        size_t swap;
+
+        if (left < count && shardBefore(shards, heap[left], heap[smallest])) {
+            smallest = left;
+        }
+
+        if (right < count && shardBefore(shards, heap[right], heap[smallest])) {
+            smallest = right;
+        }
+
+        if (smallest == slot) {
+            return;
+        }
+
+        swap = heap[slot];
+        heap[slot] = heap[smallest];
+        heap[smallest] = swap;
+        slot = smallest;
+    }
+}
+
+int mergeLogs(const struct dc_posix_env *env, struct dc_error *err, const struct log_list *udpLogs,
+        log_line_handler handler, void *context) {
+    struct merge_shard shards[MERGE_MAX_LOGS];
+    size_t heap[MERGE_MAX_LOGS];
+    size_t count = 0;
+    int ret_val = 0;
+
+    memset(shards, 0, sizeof(shards));
+
+    for (size_t i = 0; i < udpLogs->count; i++) {
+        shards[i].fd = -1;
+    }
+
+    // Packed shards hold no lines to merge.
+    for (size_t i = 0; i < udpLogs->count; i++) {
+        if (isPackedFile(env, err, udpLogs->paths[i])) {
+            printf("%s Is Packed -> Only Text Logs Can Be Merged\n", udpLogs->paths[i]);
+            return -1;
+        }
+    }
+
+    for (size_t i = 0; i < udpLogs->count; i++) {
+        shards[i].fd = dc_open(env, err, udpLogs->paths[i], O_RDONLY, 0);
+        shards[i].buffer = shards[i].fd == -1 ? NULL : dc_malloc(env, err, MERGE_READ_SIZE);
+
+        if (shards[i].buffer == NULL) {
+            ret_val = -1;
+            break;
+        }
+
+        posix_fadvise(shards[i].fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    for (size_t i = 0; ret_val == 0 && i < udpLogs->count; i++) {
+        if (nextShardLine(err, &shards[i])) {
+            heap[count++] = i;
+        } else if (shards[i].failed) {
+            ret_val = -1;
+        }
+    }
+
+    for (size_t slot = count / 2; ret_val == 0 && slot-- > 0;) {
+        siftDown(shards, heap, count, slot);
+    }
+
+    // The root is always the earliest waiting line; its shard's next line replaces it, or the last entry does.
+    while (ret_val == 0 && count > 0) {
+        struct merge_shard *shard = &shards[heap[0]];
+
+        handler(shard->line, context);
+
+        if (!nextShardLine(err, shard)) {
+            if (shard->failed) {
+                ret_val = -1;
+                break;
+            }
+
+            heap[0] = heap[--count];
+        }
+
+        siftDown(shards, heap, count, 0);
+    }
+
+    for (size_t i = 0; i < udpLogs->count; i++) {
+        if (shards[i].buffer != NULL) {
+            dc_free(env, shards[i].buffer, MERGE_READ_SIZE);
+        }
+
+        if (shards[i].fd != -1) {
+            dc_close(env, err, shards[i].fd);
+        }
+    }
+
+    return ret_val;
+}
+
+static void fillLine(struct log_span line, void *context) {
+    struct merge_fill *fill = (struct merge_fill *) context;
+    struct client_record *record;
+    u_int32_t clientID;
+    u_int32_t packetID;
+    u_int32_t arrival;
+
+    if (fill->status == -1 || !parseUdpLine(line, &clientID, &packetID, &fill->times, &arrival) ||
+        (record = findClient(fill->table, clientID)) == NULL) {
+        return;
+    }
+
+    if (appendPacket(fill->env, fill->err, record, packetID, arrival) == -1) {
+        fill->status = -1;
+    }
+}
+
+int mergeUdpLogs(const struct dc_posix_env *env, struct dc_error *err, const struct log_list *udpLogs,
+        struct client_table *table) {
+    struct merge_fill fill;
+
+    memset(&fill, 0, sizeof(fill));
+    fill.env = env;
+    fill.err = err;
+    fill.table = table;
+
+    if (mergeLogs(env, err, udpLogs, fillLine, &fill) == -1) {
+        return -1;
+    }
+
+    return fill.status;
+}
@@ -3,6 +3,20 @@
 struct application_settings {
     struct dc_opt_settings opts;
     struct dc_setting_string *message;
+    struct dc_setting_string *tcpLog;
+    struct dc_setting_string *udpLog;
+    struct dc_setting_uint16 *threads;
+    struct dc_setting_bool *follow;
+    struct dc_setting_uint16 *refresh;
+    struct dc_setting_string *checkpoint;
+    struct dc_setting_string *format;
+    struct dc_setting_bool *buildIndex;
+    struct dc_setting_string *index;
+    struct dc_setting_string *client;
+    struct dc_setting_bool *summary;
+    struct dc_setting_string *from;
+    struct dc_setting_string *to;
+    struct dc_setting_string *window;
 };
 
 static struct dc_application_settings *create_settings(const struct dc_posix_env *env, struct dc_error *err);
@@ -10,55 +24,7 @@ static int destroy_settings(const struct dc_posix_env *env, struct dc_error *err
 static int run(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings *settings);
 static void error_reporter(const struct dc_error *err);
 static void trace_reporter(const struct dc_posix_env *env, const char *file_name, const char *function_name, size_t line_number);
-
-Link createNode() {
-    Link link = (Link) malloc(sizeof(struct Node));
-
-    link->next = NULL;
-    return link;
-}
-
-Link createNodeWithNextNode(Link next) {
-    Link link = createNode();
-    link->next = next;
-    return link;
-}
-
-Link getTail(Link head) {
-    if (!head) {
-        return NULL;
-    }
-
-    if (!head->next) {
-        return head;
-    }
-
-    return getTail(head->next);
-}
-
-Link addLast(Link *head) {
-    Link newTail = createNode();
-    if (!*head) {
-        *head = newTail;
-        return newTail;
-    }
-
-    Link currentTail = getTail(*head);
-    currentTail->next = newTail;
-    return newTail;
-}
-
-void deleteList(Link head_ref) {
-    Link current = head_ref;
-    Link next;
-
-    while (current != NULL) {
-        next = current->next;
-        free(current);
-        current = next;
-    }
-    head_ref = NULL;
-}
+static void fillRecord(u_int32_t clientID, u_int32_t packetID, u_int32_t arrival, void *context);
 
 int main(int argc, char *argv[]) {
     dc_posix_tracer tracer;
@@ -84,6 +50,12 @@ int main(int argc, char *argv[]) {
 static struct dc_application_settings *create_settings(const struct dc_posix_env *env, struct dc_error *err) {
     struct application_settings *settings;
 
+    static const uint16_t default_threads = DEFAULT_THREADS;
+    static const bool default_follow = false;
+    static const uint16_t default_refresh = DEFAULT_REFRESH;
+    static const bool default_build_index = false;
+    static const bool default_summary = false;
+
     DC_TRACE(env);
     settings = dc_malloc(env, err, sizeof(struct application_settings));
 
@@ -93,6 +65,20 @@ static struct dc_application_settings *create_settings(const struct dc_posix_env
 
     settings->opts.parent.config_path = dc_setting_path_create(env, err);
     settings->message = dc_setting_string_create(env, err);
+    settings->tcpLog = dc_setting_string_create(env, err);
+    settings->udpLog = dc_setting_string_create(env, err);
+    settings->threads = dc_setting_uint16_create(env, err);
+    settings->follow = dc_setting_bool_create(env, err);
+    settings->refresh = dc_setting_uint16_create(env, err);
+    settings->checkpoint = dc_setting_string_create(env, err);
+    settings->format = dc_setting_string_create(env, err);
+    settings->buildIndex = dc_setting_bool_create(env, err);
+    settings->index = dc_setting_string_create(env, err);
+    settings->client = dc_setting_string_create(env, err);
+    settings->summary = dc_setting_bool_create(env, err);
+    settings->from = dc_setting_string_create(env, err);
+    settings->to = dc_setting_string_create(env, err);
+    settings->window = dc_setting_string_create(env, err);
 
     struct options opts[] = {
             {(struct dc_setting *)settings->opts.parent.config_path,
@@ -115,6 +101,146 @@ static struct dc_application_settings *create_settings(const struct dc_posix_env
                     "message",
                     dc_string_from_config,
                     "Hello, Default World!"},
+            {(struct dc_setting *)settings->tcpLog,
+                    dc_options_set_string,
+                    "tcp-log",
+                    required_argument,
+                    't',
+                    "TCP_LOG",
+                    dc_string_from_string,
+                    "tcp-log",
+                    dc_string_from_config,
+                    DEFAULT_TCP_LOG},
+            {(struct dc_setting *)settings->udpLog,
+                    dc_options_set_string,
+                    "udp-log",
+                    required_argument,
+                    'u',
+                    "UDP_LOG",
+                    dc_string_from_string,
+                    "udp-log",
+                    dc_string_from_config,
+                    DEFAULT_UDP_LOG},
+            {(struct dc_setting *)settings->threads,
+                    dc_options_set_uint16,
+                    "threads",
+                    required_argument,
+                    'j',
+                    "THREADS",
+                    dc_uint16_from_string,
+                    "threads",
+                    dc_uint16_from_config,
+                    &default_threads},
+            {(struct dc_setting *)settings->follow,
+                    dc_options_set_bool,
+                    "follow",
+                    no_argument,
+                    'f',
+                    "FOLLOW",
+                    dc_flag_from_string,
+                    "follow",
+                    dc_flag_from_config,
+                    &default_follow},
+            {(struct dc_setting *)settings->refresh,
+                    dc_options_set_uint16,
+                    "refresh",
+                    required_argument,
+                    'r',
+                    "REFRESH",
+                    dc_uint16_from_string,
+                    "refresh",
+                    dc_uint16_from_config,
+                    &default_refresh},
+            {(struct dc_setting *)settings->checkpoint,
+                    dc_options_set_string,
+                    "checkpoint",
+                    required_argument,
+                    'k',
+                    "CHECKPOINT",
+                    dc_string_from_string,
+                    "checkpoint",
+                    dc_string_from_config,
+                    DEFAULT_CHECKPOINT},
+            {(struct dc_setting *)settings->format,
+                    dc_options_set_string,
+                    "format",
+                    required_argument,
+                    'F',
+                    "FORMAT",
+                    dc_string_from_string,
+                    "format",
+                    dc_string_from_config,
+                    DEFAULT_FORMAT},
+            {(struct dc_setting *)settings->buildIndex,
+                    dc_options_set_bool,
+                    "build-index",
+                    no_argument,
+                    'b',
+                    "BUILD_INDEX",
+                    dc_flag_from_string,
+                    "build-index",
+                    dc_flag_from_config,
+                    &default_build_index},
+            {(struct dc_setting *)settings->index,
+                    dc_options_set_string,
+                    "index",
+                    required_argument,
+                    'i',
+                    "INDEX",
+                    dc_string_from_string,
+                    "index",
+                    dc_string_from_config,
+                    DEFAULT_INDEX},
+            {(struct dc_setting *)settings->client,
+                    dc_options_set_string,
+                    "client",
+                    required_argument,
+                    'C',
+                    "CLIENT",
+                    dc_string_from_string,
+                    "client",
+                    dc_string_from_config,
+                    DEFAULT_CLIENT},
+            {(struct dc_setting *)settings->summary,
+                    dc_options_set_bool,
+                    "summary",
+                    no_argument,
+                    's',
+                    "SUMMARY",
+                    dc_flag_from_string,
+                    "summary",
+                    dc_flag_from_config,
+                    &default_summary},
+            {(struct dc_setting *)settings->from,
+                    dc_options_set_string,
+                    "from",
+                    required_argument,
+                    'S',
+                    "FROM",
+                    dc_string_from_string,
+                    "from",
+                    dc_string_from_config,
+                    DEFAULT_FROM},
+            {(struct dc_setting *)settings->to,
+                    dc_options_set_string,
+                    "to",
+                    required_argument,
+                    'E',
+                    "TO",
+                    dc_string_from_string,
+                    "to",
+                    dc_string_from_config,
+                    DEFAULT_TO},
+            {(struct dc_setting *)settings->window,
+                    dc_options_set_string,
+                    "window",
+                    required_argument,
+                    'w',
+                    "WINDOW",
+                    dc_string_from_string,
+                    "window",
+                    dc_string_from_config,
+                    DEFAULT_WINDOW},
     };
 
     settings->opts.opts_count = (sizeof(opts) / sizeof(struct options)) + 1;
@@ -144,278 +270,220 @@ static int destroy_settings(const struct dc_posix_env *env, __attribute__((unuse
     return 0;
 }
 
-size_t printMissingPackets(const struct dc_posix_env *env, struct dc_error *err, const u_int16_t *packetIDs,
-        size_t expectedPackets, size_t receivedPackets) {
-    bool packetChecker[expectedPackets + 1];
-    dc_memset(env, packetChecker, 0, sizeof(packetChecker));
-    char packetsMessage[MAXLINE] = {0};
-    size_t lostPacketsCounter = 0;
-
-    sprintf(packetsMessage, "----------------------------------------\n");
-    dc_write(env, err, STDOUT_FILENO, packetsMessage, dc_strlen(env, packetsMessage));
-    dc_memset(env, packetsMessage, 0, sizeof(packetsMessage));
+static void fillRecord(u_int32_t clientID, u_int32_t packetID, u_int32_t arrival, void *context) {
+    struct packed_fill *fill = (struct packed_fill *) context;
+    struct client_record *record;
 
-    sprintf(packetsMessage, "Packet Numbers Lost:\n");
-    dc_write(env, err, STDOUT_FILENO, packetsMessage, dc_strlen(env, packetsMessage));
-    dc_memset(env, packetsMessage, 0, sizeof(packetsMessage));
-
-    for (size_t i = 0; i < receivedPackets; i++) {
-        packetChecker[packetIDs[i]] = true;
+    // Packets from clients missing from the tcp log are skipped, as in the text path.
+    if (fill->status == -1 || (record = findClient(fill->table, clientID)) == NULL) {
+        return;
     }
 
-    for (size_t i = 1; i <= expectedPackets; i++) {
-        if (!packetChecker[i]) {
-            printf("%06zu\n", i);
-            lostPacketsCounter++;
-        }
+    if (appendPacket(fill->env, fill->err, record, packetID, arrival) == -1) {
+        fill->status = -1;
     }
-
-    sprintf(packetsMessage, "----------------------------------------\n");
-    dc_write(env, err, STDOUT_FILENO, packetsMessage, dc_strlen(env, packetsMessage));
-    dc_memset(env, packetsMessage, 0, sizeof(packetsMessage));
-
-    return lostPacketsCounter;
 }
 
-size_t calculateMissingPacketsInSequence(const struct dc_posix_env *env, struct dc_error *err,
-        const u_int16_t *packetIDs, size_t expectedPackets, size_t receivedPackets, const char *function) {
-    bool packetChecker[expectedPackets + 1];
-    dc_memset(env, packetChecker, 0, sizeof(packetChecker));
-    size_t lostPacketsCounter = 0;
-    size_t lostPackets[expectedPackets];
-    dc_memset(env, lostPackets, 0, sizeof(lostPackets));
-    size_t minLost = 0;
-    size_t maxLost = 0;
-
-    for (size_t i = 0; i < receivedPackets; i++) {
-        packetChecker[packetIDs[i]] = true;
+void parseLogStatistics(const struct dc_posix_env *env, struct dc_error *err, const struct parser_options *options) {
+    struct log_map udpLogMap;
+    struct report_writer writer;
+    struct client_table table;
+    struct log_list tcpLogs;
+    struct log_list udpLogs;
+    int parsed;
+
+    if (splitLogList(env, err, options->tcpLog, &tcpLogs) == -1) {
+        printf("Reading Log List Failed -> Closing Log Parser\n");
+        return;
     }
 
-    for (size_t i = 1; i <= expectedPackets; i++) {
-        if (!packetChecker[i]) {
-            lostPackets[lostPacketsCounter] = i;
-            lostPacketsCounter++;
-        }
+    if (splitLogList(env, err, options->udpLog, &udpLogs) == -1) {
+        printf("Reading Log List Failed -> Closing Log Parser\n");
+        freeLogList(env, &tcpLogs);
+        return;
     }
 
-    if (lostPacketsCounter >= 1) {
-        minLost = 1;
-        maxLost = 1;
+    if (initClientTable(env, err, &table) == -1) {
+        freeLogList(env, &udpLogs);
+        freeLogList(env, &tcpLogs);
+        return;
     }
 
-    for (size_t i = 0; i < lostPacketsCounter; i++) {
-
-        if(lostPackets[i + 1] == lostPackets[i] + 1) {
-            maxLost++;
-        }
+    // Building a table of all the clients in the tcp logs.
+    if (loadClientLogs(env, err, &tcpLogs, &table) == -1) {
+        printf("Opening TCP Log Failed -> Closing Log Parser\n");
+        destroyClientTable(env, &table);
+        freeLogList(env, &udpLogs);
+        freeLogList(env, &tcpLogs);
+        return;
     }
-    if (dc_strcmp(env, function, "min") == 0) {
-        return minLost;
+
+    freeLogList(env, &tcpLogs);
+
+    if (udpLogs.count > 1) {
+        // Logs from sharded servers are merged by arrival time, so a client split across them is measured in order.
+        parsed = mergeUdpLogs(env, err, &udpLogs, &table);
+    } else if (mapLog(env, err, udpLogs.paths[0], &udpLogMap) == -1) {
+        printf("Opening UDP Log Failed -> Closing Log Parser\n");
+        destroyClientTable(env, &table);
+        freeLogList(env, &udpLogs);
+        return;
+    } else if (isPackedLog(udpLogMap.data, udpLogMap.length)) {
+        struct packed_fill fill = {env, err, &table, 0};
+
+        // A packed log is already split into numbers, so it is decoded straight into the table.
+        parsed = unpackLog(udpLogMap.data, udpLogMap.length, 0, UINT32_MAX, false, 0, fillRecord, &fill) == -1 ?
+                 -1 : fill.status;
+        unmapLog(env, err, &udpLogMap);
     } else {
-        return maxLost;
+        // One pass over the udp log, split across threads; only the first two fields of a line are looked at.
+        parsed = parseUdpLogParallel(env, err, &table, udpLogMap.data, udpLogMap.length,
+                                     parseThreadCount(options->threads));
+        unmapLog(env, err, &udpLogMap);
     }
-}
 
-void printOutOfOrderPackets(const struct dc_posix_env *env, struct dc_error *err, const u_int16_t *packetIDs, size_t receivedPackets) {
-    char packetsMessage[MAXLINE] = {0};
-    size_t packetsOutOfOrder = 0;
+    freeLogList(env, &udpLogs);
 
-    for (size_t i = 0; i < receivedPackets - 1; i++) {
-        if ((packetIDs[i + 1] < packetIDs[i])) {
-            packetsOutOfOrder++;
-        }
+    if (parsed == -1) {
+        printf("Parsing UDP Log Failed -> Closing Log Parser\n");
+        destroyClientTable(env, &table);
+        return;
     }
 
-    sprintf(packetsMessage, "Number of Packets Out Of Order: %zu\n", packetsOutOfOrder);
-    dc_write(env, err, STDOUT_FILENO, packetsMessage, dc_strlen(env, packetsMessage));
-    dc_memset(env, packetsMessage, 0, sizeof(packetsMessage));
-
-    sprintf(packetsMessage, "----------------------------------------\n");
-    dc_write(env, err, STDOUT_FILENO, packetsMessage, dc_strlen(env, packetsMessage));
-    dc_memset(env, packetsMessage, 0, sizeof(packetsMessage));
-
-    sprintf(packetsMessage, "Packet Numbers Out Of Order:\n");
-    dc_write(env, err, STDOUT_FILENO, packetsMessage, dc_strlen(env, packetsMessage));
-    dc_memset(env, packetsMessage, 0, sizeof(packetsMessage));
-
-    for (size_t i = 0; i < receivedPackets - 1; i++) {
-        if ((packetIDs[i + 1] < packetIDs[i])) {
-            printf("%06hu\n", packetIDs[i + 1]);
-        }
+    if (openReportWriter(env, err, &writer, STDOUT_FILENO) == -1) {
+        destroyClientTable(env, &table);
+        return;
     }
 
-    sprintf(packetsMessage, "----------------------------------------\n");
-    dc_write(env, err, STDOUT_FILENO, packetsMessage, dc_strlen(env, packetsMessage));
-    dc_memset(env, packetsMessage, 0, sizeof(packetsMessage));
-}
-
-size_t calculateOutOfOrderInSequence(const struct dc_posix_env *env, struct dc_error *err,
-        const u_int16_t *packetIDs, size_t receivedPackets, const char *function) {
-    size_t outOfOrderCounter = 0;
-    size_t outOfOrderPackets[receivedPackets];
-    dc_memset(env, outOfOrderPackets, 0, sizeof(outOfOrderPackets));
-    size_t minOrder = 0;
-    size_t maxOrder = 0;
-    size_t arrayCounter = 0;
-
-    for (size_t i = 0; i < receivedPackets - 1; i++) {
-        if ((packetIDs[i + 1] < packetIDs[i])) {
-            outOfOrderCounter++;
-        }
+    if (reportClientTable(env, err, &writer, options->format, &table, false) == -1) {
+        printf("Measuring Packets Failed -> Closing Log Parser\n");
     }
 
-    for (size_t i = 0; i < receivedPackets - 1; i++) {
-        if ((packetIDs[i + 1] < packetIDs[i])) {
-            outOfOrderPackets[arrayCounter] = packetIDs[i + 1];
-            arrayCounter++;
-        }
+    if (closeReportWriter(&writer) == -1) {
+        fprintf(stderr, "Writing Report Failed\n");
     }
 
-    if (outOfOrderCounter >= 1) {
-        minOrder = 1;
-        maxOrder = 1;
-    }
+    destroyClientTable(env, &table);
+}
 
-    for (size_t i = 0; i < outOfOrderCounter; i++) {
-        if(outOfOrderPackets[i + 1] == outOfOrderPackets[i] - 1) {
-            maxOrder++;
-        }
-    }
+int queryLogs(const struct dc_posix_env *env, struct dc_error *err, const struct parser_options *options) {
+    struct log_query query;
+    char indexPath[INDEX_PATH_LENGTH];
 
-    if (dc_strcmp(env, function, "min") == 0) {
-        return minOrder;
+    if (options->index[0] != '\0') {
+        snprintf(indexPath, sizeof(indexPath), "%s", options->index);
     } else {
-        return maxOrder;
+        defaultIndexPath(options->udpLog, indexPath, sizeof(indexPath));
     }
-}
 
-void parseLogStatistics(const struct dc_posix_env *env, struct dc_error *err) {
-    int tcpLogFD;
-    int udpLogFD;
-    FILE *tcpLogFileDescriptor;
-    FILE *udpLogFileDescriptor;
-    uint16_t packetCounter;
-    char *logStorage = NULL;
-    size_t lineSize = 0;
-    char *endPointer;
-    size_t clientCounter = 0;
-    char buffer[MAXLINE] = {0};
-    char packetsMessage[MAXLINE] = {0};
-    size_t lostPacketsTotal = 0;
-    double lostPackageAverage;
-    size_t tempMinLost = 0;
-    size_t tempMaxLost = 0;
-    size_t minLost = 0;
-    size_t maxLost = 0;
-    size_t tempMinOrder = 0;
-    size_t tempMaxOrder = 0;
-    size_t minOrder = 0;
-    size_t maxOrder = 0;
-
-    tcpLogFD = dc_open(env, err, "../../logs/tcpLog.txt", O_RDONLY, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
-    tcpLogFileDescriptor = dc_fdopen(env, err, tcpLogFD, "r");
-
-    // Creating a linked list of all the clients in the tcp log.
-    Link clientHead = NULL;
-    while(dc_getline(env, err, &logStorage, &lineSize, tcpLogFileDescriptor) > 0) {
-        Link currentLink;
-        currentLink = addLast(&clientHead);
-        dc_strtok_r(env, logStorage, " ", &endPointer);
-        dc_strtok_r(env, endPointer, " ", &endPointer);
-        currentLink->clientID = dc_strdup(env, err, dc_strtok_r(env, endPointer, ":", &endPointer));
-        dc_strtok_r(env, endPointer, ":", &endPointer);
-        dc_strtok_r(env, endPointer, ":", &endPointer);
-        dc_strtok_r(env, endPointer, ":", &endPointer);
-        currentLink->expectedNumberOfPackets = (u_int16_t) dc_strtol(env, err, endPointer, &endPointer, 10);
-        dc_strtok_r(env, endPointer, ":", &endPointer);
-        currentLink->packetSize = (u_int16_t) dc_strtol(env, err, endPointer, &endPointer, 10);
-        clientCounter++;
-
-        dc_memset(env, logStorage, 0, sizeof(logStorage));
+    if ((options->buildIndex || options->summary) && strchr(options->udpLog, LOG_LIST_SEPARATOR) != NULL) {
+        printf("The Index Covers A Single UDP Log -> Index Each Shard On Its Own\n");
+        return -1;
     }
 
-    while (clientHead) {
-        packetCounter = 0;
-        clientHead->packetIDs = dc_calloc(env, err, clientHead->expectedNumberOfPackets, sizeof(u_int16_t));
-        udpLogFD = dc_open(env, err, "../../logs/udpLog.txt", O_RDONLY, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
-        udpLogFileDescriptor = dc_fdopen(env, err, udpLogFD, "r");
-        while(dc_getline(env, err, &logStorage, &lineSize, udpLogFileDescriptor) > 0) {
-            if (dc_strcmp(env, dc_strtok_r(env, logStorage, ":", &endPointer), clientHead->clientID) == 0) {
-                clientHead->packetIDs[packetCounter] = (u_int16_t) dc_strtol(env, err, endPointer, &endPointer, 10);
-                packetCounter++;
-            }
-        }
-        clientHead->receivedNumberOfPackets = packetCounter;
-        sprintf(buffer, "Client %s:\nPackets Expected = %hu\nPackets Received = %hu\nPackets Lost = %d\n",
-                clientHead->clientID, clientHead->expectedNumberOfPackets, packetCounter, clientHead->expectedNumberOfPackets - packetCounter);
-        dc_write(env, err, STDOUT_FILENO, buffer, dc_strlen(env, buffer));
-        lostPacketsTotal += printMissingPackets(env, err, clientHead->packetIDs, clientHead->expectedNumberOfPackets,
-                            clientHead->receivedNumberOfPackets);
-        tempMinLost = calculateMissingPacketsInSequence(env, err, clientHead->packetIDs, clientHead->expectedNumberOfPackets,
-                                          clientHead->receivedNumberOfPackets, "min");
-        if (tempMinLost > minLost) {
-            minLost = tempMinLost;
-        }
+    if ((options->buildIndex || options->summary) && isPackedFile(env, err, options->udpLog)) {
+        printf("Packed Logs Carry Their Own Block Index -> Drop --build-index And --summary\n");
+        return -1;
+    }
 
-        tempMaxLost = calculateMissingPacketsInSequence(env, err, clientHead->packetIDs, clientHead->expectedNumberOfPackets,
-                                          clientHead->receivedNumberOfPackets, "max");
-        if (tempMaxLost > maxLost) {
-            maxLost = tempMaxLost;
+    if (options->buildIndex) {
+        if (buildLogIndex(env, err, options->tcpLog, options->udpLog, indexPath) == -1) {
+            printf("Building Index Failed -> Closing Log Parser\n");
+            return -1;
         }
 
-        tempMinOrder = calculateOutOfOrderInSequence(env, err, clientHead->packetIDs,
-                                                     clientHead->receivedNumberOfPackets, "min");
-        if (tempMinOrder > minOrder) {
-            minOrder = tempMinOrder;
-        }
+        printf("Index Written To %s\n", indexPath);
+        fflush(stdout);
 
-        tempMaxOrder = calculateOutOfOrderInSequence(env, err, clientHead->packetIDs,
-                                                     clientHead->receivedNumberOfPackets, "max");
-        if (tempMaxOrder > maxOrder) {
-            maxOrder = tempMaxOrder;
+        // --build-index on its own only refreshes the index.
+        if (!options->summary && options->client[0] == '\0' && options->from[0] == '\0' && options->to[0] == '\0' &&
+            options->window[0] == '\0') {
+            return 0;
         }
+    }
+
+    query.tcpLog = options->tcpLog;
+    query.udpLog = options->udpLog;
+    query.indexPath = indexPath;
+    query.format = options->format;
+    query.summary = options->summary;
+    query.hasClient = options->client[0] != '\0';
+    query.clientID = (u_int32_t) strtoul(options->client, NULL, 10);
+
+    if (!parseTimeBound(options->from, &query.from) || !parseTimeBound(options->to, &query.to)) {
+        printf("Unknown Time -> Use Seconds Or \"YYYY-MM-DD HH:MM:SS\"\n");
+        return -1;
+    }
+
+    query.window = 0;
 
-        printOutOfOrderPackets(env, err, clientHead->packetIDs, clientHead->receivedNumberOfPackets);
+    if (options->window[0] != '\0' && !parseWindowLength(options->window, &query.window)) {
+        printf("Unknown Window -> Use Seconds Such As 1s, 30s Or 5m\n");
+        return -1;
+    }
 
-        dc_close(env, err, udpLogFD);
-        clientHead = clientHead->next;
+    if (query.summary && query.window > 0) {
+        printf("The Index Summary Has No Windows -> Drop --summary\n");
+        return -1;
     }
 
-    sprintf(packetsMessage, "Minimum Lost Packets: %zu\n", minLost);
-    dc_write(env, err, STDOUT_FILENO, packetsMessage, dc_strlen(env, packetsMessage));
-    dc_memset(env, packetsMessage, 0, sizeof(packetsMessage));
+    // The stored summaries cover whole tests, so a time range cannot be answered from them.
+    if (query.summary && (query.from.set || query.to.set)) {
+        printf("The Index Summary Has No Time Range -> Drop --summary Or --from And --to\n");
+        return -1;
+    }
 
-    sprintf(packetsMessage, "Maximum Lost Packets: %zu\n", maxLost);
-    dc_write(env, err, STDOUT_FILENO, packetsMessage, dc_strlen(env, packetsMessage));
-    dc_memset(env, packetsMessage, 0, sizeof(packetsMessage));
+    return queryLogStatistics(env, err, &query);
+}
 
-    sprintf(packetsMessage, "----------------------------------------\n");
-    dc_write(env, err, STDOUT_FILENO, packetsMessage, dc_strlen(env, packetsMessage));
-    dc_memset(env, packetsMessage, 0, sizeof(packetsMessage));
+static int run(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings *settings) {
+    struct application_settings *app_settings;
+    struct parser_options options;
 
-    sprintf(packetsMessage, "Minimum Out Of Order Packets: %zu\n", minOrder);
-    dc_write(env, err, STDOUT_FILENO, packetsMessage, dc_strlen(env, packetsMessage));
-    dc_memset(env, packetsMessage, 0, sizeof(packetsMessage));
+    DC_TRACE(env);
+    app_settings = (struct application_settings *)settings;
+    options.tcpLog = dc_setting_string_get(env, app_settings->tcpLog);
+    options.udpLog = dc_setting_string_get(env, app_settings->udpLog);
+    options.threads = dc_setting_uint16_get(env, app_settings->threads);
+    options.follow = dc_setting_bool_get(env, app_settings->follow);
+    options.refresh = dc_setting_uint16_get(env, app_settings->refresh);
+    options.checkpoint = dc_setting_string_get(env, app_settings->checkpoint);
+
+    if (!reportFormatFromString(dc_setting_string_get(env, app_settings->format), &options.format)) {
+        printf("Unknown Report Format -> Closing Log Parser\n");
+        return EXIT_FAILURE;
+    }
 
-    sprintf(packetsMessage, "Maximum Out Of Order Packets: %zu\n", maxOrder);
-    dc_write(env, err, STDOUT_FILENO, packetsMessage, dc_strlen(env, packetsMessage));
-    dc_memset(env, packetsMessage, 0, sizeof(packetsMessage));
+    if (options.follow && (strchr(options.tcpLog, LOG_LIST_SEPARATOR) != NULL ||
+                           strchr(options.udpLog, LOG_LIST_SEPARATOR) != NULL)) {
+        printf("Follow Mode Watches A Single Pair Of Logs -> Closing Log Parser\n");
+        return EXIT_FAILURE;
+    }
 
-    sprintf(packetsMessage, "----------------------------------------\n");
-    dc_write(env, err, STDOUT_FILENO, packetsMessage, dc_strlen(env, packetsMessage));
-    dc_memset(env, packetsMessage, 0, sizeof(packetsMessage));
+    if (options.follow && isPackedFile(env, err, options.udpLog)) {
+        printf("Follow Mode Reads Text Logs -> Closing Log Parser\n");
+        return EXIT_FAILURE;
+    }
 
-    lostPackageAverage = (double)lostPacketsTotal / (double) clientCounter;
-    sprintf(packetsMessage, "Average Number Of Lost Packets: %f\n", (double) lostPackageAverage);
-    dc_write(env, err, STDOUT_FILENO, packetsMessage, dc_strlen(env, packetsMessage));
-    dc_memset(env, packetsMessage, 0, sizeof(packetsMessage));
+    if (options.follow) {
+        return followLogs(env, err, options.tcpLog, options.udpLog, options.checkpoint,
+                          options.refresh > 0 ? options.refresh : DEFAULT_REFRESH) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
-    deleteList(clientHead);
-}
+    options.buildIndex = dc_setting_bool_get(env, app_settings->buildIndex);
+    options.index = dc_setting_string_get(env, app_settings->index);
+    options.client = dc_setting_string_get(env, app_settings->client);
+    options.summary = dc_setting_bool_get(env, app_settings->summary);
+    options.from = dc_setting_string_get(env, app_settings->from);
+    options.to = dc_setting_string_get(env, app_settings->to);
+    options.window = dc_setting_string_get(env, app_settings->window);
+
+    if (options.buildIndex || options.summary || options.client[0] != '\0' || options.from[0] != '\0' ||
+        options.to[0] != '\0' || options.window[0] != '\0') {
+        return queryLogs(env, err, &options) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
-static int run(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings *settings) {
-    DC_TRACE(env);
-    parseLogStatistics(env, err);
+    parseLogStatistics(env, err, &options);
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,388 @@
+#include "logQuery.h"
+
+/**
+ * State shared with the line handler while ranges are read.
+ */
+struct query_scan {
+    const struct dc_posix_env *env;
+    struct dc_error *err;
+    const struct log_query *query;
+    struct client_table *table;
+    struct log_time_cache times;
+    u_int32_t logStart;
+    u_int32_t from;
+    u_int32_t to;
+    int status;
+};
+
+static u_int32_t resolveBound(const struct time_bound *bound, u_int32_t logStart, u_int32_t unset);
+static void scanLine(struct log_span line, void *context);
+static void scanRecord(u_int32_t clientID, u_int32_t packetID, u_int32_t arrival, void *context);
+static int loadIndexedClients(const struct dc_posix_env *env, struct dc_error *err, const struct log_index *index,
+        struct client_table *table);
+static int keepQueriedClient(const struct dc_posix_env *env, struct dc_error *err, const struct log_query *query,
+        struct client_table *table);
+static int reportIndexSummary(const struct dc_posix_env *env, struct dc_error *err, const struct log_index *index,
+        const struct log_query *query);
+static int readRanges(const struct dc_posix_env *env, struct dc_error *err, const struct log_query *query,
+        const struct log_range *ranges, size_t rangeCount, size_t bufferSize, struct query_scan *scan);
+static int mergeShards(const struct dc_posix_env *env, struct dc_error *err, const struct log_query *query,
+        struct client_table *table, struct query_scan *scan);
+static int unpackQueried(const struct dc_posix_env *env, struct dc_error *err, const struct log_query *query,
+        struct client_table *table, struct query_scan *scan);
+
+bool parseTimeBound(const char *text, struct time_bound *bound) {
+    u_int32_t year;
+    u_int32_t month;
+    u_int32_t day;
+    u_int32_t hour;
+    u_int32_t minute;
+    u_int32_t second;
+    char separator;
+    char extra;
+    size_t digits = strspn(text, "0123456789");
+
+    bound->set = text[0] != '\0';
+    bound->relative = false;
+    bound->seconds = 0;
+
+    if (!bound->set) {
+        return true;
+    }
+
+    if (text[digits] == '\0') {
+        bound->relative = true;
+        bound->seconds = (u_int32_t) strtoul(text, NULL, 10);
+        return true;
+    }
+
+    if (sscanf(text, "%4u-%2u-%2u%c%2u:%2u:%2u%c", &year, &month, &day, &separator, &hour, &minute, &second,
+               &extra) != 7 || (separator != ' ' && separator != 'T') || month < 1 || month > 12 || day < 1 ||
+        day > 31 || hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+
+    bound->seconds = civilSeconds(year, month, day, hour, minute, second);
+    return true;
+}
+
+static u_int32_t resolveBound(const struct time_bound *bound, u_int32_t logStart, u_int32_t unset) {
+    if (!bound->set) {
+        return unset;
+    }
+
+    return bound->relative ? logStart + bound->seconds : bound->seconds;
+}
+
+static void scanLine(struct log_span line, void *context) {
+    struct query_scan *scan = (struct query_scan *) context;
+    u_int32_t clientID;
+    u_int32_t packetID;
+    u_int32_t arrival;
+
+    if (scan->status != -1 && parseUdpLine(line, &clientID, &packetID, &scan->times, &arrival)) {
+        scanRecord(clientID, packetID, arrival, context);
+    }
+}
+
+static void scanRecord(u_int32_t clientID, u_int32_t packetID, u_int32_t arrival, void *context) {
+    struct query_scan *scan = (struct query_scan *) context;
+    struct client_record *record;
+
+    if (scan->status == -1) {
+        return;
+    }
+
+    // Without an index, relative bounds are only known once the first stamp has been read.
+    if (scan->logStart == 0 && arrival != 0) {
+        scan->logStart = arrival;
+        scan->from = resolveBound(&scan->query->from, arrival, 0);
+        scan->to = resolveBound(&scan->query->to, arrival, UINT32_MAX);
+    }
+
+    if ((scan->query->hasClient && clientID != scan->query->clientID) || arrival < scan->from || arrival > scan->to ||
+        (record = findClient(scan->table, clientID)) == NULL) {
+        return;
+    }
+
+    if (appendPacket(scan->env, scan->err, record, packetID, arrival) == -1) {
+        scan->status = -1;
+    }
+}
+
+static int loadIndexedClients(const struct dc_posix_env *env, struct dc_error *err, const struct log_index *index,
+        struct client_table *table) {
+    for (u_int64_t i = 0; i < index->header.clientCount; i++) {
+        struct client_record *record = addClient(env, err, table, index->clients[i].clientID);
+
+        if (record == NULL) {
+            return -1;
+        }
+
+        memcpy(record->name, index->clients[i].name, sizeof(record->name));
+        record->expectedNumberOfPackets = index->clients[i].expected;
+        record->packetSize = index->clients[i].packetSize;
+    }
+
+    return 0;
+}
+
+static int keepQueriedClient(const struct dc_posix_env *env, struct dc_error *err, const struct log_query *query,
+        struct client_table *table) {
+    struct client_table kept;
+    struct client_record *source;
+    struct client_record *record;
+
+    if (!query->hasClient) {
+        return 0;
+    }
+
+    if ((source = findClient(table, query->clientID)) == NULL) {
+        printf("Client %u Is Not In The TCP Log\n", query->clientID);
+        return -1;
+    }
+
+    if (initClientTable(env, err, &kept) == -1 || (record = addClient(env, err, &kept, query->clientID)) == NULL) {
+        return -1;
+    }
+
+    memcpy(record->name, source->name, sizeof(record->name));
+    record->expectedNumberOfPackets = source->expectedNumberOfPackets;
+    record->packetSize = source->packetSize;
+    destroyClientTable(env, table);
+    *table = kept;
+    return 0;
+}
+
+static int reportIndexSummary(const struct dc_posix_env *env, struct dc_error *err, const struct log_index *index,
+        const struct log_query *query) {
+    struct report_writer writer;
+    struct report_summary summary;
+
+    if (openReportWriter(env, err, &writer, STDOUT_FILENO) == -1) {
+        return -1;
+    }
+
+    memset(&summary, 0, sizeof(summary));
+    startReport(&writer, query->format);
+
+    // Answered from the stored summaries alone, so the lost and out-of-order lists are not available.
+    for (u_int64_t i = 0; i < index->header.clientCount; i++) {
+        const struct index_client *client = &index->clients[i];
+        struct client_record record;
+
+        if (query->hasClient && client->clientID != query->clientID) {
+            continue;
+        }
+
+        memset(&record, 0, sizeof(record));
+        record.clientID = client->clientID;
+        memcpy(record.name, client->name, sizeof(record.name));
+        record.expectedNumberOfPackets = client->expected;
+        record.packetSize = client->packetSize;
+        record.receivedNumberOfPackets = client->received;
+        reportClient(&writer, query->format, &record, &client->summary, NULL, summary.clients);
+        addToSummary(&summary, &client->summary);
+    }
+
+    finishReport(&writer, query->format, &summary);
+    return closeReportWriter(&writer);
+}
+
+static int readRanges(const struct dc_posix_env *env, struct dc_error *err, const struct log_query *query,
+        const struct log_range *ranges, size_t rangeCount, size_t bufferSize, struct query_scan *scan) {
+    char *buffer = dc_malloc(env, err, bufferSize);
+    int udpFD = buffer == NULL ? -1 : dc_open(env, err, query->udpLog, O_RDONLY, 0);
+    int ret_val = udpFD == -1 ? -1 : 0;
+
+    for (size_t i = 0; ret_val == 0 && i < rangeCount; i++) {
+        ret_val = readLogRange(env, err, udpFD, ranges[i].start, ranges[i].end, buffer, bufferSize, scanLine, scan);
+    }
+
+    if (udpFD != -1) {
+        dc_close(env, err, udpFD);
+    }
+
+    if (buffer != NULL) {
+        dc_free(env, buffer, bufferSize);
+    }
+
+    return ret_val;
+}
+
+static int mergeShards(const struct dc_posix_env *env, struct dc_error *err, const struct log_query *query,
+        struct client_table *table, struct query_scan *scan) {
+    struct log_list tcpLogs;
+    struct log_list udpLogs;
+    int ret_val = -1;
+
+    if (splitLogList(env, err, query->tcpLog, &tcpLogs) == -1) {
+        return -1;
+    }
+
+    if (splitLogList(env, err, query->udpLog, &udpLogs) == -1) {
+        freeLogList(env, &tcpLogs);
+        return -1;
+    }
+
+    // Sharded logs have no index, so every shard is read and merged by arrival time.
+    if (loadClientLogs(env, err, &tcpLogs, table) == 0 && keepQueriedClient(env, err, query, table) == 0) {
+        ret_val = mergeLogs(env, err, &udpLogs, scanLine, scan);
+    }
+
+    freeLogList(env, &udpLogs);
+    freeLogList(env, &tcpLogs);
+    return ret_val;
+}
+
+static int unpackQueried(const struct dc_posix_env *env, struct dc_error *err, const struct log_query *query,
+        struct client_table *table, struct query_scan *scan) {
+    struct log_map udpLogMap;
+
+    if (loadClientTable(env, err, query->tcpLog, table) == -1 || mapLog(env, err, query->udpLog, &udpLogMap) == -1) {
+        printf("Opening Logs Failed -> Closing Log Parser\n");
+        return -1;
+    }
+
+    if (keepQueriedClient(env, err, query, table) == -1) {
+        unmapLog(env, err, &udpLogMap);
+        return -1;
+    }
+
+    // The block headers give the start of the log, so only the blocks that can match are decoded.
+    if (firstPackedArrival(udpLogMap.data, udpLogMap.length, &scan->logStart)) {
+        scan->from = resolveBound(&query->from, scan->logStart, 0);
+        scan->to = resolveBound(&query->to, scan->logStart, UINT32_MAX);
+
+        if (unpackLog(udpLogMap.data, udpLogMap.length, scan->from, scan->to, query->hasClient, query->clientID,
+                      scanRecord, scan) == -1) {
+            scan->status = -1;
+        }
+    }
+
+    unmapLog(env, err, &udpLogMap);
+    return 0;
+}
+
+int queryLogStatistics(const struct dc_posix_env *env, struct dc_error *err, const struct log_query *query) {
+    struct log_index index;
+    struct client_table table;
+    struct query_scan scan;
+    struct report_writer writer;
+    struct log_range *ranges = NULL;
+    size_t rangeCount = 0;
+    size_t rangeCapacity = 0;
+    size_t bufferSize = QUERY_READ_SIZE;
+    bool sharded = strchr(query->tcpLog, LOG_LIST_SEPARATOR) != NULL ||
+                   strchr(query->udpLog, LOG_LIST_SEPARATOR) != NULL;
+    bool packed = !sharded && isPackedFile(env, err, query->udpLog);
+    bool indexed = !sharded && !packed && loadLogIndex(env, err, query->indexPath, query->tcpLog, query->udpLog, &index) == 0;
+    int ret_val = 0;
+
+    if (query->summary) {
+        if (!indexed) {
+            printf("No Current Index -> Run logParser --build-index First\n");
+            return -1;
+        }
+
+        ret_val = reportIndexSummary(env, err, &index, query);
+        freeLogIndex(env, &index);
+        return ret_val;
+    }
+
+    memset(&scan, 0, sizeof(scan));
+    scan.env = env;
+    scan.err = err;
+    scan.query = query;
+    scan.table = &table;
+    scan.from = 0;
+    scan.to = UINT32_MAX;
+
+    if (initClientTable(env, err, &table) == -1) {
+        if (indexed) {
+            freeLogIndex(env, &index);
+        }
+
+        return -1;
+    }
+
+    if (sharded) {
+        if (mergeShards(env, err, query, &table, &scan) == -1) {
+            printf("Reading Sharded Logs Failed -> Closing Log Parser\n");
+            ret_val = -1;
+        }
+    } else if (packed) {
+        ret_val = unpackQueried(env, err, query, &table, &scan);
+    } else if (indexed) {
+        const struct index_client *client = NULL;
+
+        // With an index the relative bounds are known up front, and only the blocks that can match are read.
+        if (index.header.timeCount > 0) {
+            scan.logStart = index.times[0].second;
+            scan.from = resolveBound(&query->from, scan.logStart, 0);
+            scan.to = resolveBound(&query->to, scan.logStart, UINT32_MAX);
+        }
+
+        if (query->hasClient && (client = findIndexedClient(&index, query->clientID)) == NULL) {
+            printf("Client %u Is Not In The Index\n", query->clientID);
+            ret_val = -1;
+        } else if (loadIndexedClients(env, err, &index, &table) == -1 ||
+                   keepQueriedClient(env, err, query, &table) == -1 ||
+                   indexRanges(env, err, &index, client, scan.from, scan.to, &ranges, &rangeCount) == -1) {
+            ret_val = -1;
+        }
+
+        rangeCapacity = (client == NULL ? 1 : (size_t) client->runCount) + 1;
+        bufferSize = (size_t) index.header.maxBlockLength + QUERY_LINE_SLACK;
+        freeLogIndex(env, &index);
+    } else {
+        struct stat status;
+
+        rangeCapacity = 1;
+
+        if (loadClientTable(env, err, query->tcpLog, &table) == -1 || stat(query->udpLog, &status) == -1 ||
+            (ranges = dc_calloc(env, err, 1, sizeof(struct log_range))) == NULL) {
+            printf("Opening Logs Failed -> Closing Log Parser\n");
+            ret_val = -1;
+        } else if (keepQueriedClient(env, err, query, &table) == -1) {
+            ret_val = -1;
+        } else {
+            ranges[0].start = 0;
+            ranges[0].end = status.st_size;
+            rangeCount = 1;
+        }
+    }
+
+    if (ret_val == 0 && !sharded && !packed && readRanges(env, err, query, ranges, rangeCount, bufferSize, &scan) == -1) {
+        scan.status = -1;
+    }
+
+    if (ret_val == 0 && scan.status == -1) {
+        printf("Reading UDP Log Failed -> Closing Log Parser\n");
+        ret_val = -1;
+    }
+
+    if (ret_val == 0 && openReportWriter(env, err, &writer, STDOUT_FILENO) == -1) {
+        printf("Report Allocation Failed -> Closing Log Parser\n");
+        ret_val = -1;
+    } else if (ret_val == 0) {
+        // A time bound cuts the test short, so loss is only counted inside the packets that were read.
+        if (query->window > 0) {
+            ret_val = reportWindows(env, err, &writer, query->format, &table, query->window, scan.from,
+                                    query->from.set || query->to.set);
+        } else {
+            ret_val = reportClientTable(env, err, &writer, query->format, &table, query->from.set || query->to.set);
+        }
+
+        if (closeReportWriter(&writer) == -1) {
+            ret_val = -1;
+        }
+    }
+
+    if (ranges != NULL) {
+        dc_free(env, ranges, rangeCapacity * sizeof(struct log_range));
+    }
+
+    destroyClientTable(env, &table);
+    return ret_val;
+}
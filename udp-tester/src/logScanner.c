@@ -0,0 +1,363 @@
+#include "logScanner.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LOG_SCANNER_X86
+#endif
+
+static const char *findByteScalar(const char *from, const char *end, char byte);
+#ifdef LOG_SCANNER_X86
+static const char *findByteSse2(const char *from, const char *end, char byte);
+static const char *findByteAvx2(const char *from, const char *end, char byte);
+#endif
+static void selectFindByte(void);
+static bool decodeDigits(const char *text, size_t digits, u_int32_t *value);
+
+#ifdef LOG_SCANNER_X86
+static const char *(*findByteImplementation)(const char *, const char *, char) = findByteSse2;
+#else
+static const char *(*findByteImplementation)(const char *, const char *, char) = findByteScalar;
+#endif
+
+static const char *findByteScalar(const char *from, const char *end, char byte) {
+    while (from < end && *from != byte) {
+        from++;
+    }
+
+    return from;
+}
+
+#ifdef LOG_SCANNER_X86
+static const char *findByteSse2(const char *from, const char *end, char byte) {
+    const __m128i needle = _mm_set1_epi8(byte);
+
+    while (end - from >= 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *) (const void *) from);
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+
+        if (mask != 0) {
+            return from + __builtin_ctz((unsigned int) mask);
+        }
+
+        from += 16;
+    }
+
+    return findByteScalar(from, end, byte);
+}
+
+__attribute__((target("avx2")))
+static const char *findByteAvx2(const char *from, const char *end, char byte) {
+    const __m256i needle = _mm256_set1_epi8(byte);
+
+    while (end - from >= 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i *) (const void *) from);
+        int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+
+        if (mask != 0) {
+            return from + __builtin_ctz((unsigned int) mask);
+        }
+
+        from += 32;
+    }
+
+    return findByteSse2(from, end, byte);
+}
+#endif
+
+static void selectFindByte(void) {
+#ifdef LOG_SCANNER_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+        findByteImplementation = findByteAvx2;
+    }
+#endif
+}
+
+const char *findByte(const char *from, const char *end, char byte) {
+    return findByteImplementation(from, end, byte);
+}
+
+int mapLog(const struct dc_posix_env *env, struct dc_error *err, const char *path, struct log_map *map) {
+    struct stat status;
+    void *data;
+
+    selectFindByte();
+    map->data = NULL;
+    map->length = 0;
+    map->fd = dc_open(env, err, path, O_RDONLY, 0);
+
+    if (map->fd == -1) {
+        return -1;
+    }
+
+    if (fstat(map->fd, &status) == -1) {
+        DC_ERROR_RAISE_ERRNO(err, errno);
+        dc_close(env, err, map->fd);
+        map->fd = -1;
+        return -1;
+    }
+
+    if (status.st_size == 0) {
+        return 0;
+    }
+
+    data = mmap(NULL, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, map->fd, 0);
+
+    if (data == MAP_FAILED) {
+        DC_ERROR_RAISE_ERRNO(err, errno);
+        dc_close(env, err, map->fd);
+        map->fd = -1;
+        return -1;
+    }
+
+    madvise(data, (size_t) status.st_size, MADV_SEQUENTIAL);
+    map->data = data;
+    map->length = (size_t) status.st_size;
+
+    return 0;
+}
+
+void unmapLog(const struct dc_posix_env *env, struct dc_error *err, struct log_map *map) {
+    if (map->data != NULL) {
+        munmap((void *) (uintptr_t) map->data, map->length);
+    }
+
+    if (map->fd != -1) {
+        dc_close(env, err, map->fd);
+    }
+
+    map->data = NULL;
+    map->length = 0;
+    map->fd = -1;
+}
+
+void startCursor(struct log_cursor *cursor, const char *data, size_t length) {
+    cursor->position = data;
+    cursor->end = data + length;
+}
+
+bool nextLine(struct log_cursor *cursor, struct log_span *line) {
+    const char *newline;
+
+    if (cursor->position >= cursor->end) {
+        return false;
+    }
+
+    newline = findByte(cursor->position, cursor->end, '\n');
+    line->data = cursor->position;
+    line->length = (size_t) (newline - cursor->position);
+    cursor->position = newline < cursor->end ? newline + 1 : newline;
+
+    return true;
+}
+
+size_t splitSpan(struct log_span span, char delimiter, struct log_span *fields, size_t maxFields) {
+    const char *position = span.data;
+    const char *end = span.data + span.length;
+    size_t count = 0;
+
+    while (count + 1 < maxFields) {
+        const char *found = findByte(position, end, delimiter);
+
+        if (found == end) {
+            break;
+        }
+
+        fields[count].data = position;
+        fields[count].length = (size_t) (found - position);
+        count++;
+        position = found + 1;
+    }
+
+    if (maxFields > 0) {
+        fields[count].data = position;
+        fields[count].length = (size_t) (end - position);
+        count++;
+    }
+
+    return count;
+}
+
+u_int32_t spanToUnsigned(struct log_span span) {
+    u_int32_t value = 0;
+
+    for (size_t i = 0; i < span.length && span.data[i] >= '0' && span.data[i] <= '9'; i++) {
+        value = value * 10 + (u_int32_t) (span.data[i] - '0');
+    }
+
+    return value;
+}
+
+bool parseTcpLine(struct log_span line, struct log_span *clientName, u_int32_t *expectedPackets, u_int16_t *packetSize) {
+    struct log_span words[3];
+    struct log_span fields[6];
+
+    if (splitSpan(line, ' ', words, 3) < 3 || splitSpan(words[2], ':', fields, 6) < 6) {
+        return false;
+    }
+
+    *clientName = fields[0];
+    *expectedPackets = spanToUnsigned(fields[4]);
+    *packetSize = (u_int16_t) spanToUnsigned(fields[5]);
+
+    return true;
+}
+
+u_int32_t civilSeconds(u_int32_t year, u_int32_t month, u_int32_t day, u_int32_t hour, u_int32_t minute,
+        u_int32_t second) {
+    u_int32_t era;
+    u_int32_t yearOfEra;
+    u_int32_t dayOfEra;
+
+    // Days since 1970-01-01 from the civil date, with March as the first month of the year.
+    year -= month <= 2 ? 1 : 0;
+    era = year / 400;
+    yearOfEra = year - era * 400;
+    dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 +
+               day - 1;
+
+    return ((era * 146097 + dayOfEra - 719468) * 24 + hour) * 3600 + minute * 60 + second;
+}
+
+u_int32_t parseLogTime(struct log_time_cache *cache, const char *text) {
+    static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    u_int32_t day;
+    u_int32_t month = 0;
+    u_int32_t year;
+
+    if (cache->valid && memcmp(cache->text, text, LOG_TIME_LENGTH) == 0) {
+        return cache->seconds;
+    }
+
+    while (month < 12 && memcmp(months + month * 3, text + 4, 3) != 0) {
+        month++;
+    }
+
+    if (month == 12 || text[13] != ':' || text[16] != ':') {
+        return 0;
+    }
+
+    day = (text[8] == ' ' ? 0 : (u_int32_t) (text[8] - '0') * 10) + (u_int32_t) (text[9] - '0');
+    year = (u_int32_t) (text[20] - '0') * 1000 + (u_int32_t) (text[21] - '0') * 100 +
+           (u_int32_t) (text[22] - '0') * 10 + (u_int32_t) (text[23] - '0');
+
+    memcpy(cache->text, text, LOG_TIME_LENGTH);
+    cache->seconds = civilSeconds(year, month + 1, day, (u_int32_t) (text[11] - '0') * 10 + (u_int32_t) (text[12] - '0'),
+                                  (u_int32_t) (text[14] - '0') * 10 + (u_int32_t) (text[15] - '0'),
+                                  (u_int32_t) (text[17] - '0') * 10 + (u_int32_t) (text[18] - '0'));
+    cache->valid = true;
+
+    return cache->seconds;
+}
+
+static bool decodeDigits(const char *text, size_t digits, u_int32_t *value) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // The digits are the low bytes, first digit lowest; the bytes above them belong to the next field.
+    u_int64_t mask = ~UINT64_C(0) >> (64 - digits * 8);
+    u_int64_t chunk;
+    u_int64_t low;
+    u_int64_t high;
+
+    memcpy(&chunk, text, sizeof(chunk));
+
+    // A byte is a digit when its high nibble is 3 both before and after adding 6.
+    low = chunk & UINT64_C(0xF0F0F0F0F0F0F0F0);
+    high = (chunk + UINT64_C(0x0606060606060606)) & UINT64_C(0xF0F0F0F0F0F0F0F0);
+
+    if (((low ^ UINT64_C(0x3030303030303030)) | (high ^ UINT64_C(0x3030303030303030))) & mask) {
+        return false;
+    }
+
+    // Shifting the digits to the top leaves zero bytes below them, which read as leading zeros.
+    chunk = ((chunk - UINT64_C(0x3030303030303030)) & mask) << (64 - digits * 8);
+    chunk = (chunk * 10 + (chunk >> 8)) & UINT64_C(0x00FF00FF00FF00FF);
+    chunk = (chunk * 100 + (chunk >> 16)) & UINT64_C(0x0000FFFF0000FFFF);
+    *value = (u_int32_t) ((chunk * 10000 + (chunk >> 32)) & UINT64_C(0xFFFFFFFF));
+    return true;
+#else
+    (void) text;
+    (void) digits;
+    (void) value;
+    return false;
+#endif
+}
+
+bool parseUdpLine(struct log_span line, u_int32_t *clientID, u_int32_t *packetID, struct log_time_cache *cache,
+        u_int32_t *arrival) {
+    struct log_span fields[3];
+    size_t packetStart = UDP_CLIENT_DIGITS + 1;
+    size_t timeStart = packetStart + UDP_PACKET_DIGITS + 1;
+
+    // The server's fixed layout is decoded without looking for the separators; both loads stay inside the line.
+    if (line.length >= packetStart + 8 && line.data[packetStart - 1] == ':' && line.data[timeStart - 1] == ':' &&
+        decodeDigits(line.data, UDP_CLIENT_DIGITS, clientID) &&
+        decodeDigits(line.data + packetStart, UDP_PACKET_DIGITS, packetID)) {
+        fields[2].data = line.data + timeStart;
+        fields[2].length = line.length - timeStart;
+    } else if (splitSpan(line, ':', fields, 3) < 3 || fields[0].length == 0 || fields[0].length > UDP_CLIENT_DIGITS ||
+               fields[1].length > UDP_PACKET_DIGITS) {
+        // Only the first two fields are split off; the rest of the line is never scanned.
+        // Numbers wider than the server writes would wrap, so those lines are malformed.
+        return false;
+    } else {
+        *clientID = spanToUnsigned(fields[0]);
+        *packetID = spanToUnsigned(fields[1]);
+    }
+
+    // The stamp is fixed width and itself holds ':', so it is taken by length, not split.
+    if (cache != NULL) {
+        *arrival = fields[2].length >= LOG_TIME_LENGTH ? parseLogTime(cache, fields[2].data) : 0;
+    }
+
+    return true;
+}
+
+int readLogRange(__attribute__((unused)) const struct dc_posix_env *env, struct dc_error *err, int fd, off_t start,
+        off_t end, char *buffer, size_t size, log_line_handler handler, void *context) {
+    size_t carried = 0;
+    off_t position = start;
+
+    while (position < end) {
+        size_t wanted = size - carried < (size_t) (end - position) ? size - carried : (size_t) (end - position);
+        ssize_t count = pread(fd, buffer + carried, wanted, position);
+        struct log_cursor cursor;
+        struct log_span line;
+        size_t filled;
+        size_t complete;
+
+        if (count <= 0) {
+            if (count == -1) {
+                DC_ERROR_RAISE_ERRNO(err, errno);
+            }
+
+            return -1;
+        }
+
+        position += count;
+        filled = carried + (size_t) count;
+        complete = filled;
+
+        // A partial last line is kept for the next read, unless the range or the buffer ends with it.
+        if (position < end) {
+            while (complete > 0 && buffer[complete - 1] != '\n') {
+                complete--;
+            }
+
+            if (complete == 0) {
+                complete = filled;
+            }
+        }
+
+        startCursor(&cursor, buffer, complete);
+
+        while (nextLine(&cursor, &line)) {
+            handler(line, context);
+        }
+
+        carried = filled - complete;
+        memmove(buffer, buffer + complete, carried);
+    }
+
+    return 0;
+}
@@ -0,0 +1,348 @@
+#include "logWindows.h"
+
+static int measureWindows(const struct dc_posix_env *env, struct dc_error *err, const struct client_record *record,
+        u_int32_t window, u_int32_t origin, bool slice, struct window_stats *stats, size_t *first, size_t *last);
+static void startWindows(struct report_writer *writer, enum report_format format, u_int32_t window);
+static void reportWindowRows(struct report_writer *writer, enum report_format format, const char *name,
+        const struct window_stats *stats, size_t first, size_t last, u_int32_t window, u_int32_t origin);
+static void reportWindowSeries(struct report_writer *writer, enum report_format format, const char *name,
+        const struct window_stats *stats, size_t first, size_t last, u_int32_t window, u_int32_t origin,
+        size_t index);
+static void reportWindowTime(struct report_writer *writer, u_int32_t seconds);
+
+bool parseWindowLength(const char *text, u_int32_t *seconds) {
+    char *end;
+    unsigned long length = strtoul(text, &end, 10);
+    unsigned long scale = 1;
+
+    if (end == text) {
+        return false;
+    }
+
+    if (*end == 'm') {
+        scale = 60;
+        end++;
+    } else if (*end == 'h') {
+        scale = 3600;
+        end++;
+    } else if (*end == 's') {
+        end++;
+    }
+
+    if (*end != '\0' || length == 0 || length > UINT32_MAX / scale) {
+        return false;
+    }
+
+    *seconds = (u_int32_t) (length * scale);
+    return true;
+}
+
+static int measureWindows(const struct dc_posix_env *env, struct dc_error *err, const struct client_record *record,
+        u_int32_t window, u_int32_t origin, bool slice, struct window_stats *stats, size_t *first, size_t *last) {
+    struct packet_bitset seen;
+    struct packet_bitset arrived;
+    u_int32_t lowest = UINT32_MAX;
+    u_int32_t highestID = 0;
+    u_int64_t highest;
+    u_int64_t limit;
+    size_t bits;
+
+    *first = SIZE_MAX;
+    *last = 0;
+
+    for (size_t i = 0; i < record->receivedNumberOfPackets; i++) {
+        if (record->packetIDs[i] < lowest) {
+            lowest = record->packetIDs[i];
+        }
+
+        if (record->packetIDs[i] > highestID) {
+            highestID = record->packetIDs[i];
+        }
+    }
+
+    bits = (size_t) (highestID > record->expectedNumberOfPackets ? highestID : record->expectedNumberOfPackets) + 1;
+
+    if (createPacketBitset(env, err, &seen, bits) == -1) {
+        return -1;
+    }
+
+    if (createPacketBitset(env, err, &arrived, bits) == -1) {
+        destroyPacketBitset(env, &seen);
+        return -1;
+    }
+
+    // The final set of packets decides what was lost; the second pass then dates each gap.
+    markPackets(&seen, record->packetIDs, record->receivedNumberOfPackets);
+    highest = slice && lowest != UINT32_MAX ? (u_int64_t) lowest - 1 : 0;
+    limit = slice ? UINT64_MAX : (u_int64_t) record->expectedNumberOfPackets + 1;
+
+    for (size_t i = 0; i < record->receivedNumberOfPackets; i++) {
+        u_int32_t packetID = record->packetIDs[i];
+        u_int32_t arrival = record->arrivals[i];
+        size_t slot;
+        struct window_stats *current;
+
+        if (arrival == 0) {
+            continue;
+        }
+
+        slot = arrival > origin ? (arrival - origin) / window : 0;
+        current = &stats[slot];
+
+        if (slot < *first) {
+            *first = slot;
+        }
+
+        if (slot > *last) {
+            *last = slot;
+        }
+
+        current->received++;
+        current->bytes += record->packetSize;
+
+        if (packetID > highest) {
+            u_int64_t to = packetID < limit ? packetID : limit;
+
+            // Packets skipped here that never turn up later were lost in this window.
+            if (to > highest + 1) {
+                current->lost += (to - highest - 1) - countMarked(&seen, (size_t) highest + 1, (size_t) to);
+            }
+
+            highest = packetID;
+            markPacket(&arrived, packetID);
+        } else if (!markPacket(&arrived, packetID)) {
+            // Duplicates are not counted as reordered, as in addPacketMetric.
+            current->reordered++;
+        }
+    }
+
+    // Packets after the last one received went missing at the end of the test.
+    if (!slice && *first != SIZE_MAX && record->expectedNumberOfPackets > highest) {
+        stats[*last].lost += record->expectedNumberOfPackets - highest;
+    }
+
+    destroyPacketBitset(env, &arrived);
+    destroyPacketBitset(env, &seen);
+    return 0;
+}
+
+static void reportWindowTime(struct report_writer *writer, u_int32_t seconds) {
+    time_t stamp = (time_t) seconds;
+    struct tm civil;
+    char text[32];
+
+    // Log stamps were decoded with civilSeconds, which is the inverse of gmtime.
+    gmtime_r(&stamp, &civil);
+    reportBytes(writer, text, strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &civil));
+}
+
+static void startWindows(struct report_writer *writer, enum report_format format, u_int32_t window) {
+    switch (format) {
+        case REPORT_JSON:
+            reportString(writer, "{\n  \"windowSeconds\": ");
+            reportUnsigned(writer, window, 0);
+            reportString(writer, ",\n  \"clients\": [");
+            break;
+        case REPORT_CSV:
+            reportString(writer, "client,offset_seconds,start,received,lost,bytes,reordered\n");
+            break;
+        case REPORT_TEXT:
+        default:
+            break;
+    }
+}
+
+static void reportWindowRows(struct report_writer *writer, enum report_format format, const char *name,
+        const struct window_stats *stats, size_t first, size_t last, u_int32_t window, u_int32_t origin) {
+    for (size_t slot = first; slot <= last; slot++) {
+        const struct window_stats *current = &stats[slot];
+        u_int64_t offset = (u_int64_t) slot * window;
+
+        switch (format) {
+            case REPORT_JSON:
+                reportString(writer, slot == first ? "\n      {\"offsetSeconds\":" : ",\n      {\"offsetSeconds\":");
+                reportUnsigned(writer, offset, 0);
+                reportString(writer, ",\"start\":\"");
+                reportWindowTime(writer, (u_int32_t) (origin + offset));
+                reportString(writer, "\",\"received\":");
+                reportUnsigned(writer, current->received, 0);
+                reportString(writer, ",\"lost\":");
+                reportUnsigned(writer, current->lost, 0);
+                reportString(writer, ",\"bytes\":");
+                reportUnsigned(writer, current->bytes, 0);
+                reportString(writer, ",\"reordered\":");
+                reportUnsigned(writer, current->reordered, 0);
+                reportBytes(writer, "}", 1);
+                break;
+            case REPORT_CSV:
+                reportCsvString(writer, name);
+                reportBytes(writer, ",", 1);
+                reportUnsigned(writer, offset, 0);
+                reportBytes(writer, ",", 1);
+                reportWindowTime(writer, (u_int32_t) (origin + offset));
+                reportBytes(writer, ",", 1);
+                reportUnsigned(writer, current->received, 0);
+                reportBytes(writer, ",", 1);
+                reportUnsigned(writer, current->lost, 0);
+                reportBytes(writer, ",", 1);
+                reportUnsigned(writer, current->bytes, 0);
+                reportBytes(writer, ",", 1);
+                reportUnsigned(writer, current->reordered, 0);
+                reportBytes(writer, "\n", 1);
+                break;
+            case REPORT_TEXT:
+            default:
+                reportUnsigned(writer, offset, 0);
+                reportString(writer, " s (");
+                reportWindowTime(writer, (u_int32_t) (origin + offset));
+                reportString(writer, "): Received = ");
+                reportUnsigned(writer, current->received, 0);
+                reportString(writer, " Lost = ");
+                reportUnsigned(writer, current->lost, 0);
+                reportString(writer, " Bytes = ");
+                reportUnsigned(writer, current->bytes, 0);
+                reportString(writer, " Reordered = ");
+                reportUnsigned(writer, current->reordered, 0);
+                reportBytes(writer, "\n", 1);
+                break;
+        }
+    }
+}
+
+static void reportWindowSeries(struct report_writer *writer, enum report_format format, const char *name,
+        const struct window_stats *stats, size_t first, size_t last, u_int32_t window, u_int32_t origin,
+        size_t index) {
+    switch (format) {
+        case REPORT_JSON:
+            reportString(writer, index == 0 ? "\n    {\"client\":" : ",\n    {\"client\":");
+            reportJsonString(writer, name);
+            reportString(writer, ",\"windows\":[");
+            reportWindowRows(writer, format, name, stats, first, last, window, origin);
+            reportString(writer, "]}");
+            break;
+        case REPORT_CSV:
+            reportWindowRows(writer, format, name, stats, first, last, window, origin);
+            break;
+        case REPORT_TEXT:
+        default:
+            reportString(writer, "Client ");
+            reportString(writer, name);
+            reportString(writer, ":\n");
+            reportWindowRows(writer, format, name, stats, first, last, window, origin);
+            reportString(writer, REPORT_SEPARATOR);
+            break;
+    }
+}
+
+int reportWindows(const struct dc_posix_env *env, struct dc_error *err, struct report_writer *writer,
+        enum report_format format, const struct client_table *table, u_int32_t window, u_int32_t origin, bool slice) {
+    struct window_stats *stats = NULL;
+    struct window_stats *totals = NULL;
+    u_int32_t earliest = UINT32_MAX;
+    u_int32_t latest = 0;
+    size_t windowCount = 0;
+    size_t totalFirst = SIZE_MAX;
+    size_t totalLast = 0;
+    size_t reported = 0;
+    int ret_val = 0;
+
+    for (size_t client = 0; client < table->count; client++) {
+        for (size_t i = 0; i < table->records[client].receivedNumberOfPackets; i++) {
+            u_int32_t arrival = table->records[client].arrivals[i];
+
+            // parseUdpLine leaves an unreadable stamp at 0; it belongs to no window.
+            if (arrival == 0) {
+                continue;
+            }
+
+            earliest = arrival < earliest ? arrival : earliest;
+            latest = arrival > latest ? arrival : latest;
+        }
+    }
+
+    // An origin far before the log is moved up to the last window boundary before it, so no empty windows are kept.
+    if (origin == 0 || origin > earliest) {
+        origin = earliest;
+    } else {
+        origin = earliest - (earliest - origin) % window;
+    }
+
+    startWindows(writer, format, window);
+
+    if (earliest != UINT32_MAX) {
+        windowCount = (size_t) (latest - origin) / window + 1;
+        stats = dc_malloc(env, err, windowCount * sizeof(struct window_stats));
+        totals = dc_calloc(env, err, windowCount, sizeof(struct window_stats));
+
+        if (stats == NULL || totals == NULL) {
+            ret_val = -1;
+        }
+    }
+
+    for (size_t client = 0; ret_val == 0 && stats != NULL && client < table->count; client++) {
+        const struct client_record *record = &table->records[client];
+        size_t first;
+        size_t last;
+
+        if (record->receivedNumberOfPackets == 0) {
+            continue;
+        }
+
+        dc_memset(env, stats, 0, windowCount * sizeof(struct window_stats));
+
+        if (measureWindows(env, err, record, window, origin, slice, stats, &first, &last) == -1) {
+            ret_val = -1;
+            break;
+        }
+
+        if (first == SIZE_MAX) {
+            continue;
+        }
+
+        // A client's rows run from its first packet to its last, so a quiet window in between shows up as zeros.
+        reportWindowSeries(writer, format, record->name, stats, first, last, window, origin, reported++);
+
+        for (size_t slot = first; slot <= last; slot++) {
+            totals[slot].received += stats[slot].received;
+            totals[slot].lost += stats[slot].lost;
+            totals[slot].bytes += stats[slot].bytes;
+            totals[slot].reordered += stats[slot].reordered;
+        }
+
+        totalFirst = first < totalFirst ? first : totalFirst;
+        totalLast = last > totalLast ? last : totalLast;
+    }
+
+    // The windows summed over every client come last; after a failure they would pass a cut-off report as whole.
+    if (ret_val == 0) {
+        switch (format) {
+            case REPORT_JSON:
+                reportString(writer, "\n  ],\n  \"all\": [");
+                break;
+            case REPORT_TEXT:
+                reportString(writer, "All Clients:\n");
+                break;
+            case REPORT_CSV:
+            default:
+                break;
+        }
+
+        if (totalFirst != SIZE_MAX) {
+            reportWindowRows(writer, format, "all", totals, totalFirst, totalLast, window, origin);
+        }
+
+        if (format == REPORT_JSON) {
+            reportString(writer, "]\n}\n");
+        }
+    }
+
+    if (stats != NULL) {
+        dc_free(env, stats, windowCount * sizeof(struct window_stats));
+    }
+
+    if (totals != NULL) {
+        dc_free(env, totals, windowCount * sizeof(struct window_stats));
+    }
+
+    return ret_val;
+}
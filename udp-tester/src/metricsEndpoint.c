@@ -0,0 +1,212 @@
+#include "metricsEndpoint.h"
+
+static void appendMetric(char *body, size_t size, size_t *used, const char *format, ...)
+        __attribute__((format(printf, 4, 5)));
+static void appendCounter(char *body, size_t size, size_t *used, const char *name, const char *type,
+        const char *help, uint64_t value);
+static void appendStage(char *body, size_t size, size_t *used, const char *stage, const struct stage_latency *latency);
+static void sendAll(int fd, const char *data, size_t length);
+
+static const unsigned int wakeupBounds[METRICS_WAKEUP_BUCKETS] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+
+int openMetricsListener(const struct dc_posix_env *env, struct dc_error *err, u_int16_t port) {
+    struct sockaddr_in address;
+    int listenFD;
+
+    listenFD = dc_socket(env, err, AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+
+    if (dc_error_has_error(err)) {
+        return -1;
+    }
+
+    setsockopt(listenFD, SOL_SOCKET, SO_REUSEADDR, &(int){1}, sizeof(int));
+    // The listener turns readable once the request has arrived, not when the handshake ends.
+    setsockopt(listenFD, IPPROTO_TCP, TCP_DEFER_ACCEPT, &(int){METRICS_DEFER_SECONDS}, sizeof(int));
+    dc_memset(env, &address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+
+    if (bind(listenFD, (struct sockaddr *) &address, sizeof(address)) == -1 || listen(listenFD, SOMAXCONN) == -1) {
+        dc_close(env, err, listenFD);
+        return -1;
+    }
+
+    return listenFD;
+}
+
+static void appendMetric(char *body, size_t size, size_t *used, const char *format, ...) {
+    va_list arguments;
+    int length;
+
+    if (*used + 1 >= size) {
+        return;
+    }
+
+    va_start(arguments, format);
+    length = vsnprintf(body + *used, size - *used, format, arguments);
+    va_end(arguments);
+
+    // A page that no longer fits is cut off rather than overrun.
+    if (length > 0) {
+        *used = *used + (size_t) length < size ? *used + (size_t) length : size - 1;
+    }
+}
+
+static void appendCounter(char *body, size_t size, size_t *used, const char *name, const char *type,
+        const char *help, uint64_t value) {
+    appendMetric(body, size, used, "# HELP %s %s\n# TYPE %s %s\n%s %" PRIu64 "\n", name, help, name, type, name, value);
+}
+
+static void appendStage(char *body, size_t size, size_t *used, const char *stage, const struct stage_latency *latency) {
+    uint64_t cumulative = 0;
+
+    for (size_t i = 0; i < STAGE_BUCKETS; i++) {
+        cumulative += latency->buckets[i];
+        appendMetric(body, size, used, "udp_tester_stage_latency_seconds_bucket{stage=\"%s\",le=\"%g\"} %" PRIu64 "\n",
+                     stage, (double) (UINT64_C(1) << i) / 1000000.0, cumulative);
+    }
+
+    appendMetric(body, size, used, "udp_tester_stage_latency_seconds_bucket{stage=\"%s\",le=\"+Inf\"} %" PRIu64 "\n"
+                                   "udp_tester_stage_latency_seconds_sum{stage=\"%s\"} %.9f\n"
+                                   "udp_tester_stage_latency_seconds_count{stage=\"%s\"} %" PRIu64 "\n",
+                 stage, latency->count, stage, (double) latency->totalNs / 1000000000.0, stage, latency->count);
+}
+
+size_t formatMetrics(const struct server_metrics *metrics, char *body, size_t size) {
+    const struct udp_receiver *receiver = metrics->receiver;
+    const struct latency_stats *wakeup = &receiver->latency;
+    uint64_t cumulative = 0;
+    size_t next = 0;
+    size_t used = 0;
+
+    body[0] = '\0';
+    appendCounter(body, size, &used, "udp_tester_tcp_sessions_total", "counter",
+                  "TCP sessions accepted on the test port.", metrics->sessionsTotal);
+    appendCounter(body, size, &used, "udp_tester_tcp_sessions_active", "gauge",
+                  "TCP sessions whose child process is still running.", metrics->sessionsActive);
+    appendCounter(body, size, &used, "udp_tester_udp_clients_active", "gauge",
+                  "Clients that sent UDP packets in the current or the previous stats interval.",
+                  activeRateClients(metrics->series));
+    appendCounter(body, size, &used, "udp_tester_packets_received_total", "counter",
+                  "UDP packets received.", receiver->packets);
+    appendCounter(body, size, &used, "udp_tester_bytes_received_total", "counter",
+                  "UDP payload bytes received.", receiver->bytes);
+    appendCounter(body, size, &used, "udp_tester_packets_dropped_total", "counter",
+                  "Packets missing from gaps in the packet numbers.",
+                  metrics->series->totalDrops);
+    appendCounter(body, size, &used, "udp_tester_packets_reordered_total", "counter",
+                  "Packets below the highest number already received from their client.",
+                  metrics->series->totalReorders);
+    appendCounter(body, size, &used, "udp_tester_packets_duplicated_total", "counter",
+                  "Repeats of the highest number already received from their client.",
+                  metrics->series->totalDuplicates);
+    appendCounter(body, size, &used, "udp_tester_log_pending_records", "gauge",
+                  "Packets received but not yet written to the UDP log.",
+                  receiver->packed != NULL ? receiver->packed->records : 0);
+
+    // Batch sizes are kept exactly; the histogram groups them in powers of two up to RECEIVER_BATCH.
+    appendMetric(body, size, &used, "# HELP udp_tester_receive_batch_size Datagrams returned by one recvmmsg().\n"
+                                    "# TYPE udp_tester_receive_batch_size histogram\n");
+
+    for (size_t bound = 1; bound <= RECEIVER_BATCH; bound *= 2) {
+        for (; next <= bound; next++) {
+            cumulative += receiver->batchSizes[next];
+        }
+
+        appendMetric(body, size, &used, "udp_tester_receive_batch_size_bucket{le=\"%zu\"} %" PRIu64 "\n", bound,
+                     cumulative);
+    }
+
+    appendMetric(body, size, &used, "udp_tester_receive_batch_size_bucket{le=\"+Inf\"} %" PRIu64 "\n"
+                                    "udp_tester_receive_batch_size_sum %" PRIu64 "\n"
+                                    "udp_tester_receive_batch_size_count %" PRIu64 "\n",
+                 receiver->batches, receiver->packets, receiver->batches);
+
+    // Wakeup comes from the 1 us buckets of the receive report, the other stages from power-of-two buckets.
+    appendMetric(body, size, &used, "# HELP udp_tester_stage_latency_seconds Time per stage: wakeup is kernel "
+                                    "stamp to read per packet, parse and write are per batch.\n"
+                                    "# TYPE udp_tester_stage_latency_seconds histogram\n");
+    cumulative = 0;
+    next = 0;
+
+    for (size_t i = 0; i < METRICS_WAKEUP_BUCKETS; i++) {
+        for (; next < wakeupBounds[i]; next++) {
+            cumulative += wakeup->buckets[next];
+        }
+
+        appendMetric(body, size, &used,
+                     "udp_tester_stage_latency_seconds_bucket{stage=\"wakeup\",le=\"%g\"} %" PRIu64 "\n",
+                     (double) wakeupBounds[i] / 1000000.0, cumulative);
+    }
+
+    appendMetric(body, size, &used,
+                 "udp_tester_stage_latency_seconds_bucket{stage=\"wakeup\",le=\"+Inf\"} %" PRIu64 "\n"
+                 "udp_tester_stage_latency_seconds_sum{stage=\"wakeup\"} %.9f\n"
+                 "udp_tester_stage_latency_seconds_count{stage=\"wakeup\"} %" PRIu64 "\n",
+                 wakeup->count, (double) wakeup->totalNs / 1000000000.0, wakeup->count);
+    appendStage(body, size, &used, "parse", &receiver->parse);
+    appendStage(body, size, &used, "write", &receiver->write);
+
+    return used;
+}
+
+static void sendAll(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        // MSG_NOSIGNAL: a scraper that hangs up must not take the server down with SIGPIPE.
+        // The socket is non-blocking, so a scraper that stops reading gets a cut-off page instead of a stall.
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+
+        if (sent <= 0) {
+            return;
+        }
+
+        data += sent;
+        length -= (size_t) sent;
+    }
+}
+
+void serveMetrics(const struct dc_posix_env *env, struct dc_error *err, int listenFD,
+        const struct server_metrics *metrics) {
+    char request[METRICS_REQUEST_SIZE];
+    char body[METRICS_BODY_SIZE];
+    char header[256];
+    size_t bodyLength;
+    ssize_t length;
+    int headerLength;
+    int fd;
+
+    fd = accept4(listenFD, NULL, NULL, SOCK_NONBLOCK);
+
+    if (fd == -1) {
+        return;
+    }
+
+    // Nothing here waits on the scraper: a request that has not arrived yet is dropped with the connection.
+    length = recv(fd, request, sizeof(request) - 1, 0);
+
+    if (length <= 0) {
+        dc_close(env, err, fd);
+        return;
+    }
+
+    request[length] = '\0';
+
+    // Only the request line matters; the scrape answer is the same whatever the headers say.
+    if (strncmp(request, "GET /metrics", 12) == 0 && (request[12] == ' ' || request[12] == '?')) {
+        bodyLength = formatMetrics(metrics, body, sizeof(body));
+        headerLength = snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\n"
+                                                        "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                                                        "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+                                bodyLength);
+    } else {
+        bodyLength = (size_t) snprintf(body, sizeof(body), "Not found, try /metrics\n");
+        headerLength = snprintf(header, sizeof(header), "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\n"
+                                                        "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+                                bodyLength);
+    }
+
+    sendAll(fd, header, (size_t) headerLength);
+    sendAll(fd, body, bodyLength);
+    dc_close(env, err, fd);
+}
@@ -0,0 +1,371 @@
+#include "packedLog.h"
+
+static size_t groupSlot(u_int32_t clientID, u_int32_t address, u_int16_t port);
+static struct packed_group *findGroup(const struct dc_posix_env *env, struct dc_error *err,
+        struct packed_writer *writer, u_int32_t clientID, u_int32_t address, u_int16_t port);
+static int reserveBytes(const struct dc_posix_env *env, struct dc_error *err, u_int8_t **bytes, size_t *capacity,
+        size_t needed);
+static size_t putVarint(u_int8_t *out, u_int64_t value);
+static bool getVarint(const u_int8_t **in, const u_int8_t *end, u_int64_t *value);
+static u_int64_t zigzag(int64_t value);
+static int64_t unzigzag(u_int64_t value);
+
+static size_t groupSlot(u_int32_t clientID, u_int32_t address, u_int16_t port) {
+    u_int32_t hash = (clientID ^ address ^ ((u_int32_t) port << 16)) * 2654435761U;
+
+    return (size_t) (hash >> 16) & (PACKED_GROUP_SLOTS - 1);
+}
+
+static size_t putVarint(u_int8_t *out, u_int64_t value) {
+    size_t length = 0;
+
+    while (value >= 0x80) {
+        out[length++] = (u_int8_t) (value | 0x80);
+        value >>= 7;
+    }
+
+    out[length++] = (u_int8_t) value;
+    return length;
+}
+
+static bool getVarint(const u_int8_t **in, const u_int8_t *end, u_int64_t *value) {
+    const u_int8_t *position = *in;
+    u_int64_t result = 0;
+
+    for (unsigned shift = 0; position < end && shift < 64; shift += 7) {
+        u_int8_t byte = *position++;
+
+        result |= (u_int64_t) (byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0) {
+            *in = position;
+            *value = result;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static u_int64_t zigzag(int64_t value) {
+    // Small changes either way become small unsigned numbers: 0, -1, 1, -2 ... map to 0, 1, 2, 3 ...
+    return ((u_int64_t) value << 1) ^ (u_int64_t) (value >> 63);
+}
+
+static int64_t unzigzag(u_int64_t value) {
+    return (int64_t) (value >> 1) ^ -(int64_t) (value & 1);
+}
+
+static int reserveBytes(const struct dc_posix_env *env, struct dc_error *err, u_int8_t **bytes, size_t *capacity,
+        size_t needed) {
+    size_t grown = *capacity == 0 ? 4096 : *capacity;
+    u_int8_t *resized;
+
+    if (needed <= *capacity) {
+        return 0;
+    }
+
+    while (grown < needed) {
+        grown *= 2;
+    }
+
+    resized = dc_realloc(env, err, *bytes, grown);
+
+    if (resized == NULL) {
+        return -1;
+    }
+
+    *bytes = resized;
+    *capacity = grown;
+    return 0;
+}
+
+int openPackedWriter(const struct dc_posix_env *env, struct dc_error *err, struct packed_writer *writer,
+        const char *path, int fd) {
+    struct packed_file_header header;
+    struct stat status;
+    bool packed;
+    int readFD;
+
+    dc_memset(env, writer, 0, sizeof(*writer));
+    writer->fd = fd;
+
+    if (fstat(fd, &status) == -1) {
+        DC_ERROR_RAISE_ERRNO(err, errno);
+        return -1;
+    }
+
+    if (status.st_size == 0) {
+        header.magic = PACKED_MAGIC;
+        header.version = PACKED_VERSION;
+        return dc_write(env, err, fd, &header, sizeof(header)) == (ssize_t) sizeof(header) ? 0 : -1;
+    }
+
+    // Appending blocks to a text log would leave a file neither reader understands.
+    readFD = dc_open(env, err, path, O_RDONLY, 0);
+    packed = readFD != -1 && pread(readFD, &header, sizeof(header), 0) == (ssize_t) sizeof(header) &&
+                  header.magic == PACKED_MAGIC && header.version == PACKED_VERSION;
+
+    if (readFD != -1) {
+        dc_close(env, err, readFD);
+    }
+
+    return packed ? 0 : -1;
+}
+
+static struct packed_group *findGroup(const struct dc_posix_env *env, struct dc_error *err,
+        struct packed_writer *writer, u_int32_t clientID, u_int32_t address, u_int16_t port) {
+    size_t slot = groupSlot(clientID, address, port);
+    struct packed_group *group;
+
+    while (writer->slots[slot] != 0) {
+        group = &writer->groups[writer->slots[slot] - 1];
+
+        if (group->clientID == clientID && group->address == address && group->port == port) {
+            return group;
+        }
+
+        slot = (slot + 1) & (PACKED_GROUP_SLOTS - 1);
+    }
+
+    // A full block of groups is written out and the record starts the next one.
+    if (writer->groupCount == PACKED_MAX_GROUPS) {
+        if (flushPackedWriter(env, err, writer) == -1) {
+            return NULL;
+        }
+
+        slot = groupSlot(clientID, address, port);
+    }
+
+    group = &writer->groups[writer->groupCount++];
+    group->clientID = clientID;
+    group->address = address;
+    group->port = port;
+    group->records = 0;
+    group->lastPacket = 0;
+    group->lastArrival = writer->firstArrival;
+    group->length = 0;
+    writer->slots[slot] = (u_int16_t) writer->groupCount;
+
+    return group;
+}
+
+int packRecord(const struct dc_posix_env *env, struct dc_error *err, struct packed_writer *writer,
+        u_int32_t clientID, u_int32_t packetID, u_int32_t arrival, u_int32_t address, u_int16_t port) {
+    struct packed_group *group;
+
+    if (writer->records > 0 && (writer->records == PACKED_BLOCK_RECORDS ||
+                                arrival >= writer->firstArrival + PACKED_FLUSH_SECONDS ||
+                                arrival < writer->firstArrival) && flushPackedWriter(env, err, writer) == -1) {
+        writer->lostRecords++;
+        return -1;
+    }
+
+    if (writer->records == 0) {
+        writer->firstArrival = arrival;
+    }
+
+    group = findGroup(env, err, writer, clientID, address, port);
+
+    if (group == NULL || reserveBytes(env, err, &group->bytes, &group->capacity,
+                                      group->length + 2 * PACKED_VARINT_LENGTH) == -1) {
+        writer->lostRecords++;
+        return -1;
+    }
+
+    group->length += putVarint(group->bytes + group->length, zigzag((int64_t) packetID - group->lastPacket));
+    group->length += putVarint(group->bytes + group->length, zigzag((int64_t) arrival - group->lastArrival));
+    group->lastPacket = packetID;
+    group->lastArrival = arrival;
+    group->records++;
+    writer->records++;
+    writer->lastArrival = arrival > writer->lastArrival ? arrival : writer->lastArrival;
+
+    return 0;
+}
+
+int flushPackedWriter(const struct dc_posix_env *env, struct dc_error *err, struct packed_writer *writer) {
+    struct packed_block_header header;
+    size_t needed = sizeof(header);
+    size_t length = sizeof(header);
+    int ret_val = 0;
+
+    if (writer->records == 0) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < writer->groupCount; i++) {
+        needed += 5 * PACKED_VARINT_LENGTH + writer->groups[i].length;
+    }
+
+    if (reserveBytes(env, err, &writer->block, &writer->blockCapacity, needed) == -1) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < writer->groupCount; i++) {
+        const struct packed_group *group = &writer->groups[i];
+
+        length += putVarint(writer->block + length, group->clientID);
+        length += putVarint(writer->block + length, group->address);
+        length += putVarint(writer->block + length, group->port);
+        length += putVarint(writer->block + length, group->records);
+        length += putVarint(writer->block + length, group->length);
+        dc_memcpy(env, writer->block + length, group->bytes, group->length);
+        length += group->length;
+    }
+
+    header.magic = PACKED_BLOCK_MAGIC;
+    header.length = (u_int32_t) (length - sizeof(header));
+    header.records = writer->records;
+    header.groups = (u_int32_t) writer->groupCount;
+    header.firstArrival = writer->firstArrival;
+    header.lastArrival = writer->lastArrival;
+    dc_memcpy(env, writer->block, &header, sizeof(header));
+
+    // One write per block keeps a crash from leaving anything but a whole block or a cut-off last one.
+    if (dc_write(env, err, writer->fd, writer->block, length) != (ssize_t) length) {
+        writer->lostRecords += writer->records;
+        ret_val = -1;
+    } else {
+        writer->totalRecords += writer->records;
+        writer->totalBytes += length;
+    }
+
+    writer->records = 0;
+    writer->groupCount = 0;
+    writer->lastArrival = 0;
+    dc_memset(env, writer->slots, 0, sizeof(writer->slots));
+
+    return ret_val;
+}
+
+int closePackedWriter(const struct dc_posix_env *env, struct dc_error *err, struct packed_writer *writer) {
+    int ret_val = flushPackedWriter(env, err, writer);
+
+    for (size_t i = 0; i < PACKED_MAX_GROUPS; i++) {
+        if (writer->groups[i].bytes != NULL) {
+            dc_free(env, writer->groups[i].bytes, writer->groups[i].capacity);
+            writer->groups[i].bytes = NULL;
+        }
+    }
+
+    if (writer->block != NULL) {
+        dc_free(env, writer->block, writer->blockCapacity);
+        writer->block = NULL;
+    }
+
+    return ret_val;
+}
+
+bool isPackedLog(const char *data, size_t length) {
+    struct packed_file_header header;
+
+    if (data == NULL || length < sizeof(header)) {
+        return false;
+    }
+
+    memcpy(&header, data, sizeof(header));
+    return header.magic == PACKED_MAGIC && header.version == PACKED_VERSION;
+}
+
+bool isPackedFile(const struct dc_posix_env *env, struct dc_error *err, const char *path) {
+    struct packed_file_header header;
+    int fd = open(path, O_RDONLY);
+    bool packed;
+
+    // A missing file is not packed; opening it for real reports the error.
+    if (fd == -1) {
+        return false;
+    }
+
+    packed = pread(fd, &header, sizeof(header), 0) == (ssize_t) sizeof(header) &&
+             isPackedLog((const char *) &header, sizeof(header));
+    dc_close(env, err, fd);
+    return packed;
+}
+
+bool firstPackedArrival(const char *data, size_t length, u_int32_t *arrival) {
+    struct packed_block_header header;
+
+    if (!isPackedLog(data, length) || length < sizeof(struct packed_file_header) + sizeof(header)) {
+        return false;
+    }
+
+    memcpy(&header, data + sizeof(struct packed_file_header), sizeof(header));
+    *arrival = header.firstArrival;
+    return header.magic == PACKED_BLOCK_MAGIC;
+}
+
+int unpackLog(const char *data, size_t length, u_int32_t from, u_int32_t to, bool hasClient, u_int32_t clientID,
+        packed_record_handler handler, void *context) {
+    size_t offset = sizeof(struct packed_file_header);
+
+    while (offset + sizeof(struct packed_block_header) <= length) {
+        struct packed_block_header header;
+        const u_int8_t *position;
+        const u_int8_t *end;
+
+        memcpy(&header, data + offset, sizeof(header));
+
+        if (header.magic != PACKED_BLOCK_MAGIC) {
+            return -1;
+        }
+
+        // The server was stopped part way through writing this block.
+        if (header.length > length - offset - sizeof(header)) {
+            return 0;
+        }
+
+        position = (const u_int8_t *) data + offset + sizeof(header);
+        end = position + header.length;
+        offset += sizeof(header) + header.length;
+
+        if (header.lastArrival < from || header.firstArrival > to) {
+            continue;
+        }
+
+        for (u_int32_t group = 0; group < header.groups; group++) {
+            u_int64_t groupClient;
+            u_int64_t address;
+            u_int64_t port;
+            u_int64_t records;
+            u_int64_t bytes;
+            const u_int8_t *groupEnd;
+            int64_t packetID = 0;
+            int64_t arrival = header.firstArrival;
+
+            if (!getVarint(&position, end, &groupClient) || !getVarint(&position, end, &address) ||
+                !getVarint(&position, end, &port) || !getVarint(&position, end, &records) ||
+                !getVarint(&position, end, &bytes) || bytes > (u_int64_t) (end - position)) {
+                return -1;
+            }
+
+            groupEnd = position + bytes;
+
+            if (hasClient && groupClient != clientID) {
+                position = groupEnd;
+                continue;
+            }
+
+            for (u_int64_t record = 0; record < records; record++) {
+                u_int64_t packetDelta;
+                u_int64_t arrivalDelta;
+
+                if (!getVarint(&position, groupEnd, &packetDelta) || !getVarint(&position, groupEnd, &arrivalDelta)) {
+                    return -1;
+                }
+
+                packetID += unzigzag(packetDelta);
+                arrival += unzigzag(arrivalDelta);
+
+                if ((u_int32_t) arrival >= from && (u_int32_t) arrival <= to) {
+                    handler((u_int32_t) groupClient, (u_int32_t) packetID, (u_int32_t) arrival, context);
+                }
+            }
+
+            position = groupEnd;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include "packetBitset.h"
+
+static size_t nextBit(const struct packet_bitset *bitset, size_t from, size_t to, uint64_t flip);
+
+int createPacketBitset(const struct dc_posix_env *env, struct dc_error *err, struct packet_bitset *bitset, size_t bits) {
+    bitset->bits = bits;
+    bitset->wordCount = (bits + 63) / 64;
+    bitset->words = dc_calloc(env, err, bitset->wordCount > 0 ? bitset->wordCount : 1, sizeof(uint64_t));
+
+    return bitset->words == NULL ? -1 : 0;
+}
+
+void destroyPacketBitset(const struct dc_posix_env *env, struct packet_bitset *bitset) {
+    if (bitset->words != NULL) {
+        dc_free(env, bitset->words, (bitset->wordCount > 0 ? bitset->wordCount : 1) * sizeof(uint64_t));
+    }
+
+    bitset->words = NULL;
+}
+
+int growPacketBitset(const struct dc_posix_env *env, struct dc_error *err, struct packet_bitset *bitset, size_t bits) {
+    size_t wordCount = (bits + 63) / 64;
+    size_t oldCount = bitset->wordCount > 0 ? bitset->wordCount : 1;
+    uint64_t *words;
+
+    if (bits <= bitset->bits) {
+        return 0;
+    }
+
+    // Double at least, so a bitset that grows one packet at a time is reallocated O(log n) times.
+    if (wordCount < oldCount * 2) {
+        wordCount = oldCount * 2;
+    }
+
+    words = dc_realloc(env, err, bitset->words, wordCount * sizeof(uint64_t));
+
+    if (words == NULL) {
+        return -1;
+    }
+
+    dc_memset(env, words + oldCount, 0, (wordCount - oldCount) * sizeof(uint64_t));
+    bitset->words = words;
+    bitset->wordCount = wordCount;
+    bitset->bits = wordCount * 64;
+
+    return 0;
+}
+
+bool markPacket(struct packet_bitset *bitset, size_t packetID) {
+    uint64_t mask = UINT64_C(1) << (packetID % 64);
+    bool marked = (bitset->words[packetID / 64] & mask) != 0;
+
+    bitset->words[packetID / 64] |= mask;
+    return marked;
+}
+
+void markPackets(struct packet_bitset *bitset, const u_int32_t *packetIDs, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (packetIDs[i] < bitset->bits) {
+            bitset->words[packetIDs[i] / 64] |= UINT64_C(1) << (packetIDs[i] % 64);
+        }
+    }
+}
+
+size_t countMarked(const struct packet_bitset *bitset, size_t from, size_t to) {
+    size_t count = 0;
+
+    if (to > bitset->bits) {
+        to = bitset->bits;
+    }
+
+    if (from >= to) {
+        return 0;
+    }
+
+    for (size_t word = from / 64; word <= (to - 1) / 64; word++) {
+        uint64_t bits = bitset->words[word];
+
+        // Trim the partial words at either end of the range.
+        if (word == from / 64) {
+            bits &= ~UINT64_C(0) << (from % 64);
+        }
+
+        if (word == (to - 1) / 64 && to % 64 != 0) {
+            bits &= ~(~UINT64_C(0) << (to % 64));
+        }
+
+        count += (size_t) __builtin_popcountll(bits);
+    }
+
+    return count;
+}
+
+static size_t nextBit(const struct packet_bitset *bitset, size_t from, size_t to, uint64_t flip) {
+    if (to > bitset->bits) {
+        to = bitset->bits;
+    }
+
+    while (from < to) {
+        size_t word = from / 64;
+        // flip turns the search for zeros into a search for ones.
+        uint64_t bits = (bitset->words[word] ^ flip) & (~UINT64_C(0) << (from % 64));
+
+        if (bits != 0) {
+            size_t found = word * 64 + (size_t) __builtin_ctzll(bits);
+
+            return found < to ? found : to;
+        }
+
+        from = (word + 1) * 64;
+    }
+
+    return to;
+}
+
+size_t nextUnmarked(const struct packet_bitset *bitset, size_t from, size_t to) {
+    return nextBit(bitset, from, to, ~UINT64_C(0));
+}
+
+size_t nextMarked(const struct packet_bitset *bitset, size_t from, size_t to) {
+    return nextBit(bitset, from, to, 0);
+}
+
+size_t unmarkedRuns(const struct packet_bitset *bitset, size_t from, size_t to, size_t *shortest, size_t *longest) {
+    size_t runs = 0;
+
+    *shortest = 0;
+    *longest = 0;
+
+    if (to > bitset->bits) {
+        to = bitset->bits;
+    }
+
+    from = nextUnmarked(bitset, from, to);
+
+    while (from < to) {
+        size_t end = nextMarked(bitset, from, to);
+        size_t length = end - from;
+
+        if (runs == 0 || length < *shortest) {
+            *shortest = length;
+        }
+
+        if (length > *longest) {
+            *longest = length;
+        }
+
+        runs++;
+        from = nextUnmarked(bitset, end, to);
+    }
+
+    return runs;
+}
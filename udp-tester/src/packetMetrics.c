@@ -0,0 +1,185 @@
+#include "packetMetrics.h"
+
+static int addPackets(const struct dc_posix_env *env, struct dc_error *err, struct packet_metrics *metrics,
+        struct packet_bitset *seen, const struct client_record *record);
+
+void startPacketMetrics(struct packet_metrics *metrics) {
+    memset(metrics, 0, sizeof(*metrics));
+}
+
+size_t metricBucket(u_int64_t length) {
+    size_t bucket = 0;
+
+    while (length > 1 && bucket + 1 < METRIC_HISTOGRAM_BUCKETS) {
+        length >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+void addPacketMetric(struct packet_metrics *metrics, struct packet_bitset *seen, u_int32_t packetID, u_int32_t arrival) {
+    if (markPacket(seen, packetID)) {
+        metrics->duplicates++;
+    } else {
+        metrics->unique++;
+
+        // Duplicates are not counted as reordered, RFC 4737 assumes they were discarded.
+        if (packetID >= metrics->nextExpected) {
+            metrics->nextExpected = packetID + 1;
+        } else {
+            u_int64_t distance = metrics->nextExpected - packetID;
+
+            metrics->reordered++;
+            metrics->reorderHistogram[metricBucket(distance)]++;
+
+            if (distance > metrics->longestReorderDistance) {
+                metrics->longestReorderDistance = distance;
+            }
+        }
+    }
+
+    if (metrics->received > 0 && packetID < metrics->previous) {
+        metrics->outOfOrder++;
+
+        if (metrics->outOfOrderRun > 0 && packetID + 1 == metrics->previousOutOfOrder) {
+            metrics->outOfOrderRun++;
+        } else {
+            if (metrics->outOfOrderRun > 0 &&
+                (metrics->shortestClosedRun == 0 || metrics->outOfOrderRun < metrics->shortestClosedRun)) {
+                metrics->shortestClosedRun = metrics->outOfOrderRun;
+            }
+
+            metrics->outOfOrderRun = 1;
+        }
+
+        if (metrics->outOfOrderRun > metrics->longestOutOfOrderRun) {
+            metrics->longestOutOfOrderRun = metrics->outOfOrderRun;
+        }
+
+        metrics->previousOutOfOrder = packetID;
+    }
+
+    if (arrival != 0 && metrics->previousArrival != 0) {
+        int64_t gap = (int64_t) arrival - (int64_t) metrics->previousArrival;
+
+        // The RFC 3550 estimator, with the gap to the previous packet standing in for the transit time.
+        if (metrics->received > 1) {
+            int64_t change = gap - metrics->previousGap;
+
+            metrics->jitter += ((double) (change < 0 ? -change : change) - metrics->jitter) / METRIC_JITTER_GAIN;
+        }
+
+        metrics->previousGap = gap;
+    }
+
+    metrics->previousArrival = arrival;
+    metrics->previous = packetID;
+    metrics->received++;
+}
+
+bool acceptPacketID(struct packet_metrics *metrics, u_int32_t expected, u_int32_t packetID) {
+    u_int64_t highest = expected > metrics->nextExpected ? expected : metrics->nextExpected;
+
+    if ((u_int64_t) packetID > highest + METRIC_PACKET_MARGIN) {
+        metrics->malformed++;
+        return false;
+    }
+
+    return true;
+}
+
+void finishPacketMetrics(struct packet_metrics *metrics, const struct packet_bitset *seen, size_t firstPacket,
+        size_t lastPacket) {
+    size_t to = lastPacket + 1 < seen->bits ? lastPacket + 1 : seen->bits;
+    size_t run = metrics->outOfOrderRun;
+
+    metrics->firstPacket = firstPacket;
+    metrics->expected = lastPacket >= firstPacket ? lastPacket - firstPacket + 1 : 0;
+    metrics->lost = 0;
+    metrics->lossRuns = 0;
+    metrics->shortestLossRun = 0;
+    metrics->longestLossRun = 0;
+    memset(metrics->lossHistogram, 0, sizeof(metrics->lossHistogram));
+
+    // Numbers past the end of the bitset were never seen, so they close the last run.
+    for (size_t start = to > firstPacket ? nextUnmarked(seen, firstPacket, to) : firstPacket; start <= lastPacket;) {
+        size_t end = start + 1 < to ? nextMarked(seen, start + 1, to) : to;
+        u_int64_t length;
+
+        if (end >= to) {
+            end = lastPacket + 1;
+        }
+
+        length = end - start;
+        metrics->lost += length;
+        metrics->lossRuns++;
+        metrics->lossHistogram[metricBucket(length)]++;
+
+        if (metrics->shortestLossRun == 0 || length < metrics->shortestLossRun) {
+            metrics->shortestLossRun = length;
+        }
+
+        if (length > metrics->longestLossRun) {
+            metrics->longestLossRun = length;
+        }
+
+        start = end <= lastPacket ? nextUnmarked(seen, end, to) : end;
+    }
+
+    metrics->shortestOutOfOrderRun = metrics->shortestClosedRun;
+
+    if (run > 0 && (metrics->shortestOutOfOrderRun == 0 || run < metrics->shortestOutOfOrderRun)) {
+        metrics->shortestOutOfOrderRun = run;
+    }
+}
+
+static int addPackets(const struct dc_posix_env *env, struct dc_error *err, struct packet_metrics *metrics,
+        struct packet_bitset *seen, const struct client_record *record) {
+    if (createPacketBitset(env, err, seen, (size_t) record->expectedNumberOfPackets + 1) == -1) {
+        return -1;
+    }
+
+    startPacketMetrics(metrics);
+
+    for (size_t i = 0; i < record->receivedNumberOfPackets; i++) {
+        if (!acceptPacketID(metrics, record->expectedNumberOfPackets, record->packetIDs[i])) {
+            continue;
+        }
+
+        // Packets numbered past the expected count still need a bit to be told apart from duplicates.
+        if (growPacketBitset(env, err, seen, (size_t) record->packetIDs[i] + 1) == -1) {
+            return -1;
+        }
+
+        addPacketMetric(metrics, seen, record->packetIDs[i], record->arrivals[i]);
+    }
+
+    return 0;
+}
+
+int measurePackets(const struct dc_posix_env *env, struct dc_error *err, struct packet_metrics *metrics,
+        struct packet_bitset *seen, const struct client_record *record) {
+    if (addPackets(env, err, metrics, seen, record) == -1) {
+        return -1;
+    }
+
+    finishPacketMetrics(metrics, seen, 1, record->expectedNumberOfPackets);
+    return 0;
+}
+
+int measurePacketSlice(const struct dc_posix_env *env, struct dc_error *err, struct packet_metrics *metrics,
+        struct packet_bitset *seen, const struct client_record *record) {
+    if (addPackets(env, err, metrics, seen, record) == -1) {
+        return -1;
+    }
+
+    // The highest number is one past NextExp; the lowest is the first marked bit.
+    if (metrics->unique == 0) {
+        finishPacketMetrics(metrics, seen, 1, 0);
+    } else {
+        finishPacketMetrics(metrics, seen, nextMarked(seen, 0, seen->bits), metrics->nextExpected - 1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "packetSender.h"
+
+static double senderSeconds(void);
+static void sleepUntil(double start, double offset);
+
+static double senderSeconds(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1000000000.0;
+}
+
+static void sleepUntil(double start, double offset) {
+    struct timespec ts;
+    double wake = start + offset;
+
+    ts.tv_sec = (time_t) wake;
+    ts.tv_nsec = (long) ((wake - (double) ts.tv_sec) * 1000000000.0);
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+int sendPackets(const struct dc_posix_env *env, struct dc_error *err, const struct packet_sender *sender) {
+    struct mmsghdr messages[SENDER_BATCH];
+    struct iovec iovecs[SENDER_BATCH];
+    struct sockaddr_in destination = sender->destination;
+    u_int16_t packetSize = sender->packetSize < SENDER_MIN_PACKET ? SENDER_MIN_PACKET : sender->packetSize;
+    char *packets;
+    u_int32_t sent = 0;
+    double start;
+
+    packets = dc_malloc(env, err, (size_t) packetSize * SENDER_BATCH);
+
+    if (packets == NULL) {
+        return -1;
+    }
+
+    // Only the header changes between packets, so the body is filled once per slot.
+    for (size_t i = 0; i < SENDER_BATCH; i++) {
+        char *packet = packets + i * packetSize;
+
+        dc_memset(env, packet + SENDER_HEADER, '*', packetSize - SENDER_HEADER - 1);
+        packet[packetSize - 1] = '\n';
+        iovecs[i].iov_base = packet;
+        iovecs[i].iov_len = packetSize;
+        dc_memset(env, &messages[i], 0, sizeof(messages[i]));
+        messages[i].msg_hdr.msg_iov = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+        messages[i].msg_hdr.msg_name = &destination;
+        messages[i].msg_hdr.msg_namelen = sizeof(destination);
+    }
+
+    start = senderSeconds();
+
+    while (sent < sender->packets) {
+        u_int32_t batch = sender->packets - sent;
+        int result;
+
+        if (batch > SENDER_BATCH) {
+            batch = SENDER_BATCH;
+        }
+
+        if (sender->rate > 0) {
+            u_int32_t due = (u_int32_t) ((senderSeconds() - start) * (double) sender->rate);
+
+            // Nothing is due yet; sleep until the next packet's slot.
+            if (due <= sent) {
+                sleepUntil(start, (double) (sent + 1) / (double) sender->rate);
+                continue;
+            }
+
+            if (due - sent < batch) {
+                batch = due - sent;
+            }
+        }
+
+        for (u_int32_t i = 0; i < batch; i++) {
+            char header[FORMAT_HEADER_LENGTH];
+
+            formatPacketHeader(header, sender->clientID, sent + i + 1);
+            hotCopy(packets + i * packetSize, header, SENDER_HEADER);
+        }
+
+        result = sendmmsg(sender->socketFD, messages, batch, 0);
+
+        if (result == -1) {
+            // A full device queue is transient; give it a moment and retry the same batch.
+            if (errno == ENOBUFS || errno == EAGAIN || errno == EINTR) {
+                sleepUntil(senderSeconds(), 0.0001);
+                continue;
+            }
+
+            DC_ERROR_RAISE_ERRNO(err, errno);
+            dc_free(env, packets, (size_t) packetSize * SENDER_BATCH);
+            return -1;
+        }
+
+        sent += (u_int32_t) result;
+    }
+
+    dc_free(env, packets, (size_t) packetSize * SENDER_BATCH);
+    return (int) sent;
+}
@@ -0,0 +1,194 @@
+#include "parallelParse.h"
+
+static void *parseChunk(void *arg);
+static void freePartial(const struct dc_posix_env *env, struct client_record *partial);
+static void freePartials(const struct dc_posix_env *env, struct client_record *partials, size_t count);
+
+size_t parseThreadCount(size_t requested) {
+    if (requested == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+
+        requested = online > 0 ? (size_t) online : 1;
+    }
+
+    return requested > MAX_PARSE_THREADS ? MAX_PARSE_THREADS : requested;
+}
+
+static void *parseChunk(void *arg) {
+    struct parse_chunk *chunk = (struct parse_chunk *) arg;
+    struct log_cursor cursor;
+    struct log_span line;
+    struct log_time_cache times = {{0}, 0, false};
+
+    startCursor(&cursor, chunk->range.data, chunk->range.length);
+
+    while (nextLine(&cursor, &line)) {
+        struct client_record *record;
+        u_int32_t clientID;
+        u_int32_t packetID;
+        u_int32_t arrival;
+
+        if (!parseUdpLine(line, &clientID, &packetID, &times, &arrival) || (record = findClient(chunk->table, clientID)) == NULL) {
+            continue;
+        }
+
+        // The shared table is only read; packets go to this chunk's copy of the client.
+        if (appendPacket(chunk->env, &chunk->err, &chunk->partials[record - chunk->table->records], packetID,
+                         arrival) == -1) {
+            chunk->status = -1;
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+static void freePartial(const struct dc_posix_env *env, struct client_record *partial) {
+    if (partial->packetIDs != NULL) {
+        dc_free(env, partial->packetIDs, partial->packetCapacity * sizeof(u_int32_t));
+    }
+
+    if (partial->arrivals != NULL) {
+        dc_free(env, partial->arrivals, partial->packetCapacity * sizeof(u_int32_t));
+    }
+
+    partial->packetIDs = NULL;
+    partial->arrivals = NULL;
+}
+
+static void freePartials(const struct dc_posix_env *env, struct client_record *partials, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        freePartial(env, &partials[i]);
+    }
+
+    dc_free(env, partials, count * sizeof(struct client_record));
+}
+
+int parseUdpLogParallel(const struct dc_posix_env *env, struct dc_error *err, struct client_table *table,
+        const char *data, size_t length, size_t threads) {
+    struct parse_chunk *chunks;
+    pthread_t *ids;
+    const char *end = data + length;
+    const char *start = data;
+    size_t started = 0;
+    int ret_val = 0;
+
+    if (length == 0 || table->count == 0) {
+        return 0;
+    }
+
+    // Tiny logs are not worth a thread each.
+    if (threads > length / 4096 + 1) {
+        threads = length / 4096 + 1;
+    }
+
+    chunks = dc_calloc(env, err, threads, sizeof(struct parse_chunk));
+    ids = dc_calloc(env, err, threads, sizeof(pthread_t));
+
+    if (chunks == NULL || ids == NULL) {
+        if (chunks != NULL) {
+            dc_free(env, chunks, threads * sizeof(struct parse_chunk));
+        }
+
+        if (ids != NULL) {
+            dc_free(env, ids, threads * sizeof(pthread_t));
+        }
+
+        return -1;
+    }
+
+    for (size_t i = 0; i < threads; i++) {
+        const char *stop = i + 1 == threads ? end : data + length / threads * (i + 1);
+
+        // Move the cut forward to just past a newline so no line is split between chunks.
+        if (stop < start) {
+            stop = start;
+        }
+
+        if (stop < end) {
+            stop = findByte(stop, end, '\n');
+            stop = stop < end ? stop + 1 : end;
+        }
+
+        chunks[i].env = env;
+        dc_error_init(&chunks[i].err, NULL);
+        chunks[i].table = table;
+        chunks[i].range.data = start;
+        chunks[i].range.length = (size_t) (stop - start);
+        chunks[i].partials = dc_calloc(env, err, table->count, sizeof(struct client_record));
+
+        if (chunks[i].partials == NULL) {
+            ret_val = -1;
+            break;
+        }
+
+        start = stop;
+    }
+
+    // The first chunk runs on this thread, the others on their own.
+    for (size_t i = 1; ret_val == 0 && i < threads; i++) {
+        if (pthread_create(&ids[i], NULL, parseChunk, &chunks[i]) != 0) {
+            printf("Starting Parse Thread Failed -> Stopping Parse\n");
+            ret_val = -1;
+            break;
+        }
+
+        started = i;
+    }
+
+    if (ret_val == 0) {
+        parseChunk(&chunks[0]);
+    }
+
+    for (size_t i = 1; i <= started; i++) {
+        pthread_join(ids[i], NULL);
+    }
+
+    for (size_t i = 0; i < threads; i++) {
+        // Workers only fail allocating, so the first one to fail is passed on as an errno error.
+        if (chunks[i].status == -1) {
+            if (dc_error_has_no_error(err) && dc_error_has_error(&chunks[i].err)) {
+                dc_error_errno(err, chunks[i].err.file_name, chunks[i].err.function_name, chunks[i].err.line_number,
+                               chunks[i].err.errno_code);
+            }
+
+            ret_val = -1;
+        }
+    }
+
+    // Concatenating the chunks in file order gives every client its packets in log order. Each client is sized
+    // once and its per-thread arrays are freed as soon as they are copied, so only one client is held twice.
+    for (size_t client = 0; ret_val == 0 && client < table->count; client++) {
+        size_t total = 0;
+
+        for (size_t i = 0; i < threads; i++) {
+            total += chunks[i].partials[client].receivedNumberOfPackets;
+        }
+
+        if (reserveClientPackets(env, err, &table->records[client], total) == -1) {
+            ret_val = -1;
+            break;
+        }
+
+        for (size_t i = 0; i < threads; i++) {
+            struct client_record *partial = &chunks[i].partials[client];
+
+            appendPackets(env, err, &table->records[client], partial->packetIDs, partial->arrivals,
+                          partial->receivedNumberOfPackets);
+            freePartial(env, partial);
+        }
+    }
+
+    for (size_t i = 0; i < threads; i++) {
+        if (chunks[i].partials != NULL) {
+            freePartials(env, chunks[i].partials, table->count);
+        }
+
+        dc_error_reset(&chunks[i].err);
+    }
+
+    dc_free(env, ids, threads * sizeof(pthread_t));
+    dc_free(env, chunks, threads * sizeof(struct parse_chunk));
+
+    return ret_val;
+}
@@ -0,0 +1,381 @@
+#include "parserBench.h"
+
+struct application_settings {
+    struct dc_opt_settings opts;
+    struct dc_setting_string *message;
+    struct dc_setting_string *parser;
+    struct dc_setting_string *tcpLog;
+    struct dc_setting_string *udpLog;
+    struct dc_setting_uint16 *runs;
+    struct dc_setting_string *args;
+    struct dc_setting_string *label;
+    struct dc_setting_string *csv;
+};
+
+static struct dc_application_settings *create_settings(const struct dc_posix_env *env, struct dc_error *err);
+static int destroy_settings(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings **psettings);
+static int run(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings *settings);
+static void error_reporter(const struct dc_error *err);
+static void trace_reporter(const struct dc_posix_env *env, const char *file_name, const char *function_name, size_t line_number);
+static int compareRuns(const void *left, const void *right);
+static void printRun(const char *name, const struct parser_bench *bench, const struct bench_run *run);
+
+int main(int argc, char *argv[]) {
+    dc_posix_tracer tracer;
+    dc_error_reporter reporter;
+    struct dc_posix_env env;
+    struct dc_error err;
+    struct dc_application_info *info;
+    int ret_val;
+
+    reporter = error_reporter;
+//    tracer = trace_reporter;
+    tracer = NULL;
+    dc_error_init(&err, reporter);
+    dc_posix_env_init(&env, tracer);
+    info = dc_application_info_create(&env, &err, "Settings Application");
+    ret_val = dc_application_run(&env, &err, info, create_settings, destroy_settings,
+                                 run, dc_default_create_lifecycle, dc_default_destroy_lifecycle,
+                                 NULL, argc, argv);
+    dc_application_info_destroy(&env, &info);
+    dc_error_reset(&err);
+
+    return ret_val;
+}
+
+static struct dc_application_settings *create_settings(const struct dc_posix_env *env, struct dc_error *err) {
+    struct application_settings *settings;
+
+    static const uint16_t default_runs = DEFAULT_BENCH_RUNS;
+
+    DC_TRACE(env);
+    settings = dc_malloc(env, err, sizeof(struct application_settings));
+
+    if(settings == NULL) {
+        return NULL;
+    }
+
+    settings->opts.parent.config_path = dc_setting_path_create(env, err);
+    settings->message = dc_setting_string_create(env, err);
+    settings->parser = dc_setting_string_create(env, err);
+    settings->tcpLog = dc_setting_string_create(env, err);
+    settings->udpLog = dc_setting_string_create(env, err);
+    settings->runs = dc_setting_uint16_create(env, err);
+    settings->args = dc_setting_string_create(env, err);
+    settings->label = dc_setting_string_create(env, err);
+    settings->csv = dc_setting_string_create(env, err);
+
+    struct options opts[] = {
+            {(struct dc_setting *)settings->opts.parent.config_path,
+                    dc_options_set_path,
+                    "config",
+                    required_argument,
+                    'c',
+                    "CONFIG",
+                    dc_string_from_string,
+                    NULL,
+                    dc_string_from_config,
+                    NULL},
+            {(struct dc_setting *)settings->message,
+                    dc_options_set_string,
+                    "message",
+                    required_argument,
+                    'm',
+                    "MESSAGE",
+                    dc_string_from_string,
+                    "message",
+                    dc_string_from_config,
+                    "Hello, Default World!"},
+            {(struct dc_setting *)settings->parser,
+                    dc_options_set_string,
+                    "parser",
+                    required_argument,
+                    'P',
+                    "PARSER",
+                    dc_string_from_string,
+                    "parser",
+                    dc_string_from_config,
+                    DEFAULT_PARSER_PROGRAM},
+            {(struct dc_setting *)settings->tcpLog,
+                    dc_options_set_string,
+                    "tcp-log",
+                    required_argument,
+                    't',
+                    "TCP_LOG",
+                    dc_string_from_string,
+                    "tcp-log",
+                    dc_string_from_config,
+                    DEFAULT_BENCH_TCP_LOG},
+            {(struct dc_setting *)settings->udpLog,
+                    dc_options_set_string,
+                    "udp-log",
+                    required_argument,
+                    'u',
+                    "UDP_LOG",
+                    dc_string_from_string,
+                    "udp-log",
+                    dc_string_from_config,
+                    DEFAULT_BENCH_UDP_LOG},
+            {(struct dc_setting *)settings->runs,
+                    dc_options_set_uint16,
+                    "runs",
+                    required_argument,
+                    'n',
+                    "RUNS",
+                    dc_uint16_from_string,
+                    "runs",
+                    dc_uint16_from_config,
+                    &default_runs},
+            {(struct dc_setting *)settings->args,
+                    dc_options_set_string,
+                    "args",
+                    required_argument,
+                    'a',
+                    "ARGS",
+                    dc_string_from_string,
+                    "args",
+                    dc_string_from_config,
+                    DEFAULT_BENCH_ARGS},
+            {(struct dc_setting *)settings->label,
+                    dc_options_set_string,
+                    "label",
+                    required_argument,
+                    'L',
+                    "LABEL",
+                    dc_string_from_string,
+                    "label",
+                    dc_string_from_config,
+                    DEFAULT_BENCH_LABEL},
+            {(struct dc_setting *)settings->csv,
+                    dc_options_set_string,
+                    "csv",
+                    required_argument,
+                    'v',
+                    "CSV",
+                    dc_string_from_string,
+                    "csv",
+                    dc_string_from_config,
+                    DEFAULT_BENCH_CSV},
+    };
+
+    settings->opts.opts_count = (sizeof(opts) / sizeof(struct options)) + 1;
+    settings->opts.opts_size = sizeof(struct options);
+    settings->opts.opts = dc_calloc(env, err, settings->opts.opts_count, settings->opts.opts_size);
+    dc_memcpy(env, settings->opts.opts, opts, sizeof(opts));
+    settings->opts.flags = "m:";
+    settings->opts.env_prefix = "DC_EXAMPLE_";
+
+    return (struct dc_application_settings *)settings;
+}
+
+static int destroy_settings(const struct dc_posix_env *env, __attribute__((unused)) struct dc_error *err,
+                            struct dc_application_settings **psettings) {
+    struct application_settings *app_settings;
+
+    DC_TRACE(env);
+    app_settings = (struct application_settings *)*psettings;
+    dc_setting_string_destroy(env, &app_settings->message);
+    dc_free(env, app_settings->opts.opts, app_settings->opts.opts_count);
+    dc_free(env, *psettings, sizeof(struct application_settings));
+
+    if(env->null_free) {
+        *psettings = NULL;
+    }
+
+    return 0;
+}
+
+int measureLog(const struct dc_posix_env *env, struct dc_error *err, struct parser_bench *bench) {
+    char buffer[1024 * 1024];
+    ssize_t bytes;
+    int fd = dc_open(env, err, bench->udpLog, O_RDONLY, 0);
+
+    if (dc_error_has_error(err)) {
+        return -1;
+    }
+
+    bench->bytes = 0;
+    bench->records = 0;
+
+    // This read also leaves the log in the page cache, so the first timed run is not a cold one.
+    while ((bytes = read(fd, buffer, sizeof(buffer))) > 0) {
+        const char *current = buffer;
+        const char *end = buffer + bytes;
+
+        while ((current = memchr(current, '\n', (size_t) (end - current))) != NULL) {
+            bench->records++;
+            current++;
+        }
+
+        bench->bytes += (u_int64_t) bytes;
+    }
+
+    dc_close(env, err, fd);
+    return bytes == -1 ? -1 : 0;
+}
+
+int runParser(const struct dc_posix_env *env, struct dc_error *err, const struct parser_bench *bench,
+        struct bench_run *run) {
+    struct rusage usage;
+    double start = monotonicSeconds();
+    pid_t pid = spawnProcess(env, err, bench->argv, bench->nullFD);
+
+    if (pid == -1 || waitProcess(env, err, pid, &usage) != 0) {
+        return -1;
+    }
+
+    run->seconds = monotonicSeconds() - start;
+    run->cpuSeconds = rusageCpuSeconds(&usage);
+    return 0;
+}
+
+int appendBenchCsv(const char *path, const char *label, const struct parser_bench *bench, const struct bench_run *best,
+        const struct bench_run *median, size_t runs) {
+    struct stat status;
+    bool isNew = stat(path, &status) != 0 || status.st_size == 0;
+    FILE *file = fopen(path, "a");
+
+    if (file == NULL) {
+        return -1;
+    }
+
+    if (isNew) {
+        fprintf(file, "label,bytes,records,runs,best_seconds,median_seconds,median_cpu_seconds,mb_per_second,"
+                      "records_per_second\n");
+    }
+
+    fprintf(file, "%s,%" PRIu64 ",%" PRIu64 ",%zu,%.4f,%.4f,%.4f,%.1f,%.0f\n", label, bench->bytes,
+            bench->records, runs, best->seconds, median->seconds, median->cpuSeconds,
+            (double) bench->bytes / 1e6 / median->seconds, (double) bench->records / median->seconds);
+
+    return fclose(file) == 0 ? 0 : -1;
+}
+
+static int compareRuns(const void *left, const void *right) {
+    const struct bench_run *first = (const struct bench_run *) left;
+    const struct bench_run *second = (const struct bench_run *) right;
+
+    return (first->seconds > second->seconds) - (first->seconds < second->seconds);
+}
+
+static void printRun(const char *name, const struct parser_bench *bench, const struct bench_run *run) {
+    printf("%-8s %8.3f s  CPU %8.3f s  %9.1f MB/s  %8.2f M records/s\n", name, run->seconds, run->cpuSeconds,
+           (double) bench->bytes / 1e6 / run->seconds, (double) bench->records / 1e6 / run->seconds);
+}
+
+static int run(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings *settings) {
+    struct application_settings *app_settings;
+    struct parser_bench bench;
+    struct bench_run runs[MAX_BENCH_RUNS];
+    const char *args;
+    const char *label;
+    const char *csv;
+    char *save = NULL;
+    char *token;
+    size_t argc = 0;
+    size_t runCount;
+    int ret_val = EXIT_SUCCESS;
+
+    DC_TRACE(env);
+
+    app_settings = (struct application_settings *)settings;
+    dc_memset(env, &bench, 0, sizeof(bench));
+    bench.parserProgram = dc_setting_string_get(env, app_settings->parser);
+    bench.tcpLog = dc_setting_string_get(env, app_settings->tcpLog);
+    bench.udpLog = dc_setting_string_get(env, app_settings->udpLog);
+    runCount = dc_setting_uint16_get(env, app_settings->runs);
+    args = dc_setting_string_get(env, app_settings->args);
+    label = dc_setting_string_get(env, app_settings->label);
+    csv = dc_setting_string_get(env, app_settings->csv);
+
+    if (runCount == 0 || runCount > MAX_BENCH_RUNS) {
+        printf("Invalid Run Count -> Use 1-%d Runs\n", MAX_BENCH_RUNS);
+        return EXIT_FAILURE;
+    }
+
+    bench.argv[argc++] = bench.parserProgram;
+    bench.argv[argc++] = "--tcp-log";
+    bench.argv[argc++] = bench.tcpLog;
+    bench.argv[argc++] = "--udp-log";
+    bench.argv[argc++] = bench.udpLog;
+    bench.args = dc_malloc(env, err, dc_strlen(env, args) + 1);
+
+    if (bench.args == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    // Extra parser arguments such as "--threads 1" are passed through as separate words.
+    dc_strcpy(env, bench.args, args);
+
+    for (token = strtok_r(bench.args, " ", &save); token != NULL; token = strtok_r(NULL, " ", &save)) {
+        if (argc == MAX_BENCH_ARGS + 5) {
+            printf("Too Many Parser Arguments -> Closing Parser Bench\n");
+            dc_free(env, bench.args, dc_strlen(env, args) + 1);
+            return EXIT_FAILURE;
+        }
+
+        bench.argv[argc++] = token;
+    }
+
+    bench.argv[argc] = NULL;
+
+    if (measureLog(env, err, &bench) == -1) {
+        printf("Reading UDP Log Failed -> Closing Parser Bench\n");
+        dc_free(env, bench.args, dc_strlen(env, args) + 1);
+        return EXIT_FAILURE;
+    }
+
+    bench.nullFD = dc_open(env, err, "/dev/null", O_WRONLY, 0);
+
+    if (bench.nullFD == -1) {
+        printf("Opening /dev/null Failed -> Closing Parser Bench\n");
+        dc_free(env, bench.args, dc_strlen(env, args) + 1);
+        return EXIT_FAILURE;
+    }
+
+    printf("%s: %.1f MB, %" PRIu64 " records, %zu runs\n", bench.udpLog, (double) bench.bytes / 1e6,
+           bench.records, runCount);
+
+    for (size_t i = 0; i < runCount; i++) {
+        char name[16];
+
+        if (runParser(env, err, &bench, &runs[i]) == -1) {
+            printf("%s Failed -> Closing Parser Bench\n", bench.parserProgram);
+            ret_val = EXIT_FAILURE;
+            break;
+        }
+
+        snprintf(name, sizeof(name), "Run %zu", i + 1);
+        printRun(name, &bench, &runs[i]);
+    }
+
+    dc_close(env, err, bench.nullFD);
+    dc_free(env, bench.args, dc_strlen(env, args) + 1);
+
+    if (ret_val == EXIT_FAILURE) {
+        return ret_val;
+    }
+
+    // The median is the figure to compare; the best shows how much of it is noise.
+    qsort(runs, runCount, sizeof(struct bench_run), compareRuns);
+    printf("----------------------------------------\n");
+    printRun("Best", &bench, &runs[0]);
+    printRun("Median", &bench, &runs[runCount / 2]);
+
+    if (csv[0] != '\0' && appendBenchCsv(csv, label, &bench, &runs[0], &runs[runCount / 2], runCount) == -1) {
+        printf("Could not write %s\n", csv);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static void error_reporter(const struct dc_error *err) {
+    fprintf(stderr, "ERROR: %s : %s : @ %zu : %d\n", err->file_name, err->function_name, err->line_number, 0);
+    fprintf(stderr, "ERROR: %s\n", err->message);
+}
+
+static void trace_reporter(__attribute__((unused)) const struct dc_posix_env *env, const char *file_name,
+                           const char *function_name, size_t line_number) {
+    fprintf(stdout, "TRACE: %s : %s : @ %zu\n", file_name, function_name, line_number);
+}
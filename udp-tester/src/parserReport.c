@@ -0,0 +1,367 @@
+#include "parserReport.h"
+
+static void reportLostRanges(struct report_writer *writer, const struct packet_bitset *seen,
+        const struct packet_metrics *metrics);
+static void reportOutOfOrder(struct report_writer *writer, const struct client_record *record, const char *separator,
+        size_t width);
+static void reportHistogramText(struct report_writer *writer, const char *title, const u_int64_t *histogram);
+static void reportHistogramJson(struct report_writer *writer, const char *name, const u_int64_t *histogram);
+static void reportJsonField(struct report_writer *writer, const char *name, u_int64_t value);
+static void reportTextClient(struct report_writer *writer, const struct client_record *record,
+        const struct packet_metrics *metrics, const struct packet_bitset *seen);
+static void reportJsonClient(struct report_writer *writer, const struct client_record *record,
+        const struct packet_metrics *metrics, const struct packet_bitset *seen, size_t index);
+static void reportCsvClient(struct report_writer *writer, const struct client_record *record,
+        const struct packet_metrics *metrics, const struct packet_bitset *seen);
+
+bool reportFormatFromString(const char *name, enum report_format *format) {
+    if (strcmp(name, "text") == 0) {
+        *format = REPORT_TEXT;
+    } else if (strcmp(name, "json") == 0) {
+        *format = REPORT_JSON;
+    } else if (strcmp(name, "csv") == 0) {
+        *format = REPORT_CSV;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+static void reportLostRanges(struct report_writer *writer, const struct packet_bitset *seen,
+        const struct packet_metrics *metrics) {
+    size_t to = metrics->firstPacket + metrics->expected;
+    bool first = true;
+
+    // Only the summary from an index comes without the packets themselves.
+    if (seen == NULL) {
+        return;
+    }
+
+    // Each run of lost numbers is found a word at a time and written as one range; past the bitset all are lost.
+    for (size_t start = nextUnmarked(seen, metrics->firstPacket, to); start < to;) {
+        size_t end = start + 1 < seen->bits ? nextMarked(seen, start + 1, to) : to;
+
+        if (end >= seen->bits) {
+            end = to;
+        }
+
+        if (!first) {
+            reportBytes(writer, ",", 1);
+        }
+
+        reportUnsigned(writer, start, 0);
+
+        if (end - start > 1) {
+            reportBytes(writer, "-", 1);
+            reportUnsigned(writer, end - 1, 0);
+        }
+
+        first = false;
+        start = end < to ? nextUnmarked(seen, end, to) : to;
+    }
+}
+
+static void reportOutOfOrder(struct report_writer *writer, const struct client_record *record, const char *separator,
+        size_t width) {
+    bool first = true;
+
+    if (record->packetIDs == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i + 1 < record->receivedNumberOfPackets; i++) {
+        if (record->packetIDs[i + 1] < record->packetIDs[i]) {
+            if (!first) {
+                reportString(writer, separator);
+            }
+
+            reportUnsigned(writer, record->packetIDs[i + 1], width);
+            first = false;
+        }
+    }
+}
+
+static void reportHistogramText(struct report_writer *writer, const char *title, const u_int64_t *histogram) {
+    reportString(writer, title);
+    reportBytes(writer, ":", 1);
+
+    // Bucket k holds lengths 2^k to 2^(k+1) - 1; empty buckets are left out.
+    for (size_t bucket = 0; bucket < METRIC_HISTOGRAM_BUCKETS; bucket++) {
+        u_int64_t low = (u_int64_t) 1 << bucket;
+
+        if (histogram[bucket] == 0) {
+            continue;
+        }
+
+        reportBytes(writer, " ", 1);
+        reportUnsigned(writer, low, 0);
+
+        if (bucket + 1 == METRIC_HISTOGRAM_BUCKETS) {
+            reportBytes(writer, "+", 1);
+        } else if (bucket > 0) {
+            reportBytes(writer, "-", 1);
+            reportUnsigned(writer, low * 2 - 1, 0);
+        }
+
+        reportBytes(writer, "=", 1);
+        reportUnsigned(writer, histogram[bucket], 0);
+    }
+
+    reportBytes(writer, "\n", 1);
+}
+
+static void reportHistogramJson(struct report_writer *writer, const char *name, const u_int64_t *histogram) {
+    reportJsonString(writer, name);
+    reportBytes(writer, ":[", 2);
+
+    for (size_t bucket = 0; bucket < METRIC_HISTOGRAM_BUCKETS; bucket++) {
+        if (bucket > 0) {
+            reportBytes(writer, ",", 1);
+        }
+
+        reportUnsigned(writer, histogram[bucket], 0);
+    }
+
+    reportBytes(writer, "]", 1);
+}
+
+static void reportJsonField(struct report_writer *writer, const char *name, u_int64_t value) {
+    reportBytes(writer, ",", 1);
+    reportJsonString(writer, name);
+    reportBytes(writer, ":", 1);
+    reportUnsigned(writer, value, 0);
+}
+
+static void reportTextClient(struct report_writer *writer, const struct client_record *record,
+        const struct packet_metrics *metrics, const struct packet_bitset *seen) {
+    reportString(writer, "Client ");
+    reportString(writer, record->name);
+    reportString(writer, ":\nPackets Expected = ");
+    reportUnsigned(writer, metrics->expected, 0);
+    reportString(writer, "\nPackets Received = ");
+    reportUnsigned(writer, record->receivedNumberOfPackets, 0);
+    reportString(writer, "\nPackets Lost = ");
+    reportSigned(writer, (int64_t) metrics->expected - (int64_t) record->receivedNumberOfPackets);
+    reportString(writer, "\n" REPORT_SEPARATOR "Packet Numbers Lost:\n");
+
+    if (metrics->lost > 0 && seen != NULL) {
+        reportLostRanges(writer, seen, metrics);
+        reportBytes(writer, "\n", 1);
+    }
+
+    reportString(writer, REPORT_SEPARATOR "Number of Packets Out Of Order: ");
+    reportUnsigned(writer, metrics->outOfOrder, 0);
+    reportString(writer, "\n" REPORT_SEPARATOR "Packet Numbers Out Of Order:\n");
+
+    if (metrics->outOfOrder > 0 && record->packetIDs != NULL) {
+        reportOutOfOrder(writer, record, "\n", 6);
+        reportBytes(writer, "\n", 1);
+    }
+
+    reportString(writer, REPORT_SEPARATOR "Duplicate Packets: ");
+    reportUnsigned(writer, metrics->duplicates, 0);
+    reportString(writer, "\nReordered Packets (RFC 4737): ");
+    reportUnsigned(writer, metrics->reordered, 0);
+    reportString(writer, "\nMaximum Reorder Distance: ");
+    reportUnsigned(writer, metrics->longestReorderDistance, 0);
+    reportBytes(writer, "\n", 1);
+    reportHistogramText(writer, "Reorder Distances", metrics->reorderHistogram);
+    reportString(writer, "Loss Bursts: ");
+    reportUnsigned(writer, metrics->lossRuns, 0);
+    reportBytes(writer, "\n", 1);
+    reportHistogramText(writer, "Loss Burst Lengths", metrics->lossHistogram);
+    reportString(writer, "Inter-Arrival Jitter: ");
+    reportDouble(writer, metrics->jitter);
+    reportString(writer, " s\n" REPORT_SEPARATOR);
+}
+
+static void reportJsonClient(struct report_writer *writer, const struct client_record *record,
+        const struct packet_metrics *metrics, const struct packet_bitset *seen, size_t index) {
+    reportString(writer, index == 0 ? "\n    {\"client\":" : ",\n    {\"client\":");
+    reportJsonString(writer, record->name);
+    reportJsonField(writer, "expected", metrics->expected);
+    reportJsonField(writer, "received", record->receivedNumberOfPackets);
+    reportJsonField(writer, "lost", metrics->lost);
+    reportString(writer, ",\"lostRanges\":\"");
+    reportLostRanges(writer, seen, metrics);
+    reportBytes(writer, "\"", 1);
+    reportJsonField(writer, "lossBursts", metrics->lossRuns);
+    reportJsonField(writer, "shortestLossBurst", metrics->shortestLossRun);
+    reportJsonField(writer, "longestLossBurst", metrics->longestLossRun);
+    reportBytes(writer, ",", 1);
+    reportHistogramJson(writer, "lossBurstHistogram", metrics->lossHistogram);
+    reportJsonField(writer, "outOfOrder", metrics->outOfOrder);
+    reportString(writer, ",\"outOfOrderPackets\":[");
+    reportOutOfOrder(writer, record, ",", 0);
+    reportBytes(writer, "]", 1);
+    reportJsonField(writer, "duplicates", metrics->duplicates);
+    reportJsonField(writer, "reordered", metrics->reordered);
+    reportJsonField(writer, "maxReorderDistance", metrics->longestReorderDistance);
+    reportBytes(writer, ",", 1);
+    reportHistogramJson(writer, "reorderDistanceHistogram", metrics->reorderHistogram);
+    reportString(writer, ",\"jitterSeconds\":");
+    reportDouble(writer, metrics->jitter);
+    reportBytes(writer, "}", 1);
+}
+
+static void reportCsvClient(struct report_writer *writer, const struct client_record *record,
+        const struct packet_metrics *metrics, const struct packet_bitset *seen) {
+    // Client names come from the log, so they are quoted like the ranges.
+    reportCsvString(writer, record->name);
+    reportBytes(writer, ",", 1);
+    reportUnsigned(writer, metrics->expected, 0);
+    reportBytes(writer, ",", 1);
+    reportUnsigned(writer, record->receivedNumberOfPackets, 0);
+    reportBytes(writer, ",", 1);
+    reportUnsigned(writer, metrics->lost, 0);
+    reportBytes(writer, ",", 1);
+    reportUnsigned(writer, metrics->lossRuns, 0);
+    reportBytes(writer, ",", 1);
+    reportUnsigned(writer, metrics->shortestLossRun, 0);
+    reportBytes(writer, ",", 1);
+    reportUnsigned(writer, metrics->longestLossRun, 0);
+    reportBytes(writer, ",", 1);
+    reportUnsigned(writer, metrics->outOfOrder, 0);
+    reportBytes(writer, ",", 1);
+    reportUnsigned(writer, metrics->duplicates, 0);
+    reportBytes(writer, ",", 1);
+    reportUnsigned(writer, metrics->reordered, 0);
+    reportBytes(writer, ",", 1);
+    reportUnsigned(writer, metrics->longestReorderDistance, 0);
+    reportBytes(writer, ",", 1);
+    reportDouble(writer, metrics->jitter);
+    reportBytes(writer, ",\"", 2);
+    reportLostRanges(writer, seen, metrics);
+    reportBytes(writer, "\"\n", 2);
+}
+
+void startReport(struct report_writer *writer, enum report_format format) {
+    switch (format) {
+        case REPORT_JSON:
+            reportString(writer, "{\n  \"clients\": [");
+            break;
+        case REPORT_CSV:
+            reportString(writer, "client,expected,received,lost,loss_bursts,shortest_loss_burst,longest_loss_burst,"
+                                 "out_of_order,duplicates,reordered,max_reorder_distance,jitter_seconds,lost_ranges\n");
+            break;
+        case REPORT_TEXT:
+        default:
+            break;
+    }
+}
+
+void reportClient(struct report_writer *writer, enum report_format format, const struct client_record *record,
+        const struct packet_metrics *metrics, const struct packet_bitset *seen, size_t index) {
+    switch (format) {
+        case REPORT_JSON:
+            reportJsonClient(writer, record, metrics, seen, index);
+            break;
+        case REPORT_CSV:
+            reportCsvClient(writer, record, metrics, seen);
+            break;
+        case REPORT_TEXT:
+        default:
+            reportTextClient(writer, record, metrics, seen);
+            break;
+    }
+}
+
+void finishReport(struct report_writer *writer, enum report_format format, const struct report_summary *summary) {
+    switch (format) {
+        case REPORT_JSON:
+            reportString(writer, "\n  ],\n  \"summary\": {\"clients\":");
+            reportUnsigned(writer, summary->clients, 0);
+            reportJsonField(writer, "minimumLostPackets", summary->minLost);
+            reportJsonField(writer, "maximumLostPackets", summary->maxLost);
+            reportJsonField(writer, "minimumOutOfOrderPackets", summary->minOrder);
+            reportJsonField(writer, "maximumOutOfOrderPackets", summary->maxOrder);
+            reportJsonField(writer, "malformedPacketNumbers", summary->malformedTotal);
+            reportString(writer, ",\"averageLostPackets\":");
+            // JSON has no NaN, so an empty log averages to 0.
+            reportDouble(writer, summary->clients > 0 ? (double) summary->lostTotal / (double) summary->clients : 0.0);
+            reportString(writer, "}\n}\n");
+            break;
+        case REPORT_CSV:
+            break;
+        case REPORT_TEXT:
+        default:
+            reportString(writer, "Minimum Lost Packets: ");
+            reportUnsigned(writer, summary->minLost, 0);
+            reportString(writer, "\nMaximum Lost Packets: ");
+            reportUnsigned(writer, summary->maxLost, 0);
+            reportString(writer, "\n" REPORT_SEPARATOR "Minimum Out Of Order Packets: ");
+            reportUnsigned(writer, summary->minOrder, 0);
+            reportString(writer, "\nMaximum Out Of Order Packets: ");
+            reportUnsigned(writer, summary->maxOrder, 0);
+            reportString(writer, "\n" REPORT_SEPARATOR "Average Number Of Lost Packets: ");
+            reportDouble(writer, summary->clients > 0 ? (double) summary->lostTotal / (double) summary->clients : 0.0);
+            reportBytes(writer, "\n", 1);
+
+            if (summary->malformedTotal > 0) {
+                reportString(writer, REPORT_SEPARATOR "Malformed Packet Numbers Left Out: ");
+                reportUnsigned(writer, summary->malformedTotal, 0);
+                reportBytes(writer, "\n", 1);
+            }
+            break;
+    }
+}
+
+void addToSummary(struct report_summary *summary, const struct packet_metrics *metrics) {
+    summary->clients++;
+    summary->lostTotal += metrics->lost;
+    summary->malformedTotal += metrics->malformed;
+
+    if (metrics->shortestLossRun > summary->minLost) {
+        summary->minLost = metrics->shortestLossRun;
+    }
+
+    if (metrics->longestLossRun > summary->maxLost) {
+        summary->maxLost = metrics->longestLossRun;
+    }
+
+    if (metrics->shortestOutOfOrderRun > summary->minOrder) {
+        summary->minOrder = metrics->shortestOutOfOrderRun;
+    }
+
+    if (metrics->longestOutOfOrderRun > summary->maxOrder) {
+        summary->maxOrder = metrics->longestOutOfOrderRun;
+    }
+}
+
+int reportClientTable(const struct dc_posix_env *env, struct dc_error *err, struct report_writer *writer,
+        enum report_format format, const struct client_table *table, bool slice) {
+    struct report_summary summary;
+    int ret_val = 0;
+
+    memset(&summary, 0, sizeof(summary));
+    startReport(writer, format);
+
+    for (size_t client = 0; client < table->count; client++) {
+        const struct client_record *clientHead = &table->records[client];
+        struct packet_metrics metrics;
+        struct packet_bitset seen;
+        int measured;
+
+        if (slice && clientHead->receivedNumberOfPackets == 0) {
+            continue;
+        }
+
+        // Every statistic for the client comes out of this one pass over its packets.
+        measured = slice ? measurePacketSlice(env, err, &metrics, &seen, clientHead)
+                         : measurePackets(env, err, &metrics, &seen, clientHead);
+
+        if (measured == -1) {
+            destroyPacketBitset(env, &seen);
+            ret_val = -1;
+            break;
+        }
+
+        reportClient(writer, format, clientHead, &metrics, &seen, summary.clients);
+        addToSummary(&summary, &metrics);
+        destroyPacketBitset(env, &seen);
+    }
+
+    finishReport(writer, format, &summary);
+    return ret_val;
+}
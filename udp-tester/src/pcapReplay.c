@@ -0,0 +1,489 @@
+#include "pcapReplay.h"
+
+/**
+ * Time resolution of one pcapng interface: 10^-exponent or 2^-exponent
+ * seconds per tick.
+ */
+struct capture_interface {
+    u_int32_t linkType;
+    bool binary;
+    unsigned int exponent;
+};
+
+static u_int16_t read16(const unsigned char *data, bool big);
+static u_int32_t read32(const unsigned char *data, bool big);
+static uint64_t toNanoseconds(uint64_t ticks, bool binary, unsigned int exponent);
+static bool udpPayloadSize(u_int32_t linkType, const unsigned char *data, size_t length, u_int16_t port,
+        size_t *size);
+static int addReplayPacket(const struct dc_posix_env *env, struct dc_error *err, struct replay_trace *trace,
+        size_t size, uint64_t time);
+static int readPcap(const struct dc_posix_env *env, struct dc_error *err, const unsigned char *data, size_t length,
+        u_int16_t port, struct replay_trace *trace);
+static int readPcapng(const struct dc_posix_env *env, struct dc_error *err, const unsigned char *data, size_t length,
+        u_int16_t port, struct replay_trace *trace);
+static void readInterfaceOptions(const unsigned char *options, size_t length, bool big,
+        struct capture_interface *interface);
+static uint64_t replayNanoseconds(void);
+static void waitUntil(uint64_t deadline);
+
+static u_int16_t read16(const unsigned char *data, bool big) {
+    return big ? (u_int16_t) (data[0] << 8 | data[1]) : (u_int16_t) (data[1] << 8 | data[0]);
+}
+
+static u_int32_t read32(const unsigned char *data, bool big) {
+    return big ? (u_int32_t) data[0] << 24 | (u_int32_t) data[1] << 16 | (u_int32_t) data[2] << 8 | data[3]
+               : (u_int32_t) data[3] << 24 | (u_int32_t) data[2] << 16 | (u_int32_t) data[1] << 8 | data[0];
+}
+
+static uint64_t toNanoseconds(uint64_t ticks, bool binary, unsigned int exponent) {
+    uint64_t scale = 1;
+
+    if (binary) {
+        // Drop the bits finer than a nanosecond could use so the fraction cannot overflow.
+        if (exponent > 32) {
+            ticks >>= exponent - 32;
+            exponent = 32;
+        }
+
+        return (ticks >> exponent) * 1000000000U + ((ticks & ((UINT64_C(1) << exponent) - 1)) * 1000000000U >> exponent);
+    }
+
+    for (unsigned int i = exponent < 9 ? exponent : 9; i < (exponent < 9 ? 9 : exponent); i++) {
+        scale *= 10;
+    }
+
+    return exponent <= 9 ? ticks * scale : ticks / scale;
+}
+
+static bool udpPayloadSize(u_int32_t linkType, const unsigned char *data, size_t length, u_int16_t port,
+        size_t *size) {
+    size_t offset;
+    unsigned int next;
+
+    if (linkType == PCAP_LINK_ETHERNET) {
+        u_int16_t type;
+
+        offset = 12;
+
+        // 802.1Q and 802.1ad tags sit between the addresses and the real type.
+        do {
+            if (length < offset + 2) {
+                return false;
+            }
+
+            type = read16(data + offset, true);
+            offset += type == 0x8100 || type == 0x88A8 || type == 0x9100 ? 4 : 2;
+        } while (type == 0x8100 || type == 0x88A8 || type == 0x9100);
+
+        if (type != 0x0800 && type != 0x86DD) {
+            return false;
+        }
+    } else if (linkType == PCAP_LINK_NULL || linkType == PCAP_LINK_LOOP) {
+        offset = 4;
+    } else if (linkType == PCAP_LINK_SLL) {
+        offset = 16;
+    } else if (linkType == PCAP_LINK_SLL2) {
+        offset = 20;
+    } else if (linkType == PCAP_LINK_RAW || linkType == PCAP_LINK_IPV4 || linkType == PCAP_LINK_IPV6) {
+        offset = 0;
+    } else {
+        return false;
+    }
+
+    // The version nibble tells the two IP versions apart whatever the link said.
+    if (length >= offset + 20 && data[offset] >> 4 == 4) {
+        // Later fragments carry no UDP header; the first one has the length of the whole datagram.
+        if ((read16(data + offset + 6, true) & 0x1FFF) != 0) {
+            return false;
+        }
+
+        next = data[offset + 9];
+        offset += (size_t) (data[offset] & 0x0F) * 4;
+    } else if (length >= offset + 40 && data[offset] >> 4 == 6) {
+        next = data[offset + 6];
+        offset += 40;
+
+        // Hop-by-hop, routing, fragment and destination options headers may come before UDP.
+        while (next == 0 || next == 43 || next == 44 || next == 60) {
+            size_t headerLength;
+
+            if (length < offset + 8 || (next == 44 && (read16(data + offset + 2, true) & 0xFFF8) != 0)) {
+                return false;
+            }
+
+            headerLength = next == 44 ? 8 : ((size_t) data[offset + 1] + 1) * 8;
+            next = data[offset];
+            offset += headerLength;
+        }
+    } else {
+        return false;
+    }
+
+    if (next != IPPROTO_UDP || length < offset + 8 || read16(data + offset + 4, true) < 8) {
+        return false;
+    }
+
+    if (port != 0 && read16(data + offset, true) != port && read16(data + offset + 2, true) != port) {
+        return false;
+    }
+
+    // The UDP length is the size on the wire even when the capture cut the payload short.
+    *size = (size_t) read16(data + offset + 4, true) - 8;
+    return true;
+}
+
+static int addReplayPacket(const struct dc_posix_env *env, struct dc_error *err, struct replay_trace *trace,
+        size_t size, uint64_t time) {
+    if (trace->count == REPLAY_MAX_PACKETS) {
+        trace->skipped++;
+        return 0;
+    }
+
+    if (trace->count == trace->capacity) {
+        size_t capacity = trace->capacity == 0 ? 1024 : trace->capacity * 2;
+        u_int16_t *sizes;
+        uint64_t *offsets;
+
+        if (capacity > REPLAY_MAX_PACKETS) {
+            capacity = REPLAY_MAX_PACKETS;
+        }
+
+        sizes = dc_realloc(env, err, trace->sizes, capacity * sizeof(u_int16_t));
+
+        if (sizes == NULL) {
+            return -1;
+        }
+
+        trace->sizes = sizes;
+        offsets = dc_realloc(env, err, trace->offsets, capacity * sizeof(uint64_t));
+
+        if (offsets == NULL) {
+            return -1;
+        }
+
+        trace->offsets = offsets;
+        trace->capacity = capacity;
+    }
+
+    // Every packet needs room for the client header, and none can be larger than one UDP datagram.
+    if (size < REPLAY_MIN_PACKET || size > REPLAY_MAX_PACKET) {
+        size = size < REPLAY_MIN_PACKET ? REPLAY_MIN_PACKET : REPLAY_MAX_PACKET;
+        trace->clamped++;
+    }
+
+    trace->sizes[trace->count] = (u_int16_t) size;
+    trace->offsets[trace->count++] = time;
+    trace->bytes += size;
+    return 0;
+}
+
+static int readPcap(const struct dc_posix_env *env, struct dc_error *err, const unsigned char *data, size_t length,
+        u_int16_t port, struct replay_trace *trace) {
+    bool big = read32(data, true) == PCAP_MAGIC_MICRO || read32(data, true) == PCAP_MAGIC_NANO;
+    bool nano = read32(data, big) == PCAP_MAGIC_NANO;
+    // The upper bits of the link type field carry FCS flags.
+    u_int32_t linkType = read32(data + 20, big) & 0xFFFF;
+    size_t offset = 24;
+
+    while (offset + 16 <= length) {
+        uint64_t seconds = read32(data + offset, big);
+        uint64_t fraction = read32(data + offset + 4, big);
+        size_t captured = read32(data + offset + 8, big);
+        size_t size;
+
+        // A capture cut off mid-record ends at the last whole one.
+        if (captured > length - offset - 16) {
+            break;
+        }
+
+        if (udpPayloadSize(linkType, data + offset + 16, captured, port, &size) &&
+            addReplayPacket(env, err, trace, size, seconds * 1000000000U + (nano ? fraction : fraction * 1000)) == -1) {
+            return -1;
+        }
+
+        offset += 16 + captured;
+    }
+
+    return 0;
+}
+
+static void readInterfaceOptions(const unsigned char *options, size_t length, bool big,
+        struct capture_interface *interface) {
+    size_t offset = 0;
+
+    while (offset + 4 <= length) {
+        u_int16_t code = read16(options + offset, big);
+        u_int16_t size = read16(options + offset + 2, big);
+
+        if (code == 0 || offset + 4 + size > length) {
+            return;
+        }
+
+        if (code == PCAPNG_OPTION_TSRESOL && size >= 1) {
+            interface->binary = (options[offset + 4] & 0x80) != 0;
+            interface->exponent = options[offset + 4] & 0x7F;
+        }
+
+        // Option values are padded to 32 bits.
+        offset += 4 + (((size_t) size + 3) & ~(size_t) 3);
+    }
+}
+
+static int readPcapng(const struct dc_posix_env *env, struct dc_error *err, const unsigned char *data, size_t length,
+        u_int16_t port, struct replay_trace *trace) {
+    struct capture_interface interfaces[REPLAY_MAX_INTERFACES];
+    size_t interfaceCount = 0;
+    size_t offset = 0;
+    bool big = false;
+
+    while (offset + 12 <= length) {
+        const unsigned char *block = data + offset;
+        u_int32_t type = read32(block, big);
+        size_t blockLength;
+
+        // Each section header sets the byte order and starts a new list of interfaces.
+        if (type == PCAPNG_SECTION_BLOCK) {
+            if (read32(block + 8, false) != PCAPNG_BYTE_ORDER_MAGIC &&
+                read32(block + 8, true) != PCAPNG_BYTE_ORDER_MAGIC) {
+                return -1;
+            }
+
+            big = read32(block + 8, true) == PCAPNG_BYTE_ORDER_MAGIC;
+            interfaceCount = 0;
+        } else if (offset == 0) {
+            return -1;
+        }
+
+        blockLength = read32(block + 4, big);
+
+        if (blockLength < 12 || blockLength % 4 != 0 || blockLength > length - offset) {
+            break;
+        }
+
+        if (type == PCAPNG_INTERFACE_BLOCK && blockLength >= 20 && interfaceCount < REPLAY_MAX_INTERFACES) {
+            struct capture_interface *interface = &interfaces[interfaceCount++];
+
+            interface->linkType = read16(block + 8, big);
+            interface->binary = false;
+            interface->exponent = 6;
+            readInterfaceOptions(block + 16, blockLength - 20, big, interface);
+        } else if (type == PCAPNG_ENHANCED_BLOCK && blockLength >= 32) {
+            u_int32_t interfaceID = read32(block + 8, big);
+            uint64_t ticks = (uint64_t) read32(block + 12, big) << 32 | read32(block + 16, big);
+            size_t captured = read32(block + 20, big);
+            size_t size;
+
+            if (interfaceID < interfaceCount && captured <= blockLength - 32 &&
+                udpPayloadSize(interfaces[interfaceID].linkType, block + 28, captured, port, &size) &&
+                addReplayPacket(env, err, trace, size, toNanoseconds(ticks, interfaces[interfaceID].binary,
+                                                                     interfaces[interfaceID].exponent)) == -1) {
+                return -1;
+            }
+        }
+
+        offset += blockLength;
+    }
+
+    return 0;
+}
+
+int loadReplayTrace(const struct dc_posix_env *env, struct dc_error *err, const char *path, u_int16_t port,
+        struct replay_trace *trace) {
+    struct stat status;
+    const unsigned char *data;
+    size_t length;
+    u_int32_t magic;
+    int ret_val = -1;
+    int fd;
+
+    dc_memset(env, trace, 0, sizeof(*trace));
+    fd = dc_open(env, err, path, O_RDONLY, 0);
+
+    if (dc_error_has_error(err)) {
+        return -1;
+    }
+
+    if (fstat(fd, &status) == -1 || status.st_size < 24) {
+        dc_close(env, err, fd);
+        return -1;
+    }
+
+    length = (size_t) status.st_size;
+    data = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    dc_close(env, err, fd);
+
+    if (data == MAP_FAILED) {
+        return -1;
+    }
+
+    madvise((void *) (uintptr_t) data, length, MADV_SEQUENTIAL);
+    magic = read32(data, false);
+
+    if (magic == PCAP_MAGIC_MICRO || magic == PCAP_MAGIC_NANO || read32(data, true) == PCAP_MAGIC_MICRO ||
+        read32(data, true) == PCAP_MAGIC_NANO) {
+        ret_val = readPcap(env, err, data, length, port, trace);
+    } else if (magic == PCAPNG_SECTION_BLOCK) {
+        ret_val = readPcapng(env, err, data, length, port, trace);
+    }
+
+    munmap((void *) (uintptr_t) data, length);
+
+    // Interfaces may be captured slightly out of step; the replay never goes back in time.
+    for (size_t i = 1; ret_val == 0 && i < trace->count; i++) {
+        if (trace->offsets[i] < trace->offsets[i - 1]) {
+            trace->offsets[i] = trace->offsets[i - 1];
+        }
+    }
+
+    for (size_t i = trace->count; ret_val == 0 && i-- > 0;) {
+        trace->offsets[i] -= trace->offsets[0];
+    }
+
+    if (ret_val == -1) {
+        freeReplayTrace(env, trace);
+    }
+
+    return ret_val;
+}
+
+void freeReplayTrace(const struct dc_posix_env *env, struct replay_trace *trace) {
+    if (trace->sizes != NULL) {
+        dc_free(env, trace->sizes, trace->capacity * sizeof(u_int16_t));
+    }
+
+    if (trace->offsets != NULL) {
+        dc_free(env, trace->offsets, trace->capacity * sizeof(uint64_t));
+    }
+
+    trace->sizes = NULL;
+    trace->offsets = NULL;
+    trace->count = 0;
+    trace->capacity = 0;
+}
+
+u_int16_t meanReplaySize(const struct replay_trace *trace) {
+    return trace->count == 0 ? REPLAY_MIN_PACKET : (u_int16_t) ((trace->bytes + trace->count / 2) / trace->count);
+}
+
+static uint64_t replayNanoseconds(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000U + (uint64_t) ts.tv_nsec;
+}
+
+static void waitUntil(uint64_t deadline) {
+    uint64_t now = replayNanoseconds();
+
+    // Sleeping wakes up tens of microseconds late, so the last stretch is spun.
+    if (deadline > now + REPLAY_SPIN_NS) {
+        struct timespec ts;
+        uint64_t wake = deadline - REPLAY_SPIN_NS;
+
+        ts.tv_sec = (time_t) (wake / 1000000000U);
+        ts.tv_nsec = (long) (wake % 1000000000U);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+    }
+
+    while (replayNanoseconds() < deadline) {
+    }
+}
+
+int replayTrace(const struct dc_posix_env *env, struct dc_error *err, const struct replay_trace *trace, int socketFD,
+        const struct sockaddr_in *destination, const char *clientID, double speed, struct replay_stats *stats) {
+    struct mmsghdr messages[REPLAY_BATCH];
+    struct iovec iovecs[REPLAY_BATCH];
+    struct sockaddr_in address = *destination;
+    size_t slotSize = REPLAY_MIN_PACKET;
+    double totalLateness = 0.0;
+    char *packets;
+    uint64_t start;
+
+    dc_memset(env, stats, 0, sizeof(*stats));
+
+    for (size_t i = 0; i < trace->count; i++) {
+        if (trace->sizes[i] > slotSize) {
+            slotSize = trace->sizes[i];
+        }
+    }
+
+    packets = dc_malloc(env, err, slotSize * REPLAY_BATCH);
+
+    if (packets == NULL) {
+        return -1;
+    }
+
+    // The payload bytes are never looked at, so each slot is filled once.
+    dc_memset(env, packets, '*', slotSize * REPLAY_BATCH);
+
+    for (size_t i = 0; i < REPLAY_BATCH; i++) {
+        iovecs[i].iov_base = packets + i * slotSize;
+        dc_memset(env, &messages[i], 0, sizeof(messages[i]));
+        messages[i].msg_hdr.msg_iov = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+        messages[i].msg_hdr.msg_name = &address;
+        messages[i].msg_hdr.msg_namelen = sizeof(address);
+    }
+
+    // The default 50 us timer slack would be added to every sleep.
+    prctl(PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL);
+    start = replayNanoseconds();
+
+    while (stats->sent < trace->count) {
+        uint64_t now;
+        size_t batch = 0;
+        int result;
+
+        waitUntil(start + (uint64_t) ((double) trace->offsets[stats->sent] / speed));
+        now = replayNanoseconds();
+
+        // Everything already due goes out in one call, so bursts in the capture stay bursts.
+        while (stats->sent + batch < trace->count && batch < REPLAY_BATCH &&
+               start + (uint64_t) ((double) trace->offsets[stats->sent + batch] / speed) <= now) {
+            size_t index = stats->sent + batch;
+            char *packet = packets + batch * slotSize;
+            char header[FORMAT_HEADER_LENGTH];
+
+            formatPacketHeader(header, clientID, (u_int32_t) (index + 1));
+            hotCopy(packet, header, REPLAY_HEADER);
+            packet[trace->sizes[index] - 1] = '\n';
+            iovecs[batch].iov_len = trace->sizes[index];
+            batch++;
+        }
+
+        result = sendmmsg(socketFD, messages, (unsigned int) batch, 0);
+
+        for (size_t i = 0; i < batch; i++) {
+            packets[i * slotSize + iovecs[i].iov_len - 1] = '*';
+        }
+
+        if (result == -1) {
+            // A full device queue is transient; the same packets are sent again, later than planned.
+            if (errno == ENOBUFS || errno == EAGAIN || errno == EINTR) {
+                continue;
+            }
+
+            DC_ERROR_RAISE_ERRNO(err, errno);
+            dc_free(env, packets, slotSize * REPLAY_BATCH);
+            return -1;
+        }
+
+        for (size_t i = 0; i < (size_t) result; i++) {
+            double lateness = (double) (now - start) / 1e9 -
+                              (double) trace->offsets[stats->sent + i] / speed / 1e9;
+
+            totalLateness += lateness;
+
+            if (lateness > stats->maxLateness) {
+                stats->maxLateness = lateness;
+            }
+        }
+
+        stats->sent += (size_t) result;
+    }
+
+    stats->seconds = (double) (replayNanoseconds() - start) / 1e9;
+    stats->meanLateness = stats->sent > 0 ? totalLateness / (double) stats->sent : 0.0;
+    dc_free(env, packets, slotSize * REPLAY_BATCH);
+    return 0;
+}
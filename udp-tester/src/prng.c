@@ -0,0 +1,73 @@
+#include "prng.h"
+
+static uint64_t rotateLeft(uint64_t value, int shift) {
+    return (value << shift) | (value >> (64 - shift));
+}
+
+void prngSeed(struct prng *prng, uint64_t seed) {
+    for (size_t i = 0; i < 4; i++) {
+        uint64_t z;
+
+        seed += UINT64_C(0x9E3779B97F4A7C15);
+        z = seed;
+        z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+        z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+        prng->state[i] = z ^ (z >> 31);
+    }
+}
+
+uint64_t prngNext(struct prng *prng) {
+    uint64_t *s = prng->state;
+    uint64_t result = rotateLeft(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotateLeft(s[3], 45);
+
+    return result;
+}
+
+double prngUniform(struct prng *prng) {
+    return (double) (prngNext(prng) >> 11) * 0x1.0p-53;
+}
+
+uint64_t prngBelow(struct prng *prng, uint64_t bound) {
+    uint64_t threshold = (0 - bound) % bound;
+    uint64_t value;
+
+    // Rejection sampling keeps the result unbiased for bounds that do not divide 2^64.
+    do {
+        value = prngNext(prng);
+    } while (value < threshold);
+
+    return value % bound;
+}
+
+uint64_t prngThreshold(double probability) {
+    if (probability <= 0.0) {
+        return 0;
+    }
+
+    if (probability >= 1.0) {
+        return UINT64_MAX;
+    }
+
+    return (uint64_t) (probability * 18446744073709551616.0);
+}
+
+bool prngChance(struct prng *prng, uint64_t threshold) {
+    // Disabled impairments must not consume random numbers, or enabling one would reshuffle the others.
+    if (threshold == 0) {
+        return false;
+    }
+
+    if (threshold == UINT64_MAX) {
+        return true;
+    }
+
+    return prngNext(prng) < threshold;
+}
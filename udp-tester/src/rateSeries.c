@@ -0,0 +1,250 @@
+#include "rateSeries.h"
+
+static struct series_slot *sessionSlot(struct series_session *session, u_int64_t index);
+static size_t formatSlot(char *line, u_int64_t startMs, const char *client, const struct series_slot *slot);
+static void writeInterval(const struct dc_posix_env *env, struct dc_error *err, struct rate_series *series);
+
+int createRateSeries(const struct dc_posix_env *env, struct dc_error *err, struct rate_series *series,
+        u_int32_t intervalMs, int logFD) {
+    dc_memset(env, series, 0, sizeof(*series));
+    series->intervalMs = intervalMs > 0 ? intervalMs : 1;
+    series->first = wallMilliseconds() / series->intervalMs;
+    series->current = series->first;
+    series->logFD = logFD;
+    series->sessions = dc_calloc(env, err, SERIES_SESSIONS, sizeof(struct series_session));
+
+    return series->sessions == NULL ? -1 : 0;
+}
+
+void destroyRateSeries(const struct dc_posix_env *env, struct dc_error *err, struct rate_series *series) {
+    if (series->sessions == NULL) {
+        return;
+    }
+
+    writeInterval(env, err, series);
+    dc_free(env, series->sessions, SERIES_SESSIONS * sizeof(struct series_session));
+    series->sessions = NULL;
+}
+
+u_int64_t wallMilliseconds(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (u_int64_t) now.tv_sec * 1000 + (u_int64_t) now.tv_nsec / 1000000;
+}
+
+static size_t formatSlot(char *line, u_int64_t startMs, const char *client, const struct series_slot *slot) {
+    int length;
+
+    if (client != NULL) {
+        length = snprintf(line, SERIES_LINE, "%" PRIu64 " %s %u %" PRIu64 " %u %u\n", startMs, client,
+                          slot->packets, slot->bytes, slot->drops, slot->reorders);
+    } else {
+        length = snprintf(line, SERIES_LINE, "%" PRIu64 ",%u,%" PRIu64 ",%u,%u\n", startMs, slot->packets,
+                          slot->bytes, slot->drops, slot->reorders);
+    }
+
+    return length > 0 ? (size_t) length : 0;
+}
+
+static void writeInterval(const struct dc_posix_env *env, struct dc_error *err, struct rate_series *series) {
+    const struct series_slot *slot = &series->slots[series->current % SERIES_SLOTS];
+    u_int64_t startMs = series->current * series->intervalMs;
+    char buffer[SERIES_LINE * 16];
+    char client[8];
+    size_t length;
+
+    // Quiet intervals are left out, a gap in the file reads as zeros.
+    if (series->logFD == -1 || slot->packets == 0) {
+        return;
+    }
+
+    length = formatSlot(buffer, startMs, "all", slot);
+
+    for (size_t i = 0; i < SERIES_SESSIONS; i++) {
+        struct series_session *session = &series->sessions[i];
+        const struct series_slot *sessionCounters = &session->slots[session->current % SERIES_SESSION_SLOTS];
+
+        if (session->clientID == 0 || session->current != series->current || sessionCounters->packets == 0) {
+            continue;
+        }
+
+        if (length + SERIES_LINE > sizeof(buffer)) {
+            dc_write(env, err, series->logFD, buffer, length);
+            length = 0;
+        }
+
+        sprintf(client, "%04u", session->clientID % 10000);
+        length += formatSlot(buffer + length, startMs, client, sessionCounters);
+    }
+
+    dc_write(env, err, series->logFD, buffer, length);
+}
+
+void advanceRateSeries(const struct dc_posix_env *env, struct dc_error *err, struct rate_series *series,
+        u_int64_t nowMs) {
+    u_int64_t index = nowMs / series->intervalMs;
+
+    if (index <= series->current) {
+        return;
+    }
+
+    writeInterval(env, err, series);
+
+    // Only the slots the clock skipped over are cleared, at most one full turn of the ring.
+    for (u_int64_t i = series->current + 1; i <= index && i <= series->current + SERIES_SLOTS; i++) {
+        dc_memset(env, &series->slots[i % SERIES_SLOTS], 0, sizeof(struct series_slot));
+    }
+
+    series->current = index;
+}
+
+static struct series_slot *sessionSlot(struct series_session *session, u_int64_t index) {
+    for (u_int64_t i = session->current + 1; i <= index && i <= session->current + SERIES_SESSION_SLOTS; i++) {
+        memset(&session->slots[i % SERIES_SESSION_SLOTS], 0, sizeof(struct series_slot));
+    }
+
+    if (index > session->current) {
+        session->current = index;
+    }
+
+    return &session->slots[session->current % SERIES_SESSION_SLOTS];
+}
+
+void countRatePacket(struct rate_series *series, u_int32_t clientID, u_int32_t packetID, u_int32_t bytes) {
+    struct series_slot *slot = &series->slots[series->current % SERIES_SLOTS];
+    struct series_session *session = &series->sessions[clientID % SERIES_SESSIONS];
+    struct series_slot *sessionCounters;
+    u_int32_t drops = 0;
+    u_int32_t reorders = 0;
+    bool recovered = false;
+
+    slot->packets++;
+    slot->bytes += bytes;
+
+    // A datagram without a client header is counted for the server only.
+    if (clientID == 0) {
+        return;
+    }
+
+    // Client ids are handed out in order, so a new client takes the place of the one SERIES_SESSIONS before it.
+    if (session->clientID != clientID) {
+        memset(session, 0, sizeof(*session));
+        session->clientID = clientID;
+        session->first = series->current;
+        session->current = series->current;
+    }
+
+    if (packetID > session->highest) {
+        drops = packetID - session->highest - 1;
+        session->highest = packetID;
+
+        if (drops > 0) {
+            session->missing += drops;
+            session->gapInterval = series->current;
+        }
+    } else if (packetID < session->highest) {
+        reorders = 1;
+
+        // A late packet may fill a gap counted earlier.
+        if (session->missing > 0) {
+            session->missing--;
+            recovered = true;
+        }
+    } else {
+        // A repeat of the highest packet is a duplicate, not a reorder.
+        series->totalDuplicates++;
+    }
+
+    sessionCounters = sessionSlot(session, series->current);
+    sessionCounters->packets++;
+    sessionCounters->bytes += bytes;
+    sessionCounters->drops += drops;
+    sessionCounters->reorders += reorders;
+    slot->drops += drops;
+    slot->reorders += reorders;
+    series->totalDrops += drops;
+    series->totalReorders += reorders;
+
+    if (recovered) {
+        series->totalDrops--;
+
+        // An interval the gap is no longer in has already been reported, so only the current one is corrected.
+        if (session->gapInterval == series->current) {
+            sessionCounters->drops -= sessionCounters->drops > 0 ? 1 : 0;
+            slot->drops -= slot->drops > 0 ? 1 : 0;
+        }
+    }
+}
+
+u_int32_t activeRateClients(const struct rate_series *series) {
+    u_int32_t active = 0;
+
+    for (size_t i = 0; i < SERIES_SESSIONS; i++) {
+        const struct series_session *session = &series->sessions[i];
+
+        if (session->clientID != 0 && session->current + 1 >= series->current) {
+            active++;
+        }
+    }
+
+    return active;
+}
+
+int writeRateSeries(const struct dc_posix_env *env, struct dc_error *err, const struct rate_series *series, int fd,
+        u_int32_t clientID, u_int64_t nowMs) {
+    const struct series_session *session = NULL;
+    const struct series_slot *slots = series->slots;
+    struct series_slot empty = {0, 0, 0, 0};
+    u_int64_t first = series->first;
+    u_int64_t current = series->current;
+    u_int64_t length = SERIES_SLOTS;
+    u_int64_t index = nowMs / series->intervalMs;
+    char buffer[SERIES_LINE * 64];
+    size_t used;
+
+    if (clientID != 0) {
+        session = &series->sessions[clientID % SERIES_SESSIONS];
+
+        if (session->clientID != clientID) {
+            used = (size_t) snprintf(buffer, sizeof(buffer), "Stats Client:%04u Unknown\n", clientID % 10000);
+            dc_write(env, err, fd, buffer, used);
+            return -1;
+        }
+
+        slots = session->slots;
+        first = session->first;
+        current = session->current;
+        length = SERIES_SESSION_SLOTS;
+    }
+
+    index = index > current ? index : current;
+
+    if (index >= first + length) {
+        first = index - length + 1;
+    }
+
+    if (clientID != 0) {
+        used = (size_t) snprintf(buffer, sizeof(buffer), "Stats Client:%04u Interval:%u\n", clientID % 10000,
+                                 series->intervalMs);
+    } else {
+        used = (size_t) snprintf(buffer, sizeof(buffer), "Stats Client:all Interval:%u\n", series->intervalMs);
+    }
+
+    used += (size_t) snprintf(buffer + used, sizeof(buffer) - used, "start_ms,packets,bytes,drops,reorders\n");
+
+    // Slots past the newest packet, or a full turn behind it, belong to intervals nothing arrived in.
+    for (u_int64_t i = first; i <= index; i++) {
+        const struct series_slot *slot = i <= current && i + length > current ? &slots[i % length] : &empty;
+
+        if (used + SERIES_LINE > sizeof(buffer)) {
+            dc_write(env, err, fd, buffer, used);
+            used = 0;
+        }
+
+        used += formatSlot(buffer + used, i * series->intervalMs, NULL, slot);
+    }
+
+    dc_write(env, err, fd, buffer, used);
+    return 0;
+}
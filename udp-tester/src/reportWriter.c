@@ -0,0 +1,117 @@
+#include "reportWriter.h"
+
+int openReportWriter(const struct dc_posix_env *env, struct dc_error *err, struct report_writer *writer, int fd) {
+    writer->env = env;
+    writer->err = err;
+    writer->fd = fd;
+    writer->length = 0;
+    writer->status = 0;
+    writer->buffer = dc_malloc(env, err, REPORT_BUFFER_SIZE);
+
+    return writer->buffer == NULL ? -1 : 0;
+}
+
+int closeReportWriter(struct report_writer *writer) {
+    int status = flushReport(writer);
+
+    dc_free(writer->env, writer->buffer, REPORT_BUFFER_SIZE);
+    writer->buffer = NULL;
+
+    return status;
+}
+
+int flushReport(struct report_writer *writer) {
+    size_t written = 0;
+
+    while (writer->status == 0 && written < writer->length) {
+        ssize_t count = hotWrite(writer->err, writer->fd, writer->buffer + written, writer->length - written);
+
+        if (count <= 0) {
+            // Once output is lost the rest of the report is dropped rather than written with a hole in it.
+            writer->status = -1;
+            break;
+        }
+
+        written += (size_t) count;
+    }
+
+    writer->length = 0;
+    return writer->status;
+}
+
+void reportBytes(struct report_writer *writer, const char *data, size_t length) {
+    while (length > 0) {
+        size_t space = REPORT_BUFFER_SIZE - writer->length;
+        size_t chunk = length < space ? length : space;
+
+        hotCopy(writer->buffer + writer->length, data, chunk);
+        writer->length += chunk;
+        data += chunk;
+        length -= chunk;
+
+        if (writer->length == REPORT_BUFFER_SIZE) {
+            flushReport(writer);
+        }
+    }
+}
+
+void reportString(struct report_writer *writer, const char *text) {
+    reportBytes(writer, text, hotLength(text));
+}
+
+void reportJsonString(struct report_writer *writer, const char *text) {
+    reportBytes(writer, "\"", 1);
+
+    for (; *text != '\0'; text++) {
+        if (*text == '"' || *text == '\\') {
+            reportBytes(writer, "\\", 1);
+            reportBytes(writer, text, 1);
+        } else if ((unsigned char) *text < 0x20) {
+            reportString(writer, "\\u00");
+            reportBytes(writer, &"0123456789abcdef"[(unsigned char) *text >> 4], 1);
+            reportBytes(writer, &"0123456789abcdef"[(unsigned char) *text & 0xf], 1);
+        } else {
+            reportBytes(writer, text, 1);
+        }
+    }
+
+    reportBytes(writer, "\"", 1);
+}
+
+void reportCsvString(struct report_writer *writer, const char *text) {
+    reportBytes(writer, "\"", 1);
+
+    for (; *text != '\0'; text++) {
+        if (*text == '"') {
+            reportBytes(writer, "\"", 1);
+        }
+
+        reportBytes(writer, text, 1);
+    }
+
+    reportBytes(writer, "\"", 1);
+}
+
+void reportUnsigned(struct report_writer *writer, u_int64_t value, size_t width) {
+    char digits[REPORT_NUMBER_LENGTH];
+
+    reportBytes(writer, digits, formatDecimal(digits, value, width < sizeof(digits) ? width : sizeof(digits)));
+}
+
+void reportSigned(struct report_writer *writer, int64_t value) {
+    if (value < 0) {
+        reportBytes(writer, "-", 1);
+        reportUnsigned(writer, (u_int64_t) -(value + 1) + 1, 0);
+    } else {
+        reportUnsigned(writer, (u_int64_t) value, 0);
+    }
+}
+
+void reportDouble(struct report_writer *writer, double value) {
+    char number[REPORT_NUMBER_LENGTH * 2];
+    int length = snprintf(number, sizeof(number), "%f", value);
+
+    if (length > 0) {
+        reportBytes(writer, number, (size_t) length < sizeof(number) ? (size_t) length : sizeof(number) - 1);
+    }
+}
@@ -0,0 +1,812 @@
+#include "scenario.h"
+
+struct application_settings {
+    struct dc_opt_settings opts;
+    struct dc_setting_string *message;
+    struct dc_setting_string *plan;
+    struct dc_setting_string *server;
+    struct dc_setting_string *client;
+    struct dc_setting_string *parser;
+    struct dc_setting_string *workDir;
+    struct dc_setting_string *report;
+};
+
+static struct dc_application_settings *create_settings(const struct dc_posix_env *env, struct dc_error *err);
+static int destroy_settings(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings **psettings);
+static int run(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings *settings);
+static void error_reporter(const struct dc_error *err);
+static void trace_reporter(const struct dc_posix_env *env, const char *file_name, const char *function_name, size_t line_number);
+static void sleepMillis(long millis);
+static double wallSeconds(void);
+static bool parseNumber(const char *text, unsigned long max, unsigned long *value);
+static int parsePlanLine(const char *where, char *line, struct scenario_plan *plan, struct scenario_phase **phase);
+static pid_t startServer(const struct dc_posix_env *env, struct dc_error *err, struct scenario *scenario, u_int16_t port);
+static void startClient(const struct dc_posix_env *env, struct dc_error *err, const struct scenario *scenario,
+        u_int16_t port, struct scenario_slot *slot, double remaining);
+static void reapClient(struct scenario_slot *slot, struct phase_result *result);
+static void stopClients(const struct dc_posix_env *env, struct dc_error *err, struct scenario_slot *slots, size_t count);
+static double megabitsPerSecond(u_int64_t bytes, u_int32_t seconds);
+static double offeredRate(const struct scenario_phase *phase);
+
+int main(int argc, char *argv[]) {
+    dc_posix_tracer tracer;
+    dc_error_reporter reporter;
+    struct dc_posix_env env;
+    struct dc_error err;
+    struct dc_application_info *info;
+    int ret_val;
+
+    reporter = error_reporter;
+//    tracer = trace_reporter;
+    tracer = NULL;
+    dc_error_init(&err, reporter);
+    dc_posix_env_init(&env, tracer);
+    info = dc_application_info_create(&env, &err, "Settings Application");
+    ret_val = dc_application_run(&env, &err, info, create_settings, destroy_settings,
+                                 run, dc_default_create_lifecycle, dc_default_destroy_lifecycle,
+                                 NULL, argc, argv);
+    dc_application_info_destroy(&env, &info);
+    dc_error_reset(&err);
+
+    return ret_val;
+}
+
+static struct dc_application_settings *create_settings(const struct dc_posix_env *env, struct dc_error *err) {
+    struct application_settings *settings;
+
+    DC_TRACE(env);
+    settings = dc_malloc(env, err, sizeof(struct application_settings));
+
+    if(settings == NULL) {
+        return NULL;
+    }
+
+    settings->opts.parent.config_path = dc_setting_path_create(env, err);
+    settings->message = dc_setting_string_create(env, err);
+    settings->plan = dc_setting_string_create(env, err);
+    settings->server = dc_setting_string_create(env, err);
+    settings->client = dc_setting_string_create(env, err);
+    settings->parser = dc_setting_string_create(env, err);
+    settings->workDir = dc_setting_string_create(env, err);
+    settings->report = dc_setting_string_create(env, err);
+
+    struct options opts[] = {
+            {(struct dc_setting *)settings->opts.parent.config_path,
+                    dc_options_set_path,
+                    "config",
+                    required_argument,
+                    'c',
+                    "CONFIG",
+                    dc_string_from_string,
+                    NULL,
+                    dc_string_from_config,
+                    NULL},
+            {(struct dc_setting *)settings->message,
+                    dc_options_set_string,
+                    "message",
+                    required_argument,
+                    'm',
+                    "MESSAGE",
+                    dc_string_from_string,
+                    "message",
+                    dc_string_from_config,
+                    "Hello, Default World!"},
+            {(struct dc_setting *)settings->plan,
+                    dc_options_set_string,
+                    "plan",
+                    required_argument,
+                    'P',
+                    "PLAN",
+                    dc_string_from_string,
+                    "plan",
+                    dc_string_from_config,
+                    DEFAULT_PLAN},
+            {(struct dc_setting *)settings->server,
+                    dc_options_set_string,
+                    "server",
+                    required_argument,
+                    's',
+                    "SERVER",
+                    dc_string_from_string,
+                    "server",
+                    dc_string_from_config,
+                    DEFAULT_SERVER_PROGRAM},
+            {(struct dc_setting *)settings->client,
+                    dc_options_set_string,
+                    "client",
+                    required_argument,
+                    'C',
+                    "CLIENT",
+                    dc_string_from_string,
+                    "client",
+                    dc_string_from_config,
+                    DEFAULT_CLIENT_PROGRAM},
+            {(struct dc_setting *)settings->parser,
+                    dc_options_set_string,
+                    "parser",
+                    required_argument,
+                    'x',
+                    "PARSER",
+                    dc_string_from_string,
+                    "parser",
+                    dc_string_from_config,
+                    DEFAULT_PARSER_PROGRAM},
+            {(struct dc_setting *)settings->workDir,
+                    dc_options_set_string,
+                    "work-dir",
+                    required_argument,
+                    'w',
+                    "WORK_DIR",
+                    dc_string_from_string,
+                    "work-dir",
+                    dc_string_from_config,
+                    DEFAULT_SCENARIO_DIR},
+            {(struct dc_setting *)settings->report,
+                    dc_options_set_string,
+                    "report",
+                    required_argument,
+                    'o',
+                    "REPORT",
+                    dc_string_from_string,
+                    "report",
+                    dc_string_from_config,
+                    DEFAULT_SCENARIO_REPORT},
+    };
+
+    settings->opts.opts_count = (sizeof(opts) / sizeof(struct options)) + 1;
+    settings->opts.opts_size = sizeof(struct options);
+    settings->opts.opts = dc_calloc(env, err, settings->opts.opts_count, settings->opts.opts_size);
+    dc_memcpy(env, settings->opts.opts, opts, sizeof(opts));
+    settings->opts.flags = "m:";
+    settings->opts.env_prefix = "DC_EXAMPLE_";
+
+    return (struct dc_application_settings *)settings;
+}
+
+static int destroy_settings(const struct dc_posix_env *env, __attribute__((unused)) struct dc_error *err,
+                            struct dc_application_settings **psettings) {
+    struct application_settings *app_settings;
+
+    DC_TRACE(env);
+    app_settings = (struct application_settings *)*psettings;
+    dc_setting_string_destroy(env, &app_settings->message);
+    dc_free(env, app_settings->opts.opts, app_settings->opts.opts_count);
+    dc_free(env, *psettings, sizeof(struct application_settings));
+
+    if(env->null_free) {
+        *psettings = NULL;
+    }
+
+    return 0;
+}
+
+static void sleepMillis(long millis) {
+    struct timespec ts;
+
+    ts.tv_sec = millis / 1000;
+    ts.tv_nsec = (millis % 1000) * 1000000;
+    nanosleep(&ts, &ts);
+}
+
+static double wallSeconds(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1000000000.0;
+}
+
+static bool parseNumber(const char *text, unsigned long max, unsigned long *value) {
+    char *endPointer;
+
+    if (text == NULL || *text < '0' || *text > '9') {
+        return false;
+    }
+
+    *value = strtoul(text, &endPointer, 10);
+    return *endPointer == '\0' && *value <= max;
+}
+
+static int parsePlanLine(const char *where, char *line, struct scenario_plan *plan, struct scenario_phase **phase) {
+    char *save;
+    char *keyword;
+    char *key;
+    unsigned long value;
+
+    keyword = strtok_r(line, " \t\r\n", &save);
+
+    if (keyword == NULL || *keyword == '#') {
+        return 0;
+    }
+
+    if (strcmp(keyword, "port") == 0 || strcmp(keyword, "warmup") == 0) {
+        if (!parseNumber(strtok_r(NULL, " \t\r\n", &save), UINT16_MAX, &value)) {
+            printf("%s: %s needs a number\n", where, keyword);
+            return -1;
+        }
+
+        if (keyword[0] == 'p') {
+            plan->port = (u_int16_t) value;
+        } else {
+            plan->warmup = (u_int16_t) value;
+        }
+
+        return 0;
+    }
+
+    if (strcmp(keyword, "phase") == 0) {
+        const char *name = strtok_r(NULL, " \t\r\n", &save);
+
+        if (plan->phaseCount == SCENARIO_MAX_PHASES) {
+            printf("%s: more than %d phases\n", where, SCENARIO_MAX_PHASES);
+            return -1;
+        }
+
+        if (name == NULL || strlen(name) >= SCENARIO_NAME_LENGTH || strchr(name, '"') != NULL) {
+            printf("%s: phase needs a name of up to %d characters\n", where, SCENARIO_NAME_LENGTH - 1);
+            return -1;
+        }
+
+        *phase = &plan->phases[plan->phaseCount++];
+        strcpy((*phase)->name, name);
+        (*phase)->warmup = plan->warmup;
+
+        while ((key = strtok_r(NULL, " \t\r\n", &save)) != NULL && *key != '#') {
+            if (!parseNumber(strtok_r(NULL, " \t\r\n", &save), UINT16_MAX, &value)) {
+                printf("%s: %s needs a number of seconds\n", where, key);
+                return -1;
+            }
+
+            if (strcmp(key, "duration") == 0) {
+                (*phase)->duration = (u_int16_t) value;
+            } else if (strcmp(key, "ramp") == 0) {
+                (*phase)->ramp = (u_int16_t) value;
+            } else if (strcmp(key, "warmup") == 0) {
+                (*phase)->warmup = (u_int16_t) value;
+            } else {
+                printf("%s: unknown phase setting %s\n", where, key);
+                return -1;
+            }
+        }
+
+        if ((*phase)->duration == 0 || (*phase)->ramp > (*phase)->duration) {
+            printf("%s: phase needs a duration of at least its ramp\n", where);
+            return -1;
+        }
+
+        return 0;
+    }
+
+    if (strcmp(keyword, "flow") == 0) {
+        struct scenario_flow *flow;
+
+        if (*phase == NULL) {
+            printf("%s: flow before the first phase\n", where);
+            return -1;
+        }
+
+        if ((*phase)->flowCount == SCENARIO_MAX_FLOWS) {
+            printf("%s: more than %d flows in a phase\n", where, SCENARIO_MAX_FLOWS);
+            return -1;
+        }
+
+        flow = &(*phase)->flows[(*phase)->flowCount++];
+        flow->clients = 1;
+
+        while ((key = strtok_r(NULL, " \t\r\n", &save)) != NULL && *key != '#') {
+            if (!parseNumber(strtok_r(NULL, " \t\r\n", &save), UINT32_MAX, &value)) {
+                printf("%s: %s needs a number\n", where, key);
+                return -1;
+            }
+
+            if (strcmp(key, "clients") == 0 && value <= SCENARIO_MAX_CLIENTS) {
+                flow->clients = (u_int16_t) value;
+            } else if (strcmp(key, "rate") == 0) {
+                flow->rate = (u_int32_t) value;
+            } else if (strcmp(key, "size") == 0 && value >= SCENARIO_MIN_PACKET_SIZE && value <= UINT16_MAX) {
+                flow->size = (u_int16_t) value;
+            } else {
+                printf("%s: unknown flow setting or value out of range: %s %lu\n", where, key, value);
+                return -1;
+            }
+        }
+
+        (*phase)->clients += flow->clients;
+
+        if (flow->clients == 0 || flow->rate == 0 || flow->size == 0) {
+            printf("%s: flow needs clients, a rate above 0 and a size\n", where);
+            return -1;
+        }
+
+        if ((*phase)->clients > SCENARIO_MAX_CLIENTS) {
+            printf("%s: more than %d clients in a phase\n", where, SCENARIO_MAX_CLIENTS);
+            return -1;
+        }
+
+        return 0;
+    }
+
+    printf("%s: unknown keyword %s\n", where, keyword);
+    return -1;
+}
+
+int loadPlan(const char *path, struct scenario_plan *plan) {
+    struct scenario_phase *phase = NULL;
+    char line[512];
+    char where[600];
+    unsigned int lineNumber = 0;
+    FILE *file;
+
+    memset(plan, 0, sizeof(*plan));
+    plan->port = DEFAULT_SCENARIO_PORT;
+    plan->warmup = DEFAULT_WARMUP_SECONDS;
+    file = fopen(path, "r");
+
+    if (file == NULL) {
+        printf("Could not open %s\n", path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        lineNumber++;
+        snprintf(where, sizeof(where), "%s:%u", path, lineNumber);
+
+        if (parsePlanLine(where, line, plan, &phase) != 0) {
+            fclose(file);
+            return -1;
+        }
+    }
+
+    fclose(file);
+
+    for (size_t i = 0; i < plan->phaseCount; i++) {
+        if (plan->phases[i].flowCount == 0) {
+            printf("%s: phase %s has no flows\n", path, plan->phases[i].name);
+            return -1;
+        }
+    }
+
+    if (plan->phaseCount == 0) {
+        printf("%s: the plan has no phases\n", path);
+        return -1;
+    }
+
+    return 0;
+}
+
+static pid_t startServer(const struct dc_posix_env *env, struct dc_error *err, struct scenario *scenario, u_int16_t port) {
+    char portText[8];
+    const char *argv[] = {
+            scenario->serverProgram,
+            "--port", portText,
+            "--tcp-log", scenario->tcpLog,
+            "--udp-log", scenario->udpLog,
+            NULL
+    };
+    int status;
+
+    sprintf(portText, "%hu", port);
+    scenario->serverPID = spawnProcess(env, err, argv, scenario->serverFD);
+    sleepMillis(SCENARIO_STARTUP_MS);
+
+    // A server that could not start or bind its port has exited by now.
+    if (scenario->serverPID > 0 && waitpid(scenario->serverPID, &status, WNOHANG) != 0) {
+        scenario->serverPID = -1;
+    }
+
+    return scenario->serverPID;
+}
+
+static void startClient(const struct dc_posix_env *env, struct dc_error *err, const struct scenario *scenario,
+        u_int16_t port, struct scenario_slot *slot, double remaining) {
+    char portText[8];
+    char packets[8];
+    char packetSize[8];
+    char packetRate[16];
+    const char *argv[] = {
+            scenario->clientProgram,
+            "--port", portText,
+            "--packets", packets,
+            "--pSize", packetSize,
+            "--rate", packetRate,
+            "--delay", "0",
+            NULL
+    };
+    double count = remaining * (double) slot->flow->rate;
+
+    // Too little time is left for another test to be worth its TCP handshake.
+    if (remaining * 1000.0 < SCENARIO_MIN_CHUNK_MS || count < 1.0) {
+        slot->done = true;
+        return;
+    }
+
+    slot->packets = count > SCENARIO_MAX_PACKETS ? SCENARIO_MAX_PACKETS : (u_int32_t) count;
+    sprintf(portText, "%hu", port);
+    sprintf(packets, "%u", slot->packets);
+    sprintf(packetSize, "%hu", slot->flow->size);
+    sprintf(packetRate, "%u", slot->flow->rate);
+    slot->pid = spawnProcess(env, err, argv, scenario->clientFD);
+
+    if (slot->pid == -1) {
+        slot->pid = 0;
+        slot->done = true;
+    }
+}
+
+static void reapClient(struct scenario_slot *slot, struct phase_result *result) {
+    struct rusage usage;
+    pid_t pid;
+    int status;
+
+    pid = wait4(slot->pid, &status, WNOHANG, &usage);
+
+    if (pid == 0) {
+        return;
+    }
+
+    slot->pid = 0;
+    result->clientsRun++;
+
+    if (pid == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        // A client that cannot connect would fail again, so its slot stays empty.
+        result->clientsFailed++;
+        slot->done = true;
+        return;
+    }
+
+    result->packetsSent += slot->packets;
+    result->clientCpu += rusageCpuSeconds(&usage);
+}
+
+static void stopClients(const struct dc_posix_env *env, struct dc_error *err, struct scenario_slot *slots, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (slots[i].pid > 0) {
+            stopProcess(env, err, slots[i].pid);
+            slots[i].pid = 0;
+        }
+    }
+}
+
+int runPhase(const struct dc_posix_env *env, struct dc_error *err, struct scenario *scenario, u_int16_t port,
+        const struct scenario_phase *phase, struct phase_result *result) {
+    struct scenario_slot slots[SCENARIO_MAX_CLIENTS];
+    size_t slotCount = 0;
+    size_t running;
+    double start;
+    double now;
+    double serverCpuStart;
+    int status;
+
+    for (size_t i = 0; i < phase->flowCount; i++) {
+        const struct scenario_flow *flow = &phase->flows[i];
+
+        // Spread the flow's clients over the ramp so its load climbs one client at a time.
+        for (u_int16_t j = 0; j < flow->clients; j++) {
+            slots[slotCount].flow = flow;
+            slots[slotCount].startAt = (double) phase->ramp * j / flow->clients;
+            slots[slotCount].packets = 0;
+            slots[slotCount].pid = 0;
+            slots[slotCount].done = false;
+            slotCount++;
+        }
+    }
+
+    memset(result, 0, sizeof(*result));
+    result->phase = phase;
+    result->wallStart = wallSeconds();
+    serverCpuStart = processCpuSeconds(scenario->serverPID);
+    start = monotonicSeconds();
+
+    do {
+        now = monotonicSeconds() - start;
+        running = 0;
+
+        if (waitpid(scenario->serverPID, &status, WNOHANG) != 0) {
+            printf("Server Exited -> Stopping Scenario\n");
+            scenario->serverPID = 0;
+            stopClients(env, err, slots, slotCount);
+            return -1;
+        }
+
+        for (size_t i = 0; i < slotCount; i++) {
+            struct scenario_slot *slot = &slots[i];
+
+            if (slot->pid > 0) {
+                reapClient(slot, result);
+            }
+
+            if (slot->pid == 0 && !slot->done && now >= slot->startAt && now < phase->duration) {
+                startClient(env, err, scenario, port, slot, phase->duration - now);
+            }
+
+            if (slot->pid > 0) {
+                running++;
+            }
+        }
+
+        if (now < phase->duration || running > 0) {
+            sleepMillis(SCENARIO_TICK_MS);
+        }
+    } while (now < phase->duration || running > 0);
+
+    result->seconds = monotonicSeconds() - start;
+    result->serverCpu = 100.0 * (processCpuSeconds(scenario->serverPID) - serverCpuStart) / result->seconds;
+    result->clientCpu = 100.0 * result->clientCpu / result->seconds;
+
+    return 0;
+}
+
+int measurePhases(const struct dc_posix_env *env, struct dc_error *err, const struct scenario *scenario,
+        struct phase_result *results, size_t count) {
+    const char *argv[] = {
+            scenario->parserProgram,
+            "--tcp-log", scenario->tcpLog,
+            "--udp-log", scenario->udpLog,
+            "--window", "1",
+            "--format", "csv",
+            NULL
+    };
+    double sumSquares[SCENARIO_MAX_PHASES] = {0};
+    char line[256];
+    FILE *file;
+    pid_t pid;
+    int fd;
+
+    fd = dc_open(env, err, scenario->windows, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+    if (dc_error_has_error(err)) {
+        return -1;
+    }
+
+    pid = spawnProcess(env, err, argv, fd);
+    dc_close(env, err, fd);
+
+    if (pid == -1 || waitProcess(env, err, pid, NULL) != 0) {
+        return -1;
+    }
+
+    // Only whole seconds inside the steady state count, so a phase is never measured while it ramps or stops.
+    for (size_t i = 0; i < count; i++) {
+        const struct scenario_phase *phase = results[i].phase;
+        u_int16_t settle = phase->ramp > phase->warmup ? phase->ramp : phase->warmup;
+        double steadyStart = ceil(results[i].wallStart + settle);
+        double steadyEnd = floor(results[i].wallStart + phase->duration);
+
+        results[i].steadyFrom = (time_t) steadyStart;
+        results[i].steadySeconds = steadyEnd > steadyStart ? (u_int32_t) (steadyEnd - steadyStart) : 0;
+    }
+
+    file = fopen(scenario->windows, "r");
+
+    if (file == NULL) {
+        return -1;
+    }
+
+    // A second's packets are added to every phase whose steady state holds it; the squares give the variation.
+    while (fgets(line, sizeof(line), file) != NULL) {
+        struct tm civil;
+        unsigned long received;
+        unsigned long lost;
+        unsigned long bytes;
+        unsigned long reordered;
+        time_t second;
+
+        memset(&civil, 0, sizeof(civil));
+
+        // The rows summed over every client are the only ones named "all".
+        if (strncmp(line, "\"all\",", 6) != 0
+            || sscanf(line + 6, "%*u,%d-%d-%d %d:%d:%d,%lu,%lu,%lu,%lu", &civil.tm_year, &civil.tm_mon,
+                      &civil.tm_mday, &civil.tm_hour, &civil.tm_min, &civil.tm_sec, &received, &lost, &bytes,
+                      &reordered) != 10) {
+            continue;
+        }
+
+        // The server stamps packets with local time, so mktime() gives back the second they arrived.
+        civil.tm_year -= 1900;
+        civil.tm_mon -= 1;
+        civil.tm_isdst = -1;
+        second = mktime(&civil);
+
+        for (size_t i = 0; i < count; i++) {
+            if (second >= results[i].steadyFrom && second < results[i].steadyFrom + results[i].steadySeconds) {
+                results[i].received += received;
+                results[i].lost += lost;
+                results[i].bytes += bytes;
+                results[i].reordered += reordered;
+                sumSquares[i] += (double) received * (double) received;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        double mean;
+        double variance;
+
+        if (results[i].steadySeconds == 0) {
+            continue;
+        }
+
+        // Seconds without a row received nothing and still count towards the mean.
+        mean = (double) results[i].received / results[i].steadySeconds;
+        variance = sumSquares[i] / results[i].steadySeconds - mean * mean;
+        results[i].variation = mean > 0.0 ? sqrt(variance > 0.0 ? variance : 0.0) / mean : 0.0;
+        results[i].steady = mean > 0.0 && results[i].variation <= SCENARIO_STEADY_VARIATION;
+    }
+
+    fclose(file);
+    return 0;
+}
+
+static double megabitsPerSecond(u_int64_t bytes, u_int32_t seconds) {
+    return seconds > 0 ? (double) bytes * 8.0 / 1000000.0 / seconds : 0.0;
+}
+
+static double offeredRate(const struct scenario_phase *phase) {
+    double rate = 0.0;
+
+    for (size_t i = 0; i < phase->flowCount; i++) {
+        rate += (double) phase->flows[i].clients * (double) phase->flows[i].rate;
+    }
+
+    return rate;
+}
+
+int writeScenarioReport(const char *path, const char *planPath, const struct scenario_plan *plan,
+        const struct phase_result *results, size_t count) {
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL) {
+        return -1;
+    }
+
+    fprintf(file, "{\n  \"plan\": \"%s\",\n  \"port\": %hu,\n  \"phases\": [", planPath, plan->port);
+
+    for (size_t i = 0; i < count; i++) {
+        const struct phase_result *result = &results[i];
+        const struct scenario_phase *phase = result->phase;
+        u_int64_t expected = result->received + result->lost;
+
+        fprintf(file, "%s\n    {\"name\": \"%s\", \"duration_seconds\": %hu, \"ramp_seconds\": %hu, "
+                      "\"warmup_seconds\": %hu, \"clients\": %zu, \"offered_pps\": %.0f,\n     \"flows\": [",
+                i == 0 ? "" : ",", phase->name, phase->duration, phase->ramp, phase->warmup, phase->clients,
+                offeredRate(phase));
+
+        for (size_t j = 0; j < phase->flowCount; j++) {
+            fprintf(file, "%s{\"clients\": %hu, \"rate\": %u, \"size\": %hu}", j == 0 ? "" : ", ",
+                    phase->flows[j].clients, phase->flows[j].rate, phase->flows[j].size);
+        }
+
+        fprintf(file, "],\n     \"clients_run\": %u, \"clients_failed\": %u, \"packets_sent\": %" PRIu64 ", "
+                      "\"server_cpu_percent\": %.1f, \"client_cpu_percent\": %.1f,\n     \"steady_seconds\": %u, "
+                      "\"received_pps\": %.1f, \"throughput_mbps\": %.3f, \"received\": %" PRIu64 ", "
+                      "\"lost\": %" PRIu64 ", \"loss_percent\": %.3f, \"reordered\": %" PRIu64 ", "
+                      "\"rate_variation\": %.3f, \"steady\": %s}",
+                result->clientsRun, result->clientsFailed, result->packetsSent,
+                result->serverCpu, result->clientCpu, result->steadySeconds,
+                result->steadySeconds > 0 ? (double) result->received / result->steadySeconds : 0.0,
+                megabitsPerSecond(result->bytes, result->steadySeconds), result->received,
+                result->lost, expected > 0 ? 100.0 * (double) result->lost / (double) expected : 0.0,
+                result->reordered, result->variation, result->steady ? "true" : "false");
+    }
+
+    fprintf(file, "\n  ]\n}\n");
+    fclose(file);
+    return 0;
+}
+
+static int run(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings *settings) {
+    struct application_settings *app_settings;
+    struct scenario_plan plan;
+    struct phase_result results[SCENARIO_MAX_PHASES];
+    struct scenario scenario;
+    const char *planPath;
+    const char *workDir;
+    const char *report;
+    char serverOutput[512];
+    size_t completed = 0;
+    int fd;
+
+    DC_TRACE(env);
+
+    app_settings = (struct application_settings *)settings;
+    dc_memset(env, &scenario, 0, sizeof(scenario));
+    planPath = dc_setting_string_get(env, app_settings->plan);
+    scenario.serverProgram = dc_setting_string_get(env, app_settings->server);
+    scenario.clientProgram = dc_setting_string_get(env, app_settings->client);
+    scenario.parserProgram = dc_setting_string_get(env, app_settings->parser);
+    workDir = dc_setting_string_get(env, app_settings->workDir);
+    report = dc_setting_string_get(env, app_settings->report);
+
+    if (loadPlan(planPath, &plan) != 0) {
+        printf("Invalid Plan -> Closing Scenario\n");
+        return EXIT_FAILURE;
+    }
+
+    if (mkdir(workDir, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) != 0 && errno != EEXIST) {
+        printf("Could not create %s -> Closing Scenario\n", workDir);
+        return EXIT_FAILURE;
+    }
+
+    snprintf(scenario.tcpLog, sizeof(scenario.tcpLog), "%s/tcpLog.txt", workDir);
+    snprintf(scenario.udpLog, sizeof(scenario.udpLog), "%s/udpLog.txt", workDir);
+    snprintf(scenario.clientOutput, sizeof(scenario.clientOutput), "%s/clients.txt", workDir);
+    snprintf(scenario.windows, sizeof(scenario.windows), "%s/windows.csv", workDir);
+    snprintf(serverOutput, sizeof(serverOutput), "%s/server.txt", workDir);
+
+    // Every run starts from empty logs so the windows hold this scenario only.
+    fd = dc_open(env, err, scenario.tcpLog, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    dc_close(env, err, fd);
+    fd = dc_open(env, err, scenario.udpLog, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    dc_close(env, err, fd);
+    scenario.serverFD = dc_open(env, err, serverOutput, O_WRONLY | O_CREAT | O_TRUNC,
+                                S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    scenario.clientFD = dc_open(env, err, scenario.clientOutput, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND,
+                                S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+    if (dc_error_has_error(err) || startServer(env, err, &scenario, plan.port) == -1) {
+        printf("Could not start %s -> Closing Scenario\n", scenario.serverProgram);
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < plan.phaseCount; i++) {
+        const struct scenario_phase *phase = &plan.phases[i];
+
+        printf("Phase %s: %zu clients, %.0f pps offered for %hu sec\n", phase->name, phase->clients,
+               offeredRate(phase), phase->duration);
+
+        if (runPhase(env, err, &scenario, plan.port, phase, &results[i]) != 0) {
+            break;
+        }
+
+        completed++;
+    }
+
+    // Let the server write what is still in its socket buffer before it stops.
+    sleepMillis(SCENARIO_DRAIN_MS);
+    stopProcess(env, err, scenario.serverPID);
+    dc_close(env, err, scenario.serverFD);
+    dc_close(env, err, scenario.clientFD);
+
+    if (completed == 0 || measurePhases(env, err, &scenario, results, completed) != 0) {
+        printf("Could not measure the phases -> Closing Scenario\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("----------------------------------------\n");
+
+    for (size_t i = 0; i < completed; i++) {
+        const struct phase_result *result = &results[i];
+        u_int64_t expected = result->received + result->lost;
+
+        printf("%-16s %8.0f pps offered %10.1f pps received %9.3f Mbit/s  loss %6.3f%%  reordered %" PRIu64 "  "
+               "server cpu %5.1f%%  %s\n", result->phase->name,
+               offeredRate(result->phase),
+               result->steadySeconds > 0 ? (double) result->received / result->steadySeconds : 0.0,
+               megabitsPerSecond(result->bytes, result->steadySeconds),
+               expected > 0 ? 100.0 * (double) result->lost / (double) expected : 0.0,
+               result->reordered, result->serverCpu,
+               result->steadySeconds == 0 ? "no steady state, lengthen the phase"
+                                          : result->steady ? "steady" : "unsteady");
+
+        if (result->clientsFailed > 0) {
+            printf("%-16s %u of %u clients failed, see %s\n", "", result->clientsFailed, result->clientsRun,
+                   scenario.clientOutput);
+        }
+    }
+
+    if (writeScenarioReport(report, planPath, &plan, results, completed) != 0) {
+        printf("Could not write %s\n", report);
+        return EXIT_FAILURE;
+    }
+
+    return completed == plan.phaseCount ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static void error_reporter(const struct dc_error *err) {
+    fprintf(stderr, "ERROR: %s : %s : @ %zu : %d\n", err->file_name, err->function_name, err->line_number, 0);
+    fprintf(stderr, "ERROR: %s\n", err->message);
+}
+
+static void trace_reporter(__attribute__((unused)) const struct dc_posix_env *env, const char *file_name,
+                           const char *function_name, size_t line_number) {
+    fprintf(stdout, "TRACE: %s : %s : @ %zu\n", file_name, function_name, line_number);
+}
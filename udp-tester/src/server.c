@@ -4,6 +4,17 @@ struct application_settings {
     struct dc_opt_settings opts;
     struct dc_setting_string *message;
     struct dc_setting_uint16 *port;
+    struct dc_setting_string *tcpLog;
+    struct dc_setting_string *udpLog;
+    struct dc_setting_string *streamLog;
+    struct dc_setting_bool *busyPoll;
+    struct dc_setting_string *cpu;
+    struct dc_setting_uint16 *busyPollUsec;
+    struct dc_setting_string *logFormat;
+    struct dc_setting_uint16 *statsInterval;
+    struct dc_setting_string *statsLog;
+    struct dc_setting_uint16 *metricsPort;
+    struct dc_setting_string *backend;
 };
 
 static struct dc_application_settings *create_settings(const struct dc_posix_env *env, struct dc_error *err);
@@ -11,6 +22,18 @@ static int destroy_settings(const struct dc_posix_env *env, struct dc_error *err
 static int run(const struct dc_posix_env *env, struct dc_error *err, struct dc_application_settings *settings);
 static void error_reporter(const struct dc_error *err);
 static void trace_reporter(const struct dc_posix_env *env, const char *file_name, const char *function_name, size_t line_number);
+static void stopServer(int signalNumber);
+static int pinToCpu(int cpu, cpu_set_t *original);
+static void serveClient(const struct dc_posix_env *env, struct dc_error *err, int connfd,
+                        const struct sockaddr_in *cliaddr, size_t idCounter, int tcpLogFD, int streamLogFD,
+                        const struct rate_series *series);
+static pid_t acceptClient(const struct dc_posix_env *env, struct dc_error *err, int listenfd, size_t *idCounter,
+                          int tcpLogFD, int streamLogFD, const cpu_set_t *childAffinity,
+                          const struct rate_series *series);
+static void reapClients(struct server_metrics *metrics);
+static void closeDescriptor(const struct dc_posix_env *env, struct dc_error *err, int fd);
+
+static volatile sig_atomic_t serverRunning = 1;
 
 int main(int argc, char *argv[]) {
     dc_posix_tracer tracer;
@@ -39,6 +62,10 @@ static struct dc_application_settings *create_settings(const struct dc_posix_env
     struct application_settings *settings;
 
     static const uint16_t default_port = DEFAULT_PORT;
+    static const bool default_busyPoll = false;
+    static const uint16_t default_busyPollUsec = DEFAULT_BUSY_POLL_USEC;
+    static const uint16_t default_statsInterval = DEFAULT_STATS_INTERVAL;
+    static const uint16_t default_metricsPort = DEFAULT_METRICS_PORT;
 
     DC_TRACE(env);
     settings = dc_malloc(env, err, sizeof(struct application_settings));
@@ -50,6 +77,17 @@ static struct dc_application_settings *create_settings(const struct dc_posix_env
     settings->opts.parent.config_path = dc_setting_path_create(env, err);
     settings->message = dc_setting_string_create(env, err);
     settings->port = dc_setting_uint16_create(env, err);
+    settings->tcpLog = dc_setting_string_create(env, err);
+    settings->udpLog = dc_setting_string_create(env, err);
+    settings->streamLog = dc_setting_string_create(env, err);
+    settings->busyPoll = dc_setting_bool_create(env, err);
+    settings->cpu = dc_setting_string_create(env, err);
+    settings->busyPollUsec = dc_setting_uint16_create(env, err);
+    settings->logFormat = dc_setting_string_create(env, err);
+    settings->statsInterval = dc_setting_uint16_create(env, err);
+    settings->statsLog = dc_setting_string_create(env, err);
+    settings->metricsPort = dc_setting_uint16_create(env, err);
+    settings->backend = dc_setting_string_create(env, err);
 
     struct options opts[] = {
             {(struct dc_setting *)settings->opts.parent.config_path,
@@ -82,6 +120,116 @@ static struct dc_application_settings *create_settings(const struct dc_posix_env
                     "port",
                     dc_uint16_from_config,
                     &default_port},
+            {(struct dc_setting *)settings->tcpLog,
+                    dc_options_set_string,
+                    "tcp-log",
+                    required_argument,
+                    't',
+                    "TCP_LOG",
+                    dc_string_from_string,
+                    "tcp-log",
+                    dc_string_from_config,
+                    DEFAULT_TCP_LOG},
+            {(struct dc_setting *)settings->udpLog,
+                    dc_options_set_string,
+                    "udp-log",
+                    required_argument,
+                    'u',
+                    "UDP_LOG",
+                    dc_string_from_string,
+                    "udp-log",
+                    dc_string_from_config,
+                    DEFAULT_UDP_LOG},
+            {(struct dc_setting *)settings->streamLog,
+                    dc_options_set_string,
+                    "stream-log",
+                    required_argument,
+                    'l',
+                    "STREAM_LOG",
+                    dc_string_from_string,
+                    "stream-log",
+                    dc_string_from_config,
+                    DEFAULT_STREAM_LOG},
+            {(struct dc_setting *)settings->busyPoll,
+                    dc_options_set_bool,
+                    "busy-poll",
+                    no_argument,
+                    'b',
+                    "BUSY_POLL",
+                    dc_flag_from_string,
+                    "busy-poll",
+                    dc_flag_from_config,
+                    &default_busyPoll},
+            {(struct dc_setting *)settings->cpu,
+                    dc_options_set_string,
+                    "cpu",
+                    required_argument,
+                    'C',
+                    "CPU",
+                    dc_string_from_string,
+                    "cpu",
+                    dc_string_from_config,
+                    DEFAULT_CPU},
+            {(struct dc_setting *)settings->busyPollUsec,
+                    dc_options_set_uint16,
+                    "busy-poll-usec",
+                    required_argument,
+                    'B',
+                    "BUSY_POLL_USEC",
+                    dc_uint16_from_string,
+                    "busy-poll-usec",
+                    dc_uint16_from_config,
+                    &default_busyPollUsec},
+            {(struct dc_setting *)settings->logFormat,
+                    dc_options_set_string,
+                    "log-format",
+                    required_argument,
+                    'L',
+                    "LOG_FORMAT",
+                    dc_string_from_string,
+                    "log-format",
+                    dc_string_from_config,
+                    DEFAULT_LOG_FORMAT},
+            {(struct dc_setting *)settings->statsInterval,
+                    dc_options_set_uint16,
+                    "stats-interval",
+                    required_argument,
+                    'I',
+                    "STATS_INTERVAL",
+                    dc_uint16_from_string,
+                    "stats-interval",
+                    dc_uint16_from_config,
+                    &default_statsInterval},
+            {(struct dc_setting *)settings->statsLog,
+                    dc_options_set_string,
+                    "stats-log",
+                    required_argument,
+                    'S',
+                    "STATS_LOG",
+                    dc_string_from_string,
+                    "stats-log",
+                    dc_string_from_config,
+                    DEFAULT_STATS_LOG},
+            {(struct dc_setting *)settings->metricsPort,
+                    dc_options_set_uint16,
+                    "metrics-port",
+                    required_argument,
+                    'M',
+                    "METRICS_PORT",
+                    dc_uint16_from_string,
+                    "metrics-port",
+                    dc_uint16_from_config,
+                    &default_metricsPort},
+            {(struct dc_setting *)settings->backend,
+                    dc_options_set_string,
+                    "backend",
+                    required_argument,
+                    'E',
+                    "BACKEND",
+                    dc_string_from_string,
+                    "backend",
+                    dc_string_from_config,
+                    DEFAULT_BACKEND},
     };
 
     settings->opts.opts_count = (sizeof(opts) / sizeof(struct options)) + 1;
@@ -119,111 +267,379 @@ int max(int x, int y) {
     }
 }
 
-void createServer(const struct dc_posix_env *env, struct dc_error *err, u_int16_t tcpPort) {
-    int listenfd, connfd, udpfd, maxfdp1;
+static void stopServer(__attribute__((unused)) int signalNumber) {
+    serverRunning = 0;
+}
+
+static int pinToCpu(int cpu, cpu_set_t *original) {
+    cpu_set_t pinned;
+
+    if (sched_getaffinity(0, sizeof(*original), original) == -1) {
+        return -1;
+    }
+
+    CPU_ZERO(&pinned);
+    CPU_SET((size_t) cpu, &pinned);
+
+    return sched_setaffinity(0, sizeof(pinned), &pinned);
+}
+
+static void serveClient(const struct dc_posix_env *env, struct dc_error *err, int connfd,
+                        const struct sockaddr_in *cliaddr, size_t idCounter, int tcpLogFD, int streamLogFD,
+                        const struct rate_series *series) {
     char buffer[MAXLINE] = {0};
     char packet[MAXLINE] = {0};
     char clientIP[128] = {0};
     char clientID[6] = {0};
     u_int16_t clientPort;
-    fd_set rset;
-    socklen_t len;
-    struct sockaddr_in cliaddr, servaddr;
-    pid_t childPID;
-    char clientPacketID[7] = {0};
-    char *currentTimeString;
-    time_t currentTime;
-    int udpLogFD;
-    int tcpLogFD;
+
+    inet_ntop(cliaddr->sin_family, &(cliaddr->sin_addr), clientIP, sizeof(clientIP));
+    clientPort = ntohs(cliaddr->sin_port);
+
+    dc_read(env, err, connfd, buffer, sizeof(buffer));
+
+    // The child was forked from the receiving process, so its copy of the rings is current as of the accept.
+    if (dc_strncmp(env, buffer, STATS_COMMAND, sizeof(STATS_COMMAND) - 1) == 0) {
+        u_int32_t statsClient = (u_int32_t) strtoul(buffer + sizeof(STATS_COMMAND) - 1, NULL, 10);
+
+        writeRateSeries(env, err, series, connfd, statsClient, wallMilliseconds());
+        return;
+    }
+
+    clientID[formatDecimal(clientID, idCounter % 10000, 4)] = '\0';
+    dc_write(env, err, connfd, clientID, sizeof(clientID));
+
+    // stream sessions are reported to the stream log only, the TCP log stays packet registrations
+    if (dc_strncmp(env, buffer, STREAM_COMMAND, sizeof(STREAM_COMMAND) - 1) == 0) {
+        struct stream_report report;
+        const char *interval = strstr(buffer, "Interval:");
+
+        sprintf(packet, "Stream Client %s:%s:%hu", clientID, clientIP, clientPort);
+        report.label = packet;
+        report.intervalMs = interval != NULL ? (u_int16_t) strtoul(interval + sizeof("Interval:") - 1, NULL, 10)
+                                             : DEFAULT_STREAM_INTERVAL;
+        report.logFD = streamLogFD;
+
+        if (receiveStream(env, err, connfd, &report) == -1) {
+            printf("TCP Stream Receive Failed -> Closing Client\n");
+        }
+
+        return;
+    }
+
+    // reverse sessions: this child transmits to the client's UDP port, the client keeps the logs
+    if (dc_strncmp(env, buffer, REVERSE_COMMAND, sizeof(REVERSE_COMMAND) - 1) == 0) {
+        struct packet_sender sender;
+        u_int16_t reversePort = 0;
+        unsigned int rate = 0;
+
+        sender.packets = 0;
+        sender.packetSize = 0;
+        sscanf(buffer, REVERSE_COMMAND "%hu Packets:%hu Size:%hu Rate:%u", &reversePort, &sender.packets,
+               &sender.packetSize, &rate);
+
+        sender.socketFD = dc_socket(env, err, AF_INET, SOCK_DGRAM, 0);
+        sender.destination = *cliaddr;
+        sender.destination.sin_port = htons(reversePort);
+        sender.clientID = clientID;
+        sender.rate = rate;
+
+        if (dc_error_has_no_error(err) && sendPackets(env, err, &sender) == -1) {
+            printf("UDP Reverse Send Failed -> Closing Client\n");
+        }
+
+        // closing the control connection tells the client the transmission is over
+        dc_close(env, err, sender.socketFD);
+        return;
+    }
+
+    sprintf(packet, "TCP Client %s:%s:%hu:%s", clientID, clientIP, clientPort, buffer);
+    dc_write(env, err, tcpLogFD, packet, dc_strlen(env, packet));
+}
+
+static pid_t acceptClient(const struct dc_posix_env *env, struct dc_error *err, int listenfd, size_t *idCounter,
+                          int tcpLogFD, int streamLogFD, const cpu_set_t *childAffinity,
+                          const struct rate_series *series) {
+    struct sockaddr_in cliaddr;
+    socklen_t len = sizeof(cliaddr);
+    char command[sizeof(STATS_COMMAND) - 1];
+    pid_t child;
+    int connfd;
+
+    connfd = dc_accept(env, err, listenfd, (struct sockaddr*)&cliaddr, &len);
+
+    if (connfd == -1) {
+        return -1;
+    }
+
+    // accepts wait for the command, so a stats query can be told apart without blocking and gets no client id
+    if (recv(connfd, command, sizeof(command), MSG_PEEK | MSG_DONTWAIT) != (ssize_t) sizeof(command)
+        || dc_strncmp(env, command, STATS_COMMAND, sizeof(command)) != 0) {
+        (*idCounter)++;
+    }
+
+    child = dc_fork(env, err);
+
+    if (child == 0) {
+        // children must not inherit the pinned core or the shutdown handler
+        if (childAffinity != NULL) {
+            sched_setaffinity(0, sizeof(*childAffinity), childAffinity);
+        }
+
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+        dc_close(env, err, listenfd);
+        serveClient(env, err, connfd, &cliaddr, *idCounter, tcpLogFD, streamLogFD, series);
+        dc_close(env, err, connfd);
+        dc_exit(env, 0);
+    }
+
+    dc_close(env, err, connfd);
+    return child;
+}
+
+static void reapClients(struct server_metrics *metrics) {
+    // reap finished children without blocking; a stream child can run for its whole duration
+    while (waitpid(-1, NULL, WNOHANG) > 0) {
+        if (metrics->sessionsActive > 0) {
+            metrics->sessionsActive--;
+        }
+    }
+}
+
+int createServer(const struct dc_posix_env *env, struct dc_error *err, const struct server_options *options) {
+    int listenfd = -1;
+    int udpfd = -1;
+    struct sockaddr_in servaddr;
+    struct sigaction stop;
+    struct udp_receiver receiver;
+    struct packed_writer packedLog;
+    struct rate_series series;
+    struct server_metrics metrics;
+    struct server_events events;
+    cpu_set_t originalAffinity;
+    const cpu_set_t *childAffinity = NULL;
+    int udpLogFD = -1;
+    int tcpLogFD = -1;
+    int streamLogFD = -1;
+    int statsLogFD = -1;
+    int metricsFD = -1;
+    int ready;
     size_t idCounter = 0;
+    bool packedOpen = false;
+    bool serving = false;
+    int ret_val = 0;
 
-    /* create listening TCP socket */
-    listenfd = socket(AF_INET, SOCK_STREAM, 0);
+    // Zeroed so the cleanup below can tell which of them were set up before a failure.
+    dc_memset(env, &series, 0, sizeof(series));
+    dc_memset(env, &receiver, 0, sizeof(receiver));
     dc_memset(env, &servaddr, 0, sizeof(servaddr));
     servaddr.sin_family = AF_INET;
     servaddr.sin_addr.s_addr = htonl(INADDR_ANY);
-    servaddr.sin_port = htons(tcpPort);
+    servaddr.sin_port = htons(options->port);
+
+    /* create listening TCP socket */
+    listenfd = socket(AF_INET, SOCK_STREAM, 0);
+
+    // back-to-back benchmark runs reuse the port while old sessions sit in TIME_WAIT
+    if (listenfd == -1 || setsockopt(listenfd, SOL_SOCKET, SO_REUSEADDR, &(int){1}, sizeof(int)) == -1) {
+        printf("TCP Socket Creation Failed -> Closing Server\n");
+        ret_val = -1;
+    }
 
     // binding server addr structure to listenfd
-    dc_bind(env, err, listenfd, (struct sockaddr*)&servaddr, sizeof(servaddr));
-    dc_listen(env, err, listenfd, 10);
-    dc_write(env, err, STDOUT_FILENO, "Server Listening for Connections...\n", sizeof ("Server Listening for Connections...\n"));
+    if (ret_val == 0 && (dc_bind(env, err, listenfd, (struct sockaddr*)&servaddr, sizeof(servaddr)) == -1
+                         || dc_listen(env, err, listenfd, 10) == -1)) {
+        printf("Binding TCP Port Failed -> Closing Server\n");
+        ret_val = -1;
+    }
 
-    /* create UDP socket */
-    udpfd = dc_socket(env, err, AF_INET, SOCK_DGRAM, 0);
-    // binding server addr structure to udp sockfd
-    dc_bind(env, err, udpfd, (struct sockaddr*)&servaddr, sizeof(servaddr));
+    if (ret_val == 0) {
+        // hand over connections once the client's command has arrived
+        setsockopt(listenfd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &(int){SERVER_DEFER_SECONDS}, sizeof(int));
+        dc_write(env, err, STDOUT_FILENO, "Server Listening for Connections...\n", sizeof ("Server Listening for Connections...\n"));
 
-    // clear the descriptor set
-    FD_ZERO(&rset);
+        /* create UDP socket */
+        udpfd = dc_socket(env, err, AF_INET, SOCK_DGRAM, 0);
 
-    // get maxfd
-    maxfdp1 = max(listenfd, udpfd) + 1;
-    for (;;) {
-        tcpLogFD = dc_open(env, err, "../../logs/tcpLog.txt", O_WRONLY|O_CREAT|O_APPEND, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
-        udpLogFD = dc_open(env, err, "../../logs/udpLog.txt", O_WRONLY|O_CREAT|O_APPEND, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+        // binding server addr structure to udp sockfd
+        if (udpfd == -1 || dc_bind(env, err, udpfd, (struct sockaddr*)&servaddr, sizeof(servaddr)) == -1) {
+            printf("Binding UDP Port Failed -> Closing Server\n");
+            ret_val = -1;
+        }
+    }
 
-        // set listenfd and udpfd in readset
-        FD_SET(listenfd, &rset);
-        FD_SET(udpfd, &rset);
+    // open the logs once; reopening them per packet leaked a descriptor every iteration
+    if (ret_val == 0) {
+        tcpLogFD = dc_open(env, err, options->tcpLog, O_WRONLY|O_CREAT|O_APPEND, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+        udpLogFD = dc_open(env, err, options->udpLog, O_WRONLY|O_CREAT|O_APPEND, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+        streamLogFD = dc_open(env, err, options->streamLog, O_WRONLY|O_CREAT|O_APPEND, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
 
-        // select the ready descriptor
-        select(maxfdp1, &rset, NULL, NULL, NULL);
+        if (options->statsLog[0] != '\0') {
+            statsLogFD = dc_open(env, err, options->statsLog, O_WRONLY|O_CREAT|O_APPEND, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+        }
 
-        // if tcp socket is readable then handle
-        // it by accepting the connection
-        if (FD_ISSET(listenfd, &rset)) {
-            idCounter++;
-            len = sizeof(cliaddr);
-            connfd = dc_accept(env, err, listenfd, (struct sockaddr*)&cliaddr, &len);
-            if ((childPID = dc_fork(env, err)) == 0) {
-                dc_close(env, err, listenfd);
-                dc_memset(env,buffer, 0, sizeof(buffer));
+        if (tcpLogFD == -1 || udpLogFD == -1 || streamLogFD == -1 || (options->statsLog[0] != '\0' && statsLogFD == -1)) {
+            printf("Opening Logs Failed -> Closing Server\n");
+            ret_val = -1;
+        }
+    }
 
-                inet_ntop(cliaddr.sin_family, &(cliaddr.sin_addr), clientIP, sizeof(clientIP));
-                clientPort = ntohs(cliaddr.sin_port);
+    if (ret_val == 0 && createRateSeries(env, err, &series, options->statsInterval, statsLogFD) == -1) {
+        printf("Rate Series Creation Failed -> Closing Server\n");
+        ret_val = -1;
+    }
 
-                dc_read(env, err, connfd, buffer, sizeof(buffer));
+    if (ret_val == 0 && options->packedLog) {
+        if (openPackedWriter(env, err, &packedLog, options->udpLog, udpLogFD) == -1) {
+            printf("UDP Log Is Not Packed -> Use A New Log For --log-format packed\n");
+            ret_val = -1;
+        } else {
+            packedOpen = true;
+        }
+    }
+
+    if (ret_val == 0 && createUdpReceiver(env, err, &receiver, udpfd, udpLogFD, packedOpen ? &packedLog : NULL,
+                                          &series) == -1) {
+        printf("UDP Receiver Creation Failed -> Closing Server\n");
+        ret_val = -1;
+    }
 
-                sprintf(clientID, "%04zu", idCounter);
-                dc_write(env, err, connfd, clientID, sizeof(clientID));
+    metrics.receiver = &receiver;
+    metrics.series = &series;
+    metrics.sessionsTotal = 0;
+    metrics.sessionsActive = 0;
 
-                sprintf(packet, "TCP Client %s:%s:%hu:%s", clientID, clientIP, clientPort, buffer);
-                dc_write(env, err, tcpLogFD, packet, dc_strlen(env, packet));
+    if (ret_val == 0 && options->metricsPort != 0) {
+        metricsFD = openMetricsListener(env, err, options->metricsPort);
 
-                dc_close(env, err, connfd);
-                dc_exit(env, 0);
+        if (metricsFD == -1) {
+            printf("Metrics Listener Failed -> Closing Server\n");
+            ret_val = -1;
+        }
+    }
+
+    if (ret_val == 0) {
+        serving = true;
+
+        // SIGINT/SIGTERM end the loop so the receive report is printed
+        dc_memset(env, &stop, 0, sizeof(stop));
+        stop.sa_handler = stopServer;
+        sigemptyset(&stop.sa_mask);
+        sigaction(SIGINT, &stop, NULL);
+        sigaction(SIGTERM, &stop, NULL);
+
+        if (options->cpu >= 0) {
+            if (pinToCpu(options->cpu, &originalAffinity) == 0) {
+                childAffinity = &originalAffinity;
+            } else {
+                printf("Pinning to CPU %d Failed -> Running Unpinned\n", options->cpu);
             }
-            int status;
-            dc_waitpid(env, err, childPID, &status, WUNTRACED);
-            dc_close(env, err, connfd);
         }
+    }
 
-        // if udp socket is readable receive the message.
-        if (FD_ISSET(udpfd, &rset)) {
-            len = sizeof(cliaddr);
-            dc_memset(env, buffer, 0, sizeof(buffer));
-            dc_recvfrom(env, err, udpfd, buffer, sizeof(buffer), 0, (struct sockaddr*)&cliaddr, &len);
+    if (serving && options->busyPoll) {
+        unsigned int spins = 0;
 
-            for (size_t i = 0; i < 4; i++) {
-                clientID[i] = buffer[i];
-            }
+        // spin on non-blocking recvmmsg; the listening socket and children are checked every SERVER_ACCEPT_SPINS turns
+        enableBusyPoll(udpfd, options->busyPollUsec);
+
+        while (serverRunning) {
+            receiveDatagrams(env, err, &receiver, MSG_DONTWAIT);
+
+            if (++spins >= SERVER_ACCEPT_SPINS) {
+                struct pollfd listening[2] = {{listenfd, POLLIN, 0}, {metricsFD, POLLIN, 0}};
+
+                spins = 0;
+                advanceRateSeries(env, err, &series, wallMilliseconds());
+                reapClients(&metrics);
+
+                // a negative fd is skipped by poll, so a server without metrics only checks the listener
+                if (poll(listening, 2, 0) > 0) {
+                    if (listening[0].revents & POLLIN && acceptClient(env, err, listenfd, &idCounter, tcpLogFD,
+                                                                      streamLogFD, childAffinity, &series) > 0) {
+                        metrics.sessionsTotal++;
+                        metrics.sessionsActive++;
+                    }
 
-            for (size_t i = 5; i < 11; i++) {
-                clientPacketID[i - 5] = buffer[i];
+                    if (listening[1].revents & POLLIN) {
+                        serveMetrics(env, err, metricsFD, &metrics);
+                    }
+                }
             }
+        }
+    }
+
+    // a busy-poll run has already ended here, so its sockets are never handed to a second receive path
+    if (serving && !options->busyPoll && openServerEvents(env, err, &events, options->backend, listenfd, &receiver,
+                                                          metricsFD) == -1) {
+        printf("Event Backend Failed -> Closing Server\n");
+        ret_val = -1;
+    }
 
-            time(&currentTime);
-            currentTimeString = dc_strdup(env, err, ctime(&currentTime));
-            currentTimeString[dc_strlen(env, currentTimeString) - 1] = '\0';
+    while (serving && ret_val == 0 && serverRunning) {
+        reapClients(&metrics);
 
-            inet_ntop(cliaddr.sin_family, &(cliaddr.sin_addr), clientIP, sizeof(clientIP));
-            clientPort = ntohs(cliaddr.sin_port);
+        // with a stats log the wait ends every interval so a quiet server still closes its intervals on time
+        ready = waitServerEvents(env, err, &events, statsLogFD != -1 ? (int) options->statsInterval : -1);
+
+        if (ready == -1) {
+            printf("Waiting On Sockets Failed -> Closing Server\n");
+            ret_val = -1;
+            break;
+        }
+
+        advanceRateSeries(env, err, &series, wallMilliseconds());
+
+        // if tcp socket is readable then handle
+        // it by accepting the connection
+        if (ready & EVENT_LISTEN
+            && acceptClient(env, err, listenfd, &idCounter, tcpLogFD, streamLogFD, childAffinity, &series) > 0) {
+            metrics.sessionsTotal++;
+            metrics.sessionsActive++;
+        }
+
+        // if udp socket is readable receive a batch of messages.
+        if (ready & EVENT_UDP) {
+            receiveDatagrams(env, err, &receiver, MSG_DONTWAIT);
+        }
 
-            sprintf(packet, "%s:%s:%s:%s:%hu\n", clientID, clientPacketID, currentTimeString, clientIP, clientPort);
-            dc_write(env, err, udpLogFD, packet, dc_strlen(env, packet));
+        if (ready & EVENT_METRICS) {
+            serveMetrics(env, err, metricsFD, &metrics);
         }
-        dc_close(env, err, udpLogFD);
+    }
+
+    // io_uring log writes still in flight land before the logs are closed.
+    if (serving && !options->busyPoll) {
+        closeServerEvents(env, err, &events);
+    }
+
+    // The block still being built holds up to PACKED_FLUSH_SECONDS of packets.
+    if (packedOpen && closePackedWriter(env, err, &packedLog) == -1) {
+        printf("Writing Packed UDP Log Failed\n");
+        ret_val = -1;
+    }
+
+    if (serving) {
+        printReceiverReport(&receiver, options->busyPoll ? "busy-poll" : eventBackendName(events.backend));
+    }
+
+    destroyUdpReceiver(env, &receiver);
+    destroyRateSeries(env, err, &series);
+    closeDescriptor(env, err, listenfd);
+    closeDescriptor(env, err, udpfd);
+    closeDescriptor(env, err, tcpLogFD);
+    closeDescriptor(env, err, udpLogFD);
+    closeDescriptor(env, err, streamLogFD);
+    closeDescriptor(env, err, statsLogFD);
+    closeDescriptor(env, err, metricsFD);
+
+    return ret_val;
+}
+
+static void closeDescriptor(const struct dc_posix_env *env, struct dc_error *err, int fd) {
+    if (fd != -1) {
+        dc_close(env, err, fd);
     }
 }
 
@@ -233,12 +649,40 @@ static int run(const struct dc_posix_env *env, struct dc_error *err, struct dc_a
     DC_TRACE(env);
 
     app_settings = (struct application_settings *)settings;
-    u_int16_t tcpPort;
-    tcpPort = dc_setting_uint16_get(env, app_settings->port);
+    struct server_options options;
+    options.port = dc_setting_uint16_get(env, app_settings->port);
+    options.tcpLog = dc_setting_string_get(env, app_settings->tcpLog);
+    options.udpLog = dc_setting_string_get(env, app_settings->udpLog);
+    options.streamLog = dc_setting_string_get(env, app_settings->streamLog);
+    options.busyPoll = dc_setting_bool_get(env, app_settings->busyPoll);
+    options.cpu = (int) strtol(dc_setting_string_get(env, app_settings->cpu), NULL, 10);
+    options.busyPollUsec = dc_setting_uint16_get(env, app_settings->busyPollUsec);
+    options.packedLog = strcmp(dc_setting_string_get(env, app_settings->logFormat), "packed") == 0;
+    options.statsInterval = dc_setting_uint16_get(env, app_settings->statsInterval);
+    options.statsLog = dc_setting_string_get(env, app_settings->statsLog);
+    options.metricsPort = dc_setting_uint16_get(env, app_settings->metricsPort);
+
+    if (!options.packedLog && strcmp(dc_setting_string_get(env, app_settings->logFormat), "text") != 0) {
+        printf("Unknown Log Format -> Use text Or packed\n");
+        return EXIT_FAILURE;
+    }
 
-    createServer(env, err, tcpPort);
+    if (parseEventBackend(dc_setting_string_get(env, app_settings->backend), &options.backend) == -1) {
+        printf("Unknown Backend -> Use select, epoll Or uring\n");
+        return EXIT_FAILURE;
+    }
+
+    if (options.busyPoll && options.backend != BACKEND_SELECT) {
+        printf("Busy Poll Runs Its Own Loop -> Drop --backend\n");
+        return EXIT_FAILURE;
+    }
+
+    if (options.statsInterval == 0) {
+        printf("Unknown Stats Interval -> Use Milliseconds Above 0\n");
+        return EXIT_FAILURE;
+    }
 
-    return EXIT_SUCCESS;
+    return createServer(env, err, &options) == -1 ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
 static void error_reporter(const struct dc_error *err) {
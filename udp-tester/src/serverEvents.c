@@ -0,0 +1,132 @@
+#include "serverEvents.h"
+
+static int watchEpoll(int epollFD, int fd, u_int32_t event);
+
+static const char *backendNames[] = {"select", "epoll", "uring"};
+
+int parseEventBackend(const char *name, enum event_backend *backend) {
+    for (size_t i = 0; i < sizeof(backendNames) / sizeof(backendNames[0]); i++) {
+        if (strcmp(name, backendNames[i]) == 0) {
+            *backend = (enum event_backend) i;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+const char *eventBackendName(enum event_backend backend) {
+    return backendNames[backend];
+}
+
+static int watchEpoll(int epollFD, int fd, u_int32_t event) {
+    struct epoll_event watch;
+
+    watch.events = EPOLLIN;
+    watch.data.u32 = event;
+
+    return epoll_ctl(epollFD, EPOLL_CTL_ADD, fd, &watch);
+}
+
+int openServerEvents(const struct dc_posix_env *env, struct dc_error *err, struct server_events *events,
+        enum event_backend backend, int listenFD, struct udp_receiver *receiver, int metricsFD) {
+    events->backend = backend;
+    events->listenFD = listenFD;
+    events->udpFD = receiver->socketFD;
+    events->metricsFD = metricsFD;
+    events->epollFD = -1;
+
+    if (backend == BACKEND_URING) {
+        if (createUringReceiver(env, err, &events->uring, receiver) == 0) {
+            watchUringSocket(&events->uring, listenFD, EVENT_LISTEN);
+
+            if (metricsFD != -1) {
+                watchUringSocket(&events->uring, metricsFD, EVENT_METRICS);
+            }
+
+            return 0;
+        }
+
+        printf("io_uring Unavailable (%s) -> Using epoll\n", strerror(errno));
+        // Flushed now, or every session child forked later would print it again.
+        fflush(stdout);
+        events->backend = BACKEND_EPOLL;
+    }
+
+    if (events->backend == BACKEND_EPOLL) {
+        events->epollFD = epoll_create1(EPOLL_CLOEXEC);
+
+        if (events->epollFD == -1 || watchEpoll(events->epollFD, listenFD, EVENT_LISTEN) == -1
+            || watchEpoll(events->epollFD, events->udpFD, EVENT_UDP) == -1
+            || (metricsFD != -1 && watchEpoll(events->epollFD, metricsFD, EVENT_METRICS) == -1)) {
+            DC_ERROR_RAISE_ERRNO(err, errno);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int waitServerEvents(const struct dc_posix_env *env, struct dc_error *err, struct server_events *events,
+        int timeoutMs) {
+    struct epoll_event ready[3];
+    struct timeval tick;
+    fd_set rset;
+    int maxfdp1;
+    int count;
+    int found = 0;
+
+    if (events->backend == BACKEND_URING) {
+        return waitUringReceiver(env, err, &events->uring, timeoutMs);
+    }
+
+    if (events->backend == BACKEND_EPOLL) {
+        count = epoll_wait(events->epollFD, ready, 3, timeoutMs);
+
+        for (int i = 0; i < count; i++) {
+            found |= (int) ready[i].data.u32;
+        }
+
+        return count == -1 && errno != EINTR ? -1 : found;
+    }
+
+    FD_ZERO(&rset);
+    FD_SET(events->listenFD, &rset);
+    FD_SET(events->udpFD, &rset);
+    maxfdp1 = (events->listenFD > events->udpFD ? events->listenFD : events->udpFD) + 1;
+
+    if (events->metricsFD != -1) {
+        FD_SET(events->metricsFD, &rset);
+        maxfdp1 = events->metricsFD >= maxfdp1 ? events->metricsFD + 1 : maxfdp1;
+    }
+
+    tick.tv_sec = timeoutMs / 1000;
+    tick.tv_usec = (timeoutMs % 1000) * 1000;
+
+    // A shutdown signal interrupts select, which reports no events so the caller can check for it.
+    if (select(maxfdp1, &rset, NULL, NULL, timeoutMs >= 0 ? &tick : NULL) == -1) {
+        if (errno == EINTR) {
+            return 0;
+        }
+
+        printf("Select Failed -> Closing Server\n");
+        return -1;
+    }
+
+    found |= FD_ISSET(events->listenFD, &rset) ? EVENT_LISTEN : 0;
+    found |= FD_ISSET(events->udpFD, &rset) ? EVENT_UDP : 0;
+    found |= events->metricsFD != -1 && FD_ISSET(events->metricsFD, &rset) ? EVENT_METRICS : 0;
+
+    return found;
+}
+
+void closeServerEvents(const struct dc_posix_env *env, struct dc_error *err, struct server_events *events) {
+    if (events->backend == BACKEND_URING) {
+        destroyUringReceiver(env, err, &events->uring);
+    }
+
+    if (events->epollFD != -1) {
+        dc_close(env, err, events->epollFD);
+        events->epollFD = -1;
+    }
+}
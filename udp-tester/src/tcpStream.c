@@ -0,0 +1,270 @@
+#include "tcpStream.h"
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+
+static double streamSeconds(void);
+static void writeStreamLine(const struct stream_report *report, const char *line, size_t length);
+static void printInterval(struct stream_report *report, double end);
+static int createPayload(const struct dc_posix_env *env, struct dc_error *err, char *payload);
+
+static double streamSeconds(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1000000000.0;
+}
+
+static void writeStreamLine(const struct stream_report *report, const char *line, size_t length) {
+    ssize_t ignored;
+
+    ignored = write(STDOUT_FILENO, line, length);
+
+    if (report->logFD != -1) {
+        ignored = write(report->logFD, line, length);
+    }
+
+    (void) ignored;
+}
+
+static void printInterval(struct stream_report *report, double end) {
+    char line[256];
+    double from = report->intervalStart - report->start;
+    double to = end - report->start;
+    double megabits = (double) report->intervalBytes * 8.0 / 1000000.0;
+    int length;
+
+    length = snprintf(line, sizeof(line), "%s:%.3f-%.3f sec:%" PRIu64 " bytes:%.2f Mbit/s\n", report->label,
+                      from, to, report->intervalBytes, to > from ? megabits / (to - from) : 0.0);
+    writeStreamLine(report, line, (size_t) length);
+
+    report->intervalStart = end;
+    report->intervalBytes = 0;
+}
+
+void startStreamReport(struct stream_report *report, const char *label, u_int16_t intervalMs, int logFD) {
+    report->label = label;
+    report->intervalMs = intervalMs > 0 ? intervalMs : DEFAULT_STREAM_INTERVAL;
+    report->logFD = logFD;
+    report->start = streamSeconds();
+    report->intervalStart = report->start;
+    report->intervalBytes = 0;
+    report->totalBytes = 0;
+}
+
+void addStreamBytes(struct stream_report *report, uint64_t bytes) {
+    double interval = (double) report->intervalMs / 1000.0;
+    double now = streamSeconds();
+
+    report->intervalBytes += bytes;
+    report->totalBytes += bytes;
+
+    if (now - report->intervalStart >= interval) {
+        printInterval(report, now);
+    }
+}
+
+void finishStreamReport(struct stream_report *report) {
+    char line[256];
+    double end = streamSeconds();
+    double elapsed = end - report->start;
+    int length;
+
+    if (report->intervalBytes > 0) {
+        printInterval(report, end);
+    }
+
+    length = snprintf(line, sizeof(line), "%s:Total %.3f sec:%" PRIu64 " bytes:%.2f Mbit/s\n", report->label,
+                      elapsed, report->totalBytes,
+                      elapsed > 0.0 ? (double) report->totalBytes * 8.0 / 1000000.0 / elapsed : 0.0);
+    writeStreamLine(report, line, (size_t) length);
+}
+
+static int createPayload(const struct dc_posix_env *env, struct dc_error *err, char *payload) {
+    int fd;
+
+    for (size_t i = 0; i < STREAM_CHUNK; i++) {
+        payload[i] = '*';
+    }
+
+    fd = memfd_create("udp-tester-stream", 0);
+
+    if (fd == -1) {
+        return -1;
+    }
+
+    if (dc_write(env, err, fd, payload, STREAM_CHUNK) != STREAM_CHUNK) {
+        dc_close(env, err, fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+int sendStream(const struct dc_posix_env *env, struct dc_error *err, int socketFD, u_int16_t seconds, uint64_t bytes,
+        struct stream_report *report) {
+    int bufferSize = STREAM_SOCKET_BUFFER;
+    struct sigaction ignorePipe;
+    struct sigaction previousPipe;
+    double deadline;
+    char *payload;
+    int payloadFD;
+    int ret_val = 0;
+
+    payload = dc_malloc(env, err, STREAM_CHUNK);
+
+    if (payload == NULL) {
+        return -1;
+    }
+
+    if (seconds == 0 && bytes == 0) {
+        seconds = DEFAULT_STREAM_SECONDS;
+    }
+
+    // sendfile() has no MSG_NOSIGNAL, so SIGPIPE is ignored for the transfer and a closed peer comes back as EPIPE.
+    dc_memset(env, &ignorePipe, 0, sizeof(ignorePipe));
+    ignorePipe.sa_handler = SIG_IGN;
+    sigemptyset(&ignorePipe.sa_mask);
+    sigaction(SIGPIPE, &ignorePipe, &previousPipe);
+
+    payloadFD = createPayload(env, err, payload);
+    setsockopt(socketFD, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+    startStreamReport(report, report->label, report->intervalMs, report->logFD);
+    deadline = report->start + (double) seconds;
+
+    while ((seconds == 0 || streamSeconds() < deadline) && (bytes == 0 || report->totalBytes < bytes)) {
+        size_t count = STREAM_CHUNK;
+        ssize_t sent = -1;
+
+        if (bytes != 0 && bytes - report->totalBytes < count) {
+            count = (size_t) (bytes - report->totalBytes);
+        }
+
+        if (payloadFD != -1) {
+            off_t offset = 0;
+
+            sent = sendfile(socketFD, payloadFD, &offset, count);
+
+            // Some socket types refuse sendfile(); drop to plain send() for the rest of the stream.
+            if (sent == -1 && (errno == EINVAL || errno == ENOSYS)) {
+                dc_close(env, err, payloadFD);
+                payloadFD = -1;
+                continue;
+            }
+        } else {
+            sent = send(socketFD, payload, count, MSG_NOSIGNAL);
+        }
+
+        if (sent == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            DC_ERROR_RAISE_ERRNO(err, errno);
+            ret_val = -1;
+            break;
+        }
+
+        addStreamBytes(report, (uint64_t) sent);
+    }
+
+    finishStreamReport(report);
+    sigaction(SIGPIPE, &previousPipe, NULL);
+
+    if (payloadFD != -1) {
+        dc_close(env, err, payloadFD);
+    }
+
+    dc_free(env, payload, STREAM_CHUNK);
+    return ret_val;
+}
+
+int receiveStream(const struct dc_posix_env *env, struct dc_error *err, int socketFD, struct stream_report *report) {
+    int bufferSize = STREAM_SOCKET_BUFFER;
+    int pipeFDs[2] = {-1, -1};
+    int nullFD;
+    char *buffer = NULL;
+    int ret_val = 0;
+
+    setsockopt(socketFD, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+    nullFD = dc_open(env, err, "/dev/null", O_WRONLY, 0);
+
+    if (nullFD == -1 || pipe(pipeFDs) == -1) {
+        pipeFDs[0] = -1;
+        pipeFDs[1] = -1;
+    }
+
+    startStreamReport(report, report->label, report->intervalMs, report->logFD);
+
+    for (;;) {
+        ssize_t received;
+
+        if (pipeFDs[0] != -1) {
+            received = splice(socketFD, NULL, pipeFDs[1], NULL, STREAM_CHUNK, SPLICE_F_MOVE | SPLICE_F_MORE);
+
+            if (received > 0) {
+                ssize_t drained = 0;
+
+                // Empty the pipe into /dev/null so the next splice has room.
+                while (drained < received) {
+                    ssize_t moved = splice(pipeFDs[0], NULL, nullFD, NULL, (size_t) (received - drained),
+                                           SPLICE_F_MOVE);
+
+                    if (moved <= 0) {
+                        break;
+                    }
+
+                    drained += moved;
+                }
+            } else if (received == -1 && errno == EINVAL) {
+                close(pipeFDs[0]);
+                close(pipeFDs[1]);
+                pipeFDs[0] = -1;
+                continue;
+            }
+        } else {
+            if (buffer == NULL) {
+                buffer = dc_malloc(env, err, STREAM_RECEIVE_BUFFER);
+
+                if (buffer == NULL) {
+                    ret_val = -1;
+                    break;
+                }
+            }
+
+            received = recv(socketFD, buffer, STREAM_RECEIVE_BUFFER, 0);
+        }
+
+        if (received == 0) {
+            break;
+        }
+
+        if (received == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            DC_ERROR_RAISE_ERRNO(err, errno);
+            ret_val = -1;
+            break;
+        }
+
+        addStreamBytes(report, (uint64_t) received);
+    }
+
+    finishStreamReport(report);
+
+    if (pipeFDs[0] != -1) {
+        close(pipeFDs[0]);
+        close(pipeFDs[1]);
+    }
+
+    if (nullFD != -1) {
+        dc_close(env, err, nullFD);
+    }
+
+    if (buffer != NULL) {
+        dc_free(env, buffer, STREAM_RECEIVE_BUFFER);
+    }
+
+    return ret_val;
+}
@@ -0,0 +1,293 @@
+#include "udpReceiver.h"
+
+static void recordLatency(struct latency_stats *stats, uint64_t ns);
+static void recordStage(struct stage_latency *stage, const struct timespec *from, const struct timespec *to);
+static double latencyPercentile(const struct latency_stats *stats, double percentile);
+static u_int32_t leadingDigits(const char *text, size_t length);
+
+int createUdpReceiver(const struct dc_posix_env *env, struct dc_error *err, struct udp_receiver *receiver,
+        int socketFD, int logFD, struct packed_writer *packed, struct rate_series *series) {
+    int enable = 1;
+
+    dc_memset(env, receiver, 0, sizeof(*receiver));
+    receiver->socketFD = socketFD;
+    receiver->logFD = logFD;
+    receiver->packed = packed;
+    receiver->series = series;
+    receiver->latency.minNs = UINT64_MAX;
+    receiver->slots = dc_malloc(env, err, RECEIVER_BATCH * RECEIVER_SLOT);
+    receiver->logBuffer = dc_malloc(env, err, RECEIVER_BATCH * RECEIVER_LOG_LINE);
+
+    if (receiver->slots == NULL || receiver->logBuffer == NULL) {
+        return -1;
+    }
+
+    receiver->timestamps = setsockopt(socketFD, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) == 0;
+
+    for (size_t i = 0; i < RECEIVER_BATCH; i++) {
+        receiver->iovecs[i].iov_base = receiver->slots + i * RECEIVER_SLOT;
+        receiver->iovecs[i].iov_len = RECEIVER_SLOT;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &receiver->started);
+    getrusage(RUSAGE_SELF, &receiver->startUsage);
+
+    return 0;
+}
+
+void destroyUdpReceiver(const struct dc_posix_env *env, struct udp_receiver *receiver) {
+    if (receiver->slots != NULL) {
+        dc_free(env, receiver->slots, RECEIVER_BATCH * RECEIVER_SLOT);
+    }
+
+    if (receiver->logBuffer != NULL) {
+        dc_free(env, receiver->logBuffer, RECEIVER_BATCH * RECEIVER_LOG_LINE);
+    }
+}
+
+static u_int32_t leadingDigits(const char *text, size_t length) {
+    u_int32_t value = 0;
+
+    for (size_t i = 0; i < length && text[i] >= '0' && text[i] <= '9'; i++) {
+        value = value * 10 + (u_int32_t) (text[i] - '0');
+    }
+
+    return value;
+}
+
+static void recordLatency(struct latency_stats *stats, uint64_t ns) {
+    uint64_t bucket = ns / 1000;
+
+    stats->buckets[bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS]++;
+    stats->count++;
+    stats->totalNs += ns;
+
+    if (ns < stats->minNs) {
+        stats->minNs = ns;
+    }
+
+    if (ns > stats->maxNs) {
+        stats->maxNs = ns;
+    }
+}
+
+static void recordStage(struct stage_latency *stage, const struct timespec *from, const struct timespec *to) {
+    int64_t ns = (int64_t) (to->tv_sec - from->tv_sec) * INT64_C(1000000000) + (to->tv_nsec - from->tv_nsec);
+    uint64_t us = ns > 0 ? ((uint64_t) ns + 999) / 1000 : 0;
+    size_t bucket = 0;
+
+    while (bucket < STAGE_BUCKETS && us > (UINT64_C(1) << bucket)) {
+        bucket++;
+    }
+
+    stage->buckets[bucket]++;
+    stage->count++;
+    stage->totalNs += ns > 0 ? (uint64_t) ns : 0;
+}
+
+void beginReceiveBatch(const struct dc_posix_env *env, struct dc_error *err, struct udp_receiver *receiver,
+        struct timespec *now, struct timespec *batchStart) {
+    clock_gettime(CLOCK_REALTIME, now);
+    clock_gettime(CLOCK_MONOTONIC, batchStart);
+
+    // ctime() only changes once a second, so it is formatted once per second rather than per packet.
+    if (now->tv_sec != receiver->cachedSecond) {
+        struct tm local;
+
+        receiver->cachedSecond = now->tv_sec;
+        ctime_r(&receiver->cachedSecond, receiver->timeString);
+        receiver->timeLength = dc_strlen(env, receiver->timeString) - 1;
+        receiver->timeString[receiver->timeLength] = '\0';
+
+        // The packed log stores the seconds ctime() shows, so both formats read back the same times.
+        localtime_r(&receiver->cachedSecond, &local);
+        receiver->wallSecond = (u_int32_t) (receiver->cachedSecond + local.tm_gmtoff);
+    }
+
+    if (receiver->series != NULL) {
+        advanceRateSeries(env, err, receiver->series,
+                          (u_int64_t) now->tv_sec * 1000 + (u_int64_t) now->tv_nsec / 1000000);
+    }
+}
+
+size_t logDatagram(const struct dc_posix_env *env, struct dc_error *err, struct udp_receiver *receiver,
+        char *packet, size_t length, const struct sockaddr_in *sender, struct msghdr *header,
+        const struct timespec *now, char *line) {
+    u_int32_t clientID;
+    u_int32_t packetID;
+
+    // Short datagrams must not pick up the previous occupant's header.
+    if (length < RECEIVER_SLOT) {
+        packet[length] = '\0';
+    }
+
+    if (receiver->timestamps) {
+        for (struct cmsghdr *control = CMSG_FIRSTHDR(header); control != NULL;
+             control = CMSG_NXTHDR(header, control)) {
+            if (control->cmsg_level == SOL_SOCKET && control->cmsg_type == SO_TIMESTAMPNS) {
+                struct timespec stamp;
+                int64_t ns;
+
+                hotCopy(&stamp, CMSG_DATA(control), sizeof(stamp));
+                ns = (int64_t) (now->tv_sec - stamp.tv_sec) * INT64_C(1000000000) + (now->tv_nsec - stamp.tv_nsec);
+                recordLatency(&receiver->latency, ns > 0 ? (uint64_t) ns : 0);
+            }
+        }
+    }
+
+    clientID = leadingDigits(packet, length < 4 ? length : 4);
+    packetID = length > 5 ? leadingDigits(packet + 5, length - 5 < 6 ? length - 5 : 6) : 0;
+    receiver->bytes += length;
+
+    if (receiver->series != NULL) {
+        countRatePacket(receiver->series, clientID, packetID, (u_int32_t) length);
+    }
+
+    if (receiver->packed != NULL) {
+        if (packRecord(env, err, receiver->packed, clientID, packetID, receiver->wallSecond, sender->sin_addr.s_addr,
+                       sender->sin_port) == -1) {
+            // A short block write fails without setting errno.
+            if (dc_error_has_no_error(err)) {
+                DC_ERROR_RAISE_ERRNO(err, EIO);
+            }
+        }
+
+        return 0;
+    }
+
+    return formatLogLine(line, packet, length, receiver->timeString, receiver->timeLength, sender);
+}
+
+void endReceiveBatch(struct udp_receiver *receiver, size_t received, const struct timespec *batchStart,
+        const struct timespec *parsed) {
+    struct timespec logged;
+
+    // Parsing covers the packed log's block writes, which happen while records are added.
+    clock_gettime(CLOCK_MONOTONIC, &logged);
+    recordStage(&receiver->parse, batchStart, parsed);
+    recordStage(&receiver->write, parsed, &logged);
+    receiver->packets += (uint64_t) received;
+    receiver->batchSizes[received < RECEIVER_BATCH ? received : RECEIVER_BATCH]++;
+    receiver->batches++;
+}
+
+int receiveDatagrams(const struct dc_posix_env *env, struct dc_error *err, struct udp_receiver *receiver, int flags) {
+    struct timespec now;
+    struct timespec batchStart;
+    struct timespec parsed;
+    size_t logLength = 0;
+    int received;
+
+    for (size_t i = 0; i < RECEIVER_BATCH; i++) {
+        struct msghdr *header = &receiver->messages[i].msg_hdr;
+
+        header->msg_iov = &receiver->iovecs[i];
+        header->msg_iovlen = 1;
+        header->msg_name = &receiver->senders[i];
+        header->msg_namelen = sizeof(receiver->senders[i]);
+        header->msg_control = receiver->controls[i];
+        header->msg_controllen = sizeof(receiver->controls[i]);
+        header->msg_flags = 0;
+    }
+
+    // MSG_TRUNC reports the full datagram length even when only its header fits the slot.
+    received = recvmmsg(receiver->socketFD, receiver->messages, RECEIVER_BATCH, flags | MSG_TRUNC, NULL);
+
+    if (received == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return 0;
+        }
+
+        DC_ERROR_RAISE_ERRNO(err, errno);
+        return -1;
+    }
+
+    beginReceiveBatch(env, err, receiver, &now, &batchStart);
+
+    for (int i = 0; i < received; i++) {
+        logLength += logDatagram(env, err, receiver, receiver->slots + (size_t) i * RECEIVER_SLOT,
+                                 receiver->messages[i].msg_len, &receiver->senders[i],
+                                 &receiver->messages[i].msg_hdr, &now, receiver->logBuffer + logLength);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &parsed);
+
+    // One write per batch instead of one per packet.
+    if (logLength > 0) {
+        hotWrite(err, receiver->logFD, receiver->logBuffer, logLength);
+    }
+
+    endReceiveBatch(receiver, (size_t) received, &batchStart, &parsed);
+
+    return received;
+}
+
+void enableBusyPoll(int socketFD, int usec) {
+    if (setsockopt(socketFD, SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof(usec)) == -1) {
+        printf("SO_BUSY_POLL unavailable (%d) -> Spinning in user space only\n", errno);
+    }
+
+#ifdef SO_PREFER_BUSY_POLL
+    {
+        int prefer = 1;
+
+        if (setsockopt(socketFD, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof(prefer)) == -1) {
+            printf("SO_PREFER_BUSY_POLL unavailable (%d)\n", errno);
+        }
+    }
+#endif
+}
+
+static double latencyPercentile(const struct latency_stats *stats, double percentile) {
+    uint64_t target = (uint64_t) ((double) stats->count * percentile);
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i <= LATENCY_BUCKETS; i++) {
+        seen += stats->buckets[i];
+
+        if (seen > target) {
+            return (double) i;
+        }
+    }
+
+    return (double) LATENCY_BUCKETS;
+}
+
+void printReceiverReport(const struct udp_receiver *receiver, const char *mode) {
+    const struct latency_stats *latency = &receiver->latency;
+    struct timespec now;
+    struct rusage usage;
+    double elapsed;
+    double cpu;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    getrusage(RUSAGE_SELF, &usage);
+    elapsed = (double) (now.tv_sec - receiver->started.tv_sec) +
+              (double) (now.tv_nsec - receiver->started.tv_nsec) / 1000000000.0;
+    cpu = (double) (usage.ru_utime.tv_sec - receiver->startUsage.ru_utime.tv_sec) +
+          (double) (usage.ru_utime.tv_usec - receiver->startUsage.ru_utime.tv_usec) / 1000000.0 +
+          (double) (usage.ru_stime.tv_sec - receiver->startUsage.ru_stime.tv_sec) +
+          (double) (usage.ru_stime.tv_usec - receiver->startUsage.ru_stime.tv_usec) / 1000000.0;
+
+    printf("Receive mode %s: %" PRIu64 " packets in %" PRIu64 " batches\n", mode, receiver->packets,
+           receiver->batches);
+
+    if (latency->count > 0) {
+        // Percentiles come from 1 us buckets; anything past the last bucket is reported as its upper bound.
+        printf("Wakeup latency us: min %.1f avg %.1f p50 %.0f p99 %.0f max %.1f\n", (double) latency->minNs / 1000.0,
+               (double) latency->totalNs / (double) latency->count / 1000.0, latencyPercentile(latency, 0.50),
+               latencyPercentile(latency, 0.99), (double) latency->maxNs / 1000.0);
+    }
+
+    if (receiver->packed != NULL && receiver->packed->lostRecords > 0) {
+        printf("Packed log: %" PRIu64 " records lost to failed writes\n", receiver->packed->lostRecords);
+    }
+
+    if (receiver->packed != NULL && receiver->packed->totalRecords > 0) {
+        printf("Packed log: %" PRIu64 " records in %" PRIu64 " bytes (%.2f bytes per record)\n",
+               receiver->packed->totalRecords, receiver->packed->totalBytes,
+               (double) receiver->packed->totalBytes / (double) receiver->packed->totalRecords);
+    }
+
+    printf("CPU %.3f sec over %.3f sec (%.1f%%)\n", cpu, elapsed, elapsed > 0.0 ? cpu * 100.0 / elapsed : 0.0);
+}
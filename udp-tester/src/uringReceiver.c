@@ -0,0 +1,507 @@
+#include "uringReceiver.h"
+
+static int enterRing(struct uring_receiver *ring, unsigned minComplete, int timeoutMs);
+static struct io_uring_sqe *nextSqe(struct uring_receiver *ring);
+static void armRecv(struct uring_receiver *ring);
+static void armWatch(struct uring_receiver *ring, size_t index);
+static void recycleBuffer(struct uring_receiver *ring, unsigned short bufferID);
+static size_t handleDatagram(const struct dc_posix_env *env, struct dc_error *err, struct uring_receiver *ring,
+        const struct io_uring_cqe *cqe, const struct timespec *now, char *line);
+static char *takeLogBuffer(struct uring_receiver *ring, size_t *index);
+static void writeLogBatch(struct dc_error *err, struct uring_receiver *ring, size_t index, const char *buffer,
+        size_t length);
+static void finishLogWrite(struct dc_error *err, struct uring_receiver *ring, const struct io_uring_cqe *cqe);
+static void writeAt(struct dc_error *err, int fd, const char *buffer, size_t length, off_t offset);
+static int reapCompletions(const struct dc_posix_env *env, struct dc_error *err, struct uring_receiver *ring);
+static void releaseRing(const struct dc_posix_env *env, struct uring_receiver *ring);
+
+int createUringReceiver(const struct dc_posix_env *env, struct dc_error *err, struct uring_receiver *ring,
+        struct udp_receiver *receiver) {
+    struct io_uring_params params;
+    struct io_uring_buf_reg registration;
+    size_t sqRingSize;
+    size_t cqRingSize;
+    int logFlags;
+
+    dc_memset(env, ring, 0, sizeof(*ring));
+    ring->receiver = receiver;
+    dc_memset(env, &params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+    params.cq_entries = URING_COMPLETIONS;
+    ring->ringFD = (int) syscall(__NR_io_uring_setup, URING_ENTRIES, &params);
+
+    // Kernels before 6.1 do not know deferred task work; the ring works without it.
+    if (ring->ringFD == -1 && errno == EINVAL) {
+        dc_memset(env, &params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = URING_COMPLETIONS;
+        ring->ringFD = (int) syscall(__NR_io_uring_setup, URING_ENTRIES, &params);
+    }
+
+    if (ring->ringFD == -1) {
+        return -1;
+    }
+
+    // Timed waits need EXT_ARG, and a full completion queue must not lose the end of a multishot request.
+    if (!(params.features & IORING_FEAT_EXT_ARG) || !(params.features & IORING_FEAT_NODROP)) {
+        releaseRing(env, ring);
+        errno = ENOTSUP;
+        return -1;
+    }
+
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        sqRingSize = sqRingSize > cqRingSize ? sqRingSize : cqRingSize;
+        cqRingSize = 0;
+    }
+
+    ring->sqRing = mmap(NULL, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ringFD,
+                        IORING_OFF_SQ_RING);
+    ring->sqRingSize = ring->sqRing == MAP_FAILED ? 0 : sqRingSize;
+    ring->cqRing = ring->sqRing;
+
+    if (ring->sqRing != MAP_FAILED && cqRingSize > 0) {
+        ring->cqRing = mmap(NULL, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ringFD,
+                            IORING_OFF_CQ_RING);
+        ring->cqRingSize = ring->cqRing == MAP_FAILED ? 0 : cqRingSize;
+    }
+
+    ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ringFD,
+                      IORING_OFF_SQES);
+    ring->bufferRingSize = URING_BUFFERS * sizeof(struct io_uring_buf);
+    ring->bufferRing = mmap(NULL, ring->bufferRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ring->buffers = dc_malloc(env, err, URING_BUFFERS * URING_BUFFER_SIZE);
+
+    if (ring->sqRing == MAP_FAILED || ring->cqRing == MAP_FAILED || ring->sqes == MAP_FAILED
+        || ring->bufferRing == MAP_FAILED || ring->buffers == NULL) {
+        releaseRing(env, ring);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    ring->sqHead = (unsigned *) ((char *) ring->sqRing + params.sq_off.head);
+    ring->sqTail = (unsigned *) ((char *) ring->sqRing + params.sq_off.tail);
+    ring->sqArray = (unsigned *) ((char *) ring->sqRing + params.sq_off.array);
+    ring->sqMask = *(unsigned *) ((char *) ring->sqRing + params.sq_off.ring_mask);
+    ring->sqEntries = params.sq_entries;
+    ring->sqLocalTail = *ring->sqTail;
+    ring->cqHead = (unsigned *) ((char *) ring->cqRing + params.cq_off.head);
+    ring->cqTail = (unsigned *) ((char *) ring->cqRing + params.cq_off.tail);
+    ring->cqes = (struct io_uring_cqe *) ((char *) ring->cqRing + params.cq_off.cqes);
+    ring->cqMask = *(unsigned *) ((char *) ring->cqRing + params.cq_off.ring_mask);
+
+    // Provided buffer rings arrived in 5.19; older kernels refuse the registration.
+    dc_memset(env, &registration, 0, sizeof(registration));
+    registration.ring_addr = (uint64_t) (uintptr_t) ring->bufferRing;
+    registration.ring_entries = URING_BUFFERS;
+    registration.bgid = URING_BUFFER_GROUP;
+
+    if (syscall(__NR_io_uring_register, ring->ringFD, IORING_REGISTER_PBUF_RING, &registration, 1) == -1) {
+        int registerError = errno;
+
+        releaseRing(env, ring);
+        errno = registerError;
+        return -1;
+    }
+
+    for (unsigned short i = 0; i < URING_BUFFERS; i++) {
+        recycleBuffer(ring, i);
+    }
+
+    __atomic_store_n(&ring->bufferRing->tail, ring->bufferTail, __ATOMIC_RELEASE);
+
+    if (receiver->packed == NULL) {
+        ring->logBuffers = dc_malloc(env, err, URING_LOG_BUFFERS * RECEIVER_BATCH * RECEIVER_LOG_LINE);
+
+        if (ring->logBuffers == NULL) {
+            releaseRing(env, ring);
+            errno = ENOMEM;
+            return -1;
+        }
+
+        // Writes carry their own offsets, which O_APPEND would override.
+        logFlags = fcntl(receiver->logFD, F_GETFL);
+        fcntl(receiver->logFD, F_SETFL, logFlags & ~O_APPEND);
+        ring->logOffset = lseek(receiver->logFD, 0, SEEK_END);
+    }
+
+    // Every datagram lands as a recvmsg_out header, the sender, the timestamp and then the payload.
+    ring->recvHeader.msg_namelen = sizeof(struct sockaddr_in);
+    ring->recvHeader.msg_controllen = RECEIVER_CONTROL;
+    armRecv(ring);
+
+    // Multishot recvmsg arrived in 6.0; an older kernel fails the request as soon as it is submitted.
+    errno = 0;
+
+    if (enterRing(ring, 0, -1) == -1 || reapCompletions(env, err, ring) == -1 || !ring->recvArmed) {
+        int armError = errno != 0 ? errno : ENOTSUP;
+
+        releaseRing(env, ring);
+        errno = armError;
+        return -1;
+    }
+
+    return 0;
+}
+
+static void releaseRing(const struct dc_posix_env *env, struct uring_receiver *ring) {
+    if (ring->logBuffers != NULL) {
+        fcntl(ring->receiver->logFD, F_SETFL, fcntl(ring->receiver->logFD, F_GETFL) | O_APPEND);
+        dc_free(env, ring->logBuffers, URING_LOG_BUFFERS * RECEIVER_BATCH * RECEIVER_LOG_LINE);
+        ring->logBuffers = NULL;
+    }
+
+    if (ring->buffers != NULL) {
+        dc_free(env, ring->buffers, URING_BUFFERS * URING_BUFFER_SIZE);
+        ring->buffers = NULL;
+    }
+
+    if (ring->bufferRing != NULL && ring->bufferRing != MAP_FAILED) {
+        munmap(ring->bufferRing, ring->bufferRingSize);
+    }
+
+    if (ring->sqes != NULL && ring->sqes != MAP_FAILED) {
+        munmap(ring->sqes, ring->sqesSize);
+    }
+
+    if (ring->cqRingSize > 0) {
+        munmap(ring->cqRing, ring->cqRingSize);
+    }
+
+    if (ring->sqRingSize > 0) {
+        munmap(ring->sqRing, ring->sqRingSize);
+    }
+
+    if (ring->ringFD != -1) {
+        close(ring->ringFD);
+    }
+
+    ring->bufferRing = NULL;
+    ring->sqes = NULL;
+    ring->cqRingSize = 0;
+    ring->sqRingSize = 0;
+    ring->ringFD = -1;
+}
+
+void destroyUringReceiver(const struct dc_posix_env *env, struct dc_error *err, struct uring_receiver *ring) {
+    // Batches received while draining are written directly, so the writes in flight are the last ones.
+    ring->draining = true;
+
+    while (ring->writesInFlight > 0 && waitUringReceiver(env, err, ring, -1) != -1) {
+    }
+
+    releaseRing(env, ring);
+}
+
+static int enterRing(struct uring_receiver *ring, unsigned minComplete, int timeoutMs) {
+    struct io_uring_getevents_arg arguments;
+    struct __kernel_timespec timeout;
+    unsigned flags = IORING_ENTER_GETEVENTS;
+    long submitted;
+
+    // GETEVENTS is always set: with deferred task work it is what posts the completions.
+    if (minComplete > 0 && timeoutMs >= 0) {
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_nsec = (timeoutMs % 1000) * 1000000;
+        memset(&arguments, 0, sizeof(arguments));
+        arguments.ts = (uint64_t) (uintptr_t) &timeout;
+        flags |= IORING_ENTER_EXT_ARG;
+        submitted = syscall(__NR_io_uring_enter, ring->ringFD, ring->toSubmit, minComplete, flags, &arguments,
+                            sizeof(arguments));
+    } else {
+        submitted = syscall(__NR_io_uring_enter, ring->ringFD, ring->toSubmit, minComplete, flags, NULL, 0);
+    }
+
+    if (submitted == -1) {
+        return errno == EINTR || errno == ETIME || errno == EAGAIN || errno == EBUSY ? 0 : -1;
+    }
+
+    ring->toSubmit -= (unsigned) submitted < ring->toSubmit ? (unsigned) submitted : ring->toSubmit;
+    return 0;
+}
+
+static struct io_uring_sqe *nextSqe(struct uring_receiver *ring) {
+    struct io_uring_sqe *sqe;
+    unsigned index;
+
+    // A full submission queue is handed to the kernel without waiting for anything to complete.
+    if (ring->sqLocalTail - __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE) >= ring->sqEntries) {
+        long submitted = syscall(__NR_io_uring_enter, ring->ringFD, ring->toSubmit, 0, 0, NULL, 0);
+
+        if (submitted > 0) {
+            ring->toSubmit -= (unsigned) submitted < ring->toSubmit ? (unsigned) submitted : ring->toSubmit;
+        }
+
+        if (ring->sqLocalTail - __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE) >= ring->sqEntries) {
+            return NULL;
+        }
+    }
+
+    index = ring->sqLocalTail & ring->sqMask;
+    sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sqArray[index] = index;
+    ring->sqLocalTail++;
+    ring->toSubmit++;
+    __atomic_store_n(ring->sqTail, ring->sqLocalTail, __ATOMIC_RELEASE);
+
+    return sqe;
+}
+
+static void armRecv(struct uring_receiver *ring) {
+    struct io_uring_sqe *sqe = nextSqe(ring);
+
+    if (sqe == NULL) {
+        return;
+    }
+
+    // MSG_TRUNC makes payloadlen the full datagram length, as with recvmmsg().
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = ring->receiver->socketFD;
+    sqe->addr = (uint64_t) (uintptr_t) &ring->recvHeader;
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUFFER_GROUP;
+    sqe->msg_flags = MSG_TRUNC;
+    sqe->user_data = URING_RECV_TAG;
+    ring->recvArmed = true;
+}
+
+int watchUringSocket(struct uring_receiver *ring, int fd, int event) {
+    if (ring->watchCount == URING_MAX_WATCHES) {
+        return -1;
+    }
+
+    ring->watchFDs[ring->watchCount] = fd;
+    ring->watchEvents[ring->watchCount] = event;
+    armWatch(ring, ring->watchCount);
+    ring->watchCount++;
+
+    return 0;
+}
+
+static void armWatch(struct uring_receiver *ring, size_t index) {
+    struct io_uring_sqe *sqe = nextSqe(ring);
+
+    if (sqe == NULL) {
+        return;
+    }
+
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = ring->watchFDs[index];
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = index;
+    ring->watchArmed[index] = true;
+}
+
+static void recycleBuffer(struct uring_receiver *ring, unsigned short bufferID) {
+    struct io_uring_buf *buffer = &ring->bufferRing->bufs[ring->bufferTail & (URING_BUFFERS - 1)];
+
+    buffer->addr = (uint64_t) (uintptr_t) (ring->buffers + (size_t) bufferID * URING_BUFFER_SIZE);
+    buffer->len = URING_BUFFER_SIZE;
+    buffer->bid = bufferID;
+    ring->bufferTail++;
+}
+
+static size_t handleDatagram(const struct dc_posix_env *env, struct dc_error *err, struct uring_receiver *ring,
+        const struct io_uring_cqe *cqe, const struct timespec *now, char *line) {
+    unsigned short bufferID = (unsigned short) (cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+    char *buffer = ring->buffers + (size_t) bufferID * URING_BUFFER_SIZE;
+    struct io_uring_recvmsg_out *out = (struct io_uring_recvmsg_out *) buffer;
+    char *name = buffer + sizeof(*out);
+    char *control = name + ring->recvHeader.msg_namelen;
+    char *payload = control + ring->recvHeader.msg_controllen;
+    struct sockaddr_in sender;
+    struct msghdr header;
+    size_t length;
+
+    hotFill(&sender, 0, sizeof(sender));
+    hotCopy(&sender, name, out->namelen < sizeof(sender) ? out->namelen : sizeof(sender));
+    hotFill(&header, 0, sizeof(header));
+    header.msg_control = control;
+    header.msg_controllen = out->controllen;
+
+    // The payload area is larger than RECEIVER_SLOT, so terminating a short datagram stays inside the buffer.
+    length = logDatagram(env, err, ring->receiver, payload, out->payloadlen, &sender, &header, now, line);
+    recycleBuffer(ring, bufferID);
+
+    return length;
+}
+
+static char *takeLogBuffer(struct uring_receiver *ring, size_t *index) {
+    if (ring->logBuffers != NULL && !ring->draining) {
+        for (size_t i = 0; i < URING_LOG_BUFFERS; i++) {
+            if (!ring->logBusy[i]) {
+                *index = i;
+                return ring->logBuffers + i * RECEIVER_BATCH * RECEIVER_LOG_LINE;
+            }
+        }
+    }
+
+    // With every buffer still being written the batch goes out synchronously from the receiver's own buffer.
+    *index = URING_LOG_BUFFERS;
+    return ring->receiver->logBuffer;
+}
+
+static void writeAt(struct dc_error *err, int fd, const char *buffer, size_t length, off_t offset) {
+    while (length > 0) {
+        ssize_t written = pwrite(fd, buffer, length, offset);
+
+        if (written <= 0) {
+            DC_ERROR_RAISE_ERRNO(err, errno);
+            return;
+        }
+
+        buffer += written;
+        length -= (size_t) written;
+        offset += written;
+    }
+}
+
+static void writeLogBatch(struct dc_error *err, struct uring_receiver *ring, size_t index, const char *buffer,
+        size_t length) {
+    struct io_uring_sqe *sqe = NULL;
+    off_t offset = ring->logOffset;
+
+    if (length == 0) {
+        return;
+    }
+
+    // The offset is reserved now, so the file keeps receive order whichever write finishes first.
+    ring->logOffset += (off_t) length;
+
+    if (index < URING_LOG_BUFFERS) {
+        sqe = nextSqe(ring);
+    }
+
+    if (sqe == NULL) {
+        writeAt(err, ring->receiver->logFD, buffer, length, offset);
+        return;
+    }
+
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = ring->receiver->logFD;
+    sqe->addr = (uint64_t) (uintptr_t) buffer;
+    sqe->len = (unsigned) length;
+    sqe->off = (uint64_t) offset;
+    sqe->user_data = URING_WRITE_TAG | index;
+    ring->logBusy[index] = true;
+    ring->logLengths[index] = length;
+    ring->logOffsets[index] = offset;
+    ring->writesInFlight++;
+}
+
+static void finishLogWrite(struct dc_error *err, struct uring_receiver *ring, const struct io_uring_cqe *cqe) {
+    size_t index = (size_t) (cqe->user_data & ~URING_WRITE_TAG);
+    const char *buffer = ring->logBuffers + index * RECEIVER_BATCH * RECEIVER_LOG_LINE;
+    size_t done = cqe->res > 0 ? (size_t) cqe->res : 0;
+
+    // A short or failed write is finished in place rather than resubmitted.
+    if (done < ring->logLengths[index]) {
+        writeAt(err, ring->receiver->logFD, buffer + done, ring->logLengths[index] - done,
+                ring->logOffsets[index] + (off_t) done);
+    }
+
+    ring->logBusy[index] = false;
+    ring->writesInFlight--;
+}
+
+static int reapCompletions(const struct dc_posix_env *env, struct dc_error *err, struct uring_receiver *ring) {
+    struct timespec now;
+    struct timespec batchStart;
+    struct timespec parsed;
+    unsigned head = *ring->cqHead;
+    size_t received = 0;
+    size_t logIndex = URING_LOG_BUFFERS;
+    size_t logLength = 0;
+    char *logBuffer = NULL;
+    int events = 0;
+
+    while (head != __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE)) {
+        const struct io_uring_cqe *cqe = &ring->cqes[head & ring->cqMask];
+
+        if (cqe->user_data == URING_RECV_TAG) {
+            if (!(cqe->flags & IORING_CQE_F_MORE)) {
+                ring->recvArmed = false;
+            }
+
+            // A multishot recvmsg that ran out of buffers ends with ENOBUFS and is armed again below.
+            if (cqe->res < 0 && cqe->res != -ENOBUFS && !(cqe->flags & IORING_CQE_F_MORE)) {
+                errno = -cqe->res;
+            }
+
+            if (cqe->res >= 0 && (cqe->flags & IORING_CQE_F_BUFFER)) {
+                if (received == 0) {
+                    beginReceiveBatch(env, err, ring->receiver, &now, &batchStart);
+                    logBuffer = takeLogBuffer(ring, &logIndex);
+                    logLength = 0;
+                }
+
+                logLength += handleDatagram(env, err, ring, cqe, &now, logBuffer + logLength);
+                received++;
+            }
+        } else if (cqe->user_data & URING_WRITE_TAG) {
+            finishLogWrite(err, ring, cqe);
+        } else if (cqe->user_data < ring->watchCount) {
+            if (!(cqe->flags & IORING_CQE_F_MORE)) {
+                ring->watchArmed[cqe->user_data] = false;
+            }
+
+            if (cqe->res > 0) {
+                events |= ring->watchEvents[cqe->user_data];
+            }
+        }
+
+        head++;
+
+        // Batches match the recvmmsg() path, so the two backends report the same histograms.
+        if (received == RECEIVER_BATCH) {
+            clock_gettime(CLOCK_MONOTONIC, &parsed);
+            writeLogBatch(err, ring, logIndex, logBuffer, logLength);
+            endReceiveBatch(ring->receiver, received, &batchStart, &parsed);
+            received = 0;
+        }
+    }
+
+    if (received > 0) {
+        clock_gettime(CLOCK_MONOTONIC, &parsed);
+        writeLogBatch(err, ring, logIndex, logBuffer, logLength);
+        endReceiveBatch(ring->receiver, received, &batchStart, &parsed);
+    }
+
+    __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->bufferRing->tail, ring->bufferTail, __ATOMIC_RELEASE);
+
+    return events;
+}
+
+int waitUringReceiver(const struct dc_posix_env *env, struct dc_error *err, struct uring_receiver *ring,
+        int timeoutMs) {
+    unsigned ready = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE) - *ring->cqHead;
+    int events;
+
+    if (enterRing(ring, ready > 0 ? 0 : 1, timeoutMs) == -1) {
+        DC_ERROR_RAISE_ERRNO(err, errno);
+        return -1;
+    }
+
+    events = reapCompletions(env, err, ring);
+
+    // Anything that ended is armed again and goes to the kernel with the next wait.
+    if (!ring->recvArmed) {
+        armRecv(ring);
+    }
+
+    for (size_t i = 0; i < ring->watchCount; i++) {
+        if (!ring->watchArmed[i]) {
+            armWatch(ring, i);
+        }
+    }
+
+    return events;
+}
@@ -0,0 +1,115 @@
+#include "tests.h"
+#include "fastFormat.h"
+#include <inttypes.h>
+#include <stdio.h>
+
+static char formatted[FORMAT_LOG_LINE_LENGTH + 1];
+static char expected[FORMAT_LOG_LINE_LENGTH + 1];
+
+static void assertDecimal(u_int64_t value, size_t width);
+
+Describe(FastFormat);
+
+BeforeEach(FastFormat) {
+    memset(formatted, 0, sizeof(formatted));
+    memset(expected, 0, sizeof(expected));
+}
+
+AfterEach(FastFormat) {
+}
+
+static void assertDecimal(u_int64_t value, size_t width) {
+    size_t length = formatDecimal(formatted, value, width);
+
+    formatted[length] = '\0';
+    snprintf(expected, sizeof(expected), "%0*" PRIu64, (int) width, value);
+    assert_that(formatted, is_equal_to_string(expected));
+}
+
+Ensure(FastFormat, writes_decimals_like_printf_at_every_digit_count) {
+    u_int64_t power = 1;
+
+    // Each power of ten and its neighbours changes the digit count or the pair split.
+    for (int digits = 0; digits < 20; digits++) {
+        assertDecimal(power - 1, 0);
+        assertDecimal(power, 0);
+        assertDecimal(power + 1, 0);
+        power *= 10;
+    }
+
+    assertDecimal(UINT64_MAX, 0);
+    assertDecimal(UINT64_MAX, 25);
+}
+
+Ensure(FastFormat, writes_every_small_value_at_every_width) {
+    for (u_int64_t value = 0; value < 100000; value++) {
+        for (size_t width = 0; width <= 7; width += 2) {
+            size_t length = formatDecimal(formatted, value, width);
+
+            formatted[length] = '\0';
+            snprintf(expected, sizeof(expected), "%0*" PRIu64, (int) width, value);
+
+            if (strcmp(formatted, expected) != 0) {
+                assert_that(formatted, is_equal_to_string(expected));
+                return;
+            }
+        }
+    }
+}
+
+Ensure(FastFormat, writes_addresses_like_inet_ntop) {
+    const char *addresses[] = {"0.0.0.0", "127.0.0.1", "10.9.99.100", "255.255.255.255", "192.168.1.20"};
+
+    for (size_t i = 0; i < sizeof(addresses) / sizeof(addresses[0]); i++) {
+        size_t length = formatIPv4(formatted, inet_addr(addresses[i]));
+
+        formatted[length] = '\0';
+        assert_that(formatted, is_equal_to_string(addresses[i]));
+    }
+}
+
+Ensure(FastFormat, writes_packet_headers_like_printf) {
+    size_t length = formatPacketHeader(formatted, "0042", 7);
+
+    formatted[length] = '\0';
+    assert_that(formatted, is_equal_to_string("0042:000007:"));
+    length = formatPacketHeader(formatted, "123456", 1234567);
+    formatted[length] = '\0';
+    assert_that(formatted, is_equal_to_string("1234:1234567:"));
+    length = formatPacketHeader(formatted, "7", 0);
+    formatted[length] = '\0';
+    assert_that(formatted, is_equal_to_string("7:000000:"));
+}
+
+Ensure(FastFormat, writes_log_lines_like_printf) {
+    const char packet[] = "0042:000123:payload";
+    const char timeString[] = "Mon Oct 19 10:00:00 2026";
+    struct sockaddr_in sender;
+    size_t length;
+
+    memset(&sender, 0, sizeof(sender));
+    sender.sin_addr.s_addr = inet_addr("10.0.0.2");
+    sender.sin_port = htons(40000);
+    length = formatLogLine(formatted, packet, sizeof(packet) - 1, timeString, sizeof(timeString) - 1, &sender);
+    formatted[length] = '\0';
+    snprintf(expected, sizeof(expected), "%.4s:%.6s:%s:%s:%hu\n", packet, packet + 5, timeString, "10.0.0.2",
+             (unsigned short) 40000);
+    assert_that(formatted, is_equal_to_string(expected));
+
+    // A datagram too short to hold a packet number leaves that field empty.
+    length = formatLogLine(formatted, "12", 2, timeString, sizeof(timeString) - 1, &sender);
+    formatted[length] = '\0';
+    assert_that(formatted, is_equal_to_string("12::Mon Oct 19 10:00:00 2026:10.0.0.2:40000\n"));
+}
+
+TestSuite *fastFormatTests(void) {
+    TestSuite *suite = create_test_suite();
+
+    add_test_with_context(suite, FastFormat, writes_decimals_like_printf_at_every_digit_count);
+    add_test_with_context(suite, FastFormat, writes_every_small_value_at_every_width);
+    add_test_with_context(suite, FastFormat, writes_addresses_like_inet_ntop);
+    add_test_with_context(suite, FastFormat, writes_packet_headers_like_printf);
+    add_test_with_context(suite, FastFormat, writes_log_lines_like_printf);
+
+    return suite;
+}
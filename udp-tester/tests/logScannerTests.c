@@ -0,0 +1,115 @@
+#include "tests.h"
+#include "logScanner.h"
+#include <stdio.h>
+
+static struct log_time_cache cache;
+static u_int32_t clientID;
+static u_int32_t packetID;
+static u_int32_t arrival;
+
+static bool parseText(const char *text);
+
+Describe(LogScanner);
+
+BeforeEach(LogScanner) {
+    memset(&cache, 0, sizeof(cache));
+    clientID = 0;
+    packetID = 0;
+    arrival = 0;
+}
+
+AfterEach(LogScanner) {
+}
+
+static bool parseText(const char *text) {
+    struct log_span line;
+
+    line.data = text;
+    line.length = strlen(text);
+    return parseUdpLine(line, &clientID, &packetID, &cache, &arrival);
+}
+
+Ensure(LogScanner, decodes_the_fixed_server_layout) {
+    assert_that(parseText("0012:000345:Mon Oct 19 10:00:00 2026:127.0.0.1:5000"), is_true);
+    assert_that(clientID, is_equal_to(12));
+    assert_that(packetID, is_equal_to(345));
+    assert_that(parseText("9999:999999:Mon Oct 19 10:00:00 2026:127.0.0.1:5000"), is_true);
+    assert_that(clientID, is_equal_to(9999));
+    assert_that(packetID, is_equal_to(999999));
+    assert_that(parseText("0000:000000:Mon Oct 19 10:00:00 2026:127.0.0.1:5000"), is_true);
+    assert_that(clientID, is_equal_to(0));
+    assert_that(packetID, is_equal_to(0));
+}
+
+Ensure(LogScanner, decodes_every_packet_number_like_the_printf_value) {
+    char text[64];
+
+    for (u_int32_t value = 0; value <= 999999; value += 7) {
+        snprintf(text, sizeof(text), "%04u:%06u:Mon Oct 19 10:00:00 2026:127.0.0.1:5000", value % 10000, value);
+
+        if (!parseText(text) || clientID != value % 10000 || packetID != value) {
+            assert_that(text, is_equal_to_string(""));
+            break;
+        }
+    }
+}
+
+Ensure(LogScanner, rejects_non_digit_bytes_in_the_fixed_layout) {
+    char text[] = "1234:567890:Mon Oct 19 10:00:00 2026:127.0.0.1:5000";
+
+    // Bytes just past '9' pass a naive nibble check; a rejected field falls back to the digits before the byte.
+    for (int byte = 1; byte < 256; byte++) {
+        if ((byte >= '0' && byte <= '9') || byte == ':') {
+            continue;
+        }
+
+        text[2] = (char) byte;
+        assert_that(parseText(text), is_true);
+        assert_that(clientID, is_equal_to(12));
+        text[2] = '3';
+
+        text[8] = (char) byte;
+        assert_that(parseText(text), is_true);
+        assert_that(packetID, is_equal_to(567));
+        text[8] = '8';
+    }
+}
+
+Ensure(LogScanner, splits_lines_outside_the_fixed_layout) {
+    assert_that(parseText("7:42:Mon Oct 19 10:00:00 2026:127.0.0.1:5000"), is_true);
+    assert_that(clientID, is_equal_to(7));
+    assert_that(packetID, is_equal_to(42));
+}
+
+Ensure(LogScanner, rejects_fields_wider_than_the_server_writes) {
+    assert_that(parseText("12345:000001:Mon Oct 19 10:00:00 2026:127.0.0.1:5000"), is_false);
+    assert_that(parseText("0001:1234567:Mon Oct 19 10:00:00 2026:127.0.0.1:5000"), is_false);
+    assert_that(parseText(":000001:Mon Oct 19 10:00:00 2026"), is_false);
+    assert_that(parseText("0001"), is_false);
+}
+
+Ensure(LogScanner, reads_arrival_seconds_across_a_month_end) {
+    u_int32_t before;
+
+    assert_that(parseText("0001:000001:Sat Oct 31 23:59:59 2026:127.0.0.1:5000"), is_true);
+    before = arrival;
+    assert_that(parseText("0001:000002:Sun Nov  1 00:00:00 2026:127.0.0.1:5000"), is_true);
+    assert_that(arrival - before, is_equal_to(1));
+    assert_that(parseText("0001:000003:Sun Nov  1 00:00:00 2026"), is_true);
+    assert_that(arrival - before, is_equal_to(1));
+    assert_that(parseText("0001:000004:Sun Xyz  1 00:00:00 2026"), is_true);
+    assert_that(arrival, is_equal_to(0));
+}
+
+TestSuite *logScannerTests(void) {
+    TestSuite *suite = create_test_suite();
+
+    add_test_with_context(suite, LogScanner, decodes_the_fixed_server_layout);
+    add_test_with_context(suite, LogScanner, decodes_every_packet_number_like_the_printf_value);
+    add_test_with_context(suite, LogScanner, rejects_non_digit_bytes_in_the_fixed_layout);
+    add_test_with_context(suite, LogScanner, splits_lines_outside_the_fixed_layout);
+    add_test_with_context(suite, LogScanner, rejects_fields_wider_than_the_server_writes);
+    add_test_with_context(suite, LogScanner, reads_arrival_seconds_across_a_month_end);
+
+    return suite;
+}
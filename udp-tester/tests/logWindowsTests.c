@@ -0,0 +1,50 @@
+#include "tests.h"
+#include "logWindows.h"
+
+static u_int32_t seconds;
+
+Describe(LogWindows);
+
+BeforeEach(LogWindows) {
+    seconds = 0;
+}
+
+AfterEach(LogWindows) {
+}
+
+Ensure(LogWindows, reads_seconds_with_an_optional_unit) {
+    assert_that(parseWindowLength("30", &seconds), is_true);
+    assert_that(seconds, is_equal_to(30));
+    assert_that(parseWindowLength("1s", &seconds), is_true);
+    assert_that(seconds, is_equal_to(1));
+    assert_that(parseWindowLength("5m", &seconds), is_true);
+    assert_that(seconds, is_equal_to(300));
+    assert_that(parseWindowLength("2h", &seconds), is_true);
+    assert_that(seconds, is_equal_to(7200));
+}
+
+Ensure(LogWindows, rejects_empty_zero_and_unknown_lengths) {
+    assert_that(parseWindowLength("", &seconds), is_false);
+    assert_that(parseWindowLength("0", &seconds), is_false);
+    assert_that(parseWindowLength("s", &seconds), is_false);
+    assert_that(parseWindowLength("5d", &seconds), is_false);
+    assert_that(parseWindowLength("5ms", &seconds), is_false);
+    assert_that(parseWindowLength("-1", &seconds), is_false);
+    assert_that(seconds, is_equal_to(0));
+}
+
+Ensure(LogWindows, rejects_lengths_past_32_bits) {
+    assert_that(parseWindowLength("4294967295", &seconds), is_true);
+    assert_that(parseWindowLength("4294967296", &seconds), is_false);
+    assert_that(parseWindowLength("1193047h", &seconds), is_false);
+}
+
+TestSuite *logWindowsTests(void) {
+    TestSuite *suite = create_test_suite();
+
+    add_test_with_context(suite, LogWindows, reads_seconds_with_an_optional_unit);
+    add_test_with_context(suite, LogWindows, rejects_empty_zero_and_unknown_lengths);
+    add_test_with_context(suite, LogWindows, rejects_lengths_past_32_bits);
+
+    return suite;
+}
@@ -8,6 +8,15 @@ int main(int argc, char **argv)
     int           suite_result;
 
     suite    = create_test_suite();
+    add_suite(suite, prngTests());
+    add_suite(suite, packetBitsetTests());
+    add_suite(suite, packetMetricsTests());
+    add_suite(suite, logWindowsTests());
+    add_suite(suite, logScannerTests());
+    add_suite(suite, packedLogTests());
+    add_suite(suite, pcapReplayTests());
+    add_suite(suite, fastFormatTests());
+    add_suite(suite, rateSeriesTests());
     reporter = create_text_reporter();
 
     if(argc > 1)
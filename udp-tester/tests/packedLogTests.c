@@ -0,0 +1,158 @@
+#include "tests.h"
+#include "packedLog.h"
+#include <arpa/inet.h>
+#include <stdlib.h>
+
+#define PACKED_TEST_RECORDS 16
+
+/**
+ * One record as the writer was given it and as the reader handed it back.
+ */
+struct packed_test_record {
+    u_int32_t clientID;
+    u_int32_t packetID;
+    u_int32_t arrival;
+};
+
+static struct dc_posix_env env;
+static struct dc_error err;
+static char path[] = "/tmp/packedLogTestsXXXXXX";
+static char *data;
+static size_t length;
+static struct packed_test_record decoded[PACKED_TEST_RECORDS];
+static size_t decodedCount;
+
+// Deltas in both directions and across the whole 32-bit range, and an arrival gap that starts a second block.
+static const struct packed_test_record written[] = {
+        {1, 1, 1000}, {2, 7, 1000}, {1, 2, 1000}, {1, 3, 1001}, {2, 6, 1001}, {1, 1000000, 1001},
+        {1, 5, 1001}, {2, UINT32_MAX, 1002}, {1, UINT32_MAX, 1002}, {2, 0, 1001}, {1, 0, 1002},
+        {1, 4, 1020}, {2, 8, 1020}, {1, 4, 1020}
+};
+
+static void writeLog(void);
+static void collectRecord(u_int32_t clientID, u_int32_t packetID, u_int32_t arrival, void *context);
+static void assertClientRecords(u_int32_t clientID);
+
+Describe(PackedLog);
+
+BeforeEach(PackedLog) {
+    int fd;
+
+    dc_error_init(&err, NULL);
+    dc_posix_env_init(&env, NULL);
+    memcpy(path + sizeof(path) - 7, "XXXXXX", 6);
+    fd = mkstemp(path);
+    assert_that(fd, is_not_equal_to(-1));
+    close(fd);
+    data = NULL;
+    length = 0;
+    decodedCount = 0;
+}
+
+AfterEach(PackedLog) {
+    free(data);
+    unlink(path);
+    dc_error_reset(&err);
+}
+
+static void writeLog(void) {
+    struct packed_writer writer;
+    struct stat status;
+    int fd = dc_open(&env, &err, path, O_WRONLY | O_APPEND, 0);
+
+    assert_that(openPackedWriter(&env, &err, &writer, path, fd), is_equal_to(0));
+
+    for (size_t i = 0; i < sizeof(written) / sizeof(written[0]); i++) {
+        assert_that(packRecord(&env, &err, &writer, written[i].clientID, written[i].packetID, written[i].arrival,
+                               htonl(0x7F000001), htons(5000)), is_equal_to(0));
+    }
+
+    assert_that(closePackedWriter(&env, &err, &writer), is_equal_to(0));
+    dc_close(&env, &err, fd);
+
+    fd = dc_open(&env, &err, path, O_RDONLY, 0);
+    fstat(fd, &status);
+    length = (size_t) status.st_size;
+    data = malloc(length);
+    assert_that(pread(fd, data, length, 0), is_equal_to(length));
+    dc_close(&env, &err, fd);
+}
+
+static void collectRecord(u_int32_t clientID, u_int32_t packetID, u_int32_t arrival,
+        __attribute__((unused)) void *context) {
+    if (decodedCount < PACKED_TEST_RECORDS) {
+        decoded[decodedCount].clientID = clientID;
+        decoded[decodedCount].packetID = packetID;
+        decoded[decodedCount].arrival = arrival;
+    }
+
+    decodedCount++;
+}
+
+static void assertClientRecords(u_int32_t clientID) {
+    size_t next = 0;
+
+    // Records come back in arrival order per client; clients may be interleaved differently.
+    for (size_t i = 0; i < sizeof(written) / sizeof(written[0]); i++) {
+        if (written[i].clientID != clientID) {
+            continue;
+        }
+
+        while (next < decodedCount && decoded[next].clientID != clientID) {
+            next++;
+        }
+
+        assert_that(next < decodedCount, is_true);
+
+        if (next == decodedCount) {
+            return;
+        }
+
+        assert_that(decoded[next].packetID, is_equal_to(written[i].packetID));
+        assert_that(decoded[next].arrival, is_equal_to(written[i].arrival));
+        next++;
+    }
+}
+
+Ensure(PackedLog, reads_back_every_record_it_wrote) {
+    u_int32_t first;
+
+    writeLog();
+    assert_that(isPackedLog(data, length), is_true);
+    assert_that(firstPackedArrival(data, length, &first), is_true);
+    assert_that(first, is_equal_to(1000));
+    assert_that(unpackLog(data, length, 0, UINT32_MAX, false, 0, collectRecord, NULL), is_equal_to(0));
+    assert_that(decodedCount, is_equal_to(sizeof(written) / sizeof(written[0])));
+    assertClientRecords(1);
+    assertClientRecords(2);
+}
+
+Ensure(PackedLog, reads_back_one_client) {
+    writeLog();
+    assert_that(unpackLog(data, length, 0, UINT32_MAX, true, 2, collectRecord, NULL), is_equal_to(0));
+    assert_that(decodedCount, is_equal_to(5));
+    assertClientRecords(2);
+}
+
+Ensure(PackedLog, stops_at_a_block_cut_short) {
+    writeLog();
+    assert_that(unpackLog(data, length - 3, 0, UINT32_MAX, false, 0, collectRecord, NULL), is_equal_to(0));
+    assert_that(decodedCount < sizeof(written) / sizeof(written[0]), is_true);
+}
+
+Ensure(PackedLog, tells_text_logs_apart) {
+    const char text[] = "0001:000001:Mon Oct 19 10:00:00 2026:127.0.0.1:5000\n";
+
+    assert_that(isPackedLog(text, sizeof(text) - 1), is_false);
+}
+
+TestSuite *packedLogTests(void) {
+    TestSuite *suite = create_test_suite();
+
+    add_test_with_context(suite, PackedLog, reads_back_every_record_it_wrote);
+    add_test_with_context(suite, PackedLog, reads_back_one_client);
+    add_test_with_context(suite, PackedLog, stops_at_a_block_cut_short);
+    add_test_with_context(suite, PackedLog, tells_text_logs_apart);
+
+    return suite;
+}
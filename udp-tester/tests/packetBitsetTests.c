@@ -0,0 +1,96 @@
+#include "tests.h"
+#include "packetBitset.h"
+
+static struct dc_posix_env env;
+static struct dc_error err;
+static struct packet_bitset bitset;
+
+Describe(PacketBitset);
+
+BeforeEach(PacketBitset) {
+    dc_error_init(&err, NULL);
+    dc_posix_env_init(&env, NULL);
+    assert_that(createPacketBitset(&env, &err, &bitset, 200), is_equal_to(0));
+}
+
+AfterEach(PacketBitset) {
+    destroyPacketBitset(&env, &bitset);
+    dc_error_reset(&err);
+}
+
+Ensure(PacketBitset, reports_whether_a_packet_was_already_marked) {
+    assert_that(markPacket(&bitset, 5), is_false);
+    assert_that(markPacket(&bitset, 5), is_true);
+    assert_that(markPacket(&bitset, 6), is_false);
+}
+
+Ensure(PacketBitset, counts_marks_across_word_boundaries) {
+    // 63 and 64 sit in different words, 128 starts the third.
+    markPacket(&bitset, 0);
+    markPacket(&bitset, 63);
+    markPacket(&bitset, 64);
+    markPacket(&bitset, 128);
+    markPacket(&bitset, 199);
+
+    assert_that(countMarked(&bitset, 0, 200), is_equal_to(5));
+    assert_that(countMarked(&bitset, 1, 64), is_equal_to(1));
+    assert_that(countMarked(&bitset, 63, 65), is_equal_to(2));
+    assert_that(countMarked(&bitset, 64, 128), is_equal_to(1));
+    assert_that(countMarked(&bitset, 100, 100), is_equal_to(0));
+}
+
+Ensure(PacketBitset, ignores_listed_packets_outside_the_bitset) {
+    const u_int32_t packetIDs[] = {1, 2, 2, 500, 70};
+
+    markPackets(&bitset, packetIDs, sizeof(packetIDs) / sizeof(packetIDs[0]));
+    assert_that(countMarked(&bitset, 0, 200), is_equal_to(3));
+}
+
+Ensure(PacketBitset, finds_marked_and_unmarked_packets) {
+    for (size_t i = 0; i < 130; i++) {
+        markPacket(&bitset, i);
+    }
+
+    assert_that(nextUnmarked(&bitset, 0, 200), is_equal_to(130));
+    assert_that(nextUnmarked(&bitset, 0, 100), is_equal_to(100));
+    assert_that(nextMarked(&bitset, 130, 200), is_equal_to(200));
+    markPacket(&bitset, 150);
+    assert_that(nextMarked(&bitset, 130, 200), is_equal_to(150));
+}
+
+Ensure(PacketBitset, measures_runs_of_missing_packets) {
+    size_t shortest;
+    size_t longest;
+
+    // Marking 0-9, 12-19 and 25-29 leaves the runs 10-11 and 20-24 inside [0, 30).
+    for (size_t i = 0; i < 30; i++) {
+        if (i < 10 || (i >= 12 && i < 20) || i >= 25) {
+            markPacket(&bitset, i);
+        }
+    }
+
+    assert_that(unmarkedRuns(&bitset, 0, 30, &shortest, &longest), is_equal_to(2));
+    assert_that(shortest, is_equal_to(2));
+    assert_that(longest, is_equal_to(5));
+}
+
+Ensure(PacketBitset, keeps_marks_and_clears_new_bits_when_grown) {
+    markPacket(&bitset, 199);
+    assert_that(growPacketBitset(&env, &err, &bitset, 1000), is_equal_to(0));
+    assert_that(bitset.bits >= 1000, is_true);
+    assert_that(countMarked(&bitset, 0, 1000), is_equal_to(1));
+    assert_that(markPacket(&bitset, 999), is_false);
+}
+
+TestSuite *packetBitsetTests(void) {
+    TestSuite *suite = create_test_suite();
+
+    add_test_with_context(suite, PacketBitset, reports_whether_a_packet_was_already_marked);
+    add_test_with_context(suite, PacketBitset, counts_marks_across_word_boundaries);
+    add_test_with_context(suite, PacketBitset, ignores_listed_packets_outside_the_bitset);
+    add_test_with_context(suite, PacketBitset, finds_marked_and_unmarked_packets);
+    add_test_with_context(suite, PacketBitset, measures_runs_of_missing_packets);
+    add_test_with_context(suite, PacketBitset, keeps_marks_and_clears_new_bits_when_grown);
+
+    return suite;
+}
@@ -0,0 +1,94 @@
+#include "tests.h"
+#include "packetMetrics.h"
+
+static struct dc_posix_env env;
+static struct dc_error err;
+static struct packet_bitset seen;
+static struct packet_metrics metrics;
+
+static void addAll(const u_int32_t *packetIDs, size_t count);
+
+Describe(PacketMetrics);
+
+BeforeEach(PacketMetrics) {
+    dc_error_init(&err, NULL);
+    dc_posix_env_init(&env, NULL);
+    assert_that(createPacketBitset(&env, &err, &seen, 64), is_equal_to(0));
+    startPacketMetrics(&metrics);
+}
+
+AfterEach(PacketMetrics) {
+    destroyPacketBitset(&env, &seen);
+    dc_error_reset(&err);
+}
+
+static void addAll(const u_int32_t *packetIDs, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        addPacketMetric(&metrics, &seen, packetIDs[i], 0);
+    }
+}
+
+Ensure(PacketMetrics, counts_packets_below_next_expected_as_reordered) {
+    // NextExp is 6 after packet 5, so 3 arrives 3 late and 4 arrives 2 late; the repeated 6 is a duplicate.
+    const u_int32_t packetIDs[] = {1, 2, 5, 3, 4, 6, 6};
+
+    addAll(packetIDs, sizeof(packetIDs) / sizeof(packetIDs[0]));
+    assert_that(metrics.unique, is_equal_to(6));
+    assert_that(metrics.duplicates, is_equal_to(1));
+    assert_that(metrics.reordered, is_equal_to(2));
+    assert_that(metrics.longestReorderDistance, is_equal_to(3));
+    assert_that(metrics.reorderHistogram[metricBucket(2)], is_equal_to(2));
+    assert_that(metrics.outOfOrder, is_equal_to(1));
+}
+
+Ensure(PacketMetrics, does_not_count_a_late_duplicate_as_reordered) {
+    const u_int32_t packetIDs[] = {1, 2, 3, 2};
+
+    addAll(packetIDs, sizeof(packetIDs) / sizeof(packetIDs[0]));
+    assert_that(metrics.duplicates, is_equal_to(1));
+    assert_that(metrics.reordered, is_equal_to(0));
+}
+
+Ensure(PacketMetrics, counts_loss_runs_up_to_the_last_expected_packet) {
+    const u_int32_t packetIDs[] = {1, 2, 4, 5, 9};
+
+    addAll(packetIDs, sizeof(packetIDs) / sizeof(packetIDs[0]));
+    finishPacketMetrics(&metrics, &seen, 1, 12);
+    assert_that(metrics.expected, is_equal_to(12));
+    assert_that(metrics.lost, is_equal_to(7));
+    assert_that(metrics.lossRuns, is_equal_to(3));
+    assert_that(metrics.shortestLossRun, is_equal_to(1));
+    assert_that(metrics.longestLossRun, is_equal_to(3));
+}
+
+Ensure(PacketMetrics, rejects_packet_numbers_far_past_the_test) {
+    assert_that(acceptPacketID(&metrics, 100, 100 + METRIC_PACKET_MARGIN), is_true);
+    assert_that(acceptPacketID(&metrics, 100, 101 + METRIC_PACKET_MARGIN), is_false);
+    assert_that(acceptPacketID(&metrics, 0, UINT32_MAX), is_false);
+    assert_that(metrics.malformed, is_equal_to(2));
+
+    // Without a registered count the limit follows the highest number accepted so far.
+    metrics.nextExpected = 70000;
+    assert_that(acceptPacketID(&metrics, 0, 70000 + METRIC_PACKET_MARGIN), is_true);
+    assert_that(metrics.malformed, is_equal_to(2));
+}
+
+Ensure(PacketMetrics, buckets_lengths_by_power_of_two) {
+    assert_that(metricBucket(1), is_equal_to(0));
+    assert_that(metricBucket(2), is_equal_to(1));
+    assert_that(metricBucket(3), is_equal_to(1));
+    assert_that(metricBucket(4), is_equal_to(2));
+    assert_that(metricBucket(UINT64_MAX), is_equal_to(METRIC_HISTOGRAM_BUCKETS - 1));
+}
+
+TestSuite *packetMetricsTests(void) {
+    TestSuite *suite = create_test_suite();
+
+    add_test_with_context(suite, PacketMetrics, counts_packets_below_next_expected_as_reordered);
+    add_test_with_context(suite, PacketMetrics, does_not_count_a_late_duplicate_as_reordered);
+    add_test_with_context(suite, PacketMetrics, counts_loss_runs_up_to_the_last_expected_packet);
+    add_test_with_context(suite, PacketMetrics, rejects_packet_numbers_far_past_the_test);
+    add_test_with_context(suite, PacketMetrics, buckets_lengths_by_power_of_two);
+
+    return suite;
+}
@@ -0,0 +1,303 @@
+#include "tests.h"
+#include "pcapReplay.h"
+
+#define CAPTURE_SIZE 1024
+
+static struct dc_posix_env env;
+static struct dc_error err;
+static struct replay_trace trace;
+static char path[] = "/tmp/pcapReplayTestsXXXXXX";
+static unsigned char capture[CAPTURE_SIZE];
+static size_t used;
+static bool bigEndian;
+
+static void put16(u_int16_t value);
+static void put32(u_int32_t value);
+static void putIPv4Udp(u_int16_t payload, u_int16_t port, u_int16_t fragment);
+static void putIPv6Udp(u_int16_t payload, u_int16_t port);
+static void putPcapHeader(u_int32_t magic, u_int32_t linkType);
+static void putPcapRecord(u_int32_t seconds, u_int32_t fraction, size_t frameStart);
+static int loadCapture(u_int16_t port);
+
+Describe(PcapReplay);
+
+BeforeEach(PcapReplay) {
+    dc_error_init(&err, NULL);
+    dc_posix_env_init(&env, NULL);
+    memset(&trace, 0, sizeof(trace));
+    memset(capture, 0, sizeof(capture));
+    used = 0;
+    bigEndian = false;
+}
+
+AfterEach(PcapReplay) {
+    freeReplayTrace(&env, &trace);
+    dc_error_reset(&err);
+}
+
+static void put16(u_int16_t value) {
+    capture[used++] = (unsigned char) (bigEndian ? value >> 8 : value & 0xFF);
+    capture[used++] = (unsigned char) (bigEndian ? value & 0xFF : value >> 8);
+}
+
+static void put32(u_int32_t value) {
+    put16((u_int16_t) (bigEndian ? value >> 16 : value & 0xFFFF));
+    put16((u_int16_t) (bigEndian ? value & 0xFFFF : value >> 16));
+}
+
+static void putIPv4Udp(u_int16_t payload, u_int16_t port, u_int16_t fragment) {
+    bool order = bigEndian;
+
+    // Only the headers are captured; the UDP length still gives the size on the wire.
+    bigEndian = true;
+    capture[used++] = 0x45;
+    capture[used++] = 0;
+    put16((u_int16_t) (28 + payload));
+    put32(0);
+    capture[used - 2] = (unsigned char) (fragment >> 8);
+    capture[used - 1] = (unsigned char) (fragment & 0xFF);
+    capture[used++] = 64;
+    capture[used++] = IPPROTO_UDP;
+    put16(0);
+    put32(0x0A000001);
+    put32(0x0A000002);
+    put16(40000);
+    put16(port);
+    put16((u_int16_t) (8 + payload));
+    put16(0);
+    bigEndian = order;
+}
+
+static void putIPv6Udp(u_int16_t payload, u_int16_t port) {
+    bool order = bigEndian;
+
+    bigEndian = true;
+    capture[used++] = 0x60;
+    used += 3;
+    put16((u_int16_t) (8 + payload));
+    capture[used++] = IPPROTO_UDP;
+    capture[used++] = 64;
+    used += 32;
+    put16(40000);
+    put16(port);
+    put16((u_int16_t) (8 + payload));
+    put16(0);
+    bigEndian = order;
+}
+
+static void putPcapHeader(u_int32_t magic, u_int32_t linkType) {
+    put32(magic);
+    put16(2);
+    put16(4);
+    put32(0);
+    put32(0);
+    put32(65535);
+    put32(linkType);
+}
+
+static void putPcapRecord(u_int32_t seconds, u_int32_t fraction, size_t frameStart) {
+    size_t frameLength = used - frameStart;
+
+    // The record header goes in front of a frame that was built first.
+    memmove(capture + frameStart + 16, capture + frameStart, frameLength);
+    used = frameStart;
+    put32(seconds);
+    put32(fraction);
+    put32((u_int32_t) frameLength);
+    put32((u_int32_t) frameLength);
+    used += frameLength;
+}
+
+static int loadCapture(u_int16_t port) {
+    int fd;
+    int ret_val;
+
+    memcpy(path + sizeof(path) - 7, "XXXXXX", 6);
+    fd = mkstemp(path);
+    assert_that(write(fd, capture, used), is_equal_to(used));
+    close(fd);
+    ret_val = loadReplayTrace(&env, &err, path, port, &trace);
+    unlink(path);
+
+    return ret_val;
+}
+
+Ensure(PcapReplay, reads_a_little_endian_microsecond_capture) {
+    size_t start;
+
+    putPcapHeader(PCAP_MAGIC_MICRO, PCAP_LINK_ETHERNET);
+    start = used;
+    used += 12;
+    bigEndian = true;
+    put16(0x0800);
+    bigEndian = false;
+    putIPv4Udp(100, 5000, 0);
+    putPcapRecord(1, 0, start);
+    start = used;
+    used += 12;
+    bigEndian = true;
+    put16(0x0800);
+    bigEndian = false;
+    putIPv4Udp(200, 5000, 0);
+    putPcapRecord(1, 500, start);
+
+    assert_that(loadCapture(0), is_equal_to(0));
+    assert_that(trace.count, is_equal_to(2));
+    assert_that(trace.sizes[0], is_equal_to(100));
+    assert_that(trace.sizes[1], is_equal_to(200));
+    assert_that(trace.offsets[0], is_equal_to(0));
+    assert_that(trace.offsets[1], is_equal_to(500000));
+    assert_that(meanReplaySize(&trace), is_equal_to(150));
+}
+
+Ensure(PcapReplay, reads_a_big_endian_nanosecond_capture_with_vlan_tags_and_ipv6) {
+    size_t start;
+
+    bigEndian = true;
+    putPcapHeader(PCAP_MAGIC_NANO, PCAP_LINK_ETHERNET);
+    start = used;
+    used += 12;
+    put16(0x8100);
+    put16(7);
+    put16(0x86DD);
+    putIPv6Udp(300, 5000);
+    putPcapRecord(2, 100, start);
+    start = used;
+    putIPv6Udp(300, 5000);
+    putPcapRecord(2, 350, start);
+    // The second frame has no link header, so it is not UDP to the reader.
+
+    assert_that(loadCapture(0), is_equal_to(0));
+    assert_that(trace.count, is_equal_to(1));
+    assert_that(trace.sizes[0], is_equal_to(300));
+}
+
+Ensure(PcapReplay, skips_other_ports_and_later_fragments) {
+    size_t start;
+
+    putPcapHeader(PCAP_MAGIC_MICRO, PCAP_LINK_RAW);
+    start = used;
+    putIPv4Udp(100, 5000, 0);
+    putPcapRecord(1, 0, start);
+    start = used;
+    putIPv4Udp(100, 6000, 0);
+    putPcapRecord(1, 10, start);
+    start = used;
+    putIPv4Udp(100, 5000, 185);
+    putPcapRecord(1, 20, start);
+
+    assert_that(loadCapture(5000), is_equal_to(0));
+    assert_that(trace.count, is_equal_to(1));
+}
+
+Ensure(PcapReplay, clamps_sizes_to_what_a_test_packet_can_carry) {
+    size_t start;
+
+    putPcapHeader(PCAP_MAGIC_MICRO, PCAP_LINK_RAW);
+    start = used;
+    putIPv4Udp(4, 5000, 0);
+    putPcapRecord(1, 0, start);
+
+    assert_that(loadCapture(0), is_equal_to(0));
+    assert_that(trace.sizes[0], is_equal_to(REPLAY_MIN_PACKET));
+    assert_that(trace.clamped, is_equal_to(1));
+}
+
+Ensure(PcapReplay, ends_at_a_record_cut_short) {
+    size_t start;
+
+    putPcapHeader(PCAP_MAGIC_MICRO, PCAP_LINK_RAW);
+    start = used;
+    putIPv4Udp(100, 5000, 0);
+    putPcapRecord(1, 0, start);
+    start = used;
+    putIPv4Udp(100, 5000, 0);
+    putPcapRecord(1, 10, start);
+    used -= 5;
+
+    assert_that(loadCapture(0), is_equal_to(0));
+    assert_that(trace.count, is_equal_to(1));
+}
+
+Ensure(PcapReplay, reads_pcapng_timestamps_in_each_interface_resolution) {
+    size_t start;
+
+    // Section header, then a microsecond interface and a nanosecond one, both raw IP.
+    put32(PCAPNG_SECTION_BLOCK);
+    put32(28);
+    put32(PCAPNG_BYTE_ORDER_MAGIC);
+    put16(1);
+    put16(0);
+    put32(0xFFFFFFFF);
+    put32(0xFFFFFFFF);
+    put32(28);
+
+    put32(PCAPNG_INTERFACE_BLOCK);
+    put32(20);
+    put16(PCAP_LINK_RAW);
+    put16(0);
+    put32(0);
+    put32(20);
+
+    put32(PCAPNG_INTERFACE_BLOCK);
+    put32(32);
+    put16(PCAP_LINK_RAW);
+    put16(0);
+    put32(0);
+    put16(PCAPNG_OPTION_TSRESOL);
+    put16(1);
+    capture[used] = 9;
+    used += 4;
+    put32(0);
+    put32(32);
+
+    // 1 s on the microsecond interface, then 1.000002 s on the nanosecond one.
+    start = used;
+    put32(PCAPNG_ENHANCED_BLOCK);
+    put32(60);
+    put32(0);
+    put32(0);
+    put32(1000000);
+    put32(28);
+    put32(28);
+    putIPv4Udp(100, 5000, 0);
+    put32(60);
+    assert_that(used - start, is_equal_to(60));
+
+    put32(PCAPNG_ENHANCED_BLOCK);
+    put32(60);
+    put32(1);
+    put32(0);
+    put32(1000002000);
+    put32(28);
+    put32(28);
+    putIPv4Udp(120, 5000, 0);
+    put32(60);
+
+    assert_that(loadCapture(0), is_equal_to(0));
+    assert_that(trace.count, is_equal_to(2));
+    assert_that(trace.sizes[1], is_equal_to(120));
+    assert_that(trace.offsets[1], is_equal_to(2000));
+}
+
+Ensure(PcapReplay, rejects_files_that_are_not_captures) {
+    memcpy(capture, "0001:000001:Mon Oct 19 10:00:00 2026:127.0.0.1:5000\n", 52);
+    used = 52;
+
+    assert_that(loadCapture(0), is_equal_to(-1));
+    assert_that(trace.sizes, is_null);
+}
+
+TestSuite *pcapReplayTests(void) {
+    TestSuite *suite = create_test_suite();
+
+    add_test_with_context(suite, PcapReplay, reads_a_little_endian_microsecond_capture);
+    add_test_with_context(suite, PcapReplay, reads_a_big_endian_nanosecond_capture_with_vlan_tags_and_ipv6);
+    add_test_with_context(suite, PcapReplay, skips_other_ports_and_later_fragments);
+    add_test_with_context(suite, PcapReplay, clamps_sizes_to_what_a_test_packet_can_carry);
+    add_test_with_context(suite, PcapReplay, ends_at_a_record_cut_short);
+    add_test_with_context(suite, PcapReplay, reads_pcapng_timestamps_in_each_interface_resolution);
+    add_test_with_context(suite, PcapReplay, rejects_files_that_are_not_captures);
+
+    return suite;
+}
@@ -0,0 +1,83 @@
+#include "tests.h"
+#include "rateSeries.h"
+
+static struct dc_posix_env env;
+static struct dc_error err;
+static struct rate_series series;
+
+static void countAll(u_int32_t clientID, const u_int32_t *packetIDs, size_t count);
+static const struct series_slot *currentSlot(void);
+
+Describe(RateSeries);
+
+BeforeEach(RateSeries) {
+    dc_error_init(&err, NULL);
+    dc_posix_env_init(&env, NULL);
+    assert_that(createRateSeries(&env, &err, &series, 1000, -1), is_equal_to(0));
+}
+
+AfterEach(RateSeries) {
+    destroyRateSeries(&env, &err, &series);
+    dc_error_reset(&err);
+}
+
+static void countAll(u_int32_t clientID, const u_int32_t *packetIDs, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        countRatePacket(&series, clientID, packetIDs[i], 100);
+    }
+}
+
+static const struct series_slot *currentSlot(void) {
+    return &series.slots[series.current % SERIES_SLOTS];
+}
+
+Ensure(RateSeries, counts_gaps_as_drops) {
+    const u_int32_t packetIDs[] = {1, 2, 5, 9};
+
+    countAll(1, packetIDs, sizeof(packetIDs) / sizeof(packetIDs[0]));
+    assert_that(currentSlot()->packets, is_equal_to(4));
+    assert_that(currentSlot()->bytes, is_equal_to(400));
+    assert_that(currentSlot()->drops, is_equal_to(5));
+    assert_that(series.totalDrops, is_equal_to(5));
+}
+
+Ensure(RateSeries, takes_a_drop_back_when_a_late_packet_fills_the_gap) {
+    const u_int32_t packetIDs[] = {1, 3, 2};
+
+    countAll(1, packetIDs, sizeof(packetIDs) / sizeof(packetIDs[0]));
+    assert_that(currentSlot()->drops, is_equal_to(0));
+    assert_that(currentSlot()->reorders, is_equal_to(1));
+    assert_that(series.totalDrops, is_equal_to(0));
+    assert_that(series.totalReorders, is_equal_to(1));
+}
+
+Ensure(RateSeries, counts_a_repeat_of_the_highest_packet_as_a_duplicate) {
+    const u_int32_t packetIDs[] = {1, 2, 2, 5, 3, 5};
+
+    countAll(1, packetIDs, sizeof(packetIDs) / sizeof(packetIDs[0]));
+    assert_that(series.totalDrops, is_equal_to(1));
+    assert_that(series.totalReorders, is_equal_to(1));
+    assert_that(series.totalDuplicates, is_equal_to(2));
+    assert_that(currentSlot()->reorders, is_equal_to(1));
+}
+
+Ensure(RateSeries, counts_datagrams_without_a_client_for_the_server_only) {
+    const u_int32_t packetIDs[] = {7, 1};
+
+    countAll(0, packetIDs, sizeof(packetIDs) / sizeof(packetIDs[0]));
+    assert_that(currentSlot()->packets, is_equal_to(2));
+    assert_that(currentSlot()->drops, is_equal_to(0));
+    assert_that(currentSlot()->reorders, is_equal_to(0));
+    assert_that(activeRateClients(&series), is_equal_to(0));
+}
+
+TestSuite *rateSeriesTests(void) {
+    TestSuite *suite = create_test_suite();
+
+    add_test_with_context(suite, RateSeries, counts_gaps_as_drops);
+    add_test_with_context(suite, RateSeries, takes_a_drop_back_when_a_late_packet_fills_the_gap);
+    add_test_with_context(suite, RateSeries, counts_a_repeat_of_the_highest_packet_as_a_duplicate);
+    add_test_with_context(suite, RateSeries, counts_datagrams_without_a_client_for_the_server_only);
+
+    return suite;
+}
@@ -3,6 +3,17 @@
 
 
 #include <cgreen/cgreen.h>
+#include <string.h>
+
+TestSuite *prngTests(void);
+TestSuite *packetBitsetTests(void);
+TestSuite *packetMetricsTests(void);
+TestSuite *logWindowsTests(void);
+TestSuite *logScannerTests(void);
+TestSuite *packedLogTests(void);
+TestSuite *pcapReplayTests(void);
+TestSuite *fastFormatTests(void);
+TestSuite *rateSeriesTests(void);
 
 
 #endif // LIBDC_POSIX_TESTS_H